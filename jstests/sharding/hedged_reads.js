@@ -0,0 +1,87 @@
+/**
+ * Tests that mongos hedges secondary reads to a second host of the shard when readHedgingDelayMS is
+ * set, that the cursors which the losing requests open are killed, and that without hedging a
+ * secondary whose operations are slow stops being selected.
+ */
+(function() {
+'use strict';
+
+const kSlowFindMillis = 5000;
+const kNumFinds = 20;
+
+const st = new ShardingTest({shards: 1, rs: {nodes: 3}, mongos: 1});
+const testDB = st.s.getDB('test');
+
+assert.commandWorked(
+    testDB.user.insert([{x: 0}, {x: 1}, {x: 2}, {x: 3}], {writeConcern: {w: 3}}));
+
+const secondaries = st.rs0.getSecondaries();
+awaitRSClientHosts(st.s, secondaries, {ok: true, secondary: true});
+
+// Delay every find which runs on one of the secondaries.
+const slowSecondary = secondaries[0];
+assert.commandWorked(slowSecondary.adminCommand({
+    configureFailPoint: 'sleepMillisAfterCommandExecutionBegins',
+    mode: 'alwaysOn',
+    data: {millis: kSlowFindMillis, commands: {find: 1}}
+}));
+
+// Profile the finds on the secondaries, so that the ones each secondary ran can be counted.
+secondaries.forEach(secondary => {
+    secondary.setSlaveOk();
+    assert.commandWorked(secondary.getDB('test').setProfilingLevel(2));
+});
+
+function numFindsRun(node) {
+    return node.getDB('test').system.profile.find({op: 'query', ns: 'test.user'}).itcount();
+}
+
+function runFindsOnSecondaries() {
+    let numSlowFinds = 0;
+    for (let i = 0; i < kNumFinds; i++) {
+        const start = Date.now();
+        assert.eq(4, testDB.user.find().readPref('secondary').batchSize(1).itcount());
+        if (Date.now() - start >= kSlowFindMillis) {
+            numSlowFinds++;
+        }
+    }
+    return numSlowFinds;
+}
+
+// With hedging enabled, a find which is sent to the slow secondary is also sent to the other one,
+// whose response is used.
+assert.commandWorked(st.s.adminCommand({setParameter: 1, readHedgingDelayMS: 50}));
+assert.eq(0, runFindsOnSecondaries());
+
+// The finds on the slow secondary leave a cursor open there, which mongos kills once they complete.
+assert.commandWorked(slowSecondary.adminCommand(
+    {configureFailPoint: 'sleepMillisAfterCommandExecutionBegins', mode: 'off'}));
+assert.soon(() => {
+    const numFindsInProgress = slowSecondary.getDB('admin')
+                                   .aggregate([{$currentOp: {}}, {$match: {'command.find': 'user'}}])
+                                   .itcount();
+    return numFindsInProgress == 0 &&
+        slowSecondary.getDB('admin').serverStatus().metrics.cursor.open.total == 0;
+});
+
+// Every find which was first sent to the slow secondary was hedged, so more finds ran on the
+// secondaries than were issued. Each find picks one of the two secondaries at random, so at least
+// one of them picked the slow one, except with negligible probability.
+assert.gt(numFindsRun(slowSecondary), 0);
+assert.gt(numFindsRun(secondaries[0]) + numFindsRun(secondaries[1]), kNumFinds);
+
+// Without hedging, the slow secondary is no longer selected once one of its finds was observed to
+// be slow.
+assert.commandWorked(slowSecondary.adminCommand({
+    configureFailPoint: 'sleepMillisAfterCommandExecutionBegins',
+    mode: 'alwaysOn',
+    data: {millis: kSlowFindMillis, commands: {find: 1}}
+}));
+assert.commandWorked(st.s.adminCommand({setParameter: 1, readHedgingDelayMS: 0}));
+assert.lte(runFindsOnSecondaries(), 1);
+
+assert.commandWorked(slowSecondary.adminCommand(
+    {configureFailPoint: 'sleepMillisAfterCommandExecutionBegins', mode: 'off'}));
+
+st.stop();
+})();
@@ -98,6 +98,12 @@ public:
      */
     virtual void markHostUnreachable(const HostAndPort& host, const Status& status) = 0;
 
+    /**
+     * Reports to the targeter that an operation sent to 'host' took 'latency' to complete, so that
+     * it can prefer the hosts which serve operations fastest on subsequent requests.
+     */
+    virtual void noteOperationLatency(const HostAndPort& host, Milliseconds latency) = 0;
+
 protected:
     RemoteCommandTargeter() = default;
 };
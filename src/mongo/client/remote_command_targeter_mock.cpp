@@ -87,6 +87,9 @@ void RemoteCommandTargeterMock::markHostUnreachable(const HostAndPort& host, con
     _hostsMarkedDown.insert(host);
 }
 
+void RemoteCommandTargeterMock::noteOperationLatency(const HostAndPort& host,
+                                                     Milliseconds latency) {}
+
 void RemoteCommandTargeterMock::setConnectionStringReturnValue(const ConnectionString returnValue) {
     _connectionStringReturnValue = std::move(returnValue);
 }
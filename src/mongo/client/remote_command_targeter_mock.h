@@ -76,6 +76,11 @@ public:
      */
     void markHostUnreachable(const HostAndPort& host, const Status& status) override;
 
+    /**
+     * No-op.
+     */
+    void noteOperationLatency(const HostAndPort& host, Milliseconds latency) override;
+
     /**
      * Sets the return value for the next call to connectionString.
      */
@@ -68,4 +68,9 @@ void RemoteCommandTargeterStandalone::markHostUnreachable(const HostAndPort& hos
     dassert(host == _hostAndPort);
 }
 
+void RemoteCommandTargeterStandalone::noteOperationLatency(const HostAndPort& host,
+                                                           Milliseconds latency) {
+    dassert(host == _hostAndPort);
+}
+
 }  // namespace mongo
@@ -106,7 +106,7 @@ bool opTimeGreater(const Node* lhs, const Node* rhs) {
 
 bool compareLatencies(const Node* lhs, const Node* rhs) {
     // NOTE: this automatically compares Node::unknownLatency worse than all others.
-    return lhs->latencyMicros < rhs->latencyMicros;
+    return lhs->selectionLatencyMicros() < rhs->selectionLatencyMicros();
 }
 
 bool hostsEqual(const Node& lhs, const HostAndPort& rhs) {
@@ -359,6 +359,13 @@ void ReplicaSetMonitor::failedHost(const HostAndPort& host, const Status& status
         _state->checkInvariants();
 }
 
+void ReplicaSetMonitor::noteOperationLatency(const HostAndPort& host, Microseconds latency) {
+    stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+    Node* node = _state->findNode(host);
+    if (node)
+        node->updateOperationLatency(durationCount<Microseconds>(latency));
+}
+
 bool ReplicaSetMonitor::isPrimary(const HostAndPort& host) const {
     stdx::lock_guard<stdx::mutex> lk(_state->mutex);
     Node* node = _state->findNode(host);
@@ -969,7 +976,8 @@ void IsMasterReply::parse(const BSONObj& obj) {
     }
 }
 
-Node::Node(const HostAndPort& host) : host(host), latencyMicros(unknownLatency) {}
+Node::Node(const HostAndPort& host)
+    : host(host), latencyMicros(unknownLatency), operationLatencyMicros(unknownLatency) {}
 
 void Node::markFailed(const Status& status) {
     if (isUp) {
@@ -1033,6 +1041,13 @@ void Node::update(const IsMasterReply& reply) {
             // update latency with smoothed moving average (1/4th the delta)
             latencyMicros += (reply.latencyMicros - latencyMicros) / 4;
         }
+
+        // A node which has become slow stops being selected and so stops reporting operation
+        // latencies. Pull the operation latency towards the ping time so that the node is tried
+        // again once its heartbeats show it has recovered.
+        if (operationLatencyMicros != unknownLatency) {
+            operationLatencyMicros += (reply.latencyMicros - operationLatencyMicros) / 4;
+        }
     }
 
     LOG(3) << "Updating " << host << " lastWriteDate to " << reply.lastWriteDate;
@@ -1043,6 +1058,27 @@ void Node::update(const IsMasterReply& reply) {
     lastWriteDateUpdateTime = Date_t::now();
 }
 
+void Node::updateOperationLatency(int64_t operationMicros) {
+    if (operationMicros < 0) {
+        return;
+    }
+
+    if (operationLatencyMicros == unknownLatency) {
+        operationLatencyMicros = operationMicros;
+    } else {
+        // Smoothed with a smaller weight than the ping time, since operations are sampled far more
+        // often than heartbeats and vary with the work they do
+        operationLatencyMicros += (operationMicros - operationLatencyMicros) / 8;
+    }
+}
+
+int64_t Node::selectionLatencyMicros() const {
+    if (operationLatencyMicros == unknownLatency || latencyMicros == unknownLatency) {
+        return latencyMicros;
+    }
+    return std::max(latencyMicros, operationLatencyMicros);
+}
+
 SetState::SetState(const MongoURI& uri,
                    ReplicaSetChangeNotifier* notifier,
                    executor::TaskExecutor* executor)
@@ -1209,8 +1245,8 @@ std::vector<HostAndPort> SetState::getMatchingHosts(const ReadPreferenceSetting&
             // and don't consider hosts further than a threshold from the closest.
             std::sort(allMatchingNodes.begin(), allMatchingNodes.end(), compareLatencies);
             for (size_t i = 1; i < allMatchingNodes.size(); i++) {
-                int64_t distance =
-                    allMatchingNodes[i]->latencyMicros - allMatchingNodes[0]->latencyMicros;
+                int64_t distance = allMatchingNodes[i]->selectionLatencyMicros() -
+                    allMatchingNodes[0]->selectionLatencyMicros();
                 if (distance >= latencyThresholdMicros) {
                     // this node and all remaining ones are too far away
                     allMatchingNodes.erase(allMatchingNodes.begin() + i, allMatchingNodes.end());
@@ -115,6 +115,13 @@ public:
      */
     void failedHost(const HostAndPort& host, const Status& status);
 
+    /**
+     * Notifies this Monitor of how long an operation sent to the given host took, from sending the
+     * request to receiving its response. Hosts whose operations are consistently slower than those
+     * of the other eligible hosts by more than the latency threshold are not selected.
+     */
+    void noteOperationLatency(const HostAndPort& host, Microseconds latency);
+
     /**
      * Returns true if this node is the master based ONLY on local data. Be careful, return may
      * be stale.
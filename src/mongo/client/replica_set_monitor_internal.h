@@ -133,10 +133,24 @@ public:
          */
         void update(const IsMasterReply& reply);
 
+        /**
+         * Folds the time an operation sent to this node took into the moving average of its
+         * operation latency.
+         */
+        void updateOperationLatency(int64_t operationMicros);
+
+        /**
+         * The latency by which this node is ranked when selecting hosts: the larger of the ping
+         * time and the latency observed for operations, so that a node which answers heartbeats
+         * promptly but is slow to serve operations is not preferred.
+         */
+        int64_t selectionLatencyMicros() const;
+
         HostAndPort host;
         bool isUp{false};
         bool isMaster{false};
         int64_t latencyMicros{};
+        int64_t operationLatencyMicros{};  // moving average of the operations run on this node
         BSONObj tags;  // owned
         int minWireVersion{};
         int maxWireVersion{};
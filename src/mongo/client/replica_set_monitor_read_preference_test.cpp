@@ -366,6 +366,25 @@ TEST_F(ReadPrefTest, NearestOneLocal) {
     ASSERT(!isPrimarySelected);
 }
 
+TEST_F(ReadPrefTest, NearestSlowOperationsExcluded) {
+    auto nodes = getThreeMemberWithTags();
+    TagSet tags(getDefaultTagSet());
+
+    nodes[0].latencyMicros = 1 * 1000;
+    nodes[1].latencyMicros = 2 * 1000;
+    nodes[2].latencyMicros = 3 * 1000;
+
+    // The closest node by ping time has been slow to serve operations
+    nodes[0].updateOperationLatency(50 * 1000);
+    nodes[1].updateOperationLatency(2 * 1000);
+
+    bool isPrimarySelected = false;
+    auto hosts = selectNodes(nodes, mongo::ReadPreference::Nearest, tags, 3, &isPrimarySelected);
+
+    ASSERT_EQUALS(2U, hosts.size());
+    ASSERT(std::find(hosts.begin(), hosts.end(), HostAndPort("a")) == hosts.end());
+}
+
 TEST_F(ReadPrefTest, PriOnlyWithTagsNoMatch) {
     auto nodes = getThreeMemberWithTags();
     TagSet tags(getP2TagSet());
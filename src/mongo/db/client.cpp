@@ -97,6 +97,10 @@ Client::Client(std::string desc, ServiceContext* serviceContext, transport::Sess
       _connectionId(_session ? _session->id() : 0),
       _prng(generateSeed(_desc)) {}
 
+Client::~Client() {
+    ::operator delete(_recycledOperationContextBlock.load());
+}
+
 void Client::reportState(BSONObjBuilder& builder) {
     builder.append("desc", desc());
 
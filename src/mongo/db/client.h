@@ -41,6 +41,7 @@
 
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/random.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/transport/session.h"
@@ -62,6 +63,8 @@ typedef long long ConnectionId;
  * */
 class Client final : public Decorable<Client> {
 public:
+    ~Client();
+
     /**
      * Creates a Client object and stores it in TLS for the current thread.
      *
@@ -253,6 +256,10 @@ private:
     bool _systemOperationKillable = false;
 
     PseudoRandom _prng;
+
+    // Memory left by the last OperationContext destroyed on this client, which the next one reuses.
+    // See ServiceContext::makeOperationContext().
+    AtomicWord<void*> _recycledOperationContextBlock{nullptr};
 };
 
 /**
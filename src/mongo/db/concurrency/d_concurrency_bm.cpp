@@ -40,7 +40,7 @@
 namespace mongo {
 namespace {
 
-const int kMaxPerfThreads = 16;  // max number of threads to use for lock perf
+const int kMaxPerfThreads = 64;  // max number of threads to use for lock perf
 
 
 class DConcurrencyTest : public benchmark::Fixture {
@@ -397,12 +397,14 @@ void LockHead::migratePartitionedLockHeads() {
 const unsigned LockManager::_numLockBuckets(128);
 
 // Balance scalability of intent locks against potential added cost of conflicting locks.
-// The exact value doesn't appear very important, but should be power of two
-const unsigned LockManager::_numPartitions = 32;
+// The exact value doesn't appear very important, but should be power of two. Lockers which share a
+// partition contend on its mutex for every intent lock, so have at least as many partitions as
+// there are commonly cores.
+const unsigned LockManager::_numPartitions = 64;
 
 LockManager::LockManager() {
-    _lockBuckets = new LockBucket[_numLockBuckets];
-    _partitions = new Partition[_numPartitions];
+    _lockBuckets = new CacheAligned<LockBucket>[_numLockBuckets];
+    _partitions = new CacheAligned<Partition>[_numPartitions];
 }
 
 LockManager::~LockManager() {
@@ -44,6 +44,7 @@
 #include "mongo/stdx/mutex.h"
 #include "mongo/stdx/unordered_map.h"
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/with_alignment.h"
 
 namespace mongo {
 
@@ -210,10 +211,12 @@ private:
      */
     void _cleanupUnusedLocksInBucket(LockBucket* bucket);
 
+    // Buckets and partitions are cache aligned, so that threads which use different ones don't
+    // contend on the same cache lines.
     static const unsigned _numLockBuckets;
-    LockBucket* _lockBuckets;
+    CacheAligned<LockBucket>* _lockBuckets;
 
     static const unsigned _numPartitions;
-    Partition* _partitions;
+    CacheAligned<Partition>* _partitions;
 };
 }  // namespace mongo
@@ -101,6 +101,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/periodic_runner_job_abort_expired_transactions.h"
 #include "mongo/db/periodic_runner_job_decrease_snapshot_cache_pressure.h"
+#include "mongo/db/pipeline/change_stream_oplog_multiplexer.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repair_database_and_check_version.h"
 #include "mongo/db/repl/drop_pending_collection_reaper.h"
@@ -976,6 +977,9 @@ void shutdownTask(const ShutdownTaskArgs& shutdownArgs) {
     // Depends on setKillAllOperations() above to interrupt the index build operations.
     IndexBuildsCoordinator::get(serviceContext)->shutdown();
 
+    // Evicts the change streams attached to the shared oplog scan and stops its tailer thread.
+    ChangeStreamOplogMultiplexer::get(serviceContext)->shutdown();
+
     ReplicaSetMonitor::shutdown();
 
     if (auto sr = Grid::get(serviceContext)->shardRegistry()) {
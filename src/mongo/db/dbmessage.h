@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+
 #include "mongo/base/static_assert.h"
 #include "mongo/bson/bson_validate.h"
 #include "mongo/client/constants.h"
@@ -448,6 +450,9 @@ struct DbResponse {
     // Cursor ID when running on exhaust mode. Defaults to '0', indicating
     // that the cursor is exhausted.
     long long exhaustCursorId = 0;
+    // The command body to use for the next invocation of an exhaust command. If this is
+    // boost::none, the previous invocation is reused unchanged for the next invocation.
+    boost::optional<BSONObj> nextInvocation;
 };
 
 /**
@@ -53,8 +53,12 @@ const char* ShardFilterStage::kStageType = "SHARDING_FILTER";
 ShardFilterStage::ShardFilterStage(OperationContext* opCtx,
                                    ScopedCollectionMetadata metadata,
                                    WorkingSet* ws,
-                                   PlanStage* child)
-    : PlanStage(kStageType, opCtx), _ws(ws), _shardFilterer(std::move(metadata)) {
+                                   PlanStage* child,
+                                   bool childReturnsOnlyOwnedDocuments)
+    : PlanStage(kStageType, opCtx),
+      _ws(ws),
+      _shardFilterer(std::move(metadata)),
+      _childReturnsOnlyOwnedDocuments(childReturnsOnlyOwnedDocuments) {
     _children.emplace_back(child);
 }
 
@@ -76,7 +80,7 @@ PlanStage::StageState ShardFilterStage::doWork(WorkingSetID* out) {
         // If we're sharded make sure that we don't return data that is not owned by us,
         // including pending documents from in-progress migrations and orphaned documents from
         // aborted migrations
-        if (_shardFilterer.isCollectionSharded()) {
+        if (_shardFilterer.isCollectionSharded() && !_childReturnsOnlyOwnedDocuments) {
             WorkingSetMember* member = _ws->get(*out);
             WorkingSetMatchableDocument matchable(member);
 
@@ -71,10 +71,16 @@ namespace mongo {
  */
 class ShardFilterStage final : public PlanStage {
 public:
+    /**
+     * If 'childReturnsOnlyOwnedDocuments' is true, the caller has established that the child can
+     * only return documents within chunks owned by this shard, so they are passed through without
+     * extracting their shard keys. The stage still holds on to the metadata.
+     */
     ShardFilterStage(OperationContext* opCtx,
                      ScopedCollectionMetadata metadata,
                      WorkingSet* ws,
-                     PlanStage* child);
+                     PlanStage* child,
+                     bool childReturnsOnlyOwnedDocuments = false);
     ~ShardFilterStage();
 
     bool isEOF() final;
@@ -103,6 +109,8 @@ private:
     // ScopedCollectionMetadata for the entire query, it'd be possible for data which the query
     // needs to read to be deleted while it's still running.
     ShardFiltererImpl _shardFilterer;
+
+    const bool _childReturnsOnlyOwnedDocuments;
 };
 
 }  // namespace mongo
@@ -54,8 +54,9 @@ ShardFilterer::DocumentBelongsResult ShardFiltererImpl::documentBelongsToMe(
         return DocumentBelongsResult::kNoShardKey;
     }
 
-    return _metadata->keyBelongsToMe(shardKey) ? DocumentBelongsResult::kBelongs
-                                               : DocumentBelongsResult::kDoesNotBelong;
+    return _metadata->keyBelongsToMe(shardKey, &_lastChunk)
+        ? DocumentBelongsResult::kBelongs
+        : DocumentBelongsResult::kDoesNotBelong;
 }
 
 }  // namespace mongo
@@ -53,5 +53,10 @@ public:
 private:
     ScopedCollectionMetadata _metadata;
     boost::optional<ShardKeyPattern> _keyPattern;
+
+    // The chunk which contained the shard key of the last document checked. Documents usually
+    // arrive in clusters of shard key values, so most of them fall within this chunk and need no
+    // lookup in the routing table.
+    mutable boost::optional<Chunk> _lastChunk;
 };
 }  // namespace mongo
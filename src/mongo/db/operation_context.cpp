@@ -80,7 +80,13 @@ const auto kNoWaiterThread = stdx::thread::id();
 }  // namespace
 
 OperationContext::OperationContext(Client* client, unsigned int opId)
-    : _client(client),
+    : OperationContext(client, opId, nullptr) {}
+
+OperationContext::OperationContext(Client* client,
+                                   unsigned int opId,
+                                   unsigned char* decorationBuffer)
+    : Decorable<OperationContext>(decorationBuffer),
+      _client(client),
       _opId(opId),
       _elapsedTime(client ? client->getServiceContext()->getTickSource()
                           : SystemTickSource::get()) {}
@@ -78,6 +78,15 @@ class OperationContext : public Interruptible, public Decorable<OperationContext
 
 public:
     OperationContext(Client* client, unsigned int opId);
+
+    /**
+     * Like the above, but places the decorations in "decorationBuffer" rather than allocating
+     * storage for them, unless it is null. The buffer must have room for
+     * getDecorationBufferSizeBytes() bytes, be aligned like memory returned by operator new, and
+     * outlive the OperationContext.
+     */
+    OperationContext(Client* client, unsigned int opId, unsigned char* decorationBuffer);
+
     virtual ~OperationContext();
 
     bool shouldParticipateInFlowControl() const {
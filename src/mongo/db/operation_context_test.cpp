@@ -52,6 +52,8 @@ namespace {
 
 using unittest::assertGet;
 
+const auto getCounter = OperationContext::declareDecoration<int>();
+
 std::ostream& operator<<(std::ostream& os, stdx::cv_status cvStatus) {
     switch (cvStatus) {
         case stdx::cv_status::timeout:
@@ -243,6 +245,30 @@ TEST(OperationContextTest, setIsExecutingShutdownWorks) {
     ASSERT_OK(opCtx->getKillStatus());
 }
 
+TEST(OperationContextTest, SuccessiveOperationContextsOnClientGetFreshDecorations) {
+    auto serviceCtx = ServiceContext::make();
+    auto client = serviceCtx->makeClient("OperationContextTest");
+
+    auto opCtx = client->makeOperationContext();
+    auto* const firstOpCtx = opCtx.get();
+    const auto firstOpId = opCtx->getOpID();
+    getCounter(opCtx.get()) = 42;
+    opCtx.reset();
+
+    // The next OperationContext may reuse the memory of the previous one, but must be constructed
+    // from scratch, decorations included.
+    opCtx = client->makeOperationContext();
+    ASSERT_EQUALS(firstOpCtx, opCtx.get());
+    ASSERT_NOT_EQUALS(firstOpId, opCtx->getOpID());
+    ASSERT_EQUALS(0, getCounter(opCtx.get()));
+
+    // An OperationContext made on another client while the first is alive gets memory of its own.
+    auto otherClient = serviceCtx->makeClient("OperationContextTest");
+    auto otherOpCtx = otherClient->makeOperationContext();
+    ASSERT_NOT_EQUALS(opCtx.get(), otherOpCtx.get());
+    ASSERT_EQUALS(0, getCounter(otherOpCtx.get()));
+}
+
 class OperationDeadlineTests : public unittest::Test {
 public:
     void setUp() {
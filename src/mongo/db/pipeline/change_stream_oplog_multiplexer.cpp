@@ -0,0 +1,519 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/change_stream_oplog_multiplexer.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/exec/collection_scan.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/repl/optime.h"
+#include "mongo/db/service_context.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+namespace {
+
+const auto getMultiplexer = ServiceContext::declareDecoration<ChangeStreamOplogMultiplexer>();
+
+// The most oplog entries the tailer reads under one snapshot before publishing them.
+constexpr size_t kMaxEntriesPerBatch = 1000;
+
+// How long the tailer waits for the oplog to change before checking whether it should stop.
+constexpr Milliseconds kTailerIdleWait{1000};
+
+void removeStream(std::vector<ChangeStreamOplogMultiplexer::Subscription*>* streams,
+                  ChangeStreamOplogMultiplexer::Subscription* subscription) {
+    streams->erase(std::remove(streams->begin(), streams->end(), subscription), streams->end());
+}
+
+void removeStream(StringMap<std::vector<ChangeStreamOplogMultiplexer::Subscription*>>* index,
+                  StringData key,
+                  ChangeStreamOplogMultiplexer::Subscription* subscription) {
+    auto it = index->find(key);
+    if (it == index->end()) {
+        return;
+    }
+    removeStream(&it->second, subscription);
+    if (it->second.empty()) {
+        index->erase(it);
+    }
+}
+
+/**
+ * Reads up to kMaxEntriesPerBatch majority-committed oplog entries after 'readAfter' into
+ * 'entries'. Returns the oplog's insert notifier, with its version as of before the read in
+ * 'notifierVersion', or nullptr if there is no majority-committed snapshot yet.
+ */
+std::shared_ptr<CappedInsertNotifier> readOplogBatch(OperationContext* opCtx,
+                                                     Timestamp readAfter,
+                                                     std::vector<BSONObj>* entries,
+                                                     uint64_t* notifierVersion) {
+    // Read at the majority commit point, as the change streams themselves do, so that no stream
+    // observes an entry which may yet be rolled back.
+    opCtx->recoveryUnit()->abandonSnapshot();
+    opCtx->recoveryUnit()->setTimestampReadSource(RecoveryUnit::ReadSource::kMajorityCommitted);
+    auto status = opCtx->recoveryUnit()->obtainMajorityCommittedSnapshot();
+    if (status == ErrorCodes::ReadConcernMajorityNotAvailableYet) {
+        return nullptr;
+    }
+    uassertStatusOK(status);
+
+    AutoGetCollectionForRead autoColl(opCtx, NamespaceString::kRsOplogNamespace);
+    auto oplog = autoColl.getCollection();
+    uassert(ErrorCodes::NamespaceNotFound, "The oplog does not exist", oplog);
+
+    // Sample the version before reading, so that an insert which lands after the read is not
+    // missed by the subsequent wait.
+    auto notifier = oplog->getCappedInsertNotifier();
+    *notifierVersion = notifier->getVersion();
+
+    CollectionScanParams params;
+    if (!readAfter.isNull()) {
+        params.minTs = readAfter;
+    }
+    auto ws = std::make_unique<WorkingSet>();
+    auto scan = std::make_unique<CollectionScan>(opCtx, oplog, params, ws.get(), nullptr);
+    auto exec = uassertStatusOK(PlanExecutor::make(
+        opCtx, std::move(ws), std::move(scan), oplog, PlanExecutor::NO_YIELD));
+
+    BSONObj entry;
+    while (entries->size() < kMaxEntriesPerBatch) {
+        auto state = exec->getNext(&entry, nullptr);
+        if (state == PlanExecutor::IS_EOF) {
+            break;
+        }
+        if (state != PlanExecutor::ADVANCED) {
+            uassertStatusOK(WorkingSetCommon::getMemberObjectStatus(entry).withContext(
+                "Change stream oplog multiplexer failed to read the oplog"));
+        }
+        if (entry[repl::OpTime::kTimestampFieldName].timestamp() > readAfter) {
+            entries->push_back(entry.getOwned());
+        }
+    }
+    return notifier;
+}
+
+class ChangeStreamOplogMultiplexerSSS final : public ServerStatusSection {
+public:
+    ChangeStreamOplogMultiplexerSSS() : ServerStatusSection("changeStreamOplogMultiplexer") {}
+
+    bool includeByDefault() const final {
+        return true;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx,
+                            const BSONElement& configElement) const final {
+        BSONObjBuilder builder;
+        ChangeStreamOplogMultiplexer::get(opCtx->getServiceContext())->appendStats(&builder);
+        return builder.obj();
+    }
+} changeStreamOplogMultiplexerSSS;
+
+}  // namespace
+
+ChangeStreamOplogMultiplexer::Subscription::Subscription(
+    NamespaceString nss,
+    BSONObj filter,
+    boost::intrusive_ptr<ExpressionContext> expCtx,
+    std::unique_ptr<MatchExpression> matcher)
+    : _nss(std::move(nss)),
+      _type(DocumentSourceChangeStream::getChangeStreamType(_nss)),
+      _filter(std::move(filter)),
+      _expCtx(std::move(expCtx)),
+      _matcher(std::move(matcher)) {}
+
+boost::optional<BSONObj> ChangeStreamOplogMultiplexer::Subscription::next() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    uassertStatusOK(_evictedStatus);
+
+    if (_buffer.empty()) {
+        // Every entry up to the point the oplog has been scanned has now been consumed.
+        _latestOplogTimestamp = _scannedThrough;
+        return boost::none;
+    }
+
+    auto entry = std::move(_buffer.front());
+    _buffer.pop_front();
+    _bufferedBytes -= entry.objsize();
+    _latestOplogTimestamp = entry[repl::OpTime::kTimestampFieldName].timestamp();
+    return entry;
+}
+
+void ChangeStreamOplogMultiplexer::Subscription::waitForEntries(OperationContext* opCtx,
+                                                                Date_t deadline) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    opCtx->waitForConditionOrInterruptUntil(_entriesAvailable, lk, deadline, [&] {
+        return !_buffer.empty() || !_evictedStatus.isOK();
+    });
+}
+
+Timestamp ChangeStreamOplogMultiplexer::Subscription::getLatestOplogTimestamp() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _latestOplogTimestamp;
+}
+
+bool ChangeStreamOplogMultiplexer::Subscription::_deliver(std::vector<BSONObj> entries,
+                                                          Timestamp scannedThrough,
+                                                          long long maxBufferBytes) {
+    long long entriesBytes = 0;
+    for (auto&& entry : entries) {
+        entriesBytes += entry.objsize();
+    }
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (!_evictedStatus.isOK()) {
+            return false;
+        }
+        if (_bufferedBytes + entriesBytes <= maxBufferBytes) {
+            _scannedThrough = scannedThrough;
+            if (!entries.empty()) {
+                std::move(entries.begin(), entries.end(), std::back_inserter(_buffer));
+                _bufferedBytes += entriesBytes;
+                _entriesAvailable.notify_all();
+            }
+            return true;
+        }
+    }
+
+    _evict({ErrorCodes::RetryChangeStream,
+            str::stream() << "Change stream on " << _nss.ns()
+                          << " fell too far behind the oplog and was closed; "
+                          << "it may be resumed from its last resume token"});
+    return false;
+}
+
+void ChangeStreamOplogMultiplexer::Subscription::_evict(Status status) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (!_evictedStatus.isOK()) {
+        return;
+    }
+    _evictedStatus = std::move(status);
+    _buffer.clear();
+    _bufferedBytes = 0;
+    _entriesAvailable.notify_all();
+}
+
+ChangeStreamOplogMultiplexer::ChangeStreamOplogMultiplexer(bool runTailer)
+    : _runTailer(runTailer) {}
+
+ChangeStreamOplogMultiplexer::~ChangeStreamOplogMultiplexer() {
+    shutdown();
+}
+
+ChangeStreamOplogMultiplexer* ChangeStreamOplogMultiplexer::get(ServiceContext* serviceContext) {
+    return &getMultiplexer(serviceContext);
+}
+
+std::shared_ptr<ChangeStreamOplogMultiplexer::Subscription> ChangeStreamOplogMultiplexer::subscribe(
+    OperationContext* opCtx,
+    const NamespaceString& nss,
+    const BSONObj& filter,
+    Timestamp startFrom,
+    bool startFromInclusive) {
+    // The filter is parsed once, here, and evaluated by the tailer against the raw oplog entries,
+    // which must use the simple collation regardless of the collation of the stream.
+    auto expCtx = make_intrusive<ExpressionContext>(opCtx, nullptr);
+    auto ownedFilter = filter.getOwned();
+    auto matcher = uassertStatusOK(MatchExpressionParser::parse(ownedFilter, expCtx));
+    auto subscription = std::make_shared<Subscription>(
+        nss, std::move(ownedFilter), std::move(expCtx), std::move(matcher));
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_inShutdown) {
+        return nullptr;
+    }
+
+    if (!_tailerRunning && _subscriptions.empty()) {
+        // Nothing is reading the oplog, so the tailer can start from wherever this stream needs.
+        _publishedThrough = (startFromInclusive && !startFrom.isNull())
+            ? Timestamp(startFrom.asULL() - 1)
+            : startFrom;
+    }
+
+    // A stream which needs entries that have already been published must read the oplog itself.
+    if (startFromInclusive ? _publishedThrough >= startFrom : _publishedThrough > startFrom) {
+        return nullptr;
+    }
+
+    subscription->_scannedThrough = _publishedThrough;
+    subscription->_latestOplogTimestamp = _publishedThrough;
+
+    auto raw = subscription.get();
+    _subscriptions.push_back(subscription);
+    switch (subscription->_type) {
+        case DocumentSourceChangeStream::ChangeStreamType::kSingleCollection:
+            _byCollection[nss.ns()].push_back(raw);
+            break;
+        case DocumentSourceChangeStream::ChangeStreamType::kSingleDatabase:
+            _byDatabase[nss.db().toString()].push_back(raw);
+            break;
+        case DocumentSourceChangeStream::ChangeStreamType::kAllChangesForCluster:
+            _wholeCluster.push_back(raw);
+            break;
+    }
+
+    if (_runTailer && !_tailerRunning) {
+        // A previous tailer may have stopped when its last stream went away. It no longer needs
+        // '_mutex', so it is safe to wait for it here.
+        if (_tailer.joinable()) {
+            _tailer.join();
+        }
+        _tailerRunning = true;
+        _tailer = stdx::thread(
+            [this, serviceContext = opCtx->getServiceContext()] { _tailerLoop(serviceContext); });
+    }
+
+    return subscription;
+}
+
+void ChangeStreamOplogMultiplexer::unsubscribe(const std::shared_ptr<Subscription>& subscription) {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _removeFromIndex(lk, subscription.get());
+    }
+    subscription->_evict({ErrorCodes::CursorKilled, "Change stream was closed"});
+}
+
+void ChangeStreamOplogMultiplexer::publish(const std::vector<BSONObj>& entries,
+                                           Timestamp scannedThrough) {
+    const auto maxBufferBytes = internalQueryChangeStreamOplogMultiplexerMaxBufferBytes.load();
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    // Match every entry against the interested streams first, so that each stream's buffer is
+    // only locked once per batch.
+    stdx::unordered_map<Subscription*, std::vector<BSONObj>> matches;
+    std::vector<Subscription*> candidates;
+    for (auto&& entry : entries) {
+        candidates.clear();
+        _gatherCandidates(lk, entry, &candidates);
+        for (auto subscription : candidates) {
+            if (subscription->_matcher->matchesBSON(entry)) {
+                matches[subscription].push_back(entry);
+            }
+        }
+    }
+    _entriesScanned.fetchAndAdd(entries.size());
+
+    // Every stream is told how far the oplog has been read, even if nothing matched, so that it
+    // can advance its resume token.
+    std::vector<Subscription*> evicted;
+    for (auto&& subscription : _subscriptions) {
+        std::vector<BSONObj> streamEntries;
+        auto it = matches.find(subscription.get());
+        if (it != matches.end()) {
+            streamEntries = std::move(it->second);
+        }
+        const auto numEntries = streamEntries.size();
+        if (subscription->_deliver(std::move(streamEntries), scannedThrough, maxBufferBytes)) {
+            _entriesDelivered.fetchAndAdd(numEntries);
+        } else {
+            evicted.push_back(subscription.get());
+        }
+    }
+
+    for (auto subscription : evicted) {
+        LOG(1) << "Evicting change stream on " << subscription->getNamespace()
+               << " from the oplog multiplexer because its buffer is full";
+        _removeFromIndex(lk, subscription);
+    }
+    _streamsEvicted.fetchAndAdd(evicted.size());
+
+    _publishedThrough = std::max(_publishedThrough, scannedThrough);
+}
+
+void ChangeStreamOplogMultiplexer::shutdown() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _inShutdown = true;
+        _evictAll(lk, {ErrorCodes::InterruptedAtShutdown, "Change stream multiplexer shut down"});
+    }
+
+    if (_tailer.joinable()) {
+        _tailer.join();
+    }
+}
+
+void ChangeStreamOplogMultiplexer::appendStats(BSONObjBuilder* builder) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    long long bufferedEntries = 0;
+    long long bufferedBytes = 0;
+    long long largestBufferBytes = 0;
+    for (auto&& subscription : _subscriptions) {
+        stdx::lock_guard<stdx::mutex> subscriptionLock(subscription->_mutex);
+        bufferedEntries += subscription->_buffer.size();
+        bufferedBytes += subscription->_bufferedBytes;
+        largestBufferBytes = std::max(largestBufferBytes, subscription->_bufferedBytes);
+    }
+
+    builder->append("attachedStreams", static_cast<long long>(_subscriptions.size()));
+    builder->append("tailerRunning", _tailerRunning);
+    builder->append("publishedThrough", _publishedThrough);
+    {
+        BSONObjBuilder buffers(builder->subobjStart("buffers"));
+        buffers.append("entries", bufferedEntries);
+        buffers.append("bytes", bufferedBytes);
+        buffers.append("largestBytes", largestBufferBytes);
+    }
+    builder->append("entriesScanned", _entriesScanned.load());
+    builder->append("entriesDelivered", _entriesDelivered.load());
+    builder->append("streamsEvicted", _streamsEvicted.load());
+}
+
+void ChangeStreamOplogMultiplexer::_gatherCandidates(WithLock,
+                                                     const BSONObj& entry,
+                                                     std::vector<Subscription*>* out) const {
+    // Commands, including the 'applyOps' entries of transactions, may concern namespaces other
+    // than the one they are logged against, so only CRUD entries can be routed by namespace.
+    if (entry["op"].valueStringDataSafe() == "c"_sd) {
+        for (auto&& subscription : _subscriptions) {
+            out->push_back(subscription.get());
+        }
+        return;
+    }
+
+    const auto ns = entry["ns"].valueStringDataSafe();
+    if (auto it = _byCollection.find(ns); it != _byCollection.end()) {
+        out->insert(out->end(), it->second.begin(), it->second.end());
+    }
+    if (auto it = _byDatabase.find(nsToDatabaseSubstring(ns)); it != _byDatabase.end()) {
+        out->insert(out->end(), it->second.begin(), it->second.end());
+    }
+    out->insert(out->end(), _wholeCluster.begin(), _wholeCluster.end());
+}
+
+void ChangeStreamOplogMultiplexer::_removeFromIndex(WithLock, Subscription* subscription) {
+    auto it = std::find_if(_subscriptions.begin(),
+                           _subscriptions.end(),
+                           [&](const auto& other) { return other.get() == subscription; });
+    if (it == _subscriptions.end()) {
+        return;
+    }
+
+    switch (subscription->_type) {
+        case DocumentSourceChangeStream::ChangeStreamType::kSingleCollection:
+            removeStream(&_byCollection, subscription->_nss.ns(), subscription);
+            break;
+        case DocumentSourceChangeStream::ChangeStreamType::kSingleDatabase:
+            removeStream(&_byDatabase, subscription->_nss.db(), subscription);
+            break;
+        case DocumentSourceChangeStream::ChangeStreamType::kAllChangesForCluster:
+            removeStream(&_wholeCluster, subscription);
+            break;
+    }
+    _subscriptions.erase(it);
+}
+
+void ChangeStreamOplogMultiplexer::_evictAll(WithLock, Status status) {
+    for (auto&& subscription : _subscriptions) {
+        subscription->_evict(status);
+    }
+    _streamsEvicted.fetchAndAdd(_subscriptions.size());
+
+    _subscriptions.clear();
+    _byCollection.clear();
+    _byDatabase.clear();
+    _wholeCluster.clear();
+}
+
+void ChangeStreamOplogMultiplexer::_tailerLoop(ServiceContext* serviceContext) {
+    ThreadClient tc("ChangeStreamOplogMultiplexer", serviceContext);
+    {
+        stdx::lock_guard<Client> lk(*tc.get());
+        tc.get()->setSystemOperationKillable(lk);
+    }
+    auto opCtx = tc->makeOperationContext();
+
+    Timestamp readAfter;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        readAfter = _publishedThrough;
+    }
+
+    while (true) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (_inShutdown || _subscriptions.empty()) {
+                _tailerRunning = false;
+                return;
+            }
+        }
+
+        try {
+            std::vector<BSONObj> entries;
+            uint64_t notifierVersion = 0;
+            auto notifier = readOplogBatch(opCtx.get(), readAfter, &entries, &notifierVersion);
+
+            if (!entries.empty()) {
+                readAfter = entries.back()[repl::OpTime::kTimestampFieldName].timestamp();
+                publish(entries, readAfter);
+                continue;
+            }
+
+            // Both oplog inserts and advances of the majority commit point signal the notifier.
+            const auto deadline =
+                serviceContext->getPreciseClockSource()->now() + kTailerIdleWait;
+            if (notifier) {
+                notifier->waitUntil(notifierVersion, deadline);
+            } else {
+                opCtx->sleepUntil(deadline);
+            }
+        } catch (const DBException& ex) {
+            // The streams cannot make progress without the tailer. Close them with the error, so
+            // that their clients resume, and let the next stream to subscribe start a new tailer.
+            log() << "Change stream oplog multiplexer failed to read the oplog: "
+                  << redact(ex.toStatus());
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _evictAll(lk, ex.toStatus());
+            _tailerRunning = false;
+            return;
+        }
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,229 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/timestamp.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/pipeline/document_source_change_stream.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/string_map.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+class OperationContext;
+class ServiceContext;
+
+/**
+ * Shares a single scan of the oplog between the change streams open on this node. A background
+ * tailer reads each new majority-committed oplog entry once and offers it to the registered
+ * streams, which are indexed by the namespace they watch: a CRUD entry is only evaluated against
+ * the filters of streams on its collection, its database or the whole cluster, whereas a command
+ * entry, which may concern namespaces other than its own, is evaluated against every stream.
+ *
+ * The entries matching a stream's filter are appended to a buffer owned by that stream. A stream
+ * whose buffer grows beyond internalQueryChangeStreamOplogMultiplexerMaxBufferBytes is evicted
+ * with a resumable error, so that a slow consumer can neither hold up the other streams nor
+ * exhaust memory. The client then resumes from its last token, reading the oplog itself.
+ */
+class ChangeStreamOplogMultiplexer {
+    ChangeStreamOplogMultiplexer(const ChangeStreamOplogMultiplexer&) = delete;
+    ChangeStreamOplogMultiplexer& operator=(const ChangeStreamOplogMultiplexer&) = delete;
+
+public:
+    /**
+     * The registration of a single change stream. Consumed by the stream's own operations, while
+     * the tailer appends to it concurrently.
+     */
+    class Subscription {
+        Subscription(const Subscription&) = delete;
+        Subscription& operator=(const Subscription&) = delete;
+
+    public:
+        Subscription(NamespaceString nss,
+                     BSONObj filter,
+                     boost::intrusive_ptr<ExpressionContext> expCtx,
+                     std::unique_ptr<MatchExpression> matcher);
+
+        /**
+         * Returns the next buffered oplog entry, or boost::none if there is none yet. Throws the
+         * error with which the stream was evicted, once it has been.
+         */
+        boost::optional<BSONObj> next();
+
+        /**
+         * Blocks until an entry has been buffered, the stream has been evicted or 'deadline' has
+         * passed. Throws if 'opCtx' is interrupted.
+         */
+        void waitForEntries(OperationContext* opCtx, Date_t deadline);
+
+        /**
+         * Returns the timestamp of the latest oplog entry which this stream has seen, whether or
+         * not it matched, as of the last call to next().
+         */
+        Timestamp getLatestOplogTimestamp() const;
+
+        const NamespaceString& getNamespace() const {
+            return _nss;
+        }
+
+    private:
+        friend class ChangeStreamOplogMultiplexer;
+
+        /**
+         * Appends 'entries' to the buffer and records that the oplog has been read through
+         * 'scannedThrough'. Returns false and evicts the stream instead if the buffer would exceed
+         * 'maxBufferBytes'.
+         */
+        bool _deliver(std::vector<BSONObj> entries,
+                      Timestamp scannedThrough,
+                      long long maxBufferBytes);
+
+        /**
+         * Discards the buffer and fails all further calls to next() with 'status'.
+         */
+        void _evict(Status status);
+
+        const NamespaceString _nss;
+        const DocumentSourceChangeStream::ChangeStreamType _type;
+        const BSONObj _filter;
+        const boost::intrusive_ptr<ExpressionContext> _expCtx;
+        const std::unique_ptr<MatchExpression> _matcher;
+
+        mutable stdx::mutex _mutex;
+        stdx::condition_variable _entriesAvailable;
+
+        std::deque<BSONObj> _buffer;
+        long long _bufferedBytes = 0;
+
+        // The timestamp of the last oplog entry offered to this stream, and the latest timestamp
+        // which has been reported to the consumer.
+        Timestamp _scannedThrough;
+        Timestamp _latestOplogTimestamp;
+
+        Status _evictedStatus = Status::OK();
+    };
+
+    /**
+     * If 'runTailer' is false, no background tailer is started and entries are only delivered
+     * through publish(). This is intended for testing.
+     */
+    explicit ChangeStreamOplogMultiplexer(bool runTailer = true);
+    ~ChangeStreamOplogMultiplexer();
+
+    static ChangeStreamOplogMultiplexer* get(ServiceContext* serviceContext);
+
+    /**
+     * Registers a change stream on 'nss', which may be a collectionless namespace for streams on
+     * a whole database or cluster, that wants every oplog entry matching 'filter'. The entries are
+     * compared using the simple collation. 'startFrom' is the earliest timestamp the filter can
+     * match. Returns nullptr if entries from that point on have already been published, in which
+     * case the stream must read the oplog itself.
+     */
+    std::shared_ptr<Subscription> subscribe(OperationContext* opCtx,
+                                            const NamespaceString& nss,
+                                            const BSONObj& filter,
+                                            Timestamp startFrom,
+                                            bool startFromInclusive);
+
+    /**
+     * Deregisters 'subscription' and discards anything still buffered for it.
+     */
+    void unsubscribe(const std::shared_ptr<Subscription>& subscription);
+
+    /**
+     * Offers 'entries', which must be consecutive entries of the oplog in order, to the registered
+     * streams. 'scannedThrough' is the timestamp of the last of them, or of the last entry read
+     * if there are none. Called by the tailer.
+     */
+    void publish(const std::vector<BSONObj>& entries, Timestamp scannedThrough);
+
+    /**
+     * Evicts all streams and stops the tailer. No stream can subscribe afterwards.
+     */
+    void shutdown();
+
+    /**
+     * Reports the number of attached streams, their buffer sizes and cumulative counters.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
+private:
+    /**
+     * Collects the streams whose filter must be evaluated against 'entry'.
+     */
+    void _gatherCandidates(WithLock, const BSONObj& entry, std::vector<Subscription*>* out) const;
+
+    void _removeFromIndex(WithLock, Subscription* subscription);
+
+    void _evictAll(WithLock, Status status);
+
+    /**
+     * The body of the tailer thread, which runs for as long as there are subscribers.
+     */
+    void _tailerLoop(ServiceContext* serviceContext);
+
+    const bool _runTailer;
+
+    mutable stdx::mutex _mutex;
+
+    // All registered streams, and the index over them by watched namespace.
+    std::vector<std::shared_ptr<Subscription>> _subscriptions;
+    StringMap<std::vector<Subscription*>> _byCollection;
+    StringMap<std::vector<Subscription*>> _byDatabase;
+    std::vector<Subscription*> _wholeCluster;
+
+    // The timestamp through which the oplog has been published to the streams.
+    Timestamp _publishedThrough;
+
+    stdx::thread _tailer;
+    bool _tailerRunning = false;
+    bool _inShutdown = false;
+
+    AtomicWord<long long> _entriesScanned{0};
+    AtomicWord<long long> _entriesDelivered{0};
+    AtomicWord<long long> _streamsEvicted{0};
+};
+
+}  // namespace mongo
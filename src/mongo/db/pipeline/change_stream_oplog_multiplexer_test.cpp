@@ -0,0 +1,199 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/change_stream_oplog_multiplexer.h"
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/pipeline/aggregation_context_fixture.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+using Subscription = ChangeStreamOplogMultiplexer::Subscription;
+
+const NamespaceString kCollectionNss("test.coll");
+const NamespaceString kDatabaseNss = NamespaceString::makeCollectionlessAggregateNSS("test");
+const NamespaceString kClusterNss = NamespaceString::makeCollectionlessAggregateNSS("admin");
+
+BSONObj makeEntry(Timestamp ts, StringData op, StringData ns) {
+    return BSON("ts" << ts << "op" << op << "ns" << ns << "o" << BSON("_id" << 1));
+}
+
+/**
+ * Drains every buffered entry of 'subscription' and returns their timestamps.
+ */
+std::vector<Timestamp> drain(Subscription* subscription) {
+    std::vector<Timestamp> timestamps;
+    while (auto entry = subscription->next()) {
+        timestamps.push_back((*entry)["ts"].timestamp());
+    }
+    return timestamps;
+}
+
+class ChangeStreamOplogMultiplexerTest : public AggregationContextFixture {
+public:
+    std::shared_ptr<Subscription> subscribe(const NamespaceString& nss,
+                                            BSONObj filter = BSONObj(),
+                                            Timestamp startFrom = Timestamp(1, 0)) {
+        auto subscription =
+            _multiplexer.subscribe(getExpCtx()->opCtx, nss, filter, startFrom, true);
+        ASSERT(subscription);
+        return subscription;
+    }
+
+    ChangeStreamOplogMultiplexer* multiplexer() {
+        return &_multiplexer;
+    }
+
+private:
+    ChangeStreamOplogMultiplexer _multiplexer{false};
+};
+
+TEST_F(ChangeStreamOplogMultiplexerTest, RoutesCrudEntriesByWatchedNamespace) {
+    auto collectionStream = subscribe(kCollectionNss);
+    auto databaseStream = subscribe(kDatabaseNss);
+    auto clusterStream = subscribe(kClusterNss);
+
+    multiplexer()->publish({makeEntry(Timestamp(10, 1), "i", "test.coll"),
+                            makeEntry(Timestamp(10, 2), "i", "test.other"),
+                            makeEntry(Timestamp(10, 3), "u", "other.coll")},
+                           Timestamp(10, 3));
+
+    ASSERT(drain(collectionStream.get()) == std::vector<Timestamp>({Timestamp(10, 1)}));
+    ASSERT(drain(databaseStream.get()) ==
+           std::vector<Timestamp>({Timestamp(10, 1), Timestamp(10, 2)}));
+    ASSERT(drain(clusterStream.get()) ==
+           std::vector<Timestamp>({Timestamp(10, 1), Timestamp(10, 2), Timestamp(10, 3)}));
+}
+
+TEST_F(ChangeStreamOplogMultiplexerTest, OffersCommandEntriesToEveryStream) {
+    auto collectionStream = subscribe(kCollectionNss);
+    auto otherStream = subscribe(NamespaceString("other.coll"));
+
+    multiplexer()->publish({makeEntry(Timestamp(10, 1), "c", "admin.$cmd")}, Timestamp(10, 1));
+
+    ASSERT(drain(collectionStream.get()) == std::vector<Timestamp>({Timestamp(10, 1)}));
+    ASSERT(drain(otherStream.get()) == std::vector<Timestamp>({Timestamp(10, 1)}));
+}
+
+TEST_F(ChangeStreamOplogMultiplexerTest, DeliversOnlyEntriesMatchingTheFilter) {
+    auto stream = subscribe(kCollectionNss, BSON("op" << "u"));
+
+    multiplexer()->publish({makeEntry(Timestamp(10, 1), "i", "test.coll"),
+                            makeEntry(Timestamp(10, 2), "u", "test.coll")},
+                           Timestamp(10, 2));
+
+    ASSERT(drain(stream.get()) == std::vector<Timestamp>({Timestamp(10, 2)}));
+}
+
+TEST_F(ChangeStreamOplogMultiplexerTest, AdvancesLatestOplogTimestampWithoutMatches) {
+    auto stream = subscribe(kCollectionNss);
+
+    multiplexer()->publish({makeEntry(Timestamp(10, 1), "i", "test.other")}, Timestamp(10, 1));
+    ASSERT_FALSE(stream->next());
+    ASSERT_EQ(stream->getLatestOplogTimestamp(), Timestamp(10, 1));
+
+    multiplexer()->publish({}, Timestamp(11, 1));
+    ASSERT_FALSE(stream->next());
+    ASSERT_EQ(stream->getLatestOplogTimestamp(), Timestamp(11, 1));
+}
+
+TEST_F(ChangeStreamOplogMultiplexerTest, RejectsStreamStartingBeforePublishedEntries) {
+    auto stream = subscribe(kCollectionNss);
+    multiplexer()->publish({makeEntry(Timestamp(10, 1), "i", "test.coll")}, Timestamp(10, 1));
+
+    auto opCtx = getExpCtx()->opCtx;
+    ASSERT_FALSE(
+        multiplexer()->subscribe(opCtx, kCollectionNss, BSONObj(), Timestamp(10, 1), true));
+    ASSERT_FALSE(
+        multiplexer()->subscribe(opCtx, kCollectionNss, BSONObj(), Timestamp(9, 1), false));
+    ASSERT(multiplexer()->subscribe(opCtx, kCollectionNss, BSONObj(), Timestamp(10, 1), false));
+    ASSERT(multiplexer()->subscribe(opCtx, kCollectionNss, BSONObj(), Timestamp(10, 2), true));
+}
+
+TEST_F(ChangeStreamOplogMultiplexerTest, EvictsStreamWhoseBufferIsFull) {
+    const auto originalMaxBufferBytes =
+        internalQueryChangeStreamOplogMultiplexerMaxBufferBytes.load();
+    ON_BLOCK_EXIT([&] {
+        internalQueryChangeStreamOplogMultiplexerMaxBufferBytes.store(originalMaxBufferBytes);
+    });
+
+    const auto entry = makeEntry(Timestamp(10, 1), "i", "test.coll");
+    internalQueryChangeStreamOplogMultiplexerMaxBufferBytes.store(entry.objsize() + 1);
+
+    auto slowStream = subscribe(kCollectionNss);
+    auto fastStream = subscribe(kCollectionNss);
+
+    multiplexer()->publish({entry}, Timestamp(10, 1));
+    ASSERT(drain(fastStream.get()) == std::vector<Timestamp>({Timestamp(10, 1)}));
+
+    multiplexer()->publish({makeEntry(Timestamp(10, 2), "i", "test.coll")}, Timestamp(10, 2));
+    ASSERT(drain(fastStream.get()) == std::vector<Timestamp>({Timestamp(10, 2)}));
+    ASSERT_THROWS_CODE(slowStream->next(), AssertionException, ErrorCodes::RetryChangeStream);
+
+    BSONObjBuilder stats;
+    multiplexer()->appendStats(&stats);
+    auto statsObj = stats.obj();
+    ASSERT_EQ(statsObj["attachedStreams"].numberLong(), 1);
+    ASSERT_EQ(statsObj["streamsEvicted"].numberLong(), 1);
+    ASSERT_EQ(statsObj["entriesScanned"].numberLong(), 2);
+    ASSERT_EQ(statsObj["entriesDelivered"].numberLong(), 3);
+    ASSERT_EQ(statsObj["buffers"]["entries"].numberLong(), 0);
+}
+
+TEST_F(ChangeStreamOplogMultiplexerTest, UnsubscribedStreamNoLongerReceivesEntries) {
+    auto stream = subscribe(kCollectionNss);
+    multiplexer()->unsubscribe(stream);
+
+    multiplexer()->publish({makeEntry(Timestamp(10, 1), "i", "test.coll")}, Timestamp(10, 1));
+    ASSERT_THROWS_CODE(stream->next(), AssertionException, ErrorCodes::CursorKilled);
+
+    BSONObjBuilder stats;
+    multiplexer()->appendStats(&stats);
+    ASSERT_EQ(stats.obj()["attachedStreams"].numberLong(), 0);
+}
+
+TEST_F(ChangeStreamOplogMultiplexerTest, ShutdownEvictsAllStreams) {
+    auto stream = subscribe(kCollectionNss);
+    multiplexer()->shutdown();
+
+    ASSERT_THROWS_CODE(stream->next(), AssertionException, ErrorCodes::InterruptedAtShutdown);
+    ASSERT_FALSE(multiplexer()->subscribe(
+        getExpCtx()->opCtx, kCollectionNss, BSONObj(), Timestamp(20, 1), true));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,107 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_key_lookup.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace document_key_lookup {
+
+namespace {
+constexpr StringData kIdFieldName = "_id"_sd;
+
+bool isIdOnly(const Document& documentKey) {
+    auto it = documentKey.fieldIterator();
+    return it.more() && it.next().first == kIdFieldName && !it.more();
+}
+}  // namespace
+
+BSONObj makeFilter(const std::vector<Document>& documentKeys) {
+    invariant(!documentKeys.empty());
+    if (documentKeys.size() == 1) {
+        return documentKeys.front().toBson();
+    }
+
+    BSONObjBuilder filter;
+    if (std::all_of(documentKeys.begin(), documentKeys.end(), isIdOnly)) {
+        BSONObjBuilder idFilter(filter.subobjStart(kIdFieldName));
+        BSONArrayBuilder ids(idFilter.subarrayStart("$in"));
+        for (auto&& documentKey : documentKeys) {
+            documentKey[kIdFieldName].addToBsonArray(&ids);
+        }
+    } else {
+        BSONArrayBuilder disjuncts(filter.subarrayStart("$or"));
+        for (auto&& documentKey : documentKeys) {
+            disjuncts.append(documentKey.toBson());
+        }
+    }
+    return filter.obj();
+}
+
+std::vector<boost::optional<Document>> matchToKeys(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    const std::vector<Document>& documentKeys,
+    const std::vector<Document>& documents) {
+    std::vector<BSONObj> documentsBson;
+    documentsBson.reserve(documents.size());
+    for (auto&& document : documents) {
+        documentsBson.push_back(document.toBson());
+    }
+
+    // Each key is matched with the same semantics as the query which fetched the documents, so
+    // that dotted shard key fields in the key are handled exactly as the shard would handle them.
+    std::vector<boost::optional<Document>> results(documentKeys.size());
+    for (size_t i = 0; i < documentKeys.size(); ++i) {
+        auto keyObj = documentKeys[i].toBson();
+        auto matcher = uassertStatusOK(MatchExpressionParser::parse(keyObj, expCtx));
+        for (size_t j = 0; j < documents.size(); ++j) {
+            if (!matcher->matchesBSON(documentsBson[j])) {
+                continue;
+            }
+            uassert(ErrorCodes::TooManyMatchingDocuments,
+                    str::stream() << "found more than one document with document key "
+                                  << documentKeys[i].toString() << " [" << results[i]->toString()
+                                  << ", " << documents[j].toString() << "]",
+                    !results[i]);
+            results[i] = documents[j];
+        }
+    }
+    return results;
+}
+
+}  // namespace document_key_lookup
+}  // namespace mongo
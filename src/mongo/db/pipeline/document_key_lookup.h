@@ -0,0 +1,64 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/intrusive_ptr.hpp>
+#include <boost/optional.hpp>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/pipeline/document.h"
+
+namespace mongo {
+
+class ExpressionContext;
+
+namespace document_key_lookup {
+
+/**
+ * Returns a single query filter which matches every document identified by one of
+ * 'documentKeys'. Keys consisting of only an _id are combined into an $in over _id; keys which also
+ * contain shard key fields are combined with $or.
+ */
+BSONObj makeFilter(const std::vector<Document>& documentKeys);
+
+/**
+ * Pairs each of 'documents', the result of querying with makeFilter(), with the entries of
+ * 'documentKeys' which it matches. Returns a vector parallel to 'documentKeys' which holds
+ * boost::none for keys with no matching document. Throws TooManyMatchingDocuments if more than
+ * one document matches the same key.
+ */
+std::vector<boost::optional<Document>> matchToKeys(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    const std::vector<Document>& documentKeys,
+    const std::vector<Document>& documents);
+
+}  // namespace document_key_lookup
+}  // namespace mongo
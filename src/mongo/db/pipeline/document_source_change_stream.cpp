@@ -103,8 +103,11 @@ static constexpr StringData kOplogMatchExplainName = "$_internalOplogMatch"_sd;
 }  // namespace
 
 intrusive_ptr<DocumentSourceOplogMatch> DocumentSourceOplogMatch::create(
-    BSONObj filter, const intrusive_ptr<ExpressionContext>& expCtx) {
-    return new DocumentSourceOplogMatch(std::move(filter), expCtx);
+    BSONObj filter,
+    const intrusive_ptr<ExpressionContext>& expCtx,
+    Timestamp startFrom,
+    bool startFromInclusive) {
+    return new DocumentSourceOplogMatch(std::move(filter), expCtx, startFrom, startFromInclusive);
 }
 
 const char* DocumentSourceOplogMatch::getSourceName() const {
@@ -139,8 +142,12 @@ Value DocumentSourceOplogMatch::serialize(optional<ExplainOptions::Verbosity> ex
 }
 
 DocumentSourceOplogMatch::DocumentSourceOplogMatch(BSONObj filter,
-                                                   const intrusive_ptr<ExpressionContext>& expCtx)
-    : DocumentSourceMatch(std::move(filter), expCtx) {}
+                                                   const intrusive_ptr<ExpressionContext>& expCtx,
+                                                   Timestamp startFrom,
+                                                   bool startFromInclusive)
+    : DocumentSourceMatch(std::move(filter), expCtx),
+      _startFrom(startFrom),
+      _startFromInclusive(startFromInclusive) {}
 
 void DocumentSourceChangeStream::checkValueType(const Value v,
                                                 const StringData filedName,
@@ -414,7 +421,9 @@ list<intrusive_ptr<DocumentSource>> buildPipeline(const intrusive_ptr<Expression
         stages.push_back(DocumentSourceOplogMatch::create(
             DocumentSourceChangeStream::buildMatchFilter(
                 expCtx, *startFrom, startFromInclusive, showMigrationEvents),
-            expCtx));
+            expCtx,
+            *startFrom,
+            startFromInclusive));
 
         // If we haven't already populated the initial PBRT, then we are starting from a specific
         // timestamp rather than a resume token. Initialize the PBRT to a high water mark token.
@@ -208,11 +208,26 @@ private:
  */
 class DocumentSourceOplogMatch final : public DocumentSourceMatch {
 public:
+    /**
+     * 'startFrom' is the timestamp from which 'filter' matches oplog entries, inclusively if
+     * 'startFromInclusive' is set.
+     */
     static boost::intrusive_ptr<DocumentSourceOplogMatch> create(
-        BSONObj filter, const boost::intrusive_ptr<ExpressionContext>& expCtx);
+        BSONObj filter,
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        Timestamp startFrom,
+        bool startFromInclusive);
 
     const char* getSourceName() const final;
 
+    Timestamp getStartFrom() const {
+        return _startFrom;
+    }
+
+    bool isStartFromInclusive() const {
+        return _startFromInclusive;
+    }
+
     GetNextResult doGetNext() final {
         // We should never execute this stage directly. We expect this stage to be absorbed into the
         // cursor feeding the pipeline, and executing this stage may result in the use of the wrong
@@ -226,7 +241,13 @@ public:
     Value serialize(boost::optional<ExplainOptions::Verbosity> explain) const final;
 
 private:
-    DocumentSourceOplogMatch(BSONObj filter, const boost::intrusive_ptr<ExpressionContext>& expCtx);
+    DocumentSourceOplogMatch(BSONObj filter,
+                             const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                             Timestamp startFrom,
+                             bool startFromInclusive);
+
+    const Timestamp _startFrom;
+    const bool _startFromInclusive;
 };
 
 }  // namespace mongo
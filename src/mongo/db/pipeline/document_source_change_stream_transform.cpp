@@ -54,6 +54,8 @@
 #include "mongo/db/repl/oplog_entry_gen.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/transaction_history_iterator.h"
+#include "mongo/db/update/doc_diff.h"
+#include "mongo/db/update/log_builder.h"
 #include "mongo/s/catalog_cache.h"
 #include "mongo/s/grid.h"
 #include "mongo/util/log.h"
@@ -239,20 +241,39 @@ Document DocumentSourceChangeStreamTransform::applyTransformation(const Document
                                repl::OplogEntry::kObjectFieldName,
                                BSONType::Object);
                 Document opObject = input[repl::OplogEntry::kObjectFieldName].getDocument();
-                Value updatedFields = opObject["$set"];
-                Value removedFields = opObject["$unset"];
-
-                // Extract the field names of $unset document.
-                vector<Value> removedFieldsVector;
-                if (removedFields.getType() == BSONType::Object) {
-                    auto iter = removedFields.getDocument().fieldIterator();
-                    while (iter.more()) {
-                        removedFieldsVector.push_back(Value(iter.next().first));
+                Value updateSemantics = opObject[LogBuilder::kUpdateSemanticsFieldName];
+                if (updateSemantics.numeric() &&
+                    updateSemantics.coerceToInt() == static_cast<int>(UpdateSemantics::kDelta)) {
+                    // The update was logged as a diff against the pre-image, so report the paths
+                    // which the diff sets and removes.
+                    Value diff = opObject[LogBuilder::kDeltaFieldName];
+                    checkValueType(diff, LogBuilder::kDeltaFieldName, BSONType::Object);
+
+                    BSONObjBuilder updatedFields;
+                    std::vector<std::string> removedFields;
+                    doc_diff::flattenDiff(
+                        diff.getDocument().toBson(), &updatedFields, &removedFields);
+                    updateDescription = Value(Document{
+                        {"updatedFields", updatedFields.obj()},
+                        {"removedFields",
+                         vector<Value>(removedFields.begin(), removedFields.end())}});
+                } else {
+                    Value updatedFields = opObject["$set"];
+                    Value removedFields = opObject["$unset"];
+
+                    // Extract the field names of $unset document.
+                    vector<Value> removedFieldsVector;
+                    if (removedFields.getType() == BSONType::Object) {
+                        auto iter = removedFields.getDocument().fieldIterator();
+                        while (iter.more()) {
+                            removedFieldsVector.push_back(Value(iter.next().first));
+                        }
                     }
+                    updateDescription = Value(Document{
+                        {"updatedFields",
+                         updatedFields.missing() ? Value(Document()) : updatedFields},
+                        {"removedFields", removedFieldsVector}});
                 }
-                updateDescription = Value(Document{
-                    {"updatedFields", updatedFields.missing() ? Value(Document()) : updatedFields},
-                    {"removedFields", removedFieldsVector}});
             } else {
                 operationType = DocumentSourceChangeStream::kReplaceOpType;
                 fullDocument = input[repl::OplogEntry::kObjectFieldName];
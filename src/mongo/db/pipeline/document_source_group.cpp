@@ -133,6 +133,10 @@ const char* DocumentSourceGroup::getSourceName() const {
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::doGetNext() {
+    if (_inputSortedByGroupKey) {
+        return getNextStreaming();
+    }
+
     if (!_initialized) {
         const auto initializationResult = initialize();
         if (initializationResult.isPaused()) {
@@ -199,6 +203,78 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
     return std::move(out);
 }
 
+DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
+    // The input is sorted by the group key, so a group is complete as soon as a document with a
+    // different key, or the end of the input, is reached. The group in progress is kept in
+    // '_currentId' and '_currentAccumulators' so that pausing in the middle of it is harmless.
+    if (_currentAccumulators.size() != _accumulatedFields.size()) {
+        _currentAccumulators.reserve(_accumulatedFields.size());
+        for (auto&& accumulatedField : _accumulatedFields) {
+            _currentAccumulators.push_back(accumulatedField.makeAccumulator(pExpCtx));
+        }
+    }
+
+    const size_t numAccumulators = _accumulatedFields.size();
+    GetNextResult input = pSource->getNext();
+    for (; input.isAdvanced(); input = pSource->getNext()) {
+        auto rootDocument = input.releaseDocument();
+        Value id = computeId(rootDocument);
+
+        if (_idFieldNames.empty() && id.isArray()) {
+            // $sort orders an array by its smallest (or largest) element, so documents with equal
+            // array keys need not be adjacent, nor separated from the documents of a scalar key
+            // equal to that element. Every group returned so far was followed by a non-array key
+            // which sorts after it and is therefore complete, so fall back to hashing the rest of
+            // the groups, starting with the one in progress.
+            if (_streamingGroupInProgress) {
+                _memoryUsageBytes += _currentId.getApproximateSize();
+                for (auto&& accum : _currentAccumulators) {
+                    _memoryUsageBytes += accum->memUsageForSorter();
+                }
+                (*_groups)[_currentId] = std::move(_currentAccumulators);
+                _streamingGroupInProgress = false;
+            }
+            _currentAccumulators.clear();
+            _inputSortedByGroupKey = false;
+
+            processDocument(id, rootDocument);
+            return doGetNext();
+        }
+
+        boost::optional<Document> out;
+        if (_streamingGroupInProgress &&
+            !pExpCtx->getValueComparator().evaluate(_currentId == id)) {
+            out = makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+            _streamingGroupInProgress = false;
+        }
+
+        if (!_streamingGroupInProgress) {
+            for (auto&& accum : _currentAccumulators) {
+                accum->reset();
+            }
+            _currentId = std::move(id);
+            _streamingGroupInProgress = true;
+        }
+
+        for (size_t i = 0; i < numAccumulators; i++) {
+            _currentAccumulators[i]->process(
+                _accumulatedFields[i].expression->evaluate(rootDocument, &pExpCtx->variables),
+                _doingMerge);
+        }
+
+        if (out) {
+            return std::move(*out);
+        }
+    }
+
+    if (input.isEOF() && _streamingGroupInProgress) {
+        _streamingGroupInProgress = false;
+        return makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+    }
+
+    return input;
+}
+
 void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
@@ -304,6 +380,21 @@ StringMap<boost::intrusive_ptr<Expression>> DocumentSourceGroup::getIdFields() c
     }
 }
 
+bool DocumentSourceGroup::groupKeyMayBeArray() const {
+    if (!_idFieldNames.empty()) {
+        return false;
+    }
+
+    invariant(_idExpressions.size() == 1);
+    if (dynamic_cast<ExpressionObject*>(_idExpressions[0].get())) {
+        return false;
+    }
+    if (auto constant = dynamic_cast<ExpressionConstant*>(_idExpressions[0].get())) {
+        return constant->getValue().isArray();
+    }
+    return true;
+}
+
 const std::vector<AccumulationStatement>& DocumentSourceGroup::getAccumulatedFields() const {
     return _accumulatedFields;
 }
@@ -465,6 +556,54 @@ private:
 };
 }  // namespace
 
+void DocumentSourceGroup::processDocument(const Value& id, const Document& rootDocument) {
+    const size_t numAccumulators = _accumulatedFields.size();
+
+    // Look for the _id value in the map. If it's not there, add a new entry with a blank
+    // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
+    // looking it up in '_groups' multiple times.
+    const size_t oldSize = _groups->size();
+    vector<intrusive_ptr<Accumulator>>& group = (*_groups)[id];
+    const bool inserted = _groups->size() != oldSize;
+
+    if (inserted) {
+        _memoryUsageBytes += id.getApproximateSize();
+
+        // Add the accumulators
+        group.reserve(numAccumulators);
+        for (auto&& accumulatedField : _accumulatedFields) {
+            group.push_back(accumulatedField.makeAccumulator(pExpCtx));
+        }
+    } else {
+        for (auto&& groupObj : group) {
+            // subtract old mem usage. New usage added back after processing.
+            _memoryUsageBytes -= groupObj->memUsageForSorter();
+        }
+    }
+
+    /* tickle all the accumulators for the group we found */
+    dassert(numAccumulators == group.size());
+
+    for (size_t i = 0; i < numAccumulators; i++) {
+        group[i]->process(
+            _accumulatedFields[i].expression->evaluate(rootDocument, &pExpCtx->variables),
+            _doingMerge);
+
+        _memoryUsageBytes += group[i]->memUsageForSorter();
+    }
+
+    if (kDebugBuild && !storageGlobalParams.readOnly) {
+        // In debug mode, spill every time we have a duplicate id to stress merge logic.
+        if (!inserted &&                 // is a dup
+            !pExpCtx->inMongos &&        // can't spill to disk in mongos
+            !_allowDiskUse &&            // don't change behavior when testing external sort
+            _sortedFiles.size() < 20) {  // don't open too many FDs
+
+            _sortedFiles.push_back(spill());
+        }
+    }
+}
+
 DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     const size_t numAccumulators = _accumulatedFields.size();
 
@@ -485,49 +624,7 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         auto rootDocument = input.releaseDocument();
         Value id = computeId(rootDocument);
 
-        // Look for the _id value in the map. If it's not there, add a new entry with a blank
-        // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
-        // looking it up in '_groups' multiple times.
-        const size_t oldSize = _groups->size();
-        vector<intrusive_ptr<Accumulator>>& group = (*_groups)[id];
-        const bool inserted = _groups->size() != oldSize;
-
-        if (inserted) {
-            _memoryUsageBytes += id.getApproximateSize();
-
-            // Add the accumulators
-            group.reserve(numAccumulators);
-            for (auto&& accumulatedField : _accumulatedFields) {
-                group.push_back(accumulatedField.makeAccumulator(pExpCtx));
-            }
-        } else {
-            for (auto&& groupObj : group) {
-                // subtract old mem usage. New usage added back after processing.
-                _memoryUsageBytes -= groupObj->memUsageForSorter();
-            }
-        }
-
-        /* tickle all the accumulators for the group we found */
-        dassert(numAccumulators == group.size());
-
-        for (size_t i = 0; i < numAccumulators; i++) {
-            group[i]->process(
-                _accumulatedFields[i].expression->evaluate(rootDocument, &pExpCtx->variables),
-                _doingMerge);
-
-            _memoryUsageBytes += group[i]->memUsageForSorter();
-        }
-
-        if (kDebugBuild && !storageGlobalParams.readOnly) {
-            // In debug mode, spill every time we have a duplicate id to stress merge logic.
-            if (!inserted &&                 // is a dup
-                !pExpCtx->inMongos &&        // can't spill to disk in mongos
-                !_allowDiskUse &&            // don't change behavior when testing external sort
-                _sortedFiles.size() < 20) {  // don't open too many FDs
-
-                _sortedFiles.push_back(spill());
-            }
-        }
+        processDocument(id, rootDocument);
     }
 
     switch (input.getStatus()) {
@@ -155,6 +155,34 @@ public:
         _doingMerge = doingMerge;
     }
 
+    /**
+     * Returns true if this $group stage relies on its input being ordered by the group key, in
+     * which case it outputs each group as soon as it has seen all of the group's documents and
+     * only holds a single group in memory.
+     */
+    bool inputSortedByGroupKey() const {
+        return _inputSortedByGroupKey;
+    }
+
+    /**
+     * Tell this source that the documents with equal group keys are adjacent in its input, for
+     * instance because it merges partial groups which were sorted by their _id on the shards.
+     * Defaults to false. This is an execution property of the local pipeline and is therefore not
+     * serialized. Should an array group key turn up in the input, the stage falls back to hashing
+     * the remaining groups, as the order of the input no longer keeps them adjacent.
+     */
+    void setInputSortedByGroupKey(bool inputSortedByGroupKey) {
+        _inputSortedByGroupKey = inputSortedByGroupKey;
+    }
+
+    /**
+     * Returns false if the group key is known never to be an array, for instance because the _id
+     * is specified as a document or a non-array constant. Since $sort orders an array by one of
+     * its elements, only input sorted by a key which cannot be an array keeps the documents of
+     * each group adjacent.
+     */
+    bool groupKeyMayBeArray() const;
+
     /**
      * Returns true if this $group stage used disk during execution and false otherwise.
      */
@@ -193,6 +221,7 @@ private:
      */
     GetNextResult getNextSpilled();
     GetNextResult getNextStandard();
+    GetNextResult getNextStreaming();
 
     /**
      * Before returning anything, this source must prepare itself. In a streaming $group,
@@ -206,6 +235,12 @@ private:
      */
     GetNextResult initialize();
 
+    /**
+     * Adds 'rootDocument', whose group key is 'id', to its group in '_groups', creating the group
+     * if needed and keeping '_memoryUsageBytes' up to date.
+     */
+    void processDocument(const Value& id, const Document& rootDocument);
+
     /**
      * Spill groups map to disk and returns an iterator to the file. Note: Since a sorted $group
      * does not exhaust the previous stage before returning, and thus does not maintain as large a
@@ -235,6 +270,7 @@ private:
 
     bool _usedDisk;  // Keeps track of whether this $group spilled to disk.
     bool _doingMerge;
+    bool _inputSortedByGroupKey = false;
     size_t _memoryUsageBytes = 0;
     size_t _maxMemoryUsageBytes;
     std::string _fileName;
@@ -249,6 +285,10 @@ private:
     Value _currentId;
     Accumulators _currentAccumulators;
 
+    // Only used when '_inputSortedByGroupKey' is true. Whether '_currentId' and
+    // '_currentAccumulators' hold a group which has not been returned yet.
+    bool _streamingGroupInProgress = false;
+
     // We use boost::optional to defer initialization until the ExpressionContext containing the
     // correct comparator is injected, since the groups must be built using the comparator's
     // definition of equality.
@@ -193,6 +193,93 @@ TEST_F(DocumentSourceGroupTest, ShouldCorrectlyTrackMemoryUsageBetweenPauses) {
     ASSERT_THROWS_CODE(group->getNext(), AssertionException, 16945);
 }
 
+TEST_F(DocumentSourceGroupTest, ShouldOutputGroupsAsSoonAsInputSortedByGroupKeyMovesOn) {
+    auto expCtx = getExpCtx();
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement countStatement{"count",
+                                         ExpressionFieldPath::parse(expCtx, "$count", vps),
+                                         AccumulationStatement::getFactory("$sum")};
+    auto group = DocumentSourceGroup::create(
+        expCtx, ExpressionFieldPath::parse(expCtx, "$_id", vps), {countStatement});
+    group->setDoingMerge(true);
+    group->setInputSortedByGroupKey(true);
+
+    // Partial groups from several shards, merged in the order of their _id
+    auto mock =
+        DocumentSourceMock::createForTest({Document{{"_id", 0}, {"count", 2}},
+                                           Document{{"_id", 0}, {"count", 3}},
+                                           Document{{"_id", 1}, {"count", 1}},
+                                           DocumentSource::GetNextResult::makePauseExecution(),
+                                           Document{{"_id", 1}, {"count", 4}},
+                                           Document{{"_id", 2}, {"count", 1}}});
+    group->setSource(mock.get());
+
+    // The group with _id 0 is complete once the first document of the next group is seen
+    auto result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_DOCUMENT_EQ(result.releaseDocument(), (Document{{"_id", 0}, {"count", 5}}));
+
+    // Pausing in the middle of a group does not lose its partial results
+    ASSERT_TRUE(group->getNext().isPaused());
+
+    result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_DOCUMENT_EQ(result.releaseDocument(), (Document{{"_id", 1}, {"count", 5}}));
+
+    result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_DOCUMENT_EQ(result.releaseDocument(), (Document{{"_id", 2}, {"count", 1}}));
+
+    ASSERT_TRUE(group->getNext().isEOF());
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldFallBackToHashingWhenInputSortedByGroupKeyHasArrayKey) {
+    auto expCtx = getExpCtx();
+    expCtx->inMongos = true;  // Disallow external sort.
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement countStatement{"count",
+                                         ExpressionFieldPath::parse(expCtx, "$count", vps),
+                                         AccumulationStatement::getFactory("$sum")};
+    auto group = DocumentSourceGroup::create(
+        expCtx, ExpressionFieldPath::parse(expCtx, "$_id", vps), {countStatement});
+    group->setDoingMerge(true);
+    group->setInputSortedByGroupKey(true);
+
+    // Partial groups sorted by {_id: 1}, which orders an array by its smallest element, so the
+    // partial groups for 1, [1, 5] and [1, 3] are interleaved.
+    auto mock = DocumentSourceMock::createForTest(
+        {Document{{"_id", 0}, {"count", 2}},
+         Document{{"_id", 1}, {"count", 1}},
+         Document{{"_id", vector<Value>{Value(1), Value(5)}}, {"count", 1}},
+         Document{{"_id", 1}, {"count", 2}},
+         Document{{"_id", vector<Value>{Value(1), Value(3)}}, {"count", 1}},
+         Document{{"_id", vector<Value>{Value(1), Value(5)}}, {"count", 3}},
+         Document{{"_id", 2}, {"count", 1}}});
+    group->setSource(mock.get());
+
+    // The group with _id 0 precedes any array key and is still returned as soon as it is complete
+    auto result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_DOCUMENT_EQ(result.releaseDocument(), (Document{{"_id", 0}, {"count", 2}}));
+    ASSERT_TRUE(group->inputSortedByGroupKey());
+
+    // The remaining groups are hashed, and each of them is returned exactly once
+    auto counts = expCtx->getValueComparator().makeUnorderedValueMap<int>();
+    for (result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        ASSERT_EQ(counts.count(doc["_id"]), 0U);
+        counts[doc["_id"]] = doc["count"].coerceToInt();
+    }
+    ASSERT_TRUE(result.isEOF());
+    ASSERT_FALSE(group->inputSortedByGroupKey());
+
+    ASSERT_EQ(counts.size(), 4U);
+    ASSERT_EQ(counts[Value(1)], 3);
+    ASSERT_EQ((counts[Value(vector<Value>{Value(1), Value(5)})]), 4);
+    ASSERT_EQ((counts[Value(vector<Value>{Value(1), Value(3)})]), 1);
+    ASSERT_EQ(counts[Value(2)], 1);
+}
+
 TEST_F(DocumentSourceGroupTest, ShouldReportSingleFieldGroupKeyAsARename) {
     auto expCtx = getExpCtx();
     VariablesParseState vps = expCtx->variablesParseState;
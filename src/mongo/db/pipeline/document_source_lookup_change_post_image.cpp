@@ -32,6 +32,10 @@
 #include "mongo/db/pipeline/document_source_lookup_change_post_image.h"
 
 #include "mongo/bson/simple_bsonelement_comparator.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/query/find_common.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -39,6 +43,13 @@ constexpr StringData DocumentSourceLookupChangePostImage::kStageName;
 constexpr StringData DocumentSourceLookupChangePostImage::kFullDocumentFieldName;
 
 namespace {
+Counter64 postImageLookupBatches;
+Counter64 postImageLookupEvents;
+ServerStatusMetricField<Counter64> displayPostImageLookupBatches(
+    "changeStreams.postImageLookup.batches", &postImageLookupBatches);
+ServerStatusMetricField<Counter64> displayPostImageLookupEvents(
+    "changeStreams.postImageLookup.events", &postImageLookupEvents);
+
 Value assertFieldHasType(const Document& fullDoc, StringData fieldName, BSONType expectedType) {
     auto val = fullDoc[fieldName];
     uassert(40578,
@@ -49,22 +60,91 @@ Value assertFieldHasType(const Document& fullDoc, StringData fieldName, BSONType
             val.getType() == expectedType);
     return val;
 }
+
+bool isEventOfType(const Document& event, StringData opType) {
+    auto opTypeVal = assertFieldHasType(
+        event, DocumentSourceChangeStream::kOperationTypeField, BSONType::String);
+    return opTypeVal.getString() == opType;
+}
+
+bool isUpdateEvent(const Document& event) {
+    return isEventOfType(event, DocumentSourceChangeStream::kUpdateOpType);
+}
+
+/**
+ * The update events in a batch which target the same collection, and so can be looked up together.
+ */
+struct LookupGroup {
+    NamespaceString nss;
+    UUID uuid;
+    Timestamp clusterTime;
+    std::vector<size_t> eventIndexes;
+    std::vector<Document> documentKeys;
+};
 }  // namespace
 
 DocumentSource::GetNextResult DocumentSourceLookupChangePostImage::doGetNext() {
+    if (!_buffer.empty()) {
+        auto next = std::move(_buffer.front());
+        _buffer.pop_front();
+        return next;
+    }
+    if (_pendingResult) {
+        auto pending = std::move(*_pendingResult);
+        _pendingResult = boost::none;
+        return pending;
+    }
+    if (_pendingException) {
+        auto pending = std::move(_pendingException);
+        _pendingException = nullptr;
+        std::rethrow_exception(pending);
+    }
+
     auto input = pSource->getNext();
-    if (!input.isAdvanced()) {
+    if (!input.isAdvanced() || !isUpdateEvent(input.getDocument())) {
         return input;
     }
-    auto opTypeVal = assertFieldHasType(
-        input.getDocument(), DocumentSourceChangeStream::kOperationTypeField, BSONType::String);
-    if (opTypeVal.getString() != DocumentSourceChangeStream::kUpdateOpType) {
-        return input;
+
+    std::vector<Document> batch{input.releaseDocument()};
+    {
+        // Only take the events which are already available: the first event must not wait for
+        // later ones, so the source should not block for the remainder of the awaitData timeout.
+        auto& awaitData = awaitDataState(pExpCtx->opCtx);
+        const auto savedDeadline = awaitData.waitForInsertsDeadline;
+        awaitData.waitForInsertsDeadline = Date_t::now();
+        ON_BLOCK_EXIT([&] { awaitData.waitForInsertsDeadline = savedDeadline; });
+
+        const size_t maxBatchSize = internalQueryChangeStreamPostImageLookupBatchSize.load();
+        while (batch.size() < maxBatchSize) {
+            boost::optional<GetNextResult> next;
+            try {
+                next = pSource->getNext();
+            } catch (const DBException&) {
+                // The events pulled so far must still be returned, so the error is only raised
+                // once they have been.
+                _pendingException = std::current_exception();
+                break;
+            }
+            if (!next->isAdvanced()) {
+                _pendingResult = std::move(*next);
+                break;
+            }
+            batch.push_back(next->releaseDocument());
+
+            // Nothing follows an invalidate, and pulling past it closes the stream.
+            if (isEventOfType(batch.back(), DocumentSourceChangeStream::kInvalidateOpType)) {
+                break;
+            }
+        }
     }
 
-    MutableDocument output(input.releaseDocument());
-    output[kFullDocumentFieldName] = lookupPostImage(output.peek());
-    return output.freeze();
+    lookupPostImages(&batch);
+
+    auto first = std::move(batch.front());
+    _buffer.insert(_buffer.end(),
+                   std::make_move_iterator(batch.begin() + 1),
+                   std::make_move_iterator(batch.end()));
+    return first;
 }
 
 NamespaceString DocumentSourceLookupChangePostImage::assertValidNamespace(
@@ -88,41 +168,76 @@ NamespaceString DocumentSourceLookupChangePostImage::assertValidNamespace(
     return nss;
 }
 
-Value DocumentSourceLookupChangePostImage::lookupPostImage(const Document& updateOp) const {
-    // Make sure we have a well-formed input.
-    auto nss = assertValidNamespace(updateOp);
-
-    auto documentKey = assertFieldHasType(updateOp,
-                                          DocumentSourceChangeStream::kDocumentKeyField,
-                                          BSONType::Object)
-                           .getDocument();
-
-    // Extract the UUID from resume token and do change stream lookups by UUID.
-    auto resumeToken =
-        ResumeToken::parse(updateOp[DocumentSourceChangeStream::kIdField].getDocument());
-
-    const auto readConcern = pExpCtx->inMongos
-        ? boost::optional<BSONObj>(BSON("level"
-                                        << "majority"
-                                        << "afterClusterTime" << resumeToken.getData().clusterTime))
-        : boost::none;
-
-
-    // Update lookup queries sent from mongoS to shards are allowed to use speculative majority
-    // reads.
-    const auto allowSpeculativeMajorityRead = pExpCtx->inMongos;
-    invariant(resumeToken.getData().uuid);
-    auto lookedUpDoc =
-        pExpCtx->mongoProcessInterface->lookupSingleDocument(pExpCtx,
-                                                             nss,
-                                                             *resumeToken.getData().uuid,
-                                                             documentKey,
-                                                             readConcern,
-                                                             allowSpeculativeMajorityRead);
-
-    // Check whether the lookup returned any documents. Even if the lookup itself succeeded, it may
-    // not have returned any results if the document was deleted in the time since the update op.
-    return (lookedUpDoc ? Value(*lookedUpDoc) : Value(BSONNULL));
+void DocumentSourceLookupChangePostImage::lookupPostImages(std::vector<Document>* batch) const {
+    // Group the update events by collection. A batch rarely spans more than a handful of
+    // collections, so a linear search is sufficient.
+    std::vector<LookupGroup> groups;
+    for (size_t i = 0; i < batch->size(); ++i) {
+        const auto& event = (*batch)[i];
+        if (!isUpdateEvent(event)) {
+            continue;
+        }
+
+        // Make sure we have a well-formed input.
+        auto nss = assertValidNamespace(event);
+
+        auto documentKey = assertFieldHasType(event,
+                                              DocumentSourceChangeStream::kDocumentKeyField,
+                                              BSONType::Object)
+                               .getDocument();
+
+        // Extract the UUID from resume token and do change stream lookups by UUID.
+        auto resumeToken =
+            ResumeToken::parse(event[DocumentSourceChangeStream::kIdField].getDocument());
+        invariant(resumeToken.getData().uuid);
+        const auto& uuid = *resumeToken.getData().uuid;
+        const auto& clusterTime = resumeToken.getData().clusterTime;
+
+        auto group = std::find_if(groups.begin(), groups.end(), [&](const LookupGroup& group) {
+            return group.uuid == uuid && group.nss == nss;
+        });
+        if (group == groups.end()) {
+            groups.push_back({nss, uuid, clusterTime, {}, {}});
+            group = groups.end() - 1;
+        }
+        // Reading after the latest event in the group also satisfies each earlier event.
+        group->clusterTime = std::max(group->clusterTime, clusterTime);
+        group->eventIndexes.push_back(i);
+        group->documentKeys.push_back(std::move(documentKey));
+    }
+
+    for (auto&& group : groups) {
+        const auto readConcern = pExpCtx->inMongos
+            ? boost::optional<BSONObj>(BSON("level"
+                                            << "majority"
+                                            << "afterClusterTime" << group.clusterTime))
+            : boost::none;
+
+        // Update lookup queries sent from mongoS to shards are allowed to use speculative majority
+        // reads.
+        const auto allowSpeculativeMajorityRead = pExpCtx->inMongos;
+        auto lookedUpDocs =
+            pExpCtx->mongoProcessInterface->lookupDocuments(pExpCtx,
+                                                            group.nss,
+                                                            group.uuid,
+                                                            group.documentKeys,
+                                                            readConcern,
+                                                            allowSpeculativeMajorityRead);
+        invariant(lookedUpDocs.size() == group.eventIndexes.size());
+
+        postImageLookupBatches.increment();
+        postImageLookupEvents.increment(group.eventIndexes.size());
+
+        for (size_t i = 0; i < group.eventIndexes.size(); ++i) {
+            auto& event = (*batch)[group.eventIndexes[i]];
+            MutableDocument output(std::move(event));
+            // Even if the lookup itself succeeded, it may not have returned a document if it was
+            // deleted in the time since the update op.
+            output[kFullDocumentFieldName] =
+                (lookedUpDocs[i] ? Value(*lookedUpDocs[i]) : Value(BSONNULL));
+            event = output.freeze();
+        }
+    }
 }
 
 }  // namespace mongo
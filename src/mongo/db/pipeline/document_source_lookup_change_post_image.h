@@ -29,6 +29,10 @@
 
 #pragma once
 
+#include <deque>
+#include <exception>
+#include <vector>
+
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_change_stream.h"
 
@@ -109,15 +113,19 @@ private:
         : DocumentSource(kStageName, expCtx) {}
 
     /**
-     * Performs the lookup to retrieve the full document.
+     * Performs the lookup to retrieve the full document. When an update event is seen, any further
+     * events which are immediately available are pulled from the source as well, so that the
+     * post-images for the whole batch can be fetched together.
      */
     GetNextResult doGetNext() final;
 
     /**
-     * Uses the "documentKey" field from 'updateOp' to look up the current version of the document.
-     * Returns Value(BSONNULL) if the document couldn't be found.
+     * Uses the "documentKey" field of each update event in 'batch' to look up the current version
+     * of its document, setting "fullDocument" to the result or to Value(BSONNULL) if the document
+     * couldn't be found. Events for the same collection are looked up with a single query. Events
+     * which are not updates are left untouched.
      */
-    Value lookupPostImage(const Document& updateOp) const;
+    void lookupPostImages(std::vector<Document>* batch) const;
 
     /**
      * Throws a AssertionException if the namespace found in 'inputDoc' doesn't match the one on the
@@ -125,6 +133,17 @@ private:
      * function verifies that the only the database names match.
      */
     NamespaceString assertValidNamespace(const Document& inputDoc) const;
+
+    // Events which have already had their post-images looked up, waiting to be returned in order.
+    std::deque<Document> _buffer;
+
+    // The first non-advanced result seen while filling '_buffer'. It is returned once the buffer
+    // has been drained, so that pauses and EOF are propagated in their original position.
+    boost::optional<GetNextResult> _pendingResult;
+
+    // An error thrown by the source while filling '_buffer'. It is rethrown once the buffer has
+    // been drained, so that the events which preceded it are not lost.
+    std::exception_ptr _pendingException;
 };
 
 }  // namespace mongo
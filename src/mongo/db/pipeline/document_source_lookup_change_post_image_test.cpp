@@ -39,12 +39,15 @@
 #include "mongo/db/pipeline/aggregation_context_fixture.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/document_source_change_stream.h"
+#include "mongo/db/pipeline/document_source_change_stream_close_cursor.h"
 #include "mongo/db/pipeline/document_source_lookup_change_post_image.h"
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/document_value_test_util.h"
 #include "mongo/db/pipeline/field_path.h"
 #include "mongo/db/pipeline/stub_mongo_process_interface_lookup_single_document.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -324,5 +327,200 @@ TEST_F(DocumentSourceLookupChangePostImageTest, ShouldPropagatePauses) {
     ASSERT_TRUE(lookupChangeStage->getNext().isEOF());
 }
 
+TEST_F(DocumentSourceLookupChangePostImageTest, ShouldLookUpConsecutiveUpdatesInOneBatch) {
+    auto expCtx = getExpCtx();
+
+    // Set up the lookup change post image stage.
+    auto lookupChangeStage = DocumentSourceLookupChangePostImage::create(expCtx);
+
+    // Mock its input with a run of updates, interrupted by an insert, followed by a pause.
+    const auto ns = Document{{"db", expCtx->ns.db()}, {"coll", expCtx->ns.coll()}};
+    auto makeEvent = [&](int id, StringData opType) {
+        MutableDocument event(Document{{"_id", makeResumeToken(id)},
+                                       {"documentKey", Document{{"_id", id}}},
+                                       {"operationType", opType},
+                                       {"ns", ns}});
+        if (opType == "insert"_sd) {
+            event["fullDocument"] = Value(Document{{"_id", id}});
+        }
+        return event.freeze();
+    };
+    auto mockLocalSource =
+        DocumentSourceMock::createForTest({makeEvent(0, "update"_sd),
+                                           makeEvent(1, "insert"_sd),
+                                           makeEvent(2, "update"_sd),
+                                           makeEvent(3, "update"_sd),
+                                           DocumentSource::GetNextResult::makePauseExecution()});
+
+    lookupChangeStage->setSource(mockLocalSource.get());
+
+    // Mock out the foreign collection. The document with _id 3 has since been deleted.
+    deque<DocumentSource::GetNextResult> mockForeignContents{
+        Document{{"_id", 0}, {"x", 0}}, Document{{"_id", 1}}, Document{{"_id", 2}, {"x", 2}}};
+    getExpCtx()->mongoProcessInterface =
+        std::make_unique<MockMongoInterface>(std::move(mockForeignContents));
+    auto mockInterface =
+        dynamic_cast<MockMongoInterface*>(getExpCtx()->mongoProcessInterface.get());
+
+    auto expectEvent = [&](int id, StringData opType, Value fullDocument) {
+        auto next = lookupChangeStage->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        MutableDocument expected(makeEvent(id, opType));
+        expected["fullDocument"] = fullDocument;
+        ASSERT_DOCUMENT_EQ(next.releaseDocument(), expected.freeze());
+    };
+    expectEvent(0, "update"_sd, Value(Document{{"_id", 0}, {"x", 0}}));
+    expectEvent(1, "insert"_sd, Value(Document{{"_id", 1}}));
+    expectEvent(2, "update"_sd, Value(Document{{"_id", 2}, {"x", 2}}));
+    expectEvent(3, "update"_sd, Value(BSONNULL));
+
+    // All three updates should have been looked up with a single query.
+    ASSERT_EQ(mockInterface->numLookupDocumentsCalls(), 1U);
+
+    ASSERT_TRUE(lookupChangeStage->getNext().isPaused());
+    ASSERT_TRUE(lookupChangeStage->getNext().isEOF());
+}
+
+TEST_F(DocumentSourceLookupChangePostImageTest, ShouldRespectPostImageLookupBatchSize) {
+    auto expCtx = getExpCtx();
+
+    // Limit each batch to two events.
+    const auto originalBatchSize = internalQueryChangeStreamPostImageLookupBatchSize.load();
+    internalQueryChangeStreamPostImageLookupBatchSize.store(2);
+    ON_BLOCK_EXIT(
+        [&] { internalQueryChangeStreamPostImageLookupBatchSize.store(originalBatchSize); });
+
+    // Set up the lookup change post image stage.
+    auto lookupChangeStage = DocumentSourceLookupChangePostImage::create(expCtx);
+
+    // Mock its input with three updates.
+    const auto ns = Document{{"db", expCtx->ns.db()}, {"coll", expCtx->ns.coll()}};
+    std::deque<DocumentSource::GetNextResult> mockInput;
+    for (int id = 0; id < 3; ++id) {
+        mockInput.push_back(Document{{"_id", makeResumeToken(id)},
+                                     {"documentKey", Document{{"_id", id}}},
+                                     {"operationType", "update"_sd},
+                                     {"ns", ns}});
+    }
+    auto mockLocalSource = DocumentSourceMock::createForTest(std::move(mockInput));
+
+    lookupChangeStage->setSource(mockLocalSource.get());
+
+    // Mock out the foreign collection.
+    deque<DocumentSource::GetNextResult> mockForeignContents{
+        Document{{"_id", 0}}, Document{{"_id", 1}}, Document{{"_id", 2}}};
+    getExpCtx()->mongoProcessInterface =
+        std::make_unique<MockMongoInterface>(std::move(mockForeignContents));
+    auto mockInterface =
+        dynamic_cast<MockMongoInterface*>(getExpCtx()->mongoProcessInterface.get());
+
+    for (int id = 0; id < 3; ++id) {
+        auto next = lookupChangeStage->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_VALUE_EQ(next.releaseDocument()["fullDocument"], Value(Document{{"_id", id}}));
+    }
+    ASSERT_TRUE(lookupChangeStage->getNext().isEOF());
+
+    ASSERT_EQ(mockInterface->numLookupDocumentsCalls(), 2U);
+}
+
+TEST_F(DocumentSourceLookupChangePostImageTest, ShouldNotPullPastInvalidateWhenBatching) {
+    auto expCtx = getExpCtx();
+
+    // Set up the lookup change post image stage behind the stage which closes the cursor after an
+    // invalidate, as in a real change stream pipeline.
+    auto lookupChangeStage = DocumentSourceLookupChangePostImage::create(expCtx);
+    auto closeCursorStage = DocumentSourceCloseCursor::create(expCtx);
+
+    // Mock the input with an update followed by the drop of its collection and the invalidate.
+    const auto ns = Document{{"db", expCtx->ns.db()}, {"coll", expCtx->ns.coll()}};
+    auto update = Document{{"_id", makeResumeToken(0)},
+                           {"documentKey", Document{{"_id", 0}}},
+                           {"operationType", "update"_sd},
+                           {"ns", ns}};
+    auto drop = Document{{"_id", makeResumeToken()}, {"operationType", "drop"_sd}, {"ns", ns}};
+    auto invalidate = Document{{"_id", makeResumeToken()}, {"operationType", "invalidate"_sd}};
+    deque<DocumentSource::GetNextResult> mockInput;
+    mockInput.push_back(Document(update));
+    mockInput.push_back(Document(drop));
+    mockInput.push_back(Document(invalidate));
+    auto mockLocalSource = DocumentSourceMock::createForTest(std::move(mockInput));
+
+    closeCursorStage->setSource(mockLocalSource.get());
+    lookupChangeStage->setSource(closeCursorStage.get());
+
+    // Mock out the foreign collection.
+    deque<DocumentSource::GetNextResult> mockForeignContents{Document{{"_id", 0}}};
+    getExpCtx()->mongoProcessInterface =
+        std::make_unique<MockMongoInterface>(std::move(mockForeignContents));
+
+    // Every event must be returned before the cursor is closed.
+    auto next = lookupChangeStage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    MutableDocument expectedUpdate(update);
+    expectedUpdate["fullDocument"] = Value(Document{{"_id", 0}});
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), expectedUpdate.freeze());
+
+    next = lookupChangeStage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), drop);
+
+    next = lookupChangeStage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), invalidate);
+
+    ASSERT_THROWS_CODE(lookupChangeStage->getNext(), DBException, ErrorCodes::CloseChangeStream);
+}
+
+/**
+ * A mock source which throws once it runs out of results, rather than returning EOF.
+ */
+class DocumentSourceMockThrowingWhenExhausted : public DocumentSourceMock {
+public:
+    using DocumentSourceMock::DocumentSourceMock;
+
+protected:
+    GetNextResult doGetNext() final {
+        auto next = DocumentSourceMock::doGetNext();
+        uassert(ErrorCodes::Interrupted, "mock source exhausted", !next.isEOF());
+        return next;
+    }
+};
+
+TEST_F(DocumentSourceLookupChangePostImageTest, ShouldReturnBatchedEventsBeforeSourceError) {
+    auto expCtx = getExpCtx();
+
+    // Set up the lookup change post image stage.
+    auto lookupChangeStage = DocumentSourceLookupChangePostImage::create(expCtx);
+
+    // Mock its input with two updates, after which the source throws.
+    const auto ns = Document{{"db", expCtx->ns.db()}, {"coll", expCtx->ns.coll()}};
+    std::deque<DocumentSource::GetNextResult> mockInput;
+    for (int id = 0; id < 2; ++id) {
+        mockInput.push_back(Document{{"_id", makeResumeToken(id)},
+                                     {"documentKey", Document{{"_id", id}}},
+                                     {"operationType", "update"_sd},
+                                     {"ns", ns}});
+    }
+    auto mockLocalSource =
+        make_intrusive<DocumentSourceMockThrowingWhenExhausted>(std::move(mockInput));
+
+    lookupChangeStage->setSource(mockLocalSource.get());
+
+    // Mock out the foreign collection.
+    deque<DocumentSource::GetNextResult> mockForeignContents{Document{{"_id", 0}},
+                                                             Document{{"_id", 1}}};
+    getExpCtx()->mongoProcessInterface =
+        std::make_unique<MockMongoInterface>(std::move(mockForeignContents));
+
+    // The error is only raised once the events which preceded it have been returned.
+    for (int id = 0; id < 2; ++id) {
+        auto next = lookupChangeStage->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_VALUE_EQ(next.releaseDocument()["fullDocument"], Value(Document{{"_id", id}}));
+    }
+    ASSERT_THROWS_CODE(lookupChangeStage->getNext(), DBException, ErrorCodes::Interrupted);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -0,0 +1,91 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_multiplexed_oplog_cursor.h"
+
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/find_common.h"
+#include "mongo/db/service_context.h"
+
+namespace mongo {
+
+constexpr StringData DocumentSourceMultiplexedOplogCursor::kStageName;
+
+boost::intrusive_ptr<DocumentSourceMultiplexedOplogCursor>
+DocumentSourceMultiplexedOplogCursor::create(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    std::shared_ptr<ChangeStreamOplogMultiplexer::Subscription> subscription) {
+    return new DocumentSourceMultiplexedOplogCursor(expCtx, std::move(subscription));
+}
+
+DocumentSourceMultiplexedOplogCursor::DocumentSourceMultiplexedOplogCursor(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    std::shared_ptr<ChangeStreamOplogMultiplexer::Subscription> subscription)
+    : DocumentSource(kStageName, expCtx),
+      _multiplexer(ChangeStreamOplogMultiplexer::get(expCtx->opCtx->getServiceContext())),
+      _subscription(std::move(subscription)) {
+    invariant(_subscription);
+}
+
+DocumentSourceMultiplexedOplogCursor::~DocumentSourceMultiplexedOplogCursor() {
+    _multiplexer->unsubscribe(_subscription);
+}
+
+DocumentSource::GetNextResult DocumentSourceMultiplexedOplogCursor::doGetNext() {
+    auto opCtx = pExpCtx->opCtx;
+    while (true) {
+        if (auto entry = _subscription->next()) {
+            return Document(*entry);
+        }
+
+        const auto& awaitData = awaitDataState(opCtx);
+        if (!awaitData.shouldWaitForInserts ||
+            awaitData.waitForInsertsDeadline <=
+                opCtx->getServiceContext()->getPreciseClockSource()->now()) {
+            return GetNextResult::makeEOF();
+        }
+        _subscription->waitForEntries(opCtx, awaitData.waitForInsertsDeadline);
+    }
+}
+
+void DocumentSourceMultiplexedOplogCursor::doDispose() {
+    _multiplexer->unsubscribe(_subscription);
+}
+
+Value DocumentSourceMultiplexedOplogCursor::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    if (explain) {
+        return Value(Document{{kStageName, Document{}}});
+    }
+    return Value();
+}
+
+}  // namespace mongo
@@ -0,0 +1,102 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "mongo/db/pipeline/change_stream_oplog_multiplexer.h"
+#include "mongo/db/pipeline/document_source.h"
+
+namespace mongo {
+
+/**
+ * Takes the place of the oplog $cursor of a change stream on mongod which has been registered with
+ * the ChangeStreamOplogMultiplexer. Returns the oplog entries that the multiplexer buffered for
+ * the stream and, once they run out, waits for more for up to the awaitData timeout of the
+ * current getMore, just as the tailable oplog cursor would.
+ */
+class DocumentSourceMultiplexedOplogCursor final : public DocumentSource {
+public:
+    static constexpr StringData kStageName = "$_internalMultiplexedOplogCursor"_sd;
+
+    static boost::intrusive_ptr<DocumentSourceMultiplexedOplogCursor> create(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        std::shared_ptr<ChangeStreamOplogMultiplexer::Subscription> subscription);
+
+    ~DocumentSourceMultiplexedOplogCursor();
+
+    const char* getSourceName() const final {
+        return kStageName.rawData();
+    }
+
+    StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        StageConstraints constraints(StreamType::kStreaming,
+                                     PositionRequirement::kFirst,
+                                     HostTypeRequirement::kAnyShard,
+                                     DiskUseRequirement::kNoDiskUse,
+                                     FacetRequirement::kNotAllowed,
+                                     TransactionRequirement::kNotAllowed,
+                                     LookupRequirement::kNotAllowed,
+                                     ChangeStreamRequirement::kChangeStreamStage);
+        constraints.requiresInputDocSource = false;
+        return constraints;
+    }
+
+    boost::optional<DistributedPlanLogic> distributedPlanLogic() final {
+        return boost::none;
+    }
+
+    /**
+     * Only serialized for explain, like the $_internalOplogMatch stage this replaces.
+     */
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
+
+    /**
+     * Returns the timestamp of the latest oplog entry that this stream has seen, whether or not it
+     * matched, so that the stream's resume token can advance while no events are returned.
+     */
+    Timestamp getLatestOplogTimestamp() const {
+        return _subscription->getLatestOplogTimestamp();
+    }
+
+private:
+    DocumentSourceMultiplexedOplogCursor(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        std::shared_ptr<ChangeStreamOplogMultiplexer::Subscription> subscription);
+
+    GetNextResult doGetNext() final;
+
+    void doDispose() final;
+
+    ChangeStreamOplogMultiplexer* const _multiplexer;
+    const std::shared_ptr<ChangeStreamOplogMultiplexer::Subscription> _subscription;
+};
+
+}  // namespace mongo
@@ -331,6 +331,20 @@ public:
         boost::optional<BSONObj> readConcern,
         bool allowSpeculativeMajorityRead = false) = 0;
 
+    /**
+     * Batched version of lookupSingleDocument(). Returns a vector parallel to 'documentKeys' which
+     * holds, for each key, the matching document or boost::none if there is none. All of the
+     * keys are looked up in the collection 'nss' with as few queries as possible. Throws if more
+     * than one document matches any of the keys.
+     */
+    virtual std::vector<boost::optional<Document>> lookupDocuments(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        const NamespaceString& nss,
+        UUID,
+        const std::vector<Document>& documentKeys,
+        boost::optional<BSONObj> readConcern,
+        bool allowSpeculativeMajorityRead = false) = 0;
+
     /**
      * Returns a vector of all idle (non-pinned) local cursors.
      */
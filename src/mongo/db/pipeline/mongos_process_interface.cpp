@@ -35,6 +35,7 @@
 #include "mongo/db/catalog/collection_catalog.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/pipeline/document_key_lookup.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/sharded_agg_helpers.h"
 #include "mongo/db/query/collation/collation_spec.h"
@@ -239,6 +240,118 @@ boost::optional<Document> MongoSInterface::lookupSingleDocument(
     return (!batch.empty() ? Document(batch.front()) : boost::optional<Document>{});
 }
 
+std::vector<boost::optional<Document>> MongoSInterface::lookupDocuments(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    const NamespaceString& nss,
+    UUID collectionUUID,
+    const std::vector<Document>& documentKeys,
+    boost::optional<BSONObj> readConcern,
+    bool allowSpeculativeMajorityRead) {
+    auto foreignExpCtx = expCtx->copyWith(nss, collectionUUID);
+    auto executor = Grid::get(expCtx->opCtx)->getExecutorPool()->getArbitraryExecutor();
+
+    std::vector<boost::optional<Document>> results(documentKeys.size());
+    bool findCmdIsByUuid(foreignExpCtx->uuid);
+    std::vector<RemoteCursor> shardResults;
+    bool established = false;
+    size_t numAttempts = 0;
+    while (!established && ++numAttempts <= kMaxNumStaleVersionRetries) {
+        // Verify that the collection exists, with the correct UUID.
+        auto catalogCache = Grid::get(expCtx->opCtx)->catalogCache();
+        auto swRoutingInfo = getCollectionRoutingInfo(foreignExpCtx);
+        if (swRoutingInfo == ErrorCodes::NamespaceNotFound) {
+            return results;
+        }
+        auto routingInfo = uassertStatusOK(std::move(swRoutingInfo));
+        if (findCmdIsByUuid && routingInfo.cm()) {
+            // Find by UUID and shard versioning do not work together (SERVER-31946). See
+            // lookupSingleDocument() for why it is safe to find by namespace instead.
+            findCmdIsByUuid = false;
+        }
+
+        // Group the keys by the shard which owns them, so that each shard receives one query.
+        std::map<ShardId, std::pair<ChunkVersion, std::vector<Document>>> keysByShard;
+        for (auto&& documentKey : documentKeys) {
+            auto shardInfo =
+                getSingleTargetedShardForQuery(expCtx->opCtx, routingInfo, documentKey.toBson());
+            auto& shardKeys = keysByShard[shardInfo.first];
+            shardKeys.first = shardInfo.second;
+            shardKeys.second.push_back(documentKey);
+        }
+
+        std::vector<std::pair<ShardId, BSONObj>> requests;
+        for (auto&& [shardId, shardKeys] : keysByShard) {
+            BSONObjBuilder cmdBuilder;
+            if (findCmdIsByUuid) {
+                foreignExpCtx->uuid->appendToBuilder(&cmdBuilder, "find");
+            } else {
+                cmdBuilder.append("find", nss.coll());
+            }
+            cmdBuilder.append("filter", document_key_lookup::makeFilter(shardKeys.second));
+            // Each key matches at most one document, so the first batch exhausts the cursor unless
+            // the documents exceed the maximum reply size.
+            cmdBuilder.append("batchSize", static_cast<long long>(shardKeys.second.size() + 1));
+            cmdBuilder.append("comment", expCtx->comment);
+            if (readConcern) {
+                cmdBuilder.append(repl::ReadConcernArgs::kReadConcernFieldName, *readConcern);
+            }
+            if (allowSpeculativeMajorityRead) {
+                cmdBuilder.append("allowSpeculativeMajorityRead", true);
+            }
+            requests.emplace_back(shardId, appendShardVersion(cmdBuilder.obj(), shardKeys.first));
+        }
+
+        try {
+            shardResults = establishCursors(expCtx->opCtx,
+                                            executor,
+                                            nss,
+                                            ReadPreferenceSetting::get(expCtx->opCtx),
+                                            requests,
+                                            false);
+            established = true;
+        } catch (const ExceptionFor<ErrorCodes::NamespaceNotFound>&) {
+            // If it's an unsharded collection which has been deleted and re-created, we may get a
+            // NamespaceNotFound error when looking up by UUID.
+            return results;
+        } catch (const ExceptionForCat<ErrorCategory::StaleShardVersionError>&) {
+            // If we hit a stale shardVersion exception, invalidate the routing table cache.
+            catalogCache->onStaleShardVersion(std::move(routingInfo));
+        }
+    }
+
+    invariant(established);
+
+    std::vector<Document> lookedUpDocuments;
+    bool truncated = false;
+    for (auto&& remoteCursor : shardResults) {
+        auto& cursor = remoteCursor.getCursorResponse();
+        for (auto&& obj : cursor.getBatch()) {
+            lookedUpDocuments.emplace_back(obj);
+        }
+        if (cursor.getCursorId() != 0) {
+            truncated = true;
+            killRemoteCursor(expCtx->opCtx, executor.get(), std::move(remoteCursor), nss);
+        }
+    }
+    results = document_key_lookup::matchToKeys(foreignExpCtx, documentKeys, lookedUpDocuments);
+
+    // If a shard's documents did not fit in a single reply, the keys which went unmatched may
+    // still have a document, so fall back to looking those up one at a time.
+    if (truncated) {
+        for (size_t i = 0; i < documentKeys.size(); ++i) {
+            if (!results[i]) {
+                results[i] = lookupSingleDocument(expCtx,
+                                                  nss,
+                                                  collectionUUID,
+                                                  documentKeys[i],
+                                                  readConcern,
+                                                  allowSpeculativeMajorityRead);
+            }
+        }
+    }
+    return results;
+}
+
 BSONObj MongoSInterface::_reportCurrentOpForClient(OperationContext* opCtx,
                                                    Client* client,
                                                    CurrentOpTruncateMode truncateOps,
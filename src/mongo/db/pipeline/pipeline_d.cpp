@@ -56,12 +56,14 @@
 #include "mongo/db/ops/write_ops_exec.h"
 #include "mongo/db/ops/write_ops_gen.h"
 #include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/change_stream_oplog_multiplexer.h"
 #include "mongo/db/pipeline/document_source_change_stream.h"
 #include "mongo/db/pipeline/document_source_cursor.h"
 #include "mongo/db/pipeline/document_source_geo_near.h"
 #include "mongo/db/pipeline/document_source_geo_near_cursor.h"
 #include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_match.h"
+#include "mongo/db/pipeline/document_source_multiplexed_oplog_cursor.h"
 #include "mongo/db/pipeline/document_source_sample.h"
 #include "mongo/db/pipeline/document_source_sample_from_random_cursor.h"
 #include "mongo/db/pipeline/document_source_single_document_transformation.h"
@@ -71,9 +73,11 @@
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/operation_sharding_state.h"
+#include "mongo/db/server_options.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/stats/top.h"
 #include "mongo/db/storage/record_store.h"
@@ -295,6 +299,40 @@ StringData extractGeoNearFieldFromIndexes(OperationContext* opCtx, Collection* c
     }
     MONGO_UNREACHABLE;
 }
+
+/**
+ * If the pipeline is a change stream which can be served by the node's shared oplog scan, replaces
+ * its oplog match with a stage reading from the multiplexer and returns true. Returns false if the
+ * stream must scan the oplog itself.
+ */
+bool attachToOplogMultiplexer(Pipeline* pipeline, const Pipeline::SourceContainer& sources) {
+    auto expCtx = pipeline->getContext();
+    if (!internalQueryChangeStreamUseOplogMultiplexer.load() || expCtx->explain ||
+        !serverGlobalParams.enableMajorityReadConcern) {
+        return false;
+    }
+
+    auto oplogMatch =
+        sources.empty() ? nullptr : dynamic_cast<DocumentSourceOplogMatch*>(sources.front().get());
+    if (!oplogMatch) {
+        return false;
+    }
+
+    auto multiplexer = ChangeStreamOplogMultiplexer::get(expCtx->opCtx->getServiceContext());
+    auto subscription = multiplexer->subscribe(expCtx->opCtx,
+                                               expCtx->ns,
+                                               oplogMatch->getQuery(),
+                                               oplogMatch->getStartFrom(),
+                                               oplogMatch->isStartFromInclusive());
+    if (!subscription) {
+        return false;
+    }
+
+    pipeline->popFront();
+    pipeline->addInitialSource(
+        DocumentSourceMultiplexedOplogCursor::create(expCtx, std::move(subscription)));
+    return true;
+}
 }  // namespace
 
 std::pair<PipelineD::AttachExecutorCallback, std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>>
@@ -311,6 +349,12 @@ PipelineD::buildInnerQueryExecutor(Collection* collection,
         return {};
     }
 
+    // A change stream may share the oplog scan of the other streams on this node rather than open
+    // a cursor of its own.
+    if (attachToOplogMultiplexer(pipeline, sources)) {
+        return {};
+    }
+
     // We are going to generate an input cursor, so we need to be holding the collection lock.
     dassert(expCtx->opCtx->lockState()->isCollectionLockedForMode(nss, MODE_IS));
 
@@ -846,6 +890,10 @@ Timestamp PipelineD::getLatestOplogTimestamp(const Pipeline* pipeline) {
             dynamic_cast<DocumentSourceCursor*>(pipeline->_sources.front().get())) {
         return docSourceCursor->getLatestOplogTimestamp();
     }
+    if (auto multiplexedCursor = dynamic_cast<DocumentSourceMultiplexedOplogCursor*>(
+            pipeline->_sources.front().get())) {
+        return multiplexedCursor->getLatestOplogTimestamp();
+    }
     return Timestamp();
 }
 
@@ -41,6 +41,7 @@
 #include "mongo/db/pipeline/document_source_change_stream.h"
 #include "mongo/db/pipeline/document_source_facet.h"
 #include "mongo/db/pipeline/document_source_graph_lookup.h"
+#include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_internal_split_pipeline.h"
 #include "mongo/db/pipeline/document_source_lookup.h"
 #include "mongo/db/pipeline/document_source_lookup_change_post_image.h"
@@ -2273,6 +2274,104 @@ class ShardedMatchSortProjLimBecomesMatchTopKSortProj : public Base {
 
 }  // namespace limitFieldsSentFromShardsToMerger
 
+namespace sortPartialGroupsForStreamingMerge {
+
+class StreamingMergeBase : public Base {
+public:
+    void run() override {
+        Base::run();
+        auto mergingGroup =
+            dynamic_cast<DocumentSourceGroup*>(mergePipe->getSources().front().get());
+        ASSERT(mergingGroup);
+        ASSERT_EQ(mergingGroup->inputSortedByGroupKey(), expectStreamingMerge());
+    }
+
+    virtual bool expectStreamingMerge() {
+        return true;
+    }
+};
+
+class GroupSortLimitSortsPartialGroupsById : public StreamingMergeBase {
+    string inputPipeJson() {
+        return "[{$group: {_id: '$a', count: {$sum: 1}}}"
+               ",{$sort: {count: -1}}"
+               ",{$limit: 5}"
+               "]";
+    }
+    string shardPipeJson() {
+        return "[{$group: {_id: '$a', count: {$sum: {$const: 1}}}}"
+               ",{$sort: {sortKey: {_id: 1}}}"
+               "]";
+    }
+    string mergePipeJson() {
+        return "[{$group: {_id: '$$ROOT._id', count: {$sum: '$$ROOT.count'}, $doingMerge: true}}"
+               ",{$sort: {sortKey: {count: -1}, limit: 5}}"
+               "]";
+    }
+};
+
+class GroupSortOnIdLimitSendsTopKPartialGroups : public StreamingMergeBase {
+    string inputPipeJson() {
+        return "[{$group: {_id: {a: '$a'}}}"
+               ",{$sort: {_id: -1}}"
+               ",{$skip: 2}"
+               ",{$limit: 3}"
+               "]";
+    }
+    string shardPipeJson() {
+        return "[{$group: {_id: {a: '$a'}}}"
+               ",{$sort: {sortKey: {_id: -1}, limit: 5}}"
+               "]";
+    }
+    string mergePipeJson() {
+        return "[{$group: {_id: '$$ROOT._id', $doingMerge: true}}"
+               ",{$sort: {sortKey: {_id: -1}, limit: 5}}"
+               ",{$skip: 2}"
+               "]";
+    }
+};
+
+class GroupSortOnIdWhichMayBeArrayDoesNotLimitShards : public StreamingMergeBase {
+    string inputPipeJson() {
+        return "[{$group: {_id: '$a'}}"
+               ",{$sort: {_id: -1}}"
+               ",{$limit: 3}"
+               "]";
+    }
+    string shardPipeJson() {
+        return "[{$group: {_id: '$a'}}"
+               ",{$sort: {sortKey: {_id: -1}}}"
+               "]";
+    }
+    string mergePipeJson() {
+        return "[{$group: {_id: '$$ROOT._id', $doingMerge: true}}"
+               ",{$sort: {sortKey: {_id: -1}, limit: 3}}"
+               "]";
+    }
+};
+
+class GroupSortWithoutLimitIsNotChanged : public StreamingMergeBase {
+    string inputPipeJson() {
+        return "[{$group: {_id: '$a'}}"
+               ",{$sort: {_id: 1}}"
+               "]";
+    }
+    string shardPipeJson() {
+        return "[{$group: {_id: '$a'}}"
+               "]";
+    }
+    string mergePipeJson() {
+        return "[{$group: {_id: '$$ROOT._id', $doingMerge: true}}"
+               ",{$sort: {sortKey: {_id: 1}}}"
+               "]";
+    }
+    bool expectStreamingMerge() override {
+        return false;
+    }
+};
+
+}  // namespace sortPartialGroupsForStreamingMerge
+
 namespace coalesceLookUpAndUnwind {
 
 class ShouldCoalesceUnwindOnAs : public Base {
@@ -3515,6 +3614,14 @@ public:
         add<Optimizations::Sharded::limitFieldsSentFromShardsToMerger::
                 ShardedMatchSortProjLimBecomesMatchTopKSortProj>();
         add<Optimizations::Sharded::limitFieldsSentFromShardsToMerger::ShardAlreadyExhaustive>();
+        add<Optimizations::Sharded::sortPartialGroupsForStreamingMerge::
+                GroupSortLimitSortsPartialGroupsById>();
+        add<Optimizations::Sharded::sortPartialGroupsForStreamingMerge::
+                GroupSortOnIdLimitSendsTopKPartialGroups>();
+        add<Optimizations::Sharded::sortPartialGroupsForStreamingMerge::
+                GroupSortOnIdWhichMayBeArrayDoesNotLimitShards>();
+        add<Optimizations::Sharded::sortPartialGroupsForStreamingMerge::
+                GroupSortWithoutLimitIsNotChanged>();
         add<Optimizations::Sharded::needsPrimaryShardMerger::Out>();
         add<Optimizations::Sharded::needsPrimaryShardMerger::MergeWithUnshardedCollection>();
         add<Optimizations::Sharded::needsPrimaryShardMerger::MergeWithShardedCollection>();
@@ -31,6 +31,7 @@
 
 #include "mongo/db/pipeline/stub_mongo_process_interface_lookup_single_document.h"
 
+#include "mongo/db/pipeline/document_key_lookup.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/util/assert_util.h"
@@ -99,4 +100,29 @@ boost::optional<Document> StubMongoProcessInterfaceLookupSingleDocument::lookupS
     return lookedUpDocument;
 }
 
+std::vector<boost::optional<Document>>
+StubMongoProcessInterfaceLookupSingleDocument::lookupDocuments(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    const NamespaceString& nss,
+    UUID collectionUUID,
+    const std::vector<Document>& documentKeys,
+    boost::optional<BSONObj> readConcern,
+    bool allowSpeculativeMajorityRead) {
+    ++_numLookupDocumentsCalls;
+    auto foreignExpCtx = expCtx->copyWith(nss, collectionUUID, boost::none);
+    std::unique_ptr<Pipeline, PipelineDeleter> pipeline;
+    try {
+        pipeline = makePipeline({BSON("$match" << document_key_lookup::makeFilter(documentKeys))},
+                                foreignExpCtx);
+    } catch (ExceptionFor<ErrorCodes::NamespaceNotFound>&) {
+        return std::vector<boost::optional<Document>>(documentKeys.size());
+    }
+
+    std::vector<Document> lookedUpDocuments;
+    while (auto next = pipeline->getNext()) {
+        lookedUpDocuments.push_back(std::move(*next));
+    }
+    return document_key_lookup::matchToKeys(foreignExpCtx, documentKeys, lookedUpDocuments);
+}
+
 }  // namespace mongo
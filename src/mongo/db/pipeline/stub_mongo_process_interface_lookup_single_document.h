@@ -83,6 +83,21 @@ public:
         boost::optional<BSONObj> readConcern,
         bool allowSpeculativeMajorityRead);
 
+    std::vector<boost::optional<Document>> lookupDocuments(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        const NamespaceString& nss,
+        UUID collectionUUID,
+        const std::vector<Document>& documentKeys,
+        boost::optional<BSONObj> readConcern,
+        bool allowSpeculativeMajorityRead);
+
+    /**
+     * Returns the number of calls to lookupDocuments() made so far.
+     */
+    size_t numLookupDocumentsCalls() const {
+        return _numLookupDocumentsCalls;
+    }
+
     std::unique_ptr<ShardFilterer> getShardFilterer(
         const boost::intrusive_ptr<ExpressionContext>& expCtx) const override {
         // Try to emulate the behavior mongos and mongod would each follow.
@@ -95,5 +110,6 @@ public:
 
 private:
     std::deque<DocumentSource::GetNextResult> _mockResults;
+    size_t _numLookupDocumentsCalls = 0;
 };
 }  // namespace mongo
@@ -50,6 +50,10 @@ const char kBatchDocSequenceField[] = "cursor.nextBatch";
 const char kBatchDocSequenceFieldInitial[] = "cursor.firstBatch";
 const char kPostBatchResumeTokenField[] = "postBatchResumeToken";
 
+// The bytes an array element adds to a document in the batch: the type byte, the decimal index
+// and its terminating null byte.
+const int kPerDocumentOverheadBytesUpperBound = 10;
+
 }  // namespace
 
 CursorResponseBuilder::CursorResponseBuilder(rpc::ReplyBuilderInterface* replyBuilder,
@@ -252,6 +256,16 @@ void CursorResponse::addToBSON(CursorResponse::ResponseType responseType,
     const char* batchFieldName =
         (responseType == ResponseType::InitialResponse) ? kBatchFieldInitial : kBatchField;
     BSONArrayBuilder batchBuilder(cursorBuilder.subarrayStart(batchFieldName));
+
+    // The whole batch is known up front, so grow the buffer once for it, rather than reallocating
+    // and copying everything appended so far each time a large batch outgrows the buffer.
+    int batchBytes = 0;
+    for (const BSONObj& obj : _batch) {
+        batchBytes += obj.objsize() + kPerDocumentOverheadBytesUpperBound;
+    }
+    batchBuilder.bb().reserveBytes(batchBytes);
+    batchBuilder.bb().claimReservedBytes(batchBytes);
+
     for (const BSONObj& obj : _batch) {
         batchBuilder.append(obj);
     }
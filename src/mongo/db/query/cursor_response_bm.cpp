@@ -0,0 +1,74 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/rpc/op_msg_rpc_impls.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Builds a getMore reply, as mongos does, from a batch of state.range(0) documents of about
+ * state.range(1) bytes each.
+ */
+void BM_getMoreReply(benchmark::State& state) {
+    const auto numDocs = state.range(0);
+    const std::string value(state.range(1), 'x');
+
+    std::vector<BSONObj> batch;
+    for (long long i = 0; i < numDocs; ++i) {
+        batch.push_back(BSON("_id" << i << "value" << value));
+    }
+    const CursorResponse response(NamespaceString("test.coll"), CursorId(123), std::move(batch));
+
+    for (auto _ : state) {
+        rpc::OpMsgReplyBuilder reply;
+        {
+            auto bob = reply.getBodyBuilder();
+            response.addToBSON(CursorResponse::ResponseType::SubsequentResponse, &bob);
+        }
+        benchmark::DoNotOptimize(reply.done());
+    }
+
+    state.SetBytesProcessed(state.iterations() * numDocs * state.range(1));
+}
+
+BENCHMARK(BM_getMoreReply)
+    ->Args({101, 100})
+    ->Args({10000, 100})
+    ->Args({1000, 16 * 1024})
+    ->Args({16, 1024 * 1024});
+
+}  // namespace
+}  // namespace mongo
@@ -67,6 +67,72 @@ namespace mongo {
 
 using std::unique_ptr;
 
+bool StageBuilder::returnsOnlyOwnedDocuments(const QuerySolutionNode* node,
+                                             const ScopedCollectionMetadata& metadata) {
+    if (!metadata->isSharded()) {
+        return false;
+    }
+
+    while (node->getType() == STAGE_FETCH) {
+        node = node->children[0];
+    }
+
+    if (node->getType() != STAGE_IXSCAN) {
+        return false;
+    }
+
+    // Multikey indexes can return documents whose shard key is an array, and collation aware
+    // indexes have bounds over collation keys rather than over the values of the shard key.
+    const auto& ixn = *static_cast<const IndexScanNode*>(node);
+    if (ixn.index.multikey || ixn.index.collator || ixn.bounds.isSimpleRange) {
+        return false;
+    }
+
+    // A document which is missing a field of a compound shard key other than the first one is
+    // indexed by its value of the first field, but has no shard key and must still be dropped
+    const auto& shardKeyPattern = metadata->getKeyPattern();
+    if (shardKeyPattern.nFields() != 1) {
+        return false;
+    }
+
+    const auto shardKeyField = shardKeyPattern.firstElement();
+    const auto indexField = ixn.index.keyPattern.firstElement();
+    if (!shardKeyField.isNumber() || !indexField.isNumber() ||
+        shardKeyField.fieldNameStringData() != indexField.fieldNameStringData()) {
+        return false;
+    }
+
+    for (const auto& interval : ixn.bounds.fields[0].intervals) {
+        BSONElement low = interval.start;
+        BSONElement high = interval.end;
+        if (low.woCompare(high, false) > 0) {
+            std::swap(low, high);
+        }
+
+        // Documents which are missing the shard key are indexed as null and must still be dropped
+        if (canonicalizeBSONType(low.type()) <= canonicalizeBSONType(jstNULL)) {
+            return false;
+        }
+
+        BSONObjBuilder minBuilder;
+        minBuilder.appendAs(low, shardKeyField.fieldName());
+        BSONObjBuilder maxBuilder;
+        maxBuilder.appendAs(high, shardKeyField.fieldName());
+
+        try {
+            if (!metadata->rangeIsOwnedByMe(minBuilder.obj(), maxBuilder.obj())) {
+                return false;
+            }
+        } catch (const ExceptionFor<ErrorCodes::StaleChunkHistory>&) {
+            // Leave it to the filter to report that the metadata is too stale for the read, if the
+            // scan returns any documents
+            return false;
+        }
+    }
+
+    return true;
+}
+
 PlanStage* buildStages(OperationContext* opCtx,
                        const Collection* collection,
                        const CanonicalQuery& cq,
@@ -312,8 +378,11 @@ PlanStage* buildStages(OperationContext* opCtx,
             }
 
             auto css = CollectionShardingState::get(opCtx, collection->ns());
+            auto metadata = css->getOrphansFilter(opCtx, collection);
+            const bool childReturnsOnlyOwnedDocuments =
+                StageBuilder::returnsOnlyOwnedDocuments(fn->children[0], metadata);
             return new ShardFilterStage(
-                opCtx, css->getOrphansFilter(opCtx, collection), ws, childStage);
+                opCtx, std::move(metadata), ws, childStage, childReturnsOnlyOwnedDocuments);
         }
         case STAGE_DISTINCT_SCAN: {
             const DistinctNode* dn = static_cast<const DistinctNode*>(root);
@@ -36,6 +36,7 @@
 namespace mongo {
 
 class OperationContext;
+class ScopedCollectionMetadata;
 
 /**
  * The StageBuilder converts a QuerySolution to an executable tree of PlanStage(s).
@@ -58,6 +59,15 @@ public:
                       const QuerySolution& solution,
                       WorkingSet* wsIn,
                       PlanStage** rootOut);
+
+    /**
+     * Returns true if 'node' can only return documents within chunks owned by this shard according
+     * to 'metadata', so that they need no shard filtering. This is the case when 'node' reads from
+     * a scan over an index on the shard key field, which must not be compound, whose bounds on that
+     * field are covered by chunks owned by this shard.
+     */
+    static bool returnsOnlyOwnedDocuments(const QuerySolutionNode* node,
+                                          const ScopedCollectionMetadata& metadata);
 };
 
 }  // namespace mongo
@@ -37,12 +37,19 @@
 
 #include "mongo/base/counter.h"
 #include "mongo/bson/util/bson_extract.h"
+#include "mongo/db/client.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/query/cursor_response.h"
 #include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/repl/replication_auth.h"
+#include "mongo/rpc/factory.h"
+#include "mongo/rpc/op_msg.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace repl {
@@ -60,6 +67,33 @@ const Milliseconds kNetworkTimeoutBufferMS{5000};
 // Default `maxTimeMS` timeout for `getMore`s.
 const Milliseconds kDefaultOplogGetMoreMaxMS{5000};
 
+/**
+ * Converts a timeout to the socket timeout in seconds expected by DBClientConnection.
+ */
+double toSocketTimeoutSecs(Milliseconds timeout) {
+    return durationCount<Milliseconds>(timeout + kNetworkTimeoutBufferMS) / 1000.0;
+}
+
+/**
+ * Parses a reply received on the exhaust stream into the same form the Fetcher hands to its
+ * callback. The documents share ownership with the reply buffer and are not copied.
+ */
+StatusWith<Fetcher::QueryResponse> parseExhaustReply(const Message& reply, bool first) {
+    auto commandReply = rpc::makeReply(&reply)->getCommandReply();
+    auto cursorResponse = CursorResponse::parseFromBSON(commandReply);
+    if (!cursorResponse.isOK()) {
+        return cursorResponse.getStatus();
+    }
+
+    Fetcher::QueryResponse queryResponse;
+    queryResponse.cursorId = cursorResponse.getValue().getCursorId();
+    queryResponse.nss = cursorResponse.getValue().getNSS();
+    queryResponse.documents = cursorResponse.getValue().releaseBatch();
+    queryResponse.otherFields.metadata = commandReply;
+    queryResponse.first = first;
+    return queryResponse;
+}
+
 }  // namespace
 
 AbstractOplogFetcher::AbstractOplogFetcher(executor::TaskExecutor* executor,
@@ -74,12 +108,19 @@ AbstractOplogFetcher::AbstractOplogFetcher(executor::TaskExecutor* executor,
       _nss(nss),
       _maxFetcherRestarts(maxFetcherRestarts),
       _onShutdownCallbackFn(onShutdownCallbackFn),
-      _lastFetched(lastFetched) {
+      _lastFetched(lastFetched),
+      _createClientFn([] { return std::make_unique<DBClientConnection>(); }) {
 
     invariant(!_lastFetched.isNull());
     invariant(onShutdownCallbackFn);
 }
 
+AbstractOplogFetcher::~AbstractOplogFetcher() {
+    if (_exhaustThread.joinable()) {
+        _exhaustThread.join();
+    }
+}
+
 Milliseconds AbstractOplogFetcher::_getInitialFindMaxTime() const {
     return Milliseconds(oplogInitialFindMaxSeconds.load() * 1000);
 }
@@ -92,6 +133,10 @@ Milliseconds AbstractOplogFetcher::_getGetMoreMaxTime() const {
     return kDefaultOplogGetMoreMaxMS;
 }
 
+bool AbstractOplogFetcher::_useExhaustCursor() const {
+    return false;
+}
+
 std::string AbstractOplogFetcher::toString() const {
     stdx::lock_guard<stdx::mutex> lock(_mutex);
     str::stream msg;
@@ -129,6 +174,11 @@ void AbstractOplogFetcher::_makeAndScheduleFetcherCallback(
 }
 
 Status AbstractOplogFetcher::_doStartup_inlock() noexcept {
+    if (_useExhaustCursor()) {
+        _exhaustThread = stdx::thread([this] { _runExhaustStream(); });
+        return Status::OK();
+    }
+
     return _scheduleWorkAndSaveHandle_inlock(
         [this](const executor::TaskExecutor::CallbackArgs& args) {
             _makeAndScheduleFetcherCallback(args);
@@ -142,6 +192,9 @@ void AbstractOplogFetcher::_doShutdown_inlock() noexcept {
     if (_fetcher) {
         _fetcher->shutdown();
     }
+    if (_exhaustConn) {
+        _exhaustConn->shutdownAndDisallowReconnect();
+    }
 }
 
 stdx::mutex* AbstractOplogFetcher::_getMutex() noexcept {
@@ -157,6 +210,11 @@ OpTime AbstractOplogFetcher::getLastOpTimeFetched_forTest() const {
     return _getLastOpTimeFetched();
 }
 
+void AbstractOplogFetcher::setCreateClientFn_forTest(const CreateClientFn& createClientFn) {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    _createClientFn = createClientFn;
+}
+
 OpTime AbstractOplogFetcher::_getLastOpTimeFetched() const {
     stdx::lock_guard<stdx::mutex> lock(_mutex);
     return _lastFetched;
@@ -264,19 +322,10 @@ void AbstractOplogFetcher::_callback(const Fetcher::QueryResponseStatus& result,
     // We have now processed the batch and should move forward our view of _lastFetched. Note that
     // the _lastFetched value will not be updated until the _onSuccessfulBatch function is
     // completed.
-    const auto& documents = queryResponse.documents;
-    if (documents.size() > 0) {
-        auto lastDocRes = OpTime::parseFromOplogEntry(documents.back());
-        if (!lastDocRes.isOK()) {
-            _finishCallback(lastDocRes.getStatus());
-            return;
-        }
-        auto lastDoc = lastDocRes.getValue();
-        LOG(3) << _getComponentName()
-               << " setting last fetched optime ahead after batch: " << lastDoc;
-
-        stdx::lock_guard<stdx::mutex> lock(_mutex);
-        _lastFetched = lastDoc;
+    auto advanceStatus = _advanceLastFetched(queryResponse.documents);
+    if (!advanceStatus.isOK()) {
+        _finishCallback(advanceStatus);
+        return;
     }
 
     // Check for shutdown to save an unnecessary `getMore` request.
@@ -290,6 +339,159 @@ void AbstractOplogFetcher::_callback(const Fetcher::QueryResponseStatus& result,
     getMoreBob->appendElements(batchResult.getValue());
 }
 
+Status AbstractOplogFetcher::_advanceLastFetched(const Fetcher::Documents& documents) {
+    if (documents.empty()) {
+        return Status::OK();
+    }
+
+    auto lastDocRes = OpTime::parseFromOplogEntry(documents.back());
+    if (!lastDocRes.isOK()) {
+        return lastDocRes.getStatus();
+    }
+    auto lastDoc = lastDocRes.getValue();
+    LOG(3) << _getComponentName() << " setting last fetched optime ahead after batch: " << lastDoc;
+
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    _lastFetched = lastDoc;
+    return Status::OK();
+}
+
+void AbstractOplogFetcher::_runExhaustStream() {
+    Client::initThread(_getComponentName());
+
+    auto findMaxTime = _getInitialFindMaxTime();
+    Status status = Status::OK();
+    while (true) {
+        bool batchFailed = false;
+        status = _runExhaustQuery(findMaxTime, &batchFailed);
+
+        if (batchFailed) {
+            // The stopReplProducer fail point expects this to return successfully. If another fail
+            // point wants this to return unsuccessfully, it should use a different error code.
+            _finishCallback(status == ErrorCodes::FailPointEnabled ? Status::OK() : status);
+            return;
+        }
+
+        // The cursor was exhausted. Stop processing and return Status::OK.
+        if (status.isOK()) {
+            _finishCallback(status);
+            return;
+        }
+
+        if (_isShuttingDown()) {
+            LOG(1) << _getComponentName() << " oplog query cancelled to " << _getSource() << ": "
+                   << redact(status);
+            _finishCallback(
+                Status(ErrorCodes::CallbackCanceled, _getComponentName() + " shutting down"));
+            return;
+        }
+
+        {
+            stdx::lock_guard<stdx::mutex> lock(_mutex);
+            if (_fetcherRestarts == _maxFetcherRestarts) {
+                log() << "Error returned from exhaust oplog query (no more query restarts left): "
+                      << redact(status);
+                break;
+            }
+            log() << "Restarting exhaust oplog query due to error: " << redact(status)
+                  << ". Last fetched optime: " << _lastFetched
+                  << ". Restarts remaining: " << (_maxFetcherRestarts - _fetcherRestarts);
+            _fetcherRestarts++;
+        }
+
+        // Use the retry 'find' timeout from now on.
+        findMaxTime = _getRetriedFindMaxTime();
+    }
+
+    _finishCallback(status);
+}
+
+Status AbstractOplogFetcher::_runExhaustQuery(Milliseconds findMaxTime, bool* batchFailed) try {
+    std::unique_ptr<DBClientConnection> conn;
+    {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        if (_isShuttingDown_inlock()) {
+            return Status(ErrorCodes::CallbackCanceled, _getComponentName() + " shutting down");
+        }
+        conn = _createClientFn();
+        _exhaustConn = conn.get();
+    }
+    ON_BLOCK_EXIT([this] {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        _exhaustConn = nullptr;
+    });
+
+    conn->setSoTimeout(toSocketTimeoutSecs(findMaxTime));
+    uassertStatusOK(conn->connect(_source, _getComponentName()));
+    uassert(ErrorCodes::AuthenticationFailed,
+            str::stream() << "Failed to authenticate to " << _source,
+            replAuthenticate(conn.get()));
+    readersCreatedStats.increment();
+
+    const auto metadataObj = _makeMetadataObject();
+    auto request = OpMsgRequest::fromDBAndBody(
+                       _nss.db(),
+                       _makeFindCommandObject(_nss, _getLastOpTimeFetched(), findMaxTime),
+                       metadataObj)
+                       .serialize();
+    Message reply;
+    conn->call(request, reply, true, nullptr);
+    conn->setSoTimeout(toSocketTimeoutSecs(_getGetMoreMaxTime()));
+
+    Timer batchTimer;
+    for (bool first = true;; first = false) {
+        auto queryResponse = uassertStatusOK(parseExhaustReply(reply, first));
+        queryResponse.elapsedMillis = Milliseconds(batchTimer.millis());
+
+        // Reset fetcher restart counter on successful response.
+        {
+            stdx::lock_guard<stdx::mutex> lock(_mutex);
+            invariant(_isActive_inlock());
+            _fetcherRestarts = 0;
+        }
+
+        if (_isShuttingDown()) {
+            return Status(ErrorCodes::CallbackCanceled, _getComponentName() + " shutting down");
+        }
+
+        auto batchResult = _onSuccessfulBatch(queryResponse);
+        if (!batchResult.isOK()) {
+            *batchFailed = true;
+            return batchResult.getStatus();
+        }
+
+        auto advanceStatus = _advanceLastFetched(queryResponse.documents);
+        if (!advanceStatus.isOK()) {
+            *batchFailed = true;
+            return advanceStatus;
+        }
+
+        // No more data.
+        if (queryResponse.cursorId == 0) {
+            return Status::OK();
+        }
+
+        batchTimer.reset();
+        if (OpMsg::isFlagSet(reply, OpMsg::kMoreToCome)) {
+            // Each reply on the exhaust stream claims to respond to the previous one.
+            const auto lastRequestId = reply.header().getId();
+            uassert(ErrorCodes::HostUnreachable,
+                    str::stream() << "Failed to receive exhaust oplog batch from " << _source,
+                    conn->recv(reply, lastRequestId));
+        } else {
+            // This is the reply to the `find`, or the sync source ended the exhaust stream. Start
+            // streaming with the `getMore` that the subclass wants to send next.
+            request =
+                OpMsgRequest::fromDBAndBody(_nss.db(), batchResult.getValue(), metadataObj)
+                    .serialize();
+            OpMsg::setFlag(&request, OpMsg::kExhaustSupported);
+            conn->call(request, reply, true, nullptr);
+        }
+    }
+} catch (const DBException& ex) {
+    return ex.toStatus();
+}
+
 void AbstractOplogFetcher::_finishCallback(Status status) {
     invariant(isActive());
 
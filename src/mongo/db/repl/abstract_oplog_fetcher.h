@@ -32,11 +32,13 @@
 #include <functional>
 
 #include "mongo/base/status_with.h"
+#include "mongo/client/dbclient_connection.h"
 #include "mongo/client/fetcher.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/repl/abstract_async_component.h"
 #include "mongo/db/repl/optime_with.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 
 namespace mongo {
 namespace repl {
@@ -49,6 +51,12 @@ namespace repl {
  *
  * The `find` command and metadata are provided by oplog fetchers that subclass the abstract oplog
  * fetcher. Subclasses also provide a callback to run on successful batches.
+ *
+ * Subclasses may instead ask for the oplog to be streamed over an exhaust cursor. In that mode the
+ * abstract oplog fetcher opens its own connection to the sync source on a dedicated thread, sends
+ * the `find` and a single `getMore` with the exhaustSupported flag, and then receives every
+ * following batch without another round trip. Batches are delivered to the same callback and
+ * restarted on error in the same way as in the Fetcher-based mode.
  */
 class AbstractOplogFetcher : public AbstractAsyncComponent {
     AbstractOplogFetcher(const AbstractOplogFetcher&) = delete;
@@ -67,6 +75,12 @@ public:
      */
     using OnShutdownCallbackFn = std::function<void(const Status& shutdownStatus)>;
 
+    /**
+     * Type of function that creates the connection used to stream the oplog over an exhaust
+     * cursor.
+     */
+    using CreateClientFn = std::function<std::unique_ptr<DBClientConnection>()>;
+
     /**
      * Invariants if validation fails on any of the provided arguments.
      */
@@ -78,7 +92,7 @@ public:
                          OnShutdownCallbackFn onShutdownCallbackFn,
                          const std::string& componentName);
 
-    virtual ~AbstractOplogFetcher() = default;
+    virtual ~AbstractOplogFetcher();
 
     std::string toString() const;
 
@@ -101,6 +115,11 @@ public:
      */
     OpTime getLastOpTimeFetched_forTest() const;
 
+    /**
+     * Overrides how the connection used for exhaust cursor streaming is created.
+     */
+    void setCreateClientFn_forTest(const CreateClientFn& createClientFn);
+
 protected:
     /**
      * Returns how long the `find` command should wait before timing out.
@@ -120,6 +139,12 @@ protected:
      */
     virtual Milliseconds _getGetMoreMaxTime() const;
 
+    /**
+     * Returns true if batches should be streamed from the sync source over an exhaust cursor on a
+     * dedicated connection rather than requested one `getMore` at a time through the executor.
+     */
+    virtual bool _useExhaustCursor() const;
+
     /**
      * Returns the sync source from which this oplog fetcher is fetching.
      */
@@ -198,6 +223,25 @@ private:
      */
     void _callback(const Fetcher::QueryResponseStatus& result, BSONObjBuilder* getMoreBob);
 
+    /**
+     * Moves _lastFetched forward to the optime of the last document in a processed batch.
+     */
+    Status _advanceLastFetched(const Fetcher::Documents& documents);
+
+    /**
+     * Body of the thread that streams the oplog over an exhaust cursor. Restarts the query on
+     * network and command errors and calls "_finishCallback" once the stream can not continue.
+     */
+    void _runExhaustStream();
+
+    /**
+     * Connects to the sync source, establishes an exhaust cursor starting at the last fetched
+     * optime and hands every batch to _onSuccessfulBatch until the cursor is exhausted or an error
+     * occurs. Sets 'batchFailed' if the error came from processing a batch rather than from the
+     * sync source, in which case the query must not be restarted.
+     */
+    Status _runExhaustQuery(Milliseconds findMaxTime, bool* batchFailed);
+
     /**
      * Notifies caller that the oplog fetcher has completed processing operations from
      * the remote oplog using the "_onShutdownCallbackFn".
@@ -230,6 +274,16 @@ private:
 
     // Handle to currently scheduled _makeAndScheduleFetcherCallback task.
     executor::TaskExecutor::CallbackHandle _makeAndScheduleFetcherHandle;
+
+    // Creates the connection used when streaming over an exhaust cursor.
+    CreateClientFn _createClientFn;
+
+    // Thread running _runExhaustStream(), if streaming over an exhaust cursor.
+    stdx::thread _exhaustThread;
+
+    // Connection currently used by _exhaustThread. Only shutdownAndDisallowReconnect() may be
+    // called on it from other threads, and only while holding _mutex.
+    DBClientConnection* _exhaustConn = nullptr;
 };
 
 }  // namespace repl
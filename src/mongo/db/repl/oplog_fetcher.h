@@ -165,6 +165,11 @@ private:
 
     Milliseconds _getGetMoreMaxTime() const override;
 
+    /**
+     * Returns the value of the 'oplogFetcherUsesExhaust' server parameter.
+     */
+    bool _useExhaustCursor() const override;
+
     /**
      * This function is run by the AbstractOplogFetcher on a successful batch of oplog entries.
      */
@@ -34,9 +34,12 @@
 #include "mongo/db/repl/abstract_oplog_fetcher_test_fixture.h"
 #include "mongo/db/repl/data_replicator_external_state_mock.h"
 #include "mongo/db/repl/oplog_fetcher.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/service_context.h"
 #include "mongo/rpc/metadata.h"
 #include "mongo/rpc/metadata/oplog_query_metadata.h"
 #include "mongo/rpc/metadata/repl_set_metadata.h"
+#include "mongo/rpc/op_msg.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/ensure_fcv.h"
 #include "mongo/unittest/task_executor_proxy.h"
@@ -1023,4 +1026,181 @@ TEST_F(OplogFetcherTest,
 
     ASSERT_EQUALS(OpTime(), info.lastDocument);
 }
+
+/**
+ * A connection that answers the oplog fetcher's exhaust stream from a script of replies instead of
+ * the network. An empty script behaves like a connection that was closed by the sync source.
+ */
+class ScriptedExhaustConnection : public DBClientConnection {
+public:
+    struct Request {
+        BSONObj body;
+        bool exhaustSupported;
+    };
+
+    ScriptedExhaustConnection(std::deque<Message> replies, std::vector<Request>* requests)
+        : _replies(std::move(replies)), _requests(requests) {}
+
+    Status connect(const HostAndPort&, StringData) override {
+        return Status::OK();
+    }
+
+    bool call(Message& toSend, Message& response, bool, std::string*) override {
+        _requests->push_back({OpMsgRequest::parse(toSend).body.getOwned(),
+                              OpMsg::isFlagSet(toSend, OpMsg::kExhaustSupported)});
+        toSend.header().setId(nextMessageId());
+        uassert(ErrorCodes::HostUnreachable,
+                "connection closed by scripted sync source",
+                recv(response, toSend.header().getId()));
+        return true;
+    }
+
+    bool recv(Message& m, int lastRequestId) override {
+        if (_replies.empty()) {
+            return false;
+        }
+        m = std::move(_replies.front());
+        _replies.pop_front();
+        m.header().setId(nextMessageId());
+        m.header().setResponseToMsgId(lastRequestId);
+        return true;
+    }
+
+private:
+    std::deque<Message> _replies;
+    std::vector<Request>* const _requests;
+};
+
+class OplogFetcherExhaustTest : public OplogFetcherTest {
+protected:
+    void setUp() override {
+        setGlobalServiceContext(ServiceContext::make());
+        OplogFetcherTest::setUp();
+        oplogFetcherUsesExhaust = true;
+    }
+
+    void tearDown() override {
+        oplogFetcherUsesExhaust = false;
+        OplogFetcherTest::tearDown();
+        setGlobalServiceContext({});
+    }
+
+    /**
+     * Returns a cursor reply carrying oplog query metadata. Replies that are not the last in an
+     * exhaust stream have the moreToCome flag set.
+     */
+    Message makeReply(CursorId cursorId,
+                      Fetcher::Documents oplogEntries,
+                      bool isFirstBatch,
+                      bool moreToCome) {
+        auto reply = OpMsg{concatenate(makeCursorResponse(cursorId, oplogEntries, isFirstBatch),
+                                       makeOplogQueryMetadataObject(remoteNewerOpTime, rbid, 2, 2))}
+                         .serialize();
+        if (moreToCome) {
+            OpMsg::setFlag(&reply, OpMsg::kMoreToCome);
+        }
+        return reply;
+    }
+
+    /**
+     * Starts an oplog fetcher whose connections, in order, answer with the scripted replies and
+     * waits for it to finish.
+     */
+    std::unique_ptr<ShutdownState> runExhaustStream(std::deque<std::deque<Message>> connections,
+                                                    std::size_t maxFetcherRestarts) {
+        auto shutdownState = std::make_unique<ShutdownState>();
+        OplogFetcher oplogFetcher(&getExecutor(),
+                                  lastFetched,
+                                  source,
+                                  nss,
+                                  _createConfig(),
+                                  maxFetcherRestarts,
+                                  rbid,
+                                  true,
+                                  dataReplicatorExternalState.get(),
+                                  enqueueDocumentsFn,
+                                  std::ref(*shutdownState),
+                                  defaultBatchSize);
+        oplogFetcher.setCreateClientFn_forTest([&] {
+            invariant(!connections.empty());
+            auto replies = std::move(connections.front());
+            connections.pop_front();
+            return std::make_unique<ScriptedExhaustConnection>(std::move(replies), &requests);
+        });
+
+        ASSERT_OK(oplogFetcher.startup());
+        oplogFetcher.join();
+        lastFetchedAfterStream = oplogFetcher.getLastOpTimeFetched_forTest();
+        return shutdownState;
+    }
+
+    std::vector<ScriptedExhaustConnection::Request> requests;
+    OpTime lastFetchedAfterStream;
+};
+
+TEST_F(OplogFetcherExhaustTest, ExhaustStreamReceivesBatchesWithoutSendingGetMores) {
+    auto firstEntry = makeNoopOplogEntry(lastFetched);
+    auto secondEntry = makeNoopOplogEntry({{124, 1}, 1});
+    auto thirdEntry = makeNoopOplogEntry({{125, 1}, 1});
+    auto fourthEntry = makeNoopOplogEntry({{126, 1}, 1});
+
+    std::deque<Message> replies;
+    replies.push_back(makeReply(22LL, {firstEntry, secondEntry}, true, false));
+    replies.push_back(makeReply(22LL, {thirdEntry}, false, true));
+    replies.push_back(makeReply(0LL, {fourthEntry}, false, false));
+
+    std::deque<std::deque<Message>> connections;
+    connections.push_back(std::move(replies));
+    ASSERT_OK(runExhaustStream(std::move(connections), 0)->getStatus());
+
+    // One `find` and a single `getMore` starting the exhaust stream.
+    ASSERT_EQUALS(2U, requests.size());
+    ASSERT_EQUALS("find"_sd, requests[0].body.firstElementFieldNameStringData());
+    ASSERT_FALSE(requests[0].exhaustSupported);
+    ASSERT_EQUALS("getMore"_sd, requests[1].body.firstElementFieldNameStringData());
+    ASSERT_EQUALS(22LL, requests[1].body.firstElement().numberLong());
+    ASSERT_TRUE(requests[1].exhaustSupported);
+
+    ASSERT_EQUALS(1U, lastEnqueuedDocuments.size());
+    ASSERT_BSONOBJ_EQ(fourthEntry, lastEnqueuedDocuments[0]);
+    ASSERT_EQUALS(OpTime({126, 1}, 1), lastFetchedAfterStream);
+}
+
+TEST_F(OplogFetcherExhaustTest, ExhaustStreamRestartsFromLastFetchedOpTimeOnNetworkError) {
+    auto firstEntry = makeNoopOplogEntry(lastFetched);
+    auto secondEntry = makeNoopOplogEntry({{124, 1}, 1});
+    auto thirdEntry = makeNoopOplogEntry({{125, 1}, 1});
+
+    // The first connection is closed right after the reply to the `find`.
+    std::deque<Message> firstConnection;
+    firstConnection.push_back(makeReply(22LL, {firstEntry, secondEntry}, true, false));
+    std::deque<Message> secondConnection;
+    secondConnection.push_back(makeReply(0LL, {secondEntry, thirdEntry}, true, false));
+
+    std::deque<std::deque<Message>> connections;
+    connections.push_back(std::move(firstConnection));
+    connections.push_back(std::move(secondConnection));
+    ASSERT_OK(runExhaustStream(std::move(connections), 1)->getStatus());
+
+    ASSERT_EQUALS(3U, requests.size());
+    ASSERT_EQUALS("find"_sd, requests[2].body.firstElementFieldNameStringData());
+    ASSERT_BSONOBJ_EQ(BSON("ts" << BSON("$gte" << Timestamp(124, 1))),
+                      requests[2].body["filter"].Obj());
+
+    ASSERT_EQUALS(1U, lastEnqueuedDocuments.size());
+    ASSERT_BSONOBJ_EQ(thirdEntry, lastEnqueuedDocuments[0]);
+    ASSERT_EQUALS(OpTime({125, 1}, 1), lastFetchedAfterStream);
+}
+
+TEST_F(OplogFetcherExhaustTest, ExhaustStreamIsNotRestartedWhenFirstBatchRequiresRollback) {
+    std::deque<Message> replies;
+    replies.push_back(
+        makeReply(22LL, {makeNoopOplogEntry({{124, 1}, 1})}, true /* isFirstBatch */, false));
+
+    std::deque<std::deque<Message>> connections;
+    connections.push_back(std::move(replies));
+    ASSERT_EQUALS(ErrorCodes::OplogStartMissing,
+                  runExhaustStream(std::move(connections), 1)->getStatus());
+    ASSERT_EQUALS(1U, requests.size());
+}
 }  // namespace
@@ -29,8 +29,11 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/base/status_with.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/net/hostandport.h"
 #include "mongo/util/uuid.h"
 
@@ -89,6 +92,21 @@ public:
                                                               UUID uuid,
                                                               const BSONObj& filter) const = 0;
 
+    /**
+     * Fetches the documents whose _id is one of 'ids' from the sync source using the UUID. Returns
+     * the documents found, in no particular order, and the namespace matching the UUID on the sync
+     * source. Unlike the other functions, this may be called from several threads at once.
+     *
+     * The size of each document fetched is taken out of 'remainingBytes', which concurrent calls
+     * share. Throws ExceededMemoryLimit, without waiting for the remaining documents, once it is
+     * used up.
+     */
+    virtual std::pair<std::vector<BSONObj>, NamespaceString> findByUUID(
+        const std::string& db,
+        UUID uuid,
+        const std::vector<BSONElement>& ids,
+        AtomicWord<long long>* remainingBytes) const = 0;
+
     /**
      * Clones a single collection from the sync source.
      */
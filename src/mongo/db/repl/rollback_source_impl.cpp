@@ -51,6 +51,8 @@ RollbackSourceImpl::RollbackSourceImpl(GetConnectionFn getConnection,
       _collectionName(collectionName),
       _oplog(source, getConnection, collectionName, batchSize) {}
 
+RollbackSourceImpl::~RollbackSourceImpl() = default;
+
 const OplogInterface& RollbackSourceImpl::getOplog() const {
     return _oplog;
 }
@@ -83,6 +85,62 @@ std::pair<BSONObj, NamespaceString> RollbackSourceImpl::findOneByUUID(const std:
     return _getConnection()->findOneByUUID(db, uuid, filter);
 }
 
+std::pair<std::vector<BSONObj>, NamespaceString> RollbackSourceImpl::findByUUID(
+    const std::string& db,
+    UUID uuid,
+    const std::vector<BSONElement>& ids,
+    AtomicWord<long long>* remainingBytes) const {
+    std::unique_ptr<DBClientConnection> conn;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_idleConnectionsMutex);
+        if (!_idleConnections.empty()) {
+            conn = std::move(_idleConnections.back());
+            _idleConnections.pop_back();
+        }
+    }
+    if (!conn) {
+        std::string errmsg;
+        conn = std::make_unique<DBClientConnection>();
+        uassert(ErrorCodes::HostUnreachable,
+                str::stream() << "replSet rollback could not connect to " << _source << ": "
+                              << errmsg,
+                conn->connect(_source, StringData(), errmsg) && replAuthenticate(conn.get()));
+    }
+
+    BSONObjBuilder filter;
+    {
+        BSONObjBuilder idBuilder(filter.subobjStart("_id"));
+        BSONArrayBuilder inBuilder(idBuilder.subarrayStart("$in"));
+        for (auto&& id : ids) {
+            inBuilder.append(id);
+        }
+    }
+
+    auto cursor = conn->query(
+        NamespaceStringOrUUID(db, uuid), Query(filter.obj()), 0, 0, nullptr, QueryOption_SlaveOk);
+    uassert(ErrorCodes::HostUnreachable,
+            str::stream() << "find command using UUID failed on " << _source,
+            cursor);
+
+    std::vector<BSONObj> docs;
+    docs.reserve(ids.size());
+    while (cursor->more()) {
+        docs.push_back(cursor->nextSafe().getOwned());
+
+        // Abandoning the cursor here also abandons the connection, which is not reused below.
+        uassert(ErrorCodes::ExceededMemoryLimit,
+                "replSet too much data to roll back",
+                remainingBytes->subtractAndFetch(docs.back().objsize()) > 0);
+    }
+    NamespaceString nss(cursor->getns());
+    cursor.reset();
+
+    // Only a connection whose cursor was exhausted without error can be reused.
+    stdx::lock_guard<stdx::mutex> lk(_idleConnectionsMutex);
+    _idleConnections.push_back(std::move(conn));
+    return {std::move(docs), std::move(nss)};
+}
+
 void RollbackSourceImpl::copyCollectionFromRemote(OperationContext* opCtx,
                                                   const NamespaceString& nss) const {
     std::string errmsg;
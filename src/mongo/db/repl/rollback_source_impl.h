@@ -30,15 +30,19 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "mongo/db/repl/oplog_interface_remote.h"
 #include "mongo/db/repl/rollback_source.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/net/hostandport.h"
 
 namespace mongo {
 
 class DBClientBase;
+class DBClientConnection;
 
 namespace repl {
 
@@ -58,6 +62,8 @@ public:
                        const std::string& collectionName,
                        int batchSize);
 
+    ~RollbackSourceImpl();
+
     const OplogInterface& getOplog() const override;
 
     const HostAndPort& getSource() const override;
@@ -72,6 +78,16 @@ public:
                                                       UUID uuid,
                                                       const BSONObj& filter) const override;
 
+    /**
+     * Runs on a connection of its own rather than the one returned by 'getConnection', so that
+     * several of these queries can be in flight at once.
+     */
+    std::pair<std::vector<BSONObj>, NamespaceString> findByUUID(
+        const std::string& db,
+        UUID uuid,
+        const std::vector<BSONElement>& ids,
+        AtomicWord<long long>* remainingBytes) const override;
+
     void copyCollectionFromRemote(OperationContext* opCtx,
                                   const NamespaceString& nss) const override;
 
@@ -85,6 +101,10 @@ private:
     HostAndPort _source;
     std::string _collectionName;
     OplogInterfaceRemote _oplog;
+
+    // Idle connections to the sync source used by findByUUID().
+    mutable stdx::mutex _idleConnectionsMutex;
+    mutable std::vector<std::unique_ptr<DBClientConnection>> _idleConnections;
 };
 
 
@@ -247,6 +247,27 @@ std::pair<BSONObj, NamespaceString> RollbackSourceMock::findOneByUUID(const std:
     return {BSONObj(), NamespaceString()};
 }
 
+std::pair<std::vector<BSONObj>, NamespaceString> RollbackSourceMock::findByUUID(
+    const std::string& db,
+    UUID uuid,
+    const std::vector<BSONElement>& ids,
+    AtomicWord<long long>* remainingBytes) const {
+    stdx::lock_guard<stdx::mutex> lk(_findMutex);
+    std::vector<BSONObj> docs;
+    NamespaceString nss;
+    for (auto&& id : ids) {
+        BSONObj doc;
+        std::tie(doc, nss) = findOneByUUID(db, uuid, id.wrap());
+        if (!doc.isEmpty()) {
+            uassert(ErrorCodes::ExceededMemoryLimit,
+                    "replSet too much data to roll back",
+                    remainingBytes->subtractAndFetch(doc.objsize()) > 0);
+            docs.push_back(std::move(doc));
+        }
+    }
+    return {std::move(docs), std::move(nss)};
+}
+
 void RollbackSourceMock::copyCollectionFromRemote(OperationContext* opCtx,
                                                   const NamespaceString& nss) const {}
 
@@ -256,6 +256,16 @@ public:
                                                       UUID uuid,
                                                       const BSONObj& filter) const override;
 
+    /**
+     * Looks up each of 'ids' in turn through findOneByUUID(), so that mocks only need to override
+     * the latter. Calls to findOneByUUID() are serialized.
+     */
+    std::pair<std::vector<BSONObj>, NamespaceString> findByUUID(
+        const std::string& db,
+        UUID uuid,
+        const std::vector<BSONElement>& ids,
+        AtomicWord<long long>* remainingBytes) const override;
+
     void copyCollectionFromRemote(OperationContext* opCtx,
                                   const NamespaceString& nss) const override;
     StatusWith<BSONObj> getCollectionInfoByUUID(const std::string& db,
@@ -265,6 +275,8 @@ public:
 private:
     std::unique_ptr<OplogInterface> _oplog;
     HostAndPort _source;
+
+    mutable stdx::mutex _findMutex;
 };
 
 /**
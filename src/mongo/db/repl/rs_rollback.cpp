@@ -63,6 +63,7 @@
 #include "mongo/db/repl/drop_pending_collection_reaper.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/oplog_interface.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/replication_coordinator_impl.h"
 #include "mongo/db/repl/replication_process.h"
@@ -76,6 +77,7 @@
 #include "mongo/db/transaction_participant.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -1016,91 +1018,235 @@ Status _syncRollback(OperationContext* opCtx,
 
 }  // namespace
 
-void rollback_internal::syncFixUp(OperationContext* opCtx,
-                                  const FixUpInfo& fixUpInfo,
-                                  const RollbackSource& rollbackSource,
-                                  ReplicationCoordinator* replCoord,
-                                  ReplicationProcess* replicationProcess) {
-    unsigned long long totalSize = 0;
+namespace {
 
-    // UUID -> doc id -> doc
-    stdx::unordered_map<UUID, std::map<DocID, BSONObj>, UUID::Hash> goodVersions;
-    auto& catalog = CollectionCatalog::get(opCtx);
+// We do not roll back more than 300 MB of documents in order to prevent out of memory errors from
+// too much data being stored. See SERVER-23392.
+const long long kMaxRefetchTotalSize = 300 * 1024 * 1024;
 
-    // Fetches all the goodVersions of each document from the current sync source.
-    unsigned long long numFetched = 0;
+// The number of refetched documents written back under one acquisition of their database lock.
+const size_t kMaxDocsPerLockAcquisition = 1000;
 
-    log() << "Starting refetching documents";
+// Bounds the size of the $in list sent to the sync source for a single batch of _ids.
+const int kMaxRefetchBatchIdBytes = BSONObjMaxUserSize / 2;
 
+/**
+ * Documents of a single collection which are refetched from the sync source in one query.
+ */
+struct RefetchBatch {
+    RefetchBatch(UUID uuid, std::string dbName) : uuid(uuid), dbName(std::move(dbName)) {}
+
+    UUID uuid;
+    std::string dbName;
+    std::vector<const DocID*> docs;
+    int idBytes = 0;
+
+    // The outcome of the query.
+    Status status = Status::OK();
+    std::vector<BSONObj> fetched;
+    NamespaceString resNss;
+};
+
+/**
+ * Splits the documents to refetch into batches, one collection at a time. 'docsToRefetch' is
+ * ordered by collection UUID, so the documents of a collection are adjacent.
+ */
+std::vector<RefetchBatch> makeRefetchBatches(OperationContext* opCtx, const FixUpInfo& fixUpInfo) {
+    auto& catalog = CollectionCatalog::get(opCtx);
+    const size_t maxBatchSize = rollbackRefetchBatchSize.load();
+
+    std::vector<RefetchBatch> batches;
     for (auto&& doc : fixUpInfo.docsToRefetch) {
         invariant(!doc._id.eoo());  // This is checked when we insert to the set.
 
-        UUID uuid = doc.uuid;
-        boost::optional<NamespaceString> nss = catalog.lookupNSSByUUID(uuid);
+        if (batches.empty() || batches.back().uuid != doc.uuid ||
+            batches.back().docs.size() >= maxBatchSize ||
+            batches.back().idBytes + doc._id.size() > kMaxRefetchBatchIdBytes) {
+            boost::optional<NamespaceString> nss = catalog.lookupNSSByUUID(doc.uuid);
+            batches.emplace_back(doc.uuid, nss ? nss->db().toString() : "");
+        }
+        batches.back().docs.push_back(&doc);
+        batches.back().idBytes += doc._id.size();
+    }
+    return batches;
+}
 
+/**
+ * Runs the queries for 'batches' against the sync source, up to rollbackRefetchMaxConcurrency of
+ * them at once. The documents fetched by all of the queries together may not reach
+ * kMaxRefetchTotalSize, and no more queries are issued once they do. Returns the total size of the
+ * documents fetched, which is at least kMaxRefetchTotalSize if the limit was reached.
+ */
+long long runRefetchBatches(const RollbackSource& rollbackSource,
+                            std::vector<RefetchBatch>* batches) {
+    AtomicWord<long long> remainingBytes{kMaxRefetchTotalSize};
+    auto fetchBatch = [&](RefetchBatch* batch) {
+        if (remainingBytes.load() <= 0) {
+            return;
+        }
+
+        std::vector<BSONElement> ids;
+        ids.reserve(batch->docs.size());
+        for (auto doc : batch->docs) {
+            ids.push_back(doc->_id);
+        }
+
+        LOG(2) << "Refetching " << ids.size() << " documents, UUID: " << batch->uuid;
         try {
-            if (nss) {
-                LOG(2) << "Refetching document, collection: " << *nss << ", UUID: " << uuid << ", "
-                       << redact(doc._id);
-            } else {
-                LOG(2) << "Refetching document, UUID: " << uuid << ", " << redact(doc._id);
-            }
-            // TODO : Slow. Lots of round trips.
-            numFetched++;
+            std::tie(batch->fetched, batch->resNss) =
+                rollbackSource.findByUUID(batch->dbName, batch->uuid, ids, &remainingBytes);
+        } catch (const DBException& ex) {
+            batch->status = ex.toStatus();
+        }
+    };
 
-            BSONObj good;
-            NamespaceString resNss;
-
-            std::string dbName = nss ? nss->db().toString() : "";
-            std::tie(good, resNss) = rollbackSource.findOneByUUID(dbName, uuid, doc._id.wrap());
-
-            // To prevent inconsistencies in the transactions collection, rollback fails if the UUID
-            // of the collection is different on the sync source than on the node rolling back,
-            // forcing an initial sync. This is detected if the returned namespace for a refetch of
-            // a transaction table document is not "config.transactions," which implies a rename or
-            // drop of the collection occured on either node.
-            if (uuid == fixUpInfo.transactionTableUUID &&
-                resNss != NamespaceString::kSessionTransactionsTableNamespace) {
-                throw RSFatalException(
-                    str::stream()
-                    << "A fetch on the transactions collection returned an unexpected namespace: "
-                    << resNss.ns()
-                    << ". The transactions collection cannot be correctly rolled back, a full "
-                       "resync is required.");
+    const size_t concurrency =
+        std::min<size_t>(rollbackRefetchMaxConcurrency.load(), batches->size());
+    if (concurrency <= 1) {
+        for (auto&& batch : *batches) {
+            fetchBatch(&batch);
+        }
+        return kMaxRefetchTotalSize - remainingBytes.load();
+    }
+
+    ThreadPool::Options options;
+    options.poolName = "RollbackRefetch";
+    options.minThreads = 0;
+    options.maxThreads = concurrency;
+    options.onCreateThread = [](const std::string& name) { Client::initThread(name); };
+    ThreadPool pool(options);
+    pool.startup();
+    for (auto&& batch : *batches) {
+        pool.schedule([&fetchBatch, batch = &batch](Status status) {
+            if (!status.isOK()) {
+                batch->status = status;
+                return;
             }
+            fetchBatch(batch);
+        });
+    }
+    pool.shutdown();
+    pool.join();
+    return kMaxRefetchTotalSize - remainingBytes.load();
+}
+
+}  // namespace
 
-            totalSize += good.objsize();
+stdx::unordered_map<UUID, std::map<DocID, BSONObj>, UUID::Hash> rollback_internal::refetchDocuments(
+    OperationContext* opCtx, const FixUpInfo& fixUpInfo, const RollbackSource& rollbackSource) {
+    stdx::unordered_map<UUID, std::map<DocID, BSONObj>, UUID::Hash> goodVersions;
+
+    log() << "Starting refetching documents";
 
-            // Checks that the total amount of data that needs to be refetched is at most
-            // 300 MB. We do not roll back more than 300 MB of documents in order to
-            // prevent out of memory errors from too much data being stored. See SERVER-23392.
-            if (totalSize >= 300 * 1024 * 1024) {
-                throw RSFatalException("replSet too much data to roll back.");
+    auto batches = makeRefetchBatches(opCtx, fixUpInfo);
+    auto totalSize = runRefetchBatches(rollbackSource, &batches);
+
+    // Checks that the total amount of data that needs to be refetched is at most 300 MB.
+    if (totalSize >= kMaxRefetchTotalSize) {
+        throw RSFatalException("replSet too much data to roll back.");
+    }
+
+    size_t numFetched = 0;
+    for (auto&& batch : batches) {
+        numFetched += batch.docs.size();
+
+        // If the collection turned into a view, we might get an error trying to refetch
+        // documents, but these errors should be ignored, as we'll be creating the view during
+        // oplog replay. Collection may be dropped on the sync source, in which case it will be
+        // dropped during oplog replay. So it is safe to ignore NamespaceNotFound errors while
+        // trying to refetch documents.
+        if (batch.status == ErrorCodes::CommandNotSupportedOnView ||
+            batch.status == ErrorCodes::NamespaceNotFound) {
+            continue;
+        }
+        if (!batch.status.isOK()) {
+            log() << "Rollback couldn't re-fetch from uuid: " << batch.uuid << " "
+                  << batch.docs.size() << " documents starting at _id: "
+                  << redact(batch.docs.front()->_id) << ' ' << numFetched << '/'
+                  << fixUpInfo.docsToRefetch.size() << ": " << redact(batch.status);
+            uassertStatusOK(batch.status);
+        }
+
+        // To prevent inconsistencies in the transactions collection, rollback fails if the UUID
+        // of the collection is different on the sync source than on the node rolling back,
+        // forcing an initial sync. This is detected if the returned namespace for a refetch of
+        // a transaction table document is not "config.transactions," which implies a rename or
+        // drop of the collection occured on either node.
+        if (batch.uuid == fixUpInfo.transactionTableUUID &&
+            batch.resNss != NamespaceString::kSessionTransactionsTableNamespace) {
+            throw RSFatalException(
+                str::stream()
+                << "A fetch on the transactions collection returned an unexpected namespace: "
+                << batch.resNss.ns()
+                << ". The transactions collection cannot be correctly rolled back, a full "
+                   "resync is required.");
+        }
+
+        // Matches the fetched documents to the requested _ids the same way as DocID does.
+        const StringData::ComparatorInterface* stringComparator = nullptr;
+        BSONElementComparator eltCmp(BSONElementComparator::FieldNamesMode::kIgnore,
+                                     stringComparator);
+        auto fetchedById = eltCmp.makeBSONEltIndexedMap<BSONObj>();
+        for (auto&& fetched : batch.fetched) {
+            fetchedById.emplace(fetched["_id"], fetched);
+        }
+
+        auto& collectionGoodVersions = goodVersions[batch.uuid];
+        size_t numMatched = 0;
+        std::vector<const DocID*> unmatched;
+        for (auto doc : batch.docs) {
+            auto it = fetchedById.find(doc->_id);
+            if (it != fetchedById.end()) {
+                collectionGoodVersions.emplace(*doc, it->second);
+                ++numMatched;
+            } else {
+                unmatched.push_back(doc);
             }
+        }
 
+        // Under a non-simple collation, the sync source may have returned a document for an _id
+        // which is not bitwise equal to the requested one. Those _ids are refetched one at a
+        // time, so that they resolve exactly as a single lookup would.
+        const bool needsSingleLookups = numMatched < batch.fetched.size();
+        for (auto doc : unmatched) {
             // Note good might be empty, indicating we should delete it.
-            goodVersions[uuid].insert(std::pair<DocID, BSONObj>(doc, good));
-
-        } catch (const DBException& ex) {
-            // If the collection turned into a view, we might get an error trying to
-            // refetch documents, but these errors should be ignored, as we'll be creating
-            // the view during oplog replay.
-            // Collection may be dropped on the sync source, in which case it will be dropped during
-            // oplog replay. So it is safe to ignore NamespaceNotFound errors while trying to
-            // refetch documents.
-            if (ex.code() == ErrorCodes::CommandNotSupportedOnView ||
-                ex.code() == ErrorCodes::NamespaceNotFound)
-                continue;
+            BSONObj good;
+            if (needsSingleLookups) {
+                try {
+                    good = rollbackSource.findOneByUUID(batch.dbName, batch.uuid, doc->_id.wrap())
+                               .first;
+                } catch (const DBException& ex) {
+                    if (ex.code() == ErrorCodes::CommandNotSupportedOnView ||
+                        ex.code() == ErrorCodes::NamespaceNotFound) {
+                        continue;
+                    }
+                    log() << "Rollback couldn't re-fetch from uuid: " << batch.uuid
+                          << " _id: " << redact(doc->_id) << ": " << redact(ex);
+                    throw;
+                }
 
-            log() << "Rollback couldn't re-fetch from uuid: " << uuid << " _id: " << redact(doc._id)
-                  << ' ' << numFetched << '/' << fixUpInfo.docsToRefetch.size() << ": "
-                  << redact(ex);
-            throw;
+                totalSize += good.objsize();
+                if (totalSize >= kMaxRefetchTotalSize) {
+                    throw RSFatalException("replSet too much data to roll back.");
+                }
+            }
+            collectionGoodVersions.emplace(*doc, good);
         }
     }
 
-    log() << "Finished refetching documents. Total size of documents refetched: "
-          << goodVersions.size();
+    log() << "Finished refetching documents. Total size of documents refetched: " << totalSize;
+    return goodVersions;
+}
+
+void rollback_internal::syncFixUp(OperationContext* opCtx,
+                                  const FixUpInfo& fixUpInfo,
+                                  const RollbackSource& rollbackSource,
+                                  ReplicationCoordinator* replCoord,
+                                  ReplicationProcess* replicationProcess) {
+    auto& catalog = CollectionCatalog::get(opCtx);
+
+    // UUID -> doc id -> doc
+    auto goodVersions = refetchDocuments(opCtx, fixUpInfo, rollbackSource);
 
     // We must start taking unstable checkpoints before rolling back oplog entries. Otherwise, a
     // stable checkpoint could include the fixup write (since it is untimestamped) but not the write
@@ -1331,6 +1477,13 @@ void rollback_internal::syncFixUp(OperationContext* opCtx,
                   << removeSaver->file().generic_string();
         }
 
+        // The database lock and client context are held across consecutive documents of the same
+        // namespace, up to kMaxDocsPerLockAcquisition of them, rather than taken for each one.
+        boost::optional<Lock::DBLock> docDbLock;
+        boost::optional<OldClientContext> ctx;
+        StringData ctxNs;
+        size_t docsUnderLock = 0;
+
         const auto& goodVersionsByDocID = nsAndGoodVersionsByDocID.second;
         for (const auto& idAndDoc : goodVersionsByDocID) {
             time_t now = time(nullptr);
@@ -1344,10 +1497,18 @@ void rollback_internal::syncFixUp(OperationContext* opCtx,
             BSONObj pattern = doc._id.wrap();  // { _id : ... }
             try {
 
-                // TODO: Lots of overhead in context. This can be faster.
-                const NamespaceString docNss(doc.ns);
-                Lock::DBLock docDbLock(opCtx, docNss.db(), MODE_X);
-                OldClientContext ctx(opCtx, doc.ns.toString());
+                if (!ctx || doc.ns != ctxNs || docsUnderLock >= kMaxDocsPerLockAcquisition) {
+                    ctx.reset();
+                    docDbLock.reset();
+
+                    const NamespaceString docNss(doc.ns);
+                    docDbLock.emplace(opCtx, docNss.db(), MODE_X);
+                    ctx.emplace(opCtx, doc.ns.toString());
+                    ctxNs = doc.ns;
+                    docsUnderLock = 0;
+                }
+                ++docsUnderLock;
+
                 Collection* collection = catalog.lookupCollectionByUUID(uuid);
 
                 // Adds the doc to our rollback file if the collection was not dropped while
@@ -1459,7 +1620,7 @@ void rollback_internal::syncFixUp(OperationContext* opCtx,
                     request.setGod();
                     request.setUpsert();
 
-                    update(opCtx, ctx.db(), request);
+                    update(opCtx, ctx->db(), request);
                 }
             } catch (const DBException& e) {
                 log() << "Exception in rollback ns:" << nss->ns() << ' ' << pattern.toString()
@@ -212,7 +212,8 @@ Rollback function flowchart:
 
 /**
  * This namespace contains internal details of the rollback system. It is only exposed in a header
- * for unit testing. Nothing here should be used outside of rs_rollback.cpp or its unit test.
+ * for unit testing. Nothing here should be used outside of rs_rollback.cpp or its unit test and
+ * benchmark.
  */
 namespace rollback_internal {
 
@@ -367,6 +368,15 @@ Status updateFixUpInfoFromLocalOplogEntry(OperationContext* opCtx,
                                           const BSONObj& ourObj,
                                           bool isNestedApplyOpsCommand);
 
+/**
+ * Fetches the current version of each document in 'fixUpInfo.docsToRefetch' from the sync source,
+ * keyed by collection UUID. An empty document means that the document no longer exists on the
+ * sync source and must be deleted. The documents of a collection are requested in batches, and
+ * the batches of different collections are fetched concurrently.
+ */
+stdx::unordered_map<UUID, std::map<DocID, BSONObj>, UUID::Hash> refetchDocuments(
+    OperationContext* opCtx, const FixUpInfo& fixUpInfo, const RollbackSource& rollbackSource);
+
 /**
  * This function uses the FixUpInfo struct to undo all of the operations that occurred after the
  * common point on the rolling back node, checking the rollback ID and updating minValid as
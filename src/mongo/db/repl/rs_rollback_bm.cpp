@@ -0,0 +1,187 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kReplicationRollback
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/client.h"
+#include "mongo/db/repl/oplog_interface_mock.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/repl/rollback_source.h"
+#include "mongo/db/repl/rs_rollback.h"
+#include "mongo/db/service_context.h"
+#include "mongo/logger/logger.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+using rollback_internal::DocID;
+using rollback_internal::FixUpInfo;
+
+// The simulated network round trip to the sync source for each query.
+const Microseconds kRoundTrip{200};
+
+/**
+ * A sync source which has a current version of every document, and answers each query after
+ * kRoundTrip has passed.
+ */
+class RollbackSourceWithLatency : public RollbackSource {
+public:
+    const OplogInterface& getOplog() const override {
+        return _oplog;
+    }
+
+    const HostAndPort& getSource() const override {
+        return _source;
+    }
+
+    int getRollbackId() const override {
+        return 0;
+    }
+
+    BSONObj getLastOperation() const override {
+        return BSONObj();
+    }
+
+    BSONObj findOne(const NamespaceString& nss, const BSONObj& filter) const override {
+        return BSONObj();
+    }
+
+    std::pair<BSONObj, NamespaceString> findOneByUUID(const std::string& db,
+                                                      UUID uuid,
+                                                      const BSONObj& filter) const override {
+        sleepFor(kRoundTrip);
+        return {makeDocument(filter.firstElement()), NamespaceString()};
+    }
+
+    std::pair<std::vector<BSONObj>, NamespaceString> findByUUID(
+        const std::string& db,
+        UUID uuid,
+        const std::vector<BSONElement>& ids,
+        AtomicWord<long long>* remainingBytes) const override {
+        sleepFor(kRoundTrip);
+        std::vector<BSONObj> docs;
+        docs.reserve(ids.size());
+        for (auto&& id : ids) {
+            docs.push_back(makeDocument(id));
+        }
+        return {std::move(docs), NamespaceString()};
+    }
+
+    void copyCollectionFromRemote(OperationContext* opCtx,
+                                  const NamespaceString& nss) const override {}
+
+    StatusWith<BSONObj> getCollectionInfoByUUID(const std::string& db,
+                                                const UUID& uuid) const override {
+        return BSONObj();
+    }
+
+    StatusWith<BSONObj> getCollectionInfo(const NamespaceString& nss) const override {
+        return BSONObj();
+    }
+
+private:
+    static BSONObj makeDocument(const BSONElement& id) {
+        BSONObjBuilder builder;
+        builder.appendAs(id, "_id");
+        builder.append("v", 1);
+        return builder.obj();
+    }
+
+    OplogInterfaceMock _oplog;
+    HostAndPort _source;
+};
+
+/**
+ * Refetches state.range(0) documents spread evenly over state.range(1) collections, with the
+ * batch size set to state.range(2) and the concurrency to state.range(3). A batch size and
+ * concurrency of 1 fetch the documents one at a time.
+ */
+void BM_RefetchDocuments(benchmark::State& state) {
+    const int numDocs = state.range(0);
+    const int numCollections = state.range(1);
+
+    const auto originalBatchSize = rollbackRefetchBatchSize.load();
+    const auto originalConcurrency = rollbackRefetchMaxConcurrency.load();
+    rollbackRefetchBatchSize.store(state.range(2));
+    rollbackRefetchMaxConcurrency.store(state.range(3));
+
+    const auto originalSeverity =
+        logger::globalLogDomain()->getMinimumLogSeverity(logger::LogComponent::kReplication);
+    logger::globalLogDomain()->setMinimumLoggedSeverity(logger::LogComponent::kReplication,
+                                                        logger::LogSeverity::Warning());
+
+    std::vector<UUID> uuids;
+    for (int i = 0; i < numCollections; ++i) {
+        uuids.push_back(UUID::gen());
+    }
+
+    FixUpInfo fixUpInfo;
+    for (int i = 0; i < numDocs; ++i) {
+        auto obj = BSON("ns"
+                        << "test.coll"
+                        << "o" << BSON("_id" << i));
+        fixUpInfo.docsToRefetch.insert(
+            DocID(obj, obj["o"].Obj()["_id"], uuids[i % numCollections]));
+    }
+
+    auto client = getGlobalServiceContext()->makeClient("BM_RefetchDocuments");
+    auto opCtx = client->makeOperationContext();
+    RollbackSourceWithLatency rollbackSource;
+
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(
+            rollback_internal::refetchDocuments(opCtx.get(), fixUpInfo, rollbackSource));
+    }
+    state.SetItemsProcessed(state.iterations() * numDocs);
+
+    logger::globalLogDomain()->setMinimumLoggedSeverity(logger::LogComponent::kReplication,
+                                                        originalSeverity);
+    rollbackRefetchBatchSize.store(originalBatchSize);
+    rollbackRefetchMaxConcurrency.store(originalConcurrency);
+}
+
+BENCHMARK(BM_RefetchDocuments)
+    ->Args({1000, 1, 1, 1})
+    ->Args({1000, 1, 1000, 1})
+    ->Args({1000, 8, 1, 1})
+    ->Args({1000, 8, 1000, 4})
+    ->Args({10000, 8, 1000, 1})
+    ->Args({10000, 8, 1000, 4})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
@@ -52,6 +52,7 @@
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/oplog_interface.h"
 #include "mongo/db/repl/oplog_interface_mock.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
 #include "mongo/db/repl/rollback_source.h"
 #include "mongo/db/repl/rollback_test_fixture.h"
 #include "mongo/db/repl/rs_rollback.h"
@@ -60,6 +61,7 @@
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/net/hostandport.h"
+#include "mongo/util/scopeguard.h"
 
 namespace {
 
@@ -1622,6 +1624,148 @@ TEST_F(RSRollbackTest, RollbackApplyOpsCommand) {
         << result;
 }
 
+TEST_F(RSRollbackTest, RollbackRefetchesDocumentsInBatchesPerCollection) {
+    const auto originalBatchSize = rollbackRefetchBatchSize.load();
+    ON_BLOCK_EXIT([&] { rollbackRefetchBatchSize.store(originalBatchSize); });
+    rollbackRefetchBatchSize.store(2);
+
+    createOplog(_opCtx.get());
+    CollectionOptions options;
+    options.uuid = UUID::gen();
+    auto collT = _createCollection(_opCtx.get(), "test.t", options);
+    options.uuid = UUID::gen();
+    auto collU = _createCollection(_opCtx.get(), "test.u", options);
+    const auto uuidT = collT->uuid();
+    const auto uuidU = collU->uuid();
+
+    // Deletes of _ids 1 to 5 on test.t and 1 to 2 on test.u, newest first.
+    auto commonOperation = makeOpAndRecordId(1);
+    OplogInterfaceMock::Operations localOperations;
+    auto addDelete = [&](UUID uuid, StringData ns, int id) {
+        const int time = 2 + localOperations.size();
+        localOperations.push_front(std::make_pair(BSON("ts" << Timestamp(Seconds(time), 0) << "op"
+                                                            << "d"
+                                                            << "ui" << uuid << "ns" << ns << "o"
+                                                            << BSON("_id" << id)),
+                                                  RecordId(time)));
+    };
+    for (int id = 1; id <= 5; ++id) {
+        addDelete(uuidT, "test.t", id);
+    }
+    for (int id = 1; id <= 2; ++id) {
+        addDelete(uuidU, "test.u", id);
+    }
+    localOperations.push_back(commonOperation);
+
+    class RollbackSourceLocal : public RollbackSourceMock {
+    public:
+        RollbackSourceLocal(std::unique_ptr<OplogInterface> oplog)
+            : RollbackSourceMock(std::move(oplog)) {}
+
+        std::pair<std::vector<BSONObj>, NamespaceString> findByUUID(
+            const std::string& db,
+            UUID uuid,
+            const std::vector<BSONElement>& ids,
+            AtomicWord<long long>* remainingBytes) const override {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            batchSizes[uuid].insert(ids.size());
+
+            // The document with _id 5 no longer exists on the sync source.
+            std::vector<BSONObj> docs;
+            for (auto&& id : ids) {
+                if (id.numberInt() != 5) {
+                    docs.push_back(BSON("_id" << id.numberInt() << "v" << 1));
+                }
+            }
+            return {std::move(docs), NamespaceString()};
+        }
+
+        mutable stdx::unordered_map<UUID, std::multiset<size_t>, UUID::Hash> batchSizes;
+
+    private:
+        mutable stdx::mutex _mutex;
+    } rollbackSource(std::unique_ptr<OplogInterface>(new OplogInterfaceMock({commonOperation})));
+
+    ASSERT_OK(syncRollback(_opCtx.get(),
+                           OplogInterfaceMock(localOperations),
+                           rollbackSource,
+                           {},
+                           _coordinator,
+                           _replicationProcess.get()));
+    ASSERT(rollbackSource.batchSizes[uuidT] == std::multiset<size_t>({1, 2, 2}));
+    ASSERT(rollbackSource.batchSizes[uuidU] == std::multiset<size_t>({2}));
+
+    AutoGetCollectionForReadCommand acr(_opCtx.get(), NamespaceString("test.t"));
+    BSONObj result;
+    for (int id = 1; id <= 4; ++id) {
+        ASSERT(Helpers::findOne(_opCtx.get(), acr.getCollection(), BSON("_id" << id), result));
+        ASSERT_EQUALS(1, result["v"].numberInt()) << result;
+    }
+    ASSERT_FALSE(Helpers::findOne(_opCtx.get(), acr.getCollection(), BSON("_id" << 5), result))
+        << result;
+}
+
+TEST_F(RSRollbackTest, RollbackStopsRefetchingOnceTooMuchDataIsFetched) {
+    const auto originalBatchSize = rollbackRefetchBatchSize.load();
+    const auto originalConcurrency = rollbackRefetchMaxConcurrency.load();
+    ON_BLOCK_EXIT([&] {
+        rollbackRefetchBatchSize.store(originalBatchSize);
+        rollbackRefetchMaxConcurrency.store(originalConcurrency);
+    });
+    rollbackRefetchBatchSize.store(1);
+    rollbackRefetchMaxConcurrency.store(1);
+
+    createOplog(_opCtx.get());
+    CollectionOptions options;
+    options.uuid = UUID::gen();
+    auto coll = _createCollection(_opCtx.get(), "test.t", options);
+
+    // Deletes of _ids 1 to 5, newest first.
+    auto commonOperation = makeOpAndRecordId(1);
+    OplogInterfaceMock::Operations localOperations;
+    for (int id = 1; id <= 5; ++id) {
+        const int time = 1 + id;
+        localOperations.push_front(std::make_pair(BSON("ts" << Timestamp(Seconds(time), 0) << "op"
+                                                            << "d"
+                                                            << "ui" << coll->uuid() << "ns"
+                                                            << "test.t"
+                                                            << "o" << BSON("_id" << id)),
+                                                  RecordId(time)));
+    }
+    localOperations.push_back(commonOperation);
+
+    // Each document the sync source returns is accounted as 100MB, so the third one exhausts the
+    // 300MB allowed for a rollback.
+    class RollbackSourceLocal : public RollbackSourceMock {
+    public:
+        RollbackSourceLocal(std::unique_ptr<OplogInterface> oplog)
+            : RollbackSourceMock(std::move(oplog)) {}
+
+        std::pair<std::vector<BSONObj>, NamespaceString> findByUUID(
+            const std::string& db,
+            UUID uuid,
+            const std::vector<BSONElement>& ids,
+            AtomicWord<long long>* remainingBytes) const override {
+            numCalls.fetchAndAdd(1);
+            uassert(ErrorCodes::ExceededMemoryLimit,
+                    "replSet too much data to roll back",
+                    remainingBytes->subtractAndFetch(100 * 1024 * 1024) > 0);
+            return {{BSON("_id" << ids.front().numberInt())}, NamespaceString()};
+        }
+
+        mutable AtomicWord<int> numCalls{0};
+    } rollbackSource(std::unique_ptr<OplogInterface>(new OplogInterfaceMock({commonOperation})));
+
+    auto status = syncRollback(_opCtx.get(),
+                               OplogInterfaceMock(localOperations),
+                               rollbackSource,
+                               {},
+                               _coordinator,
+                               _replicationProcess.get());
+    ASSERT_EQUALS(ErrorCodes::UnrecoverableRollbackError, status.code());
+    ASSERT_EQUALS(3, rollbackSource.numCalls.load());
+}
+
 TEST_F(RSRollbackTest, RollbackCreateCollectionCommand) {
     createOplog(_opCtx.get());
     CollectionOptions options;
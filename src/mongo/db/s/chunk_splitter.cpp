@@ -40,6 +40,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/s/chunk_split_state_driver.h"
 #include "mongo/db/s/shard_filtering_metadata_refresh.h"
+#include "mongo/db/s/sharding_runtime_d_params_gen.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/s/split_chunk.h"
 #include "mongo/db/s/split_vector.h"
@@ -271,20 +272,36 @@ void ChunkSplitter::trySplitting(std::shared_ptr<ChunkSplitStateDriver> chunkSpl
     if (!_isPrimary) {
         return;
     }
-    _threadPool.schedule(
-        [ this, csd = std::move(chunkSplitStateDriver), nss, min, max,
-          dataWritten ](auto status) noexcept {
-            invariant(status);
 
-            _runAutosplit(csd, nss, min, max, dataWritten);
-        });
+    {
+        stdx::lock_guard<stdx::mutex> lg(_mutex);
+        auto& pendingSplits = _pendingSplits[nss];
+        pendingSplits.push_back(
+            {std::move(chunkSplitStateDriver), min.getOwned(), max.getOwned(), dataWritten});
+
+        // The task which is already scheduled for this collection picks up the new chunk
+        if (pendingSplits.size() > 1) {
+            return;
+        }
+    }
+
+    _threadPool.schedule([ this, nss ](auto status) noexcept {
+        invariant(status);
+
+        _runAutosplit(nss);
+    });
 }
 
-void ChunkSplitter::_runAutosplit(std::shared_ptr<ChunkSplitStateDriver> chunkSplitStateDriver,
-                                  const NamespaceString& nss,
-                                  const BSONObj& min,
-                                  const BSONObj& max,
-                                  long dataWritten) {
+void ChunkSplitter::_runAutosplit(const NamespaceString& nss) {
+    std::vector<PendingSplit> pendingSplits;
+    {
+        stdx::lock_guard<stdx::mutex> lg(_mutex);
+        auto it = _pendingSplits.find(nss);
+        invariant(it != _pendingSplits.end());
+        pendingSplits = std::move(it->second);
+        _pendingSplits.erase(it);
+    }
+
     if (!_isPrimary) {
         return;
     }
@@ -299,7 +316,6 @@ void ChunkSplitter::_runAutosplit(std::shared_ptr<ChunkSplitStateDriver> chunkSp
                 "Could not split chunk. Collection is no longer sharded",
                 cm);
 
-        const auto chunk = cm->findIntersectingChunkWithSimpleCollation(min);
         const auto& shardKeyPattern = cm->getShardKeyPattern();
 
         const auto balancerConfig = Grid::get(opCtx.get())->getBalancerConfiguration();
@@ -312,107 +328,142 @@ void ChunkSplitter::_runAutosplit(std::shared_ptr<ChunkSplitStateDriver> chunkSp
 
         const uint64_t maxChunkSizeBytes = balancerConfig->getMaxChunkSizeBytes();
 
-        LOG(1) << "about to initiate autosplit: " << redact(chunk.toString())
-               << " dataWritten since last check: " << dataWritten
-               << " maxChunkSizeBytes: " << maxChunkSizeBytes;
-
-        chunkSplitStateDriver->prepareSplit();
-        auto splitPoints = uassertStatusOK(splitVector(opCtx.get(),
-                                                       nss,
-                                                       shardKeyPattern.toBSON(),
-                                                       chunk.getMin(),
-                                                       chunk.getMax(),
-                                                       false,
-                                                       boost::none,
-                                                       boost::none,
-                                                       boost::none,
-                                                       maxChunkSizeBytes));
-
-        if (splitPoints.size() <= 1) {
-            LOG(1)
-                << "ChunkSplitter attempted split but not enough split points were found for chunk "
-                << redact(chunk.toString());
-            // Reset our size estimate that we had prior to splitVector to 0, while still counting
-            // the bytes that have been written in parallel to this split task
-            chunkSplitStateDriver->abandonPrepare();
-            // No split points means there isn't enough data to split on; 1 split point means we
-            // have between half the chunk size to full chunk size so there is no need to split yet
-            return;
+        std::vector<Chunk> chunks;
+        std::vector<ChunkRange> ranges;
+        for (const auto& pendingSplit : pendingSplits) {
+            chunks.push_back(cm->findIntersectingChunkWithSimpleCollation(pendingSplit.min));
+            ranges.emplace_back(chunks.back().getMin(), chunks.back().getMax());
+
+            LOG(1) << "about to initiate autosplit: " << redact(chunks.back().toString())
+                   << " dataWritten since last check: " << pendingSplit.dataWritten
+                   << " maxChunkSizeBytes: " << maxChunkSizeBytes;
+
+            pendingSplit.chunkSplitStateDriver->prepareSplit();
         }
 
-        // We assume that if the chunk being split is the first (or last) one on the collection,
-        // this chunk is likely to see more insertions. Instead of splitting mid-chunk, we use the
-        // very first (or last) key as a split point.
-        //
-        // This heuristic is skipped for "special" shard key patterns that are not likely to produce
-        // monotonically increasing or decreasing values (e.g. hashed shard keys).
-
-        // Keeps track of the minKey of the top chunk after the split so we can migrate the chunk.
-        BSONObj topChunkMinKey;
-        const auto skpGlobalMin = shardKeyPattern.getKeyPattern().globalMin();
-        const auto skpGlobalMax = shardKeyPattern.getKeyPattern().globalMax();
-        if (KeyPattern::isOrderedKeyPattern(shardKeyPattern.toBSON())) {
-            if (skpGlobalMin.woCompare(min) == 0) {
-                // MinKey is infinity (This is the first chunk on the collection)
-                BSONObj key = findExtremeKeyForShard(opCtx.get(), nss, shardKeyPattern, true);
-                if (!key.isEmpty()) {
-                    splitPoints.front() = key.getOwned();
-                    topChunkMinKey = skpGlobalMin;
-                }
-            } else if (skpGlobalMax.woCompare(max) == 0) {
-                // MaxKey is infinity (This is the last chunk on the collection)
-                BSONObj key = findExtremeKeyForShard(opCtx.get(), nss, shardKeyPattern, false);
-                if (!key.isEmpty()) {
-                    splitPoints.back() = key.getOwned();
-                    topChunkMinKey = key.getOwned();
-                }
+        auto splitPointsByChunk = splitVectorFromSample(opCtx.get(),
+                                                        nss,
+                                                        shardKeyPattern.toBSON(),
+                                                        ranges,
+                                                        maxChunkSizeBytes,
+                                                        autoSplitMaxSampledDocs.load());
+
+        for (size_t i = 0; i < pendingSplits.size(); ++i) {
+            try {
+                _splitChunk(opCtx.get(),
+                            nss,
+                            *cm,
+                            chunks[i],
+                            pendingSplits[i],
+                            uassertStatusOK(std::move(splitPointsByChunk[i])),
+                            maxChunkSizeBytes);
+            } catch (const DBException& ex) {
+                log() << "Unable to auto-split chunk "
+                      << redact(ChunkRange(pendingSplits[i].min, pendingSplits[i].max).toString())
+                      << " in namespace " << nss << causedBy(redact(ex.toStatus()));
             }
         }
-
-        uassertStatusOK(splitChunkAtMultiplePoints(opCtx.get(),
-                                                   chunk.getShardId(),
-                                                   nss,
-                                                   shardKeyPattern,
-                                                   cm->getVersion(),
-                                                   ChunkRange(min, max),
-                                                   splitPoints));
-        chunkSplitStateDriver->commitSplit();
-
-        const bool shouldBalance = isAutoBalanceEnabled(opCtx.get(), nss, balancerConfig);
-
-        log() << "autosplitted " << nss << " chunk: " << redact(chunk.toString()) << " into "
-              << (splitPoints.size() + 1) << " parts (maxChunkSizeBytes " << maxChunkSizeBytes
-              << ")"
-              << (topChunkMinKey.isEmpty() ? ""
-                                           : " (top chunk migration suggested" +
-                          (std::string)(shouldBalance ? ")" : ", but no migrations allowed)"));
-
-        // Because the ShardServerOpObserver uses the metadata from the CSS for tracking incoming
-        // writes, if we split a chunk but do not force a CSS refresh, subsequent inserts will see
-        // stale metadata and so will not trigger a chunk split. If we force metadata refresh here,
-        // we can limit the amount of time that the op observer is tracking writes on the parent
-        // chunk rather than on its child chunks.
-        forceShardFilteringMetadataRefresh(opCtx.get(), nss, false);
-
-        // Balance the resulting chunks if the autobalance option is enabled and if we split at the
-        // first or last chunk on the collection as part of top chunk optimization.
-        if (!shouldBalance || topChunkMinKey.isEmpty()) {
-            return;
+    } catch (const DBException& ex) {
+        for (const auto& pendingSplit : pendingSplits) {
+            log() << "Unable to auto-split chunk "
+                  << redact(ChunkRange(pendingSplit.min, pendingSplit.max).toString())
+                  << " in namespace " << nss << causedBy(redact(ex.toStatus()));
         }
+    }
+}
 
-        try {
-            // Tries to move the top chunk out of the shard to prevent the hot
-            // spot from staying on a single shard. This is based on the
-            // assumption that succeeding inserts will fall on the top chunk.
-            moveChunk(opCtx.get(), nss, topChunkMinKey);
-        } catch (const DBException& ex) {
-            log() << "Top-chunk optimization failed to move chunk "
-                  << redact(ChunkRange(min, max).toString()) << " in collection " << nss
-                  << " after a successful split" << causedBy(redact(ex.toStatus()));
+void ChunkSplitter::_splitChunk(OperationContext* opCtx,
+                                const NamespaceString& nss,
+                                const ChunkManager& cm,
+                                const Chunk& chunk,
+                                const PendingSplit& pendingSplit,
+                                std::vector<BSONObj> splitPoints,
+                                uint64_t maxChunkSizeBytes) {
+    const auto& chunkSplitStateDriver = pendingSplit.chunkSplitStateDriver;
+    const auto& min = pendingSplit.min;
+    const auto& max = pendingSplit.max;
+    const auto& shardKeyPattern = cm.getShardKeyPattern();
+
+    if (splitPoints.size() <= 1) {
+        LOG(1) << "ChunkSplitter attempted split but not enough split points were found for chunk "
+               << redact(chunk.toString());
+        // Reset our size estimate that we had prior to splitVector to 0, while still counting
+        // the bytes that have been written in parallel to this split task
+        chunkSplitStateDriver->abandonPrepare();
+        // No split points means there isn't enough data to split on; 1 split point means we
+        // have between half the chunk size to full chunk size so there is no need to split yet
+        return;
+    }
+
+    // We assume that if the chunk being split is the first (or last) one on the collection,
+    // this chunk is likely to see more insertions. Instead of splitting mid-chunk, we use the
+    // very first (or last) key as a split point.
+    //
+    // This heuristic is skipped for "special" shard key patterns that are not likely to produce
+    // monotonically increasing or decreasing values (e.g. hashed shard keys).
+
+    // Keeps track of the minKey of the top chunk after the split so we can migrate the chunk.
+    BSONObj topChunkMinKey;
+    const auto skpGlobalMin = shardKeyPattern.getKeyPattern().globalMin();
+    const auto skpGlobalMax = shardKeyPattern.getKeyPattern().globalMax();
+    if (KeyPattern::isOrderedKeyPattern(shardKeyPattern.toBSON())) {
+        if (skpGlobalMin.woCompare(min) == 0) {
+            // MinKey is infinity (This is the first chunk on the collection)
+            BSONObj key = findExtremeKeyForShard(opCtx, nss, shardKeyPattern, true);
+            if (!key.isEmpty()) {
+                splitPoints.front() = key.getOwned();
+                topChunkMinKey = skpGlobalMin;
+            }
+        } else if (skpGlobalMax.woCompare(max) == 0) {
+            // MaxKey is infinity (This is the last chunk on the collection)
+            BSONObj key = findExtremeKeyForShard(opCtx, nss, shardKeyPattern, false);
+            if (!key.isEmpty()) {
+                splitPoints.back() = key.getOwned();
+                topChunkMinKey = key.getOwned();
+            }
         }
+    }
+
+    uassertStatusOK(splitChunkAtMultiplePoints(opCtx,
+                                               chunk.getShardId(),
+                                               nss,
+                                               shardKeyPattern,
+                                               cm.getVersion(),
+                                               ChunkRange(min, max),
+                                               splitPoints));
+    chunkSplitStateDriver->commitSplit();
+
+    const auto balancerConfig = Grid::get(opCtx)->getBalancerConfiguration();
+    const bool shouldBalance = isAutoBalanceEnabled(opCtx, nss, balancerConfig);
+
+    log() << "autosplitted " << nss << " chunk: " << redact(chunk.toString()) << " into "
+          << (splitPoints.size() + 1) << " parts (maxChunkSizeBytes " << maxChunkSizeBytes << ")"
+          << (topChunkMinKey.isEmpty() ? ""
+                                       : " (top chunk migration suggested" +
+                      (std::string)(shouldBalance ? ")" : ", but no migrations allowed)"));
+
+    // Because the ShardServerOpObserver uses the metadata from the CSS for tracking incoming
+    // writes, if we split a chunk but do not force a CSS refresh, subsequent inserts will see
+    // stale metadata and so will not trigger a chunk split. If we force metadata refresh here,
+    // we can limit the amount of time that the op observer is tracking writes on the parent
+    // chunk rather than on its child chunks.
+    forceShardFilteringMetadataRefresh(opCtx, nss, false);
+
+    // Balance the resulting chunks if the autobalance option is enabled and if we split at the
+    // first or last chunk on the collection as part of top chunk optimization.
+    if (!shouldBalance || topChunkMinKey.isEmpty()) {
+        return;
+    }
+
+    try {
+        // Tries to move the top chunk out of the shard to prevent the hot
+        // spot from staying on a single shard. This is based on the
+        // assumption that succeeding inserts will fall on the top chunk.
+        moveChunk(opCtx, nss, topChunkMinKey);
     } catch (const DBException& ex) {
-        log() << "Unable to auto-split chunk " << redact(ChunkRange(min, max).toString())
-              << " in namespace " << nss << causedBy(redact(ex.toStatus()));
+        log() << "Top-chunk optimization failed to move chunk "
+              << redact(ChunkRange(min, max).toString()) << " in collection " << nss
+              << " after a successful split" << causedBy(redact(ex.toStatus()));
     }
 }
 
@@ -29,12 +29,18 @@
 
 #pragma once
 
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/periodic_runner.h"
 
 namespace mongo {
 
-class NamespaceString;
+class Chunk;
+class ChunkManager;
 class OperationContext;
 class ServiceContext;
 class ChunkSplitStateDriver;
@@ -83,7 +89,9 @@ public:
     void waitForIdle();
 
     /**
-     * Schedules an autosplit task. This function throws on scheduling failure.
+     * Schedules an autosplit task. If a task for the same collection is still waiting for a
+     * thread, the chunk is split by that task instead, which shares a single sample of the
+     * collection between all the chunks it splits. This function throws on scheduling failure.
      */
     void trySplitting(std::shared_ptr<ChunkSplitStateDriver> chunkSplitStateDriver,
                       const NamespaceString& nss,
@@ -93,18 +101,36 @@ public:
 
 private:
     /**
-     * Determines if the specified chunk should be split and then performs any necessary splits.
+     * A chunk which is waiting for an autosplit task to split it.
+     */
+    struct PendingSplit {
+        std::shared_ptr<ChunkSplitStateDriver> chunkSplitStateDriver;
+        BSONObj min;
+        BSONObj max;
+        long dataWritten;
+    };
+
+    /**
+     * Determines the split points of all the chunks of 'nss' which are pending a split and then
+     * performs any necessary splits.
+     */
+    void _runAutosplit(const NamespaceString& nss);
+
+    /**
+     * Splits the specified chunk at 'splitPoints', if there are enough of them.
      *
      * It may also perform a 'top chunk' optimization where a resulting chunk that contains either
      * MaxKey or MinKey as a range extreme will be moved off to another shard to relieve load on the
      * original owner. This optimization presumes that the user is doing writes with increasing or
      * decreasing shard key values.
      */
-    void _runAutosplit(std::shared_ptr<ChunkSplitStateDriver> chunkSplitStateDriver,
-                       const NamespaceString& nss,
-                       const BSONObj& min,
-                       const BSONObj& max,
-                       long dataWritten);
+    void _splitChunk(OperationContext* opCtx,
+                     const NamespaceString& nss,
+                     const ChunkManager& cm,
+                     const Chunk& chunk,
+                     const PendingSplit& pendingSplit,
+                     std::vector<BSONObj> splitPoints,
+                     uint64_t maxChunkSizeBytes);
 
     // Protects the state below.
     stdx::mutex _mutex;
@@ -112,6 +138,9 @@ private:
     // The ChunkSplitter is only active on a primary node.
     bool _isPrimary{false};
 
+    // The chunks waiting to be split by a scheduled autosplit task, by collection
+    stdx::unordered_map<NamespaceString, std::vector<PendingSplit>> _pendingSplits;
+
     // Thread pool for parallelizing splits.
     ThreadPool _threadPool;
 };
@@ -102,6 +102,26 @@ RangeMap CollectionMetadata::getChunks() const {
     return chunksMap;
 }
 
+bool CollectionMetadata::keyBelongsToMe(const BSONObj& key,
+                                        boost::optional<Chunk>* lastChunk) const {
+    invariant(isSharded());
+
+    if (key.isEmpty()) {
+        return false;
+    }
+
+    if (!*lastChunk || !(*lastChunk)->containsKey(key)) {
+        // The global max key is not contained in any chunk
+        if (key.woCompare(getMaxKey()) >= 0) {
+            return false;
+        }
+
+        lastChunk->emplace(_cm->findIntersectingChunkWithSimpleCollation(key));
+    }
+
+    return (*lastChunk)->getShardId() == _thisShardId;
+}
+
 bool CollectionMetadata::getNextChunk(const BSONObj& lookupKey, ChunkType* chunk) const {
     invariant(isSharded());
 
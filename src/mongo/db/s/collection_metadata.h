@@ -158,6 +158,23 @@ public:
         return _cm->keyBelongsToShard(key, _thisShardId);
     }
 
+    /**
+     * Same as above, but only looks the key up in the routing table if it does not fall within
+     * 'lastChunk', which is then set to the chunk containing the key. Callers which pass the same
+     * 'lastChunk' for keys that mostly arrive in shard key order, such as the shard keys of the
+     * documents returned by an index scan, look up each chunk only once. 'lastChunk' must not be
+     * used after this metadata object is destroyed.
+     */
+    bool keyBelongsToMe(const BSONObj& key, boost::optional<Chunk>* lastChunk) const;
+
+    /**
+     * Returns true if every key between 'min' and 'max', both inclusive, belongs to this chunkset.
+     */
+    bool rangeIsOwnedByMe(const BSONObj& min, const BSONObj& max) const {
+        invariant(isSharded());
+        return _cm->rangeIsOwnedByShard(min, max, _thisShardId);
+    }
+
     /**
      * Given a key 'lookupKey' in the shard key range, get the next chunk which overlaps or is
      * greater than this key.  Returns true if a chunk exists, false otherwise.
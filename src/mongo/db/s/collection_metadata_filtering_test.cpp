@@ -30,6 +30,9 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/catalog_raii.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/query/stage_builder.h"
 #include "mongo/db/s/collection_sharding_runtime.h"
 #include "mongo/db/s/operation_sharding_state.h"
 #include "mongo/s/catalog/type_chunk.h"
@@ -216,5 +219,173 @@ TEST_F(CollectionMetadataFilteringTest, FilterDocumentsTooFarInThePastThrowsStal
     }
 }
 
+/**
+ * Metadata which shard "0" reads for a collection sharded on 'shardKey', where shard "0" owns the
+ * chunks [MinKey, 0) and [100, MaxKey) of the first shard key field and shard "1" owns [0, 100).
+ */
+class ConstantMetadata : public ScopedCollectionMetadata::Impl {
+public:
+    ConstantMetadata(const BSONObj& shardKey) {
+        const OID epoch = OID::gen();
+        const KeyPattern keyPattern(shardKey);
+
+        const auto makeBound = [&](int firstFieldValue) {
+            BSONObjBuilder builder;
+            builder.append(shardKey.firstElementFieldName(), firstFieldValue);
+            for (const auto& field : shardKey.removeField(shardKey.firstElementFieldName())) {
+                builder.appendMinKey(field.fieldName());
+            }
+            return builder.obj();
+        };
+
+        ChunkVersion version(1, 0, epoch);
+        std::vector<ChunkType> chunks;
+        chunks.emplace_back(
+            kNss, ChunkRange{keyPattern.globalMin(), makeBound(0)}, version, ShardId("0"));
+        version.incMinor();
+        chunks.emplace_back(kNss, ChunkRange{makeBound(0), makeBound(100)}, version, ShardId("1"));
+        version.incMinor();
+        chunks.emplace_back(
+            kNss, ChunkRange{makeBound(100), keyPattern.globalMax()}, version, ShardId("0"));
+
+        auto rt = RoutingTableHistory::makeNew(
+            kNss, UUID::gen(), shardKey, nullptr, false, epoch, std::move(chunks));
+        _metadata = CollectionMetadata(std::make_shared<ChunkManager>(rt, boost::none), {"0"});
+    }
+
+    const CollectionMetadata& get() override {
+        return _metadata;
+    }
+
+private:
+    CollectionMetadata _metadata;
+};
+
+ScopedCollectionMetadata makeMetadata(const BSONObj& shardKey) {
+    return ScopedCollectionMetadata(std::make_shared<ConstantMetadata>(shardKey));
+}
+
+/**
+ * Makes a scan over the index 'keyPattern' whose bounds on its first field are 'intervals', each
+ * of which is given as the object {"": start, "": end}.
+ */
+std::unique_ptr<IndexScanNode> makeIndexScan(const BSONObj& keyPattern,
+                                             const std::vector<BSONObj>& intervals) {
+    auto ixscan = std::make_unique<IndexScanNode>(IndexEntry(keyPattern,
+                                                             INDEX_BTREE,
+                                                             false,
+                                                             {},
+                                                             {},
+                                                             false,
+                                                             false,
+                                                             CoreIndexInfo::Identifier("index"),
+                                                             nullptr,
+                                                             {},
+                                                             nullptr,
+                                                             nullptr));
+    for (const auto& field : keyPattern) {
+        ixscan->bounds.fields.emplace_back(field.fieldName());
+    }
+    for (const auto& interval : intervals) {
+        ixscan->bounds.fields[0].intervals.emplace_back(interval, true, true);
+    }
+    return ixscan;
+}
+
+TEST(ReturnsOnlyOwnedDocumentsTest, ScanOverOwnedRangesSkipsFiltering) {
+    const auto metadata = makeMetadata(BSON("x" << 1));
+
+    auto ixscan = makeIndexScan(BSON("x" << 1), {BSON("" << -50 << "" << -10)});
+    ASSERT_TRUE(StageBuilder::returnsOnlyOwnedDocuments(ixscan.get(), metadata));
+
+    ixscan = makeIndexScan(BSON("x" << 1 << "y" << 1),
+                           {BSON("" << -50 << "" << -10), BSON("" << 150 << "" << 200)});
+    ASSERT_TRUE(StageBuilder::returnsOnlyOwnedDocuments(ixscan.get(), metadata));
+
+    FetchNode fetch;
+    fetch.children.push_back(
+        makeIndexScan(BSON("x" << 1), {BSON("" << -50 << "" << -10)}).release());
+    ASSERT_TRUE(StageBuilder::returnsOnlyOwnedDocuments(&fetch, metadata));
+}
+
+TEST(ReturnsOnlyOwnedDocumentsTest, DescendingScanOverOwnedRangeSkipsFiltering) {
+    const auto metadata = makeMetadata(BSON("x" << 1));
+
+    auto ixscan = makeIndexScan(BSON("x" << -1), {BSON("" << -10 << "" << -50)});
+    ASSERT_TRUE(StageBuilder::returnsOnlyOwnedDocuments(ixscan.get(), metadata));
+
+    ixscan = makeIndexScan(BSON("x" << -1), {BSON("" << 50 << "" << -50)});
+    ASSERT_FALSE(StageBuilder::returnsOnlyOwnedDocuments(ixscan.get(), metadata));
+}
+
+TEST(ReturnsOnlyOwnedDocumentsTest, ScanReachingUnownedChunkIsFiltered) {
+    const auto metadata = makeMetadata(BSON("x" << 1));
+
+    auto ixscan = makeIndexScan(BSON("x" << 1), {BSON("" << -50 << "" << 50)});
+    ASSERT_FALSE(StageBuilder::returnsOnlyOwnedDocuments(ixscan.get(), metadata));
+
+    // The upper bound of the owned chunk [MinKey, 0) belongs to the next chunk
+    ixscan = makeIndexScan(BSON("x" << 1), {BSON("" << -50 << "" << 0)});
+    ASSERT_FALSE(StageBuilder::returnsOnlyOwnedDocuments(ixscan.get(), metadata));
+
+    ixscan = makeIndexScan(BSON("x" << 1),
+                           {BSON("" << -50 << "" << -10), BSON("" << 50 << "" << 60)});
+    ASSERT_FALSE(StageBuilder::returnsOnlyOwnedDocuments(ixscan.get(), metadata));
+}
+
+TEST(ReturnsOnlyOwnedDocumentsTest, ScanOverNullOrMinKeyOrMaxKeyIsFiltered) {
+    const auto metadata = makeMetadata(BSON("x" << 1));
+
+    // Documents which are missing the shard key are indexed as null
+    auto ixscan = makeIndexScan(BSON("x" << 1), {BSON("" << BSONNULL << "" << BSONNULL)});
+    ASSERT_FALSE(StageBuilder::returnsOnlyOwnedDocuments(ixscan.get(), metadata));
+
+    ixscan = makeIndexScan(BSON("x" << 1), {BSON("" << MINKEY << "" << -10)});
+    ASSERT_FALSE(StageBuilder::returnsOnlyOwnedDocuments(ixscan.get(), metadata));
+
+    ixscan = makeIndexScan(BSON("x" << 1), {BSON("" << 150 << "" << MAXKEY)});
+    ASSERT_FALSE(StageBuilder::returnsOnlyOwnedDocuments(ixscan.get(), metadata));
+}
+
+TEST(ReturnsOnlyOwnedDocumentsTest, MultikeyOrCollatedOrSimpleRangeScanIsFiltered) {
+    const auto metadata = makeMetadata(BSON("x" << 1));
+
+    auto ixscan = makeIndexScan(BSON("x" << 1), {BSON("" << -50 << "" << -10)});
+    ixscan->index.multikey = true;
+    ASSERT_FALSE(StageBuilder::returnsOnlyOwnedDocuments(ixscan.get(), metadata));
+
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kReverseString);
+    ixscan = makeIndexScan(BSON("x" << 1), {BSON("" << -50 << "" << -10)});
+    ixscan->index.collator = &collator;
+    ASSERT_FALSE(StageBuilder::returnsOnlyOwnedDocuments(ixscan.get(), metadata));
+
+    ixscan = makeIndexScan(BSON("x" << 1), {});
+    ixscan->bounds.isSimpleRange = true;
+    ixscan->bounds.startKey = BSON("" << -50);
+    ixscan->bounds.endKey = BSON("" << -10);
+    ASSERT_FALSE(StageBuilder::returnsOnlyOwnedDocuments(ixscan.get(), metadata));
+}
+
+TEST(ReturnsOnlyOwnedDocumentsTest, ScanOverOtherIndexOrCollectionIsFiltered) {
+    const auto metadata = makeMetadata(BSON("x" << 1));
+
+    auto ixscan = makeIndexScan(BSON("y" << 1), {BSON("" << -50 << "" << -10)});
+    ASSERT_FALSE(StageBuilder::returnsOnlyOwnedDocuments(ixscan.get(), metadata));
+
+    CollectionScanNode collscan;
+    ASSERT_FALSE(StageBuilder::returnsOnlyOwnedDocuments(&collscan, metadata));
+}
+
+TEST(ReturnsOnlyOwnedDocumentsTest, ScanOverCompoundShardKeyIsFiltered) {
+    // A document which is missing 'y' is indexed by its value of 'x', but has no shard key
+    const auto metadata = makeMetadata(BSON("x" << 1 << "y" << 1));
+
+    auto ixscan = makeIndexScan(BSON("x" << 1), {BSON("" << -50 << "" << -10)});
+    ASSERT_FALSE(StageBuilder::returnsOnlyOwnedDocuments(ixscan.get(), metadata));
+
+    ixscan = makeIndexScan(BSON("x" << 1 << "y" << 1), {BSON("" << -50 << "" << -10)});
+    ASSERT_FALSE(StageBuilder::returnsOnlyOwnedDocuments(ixscan.get(), metadata));
+}
+
 }  // namespace
 }  // namespace mongo
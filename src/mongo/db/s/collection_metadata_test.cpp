@@ -347,6 +347,36 @@ TEST_F(ThreeChunkWithRangeGapFixture, KeyBelongsToMe) {
     ASSERT(!makeCollectionMetadata()->keyBelongsToMe(BSONObj()));
 }
 
+TEST_F(ThreeChunkWithRangeGapFixture, KeyBelongsToMeWithLastChunk) {
+    auto metadata(makeCollectionMetadata());
+    boost::optional<Chunk> lastChunk;
+
+    for (int a : {5, 10, 15, 20, 25, 30, 40, 25, 5}) {
+        const auto key = BSON("a" << a);
+        ASSERT_EQ(metadata->keyBelongsToMe(key), metadata->keyBelongsToMe(key, &lastChunk));
+        ASSERT(lastChunk);
+        ASSERT(lastChunk->containsKey(key));
+    }
+
+    ASSERT_BSONOBJ_EQ(BSON("a" << MINKEY), lastChunk->getMin());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 10), lastChunk->getMax());
+
+    ASSERT(!metadata->keyBelongsToMe(BSONObj(), &lastChunk));
+}
+
+TEST_F(ThreeChunkWithRangeGapFixture, RangeIsOwnedByMe) {
+    auto metadata(makeCollectionMetadata());
+
+    ASSERT(metadata->rangeIsOwnedByMe(BSON("a" << MINKEY), BSON("a" << 19)));
+    ASSERT(metadata->rangeIsOwnedByMe(BSON("a" << 10), BSON("a" << 15)));
+    ASSERT(metadata->rangeIsOwnedByMe(BSON("a" << 30), BSON("a" << 40)));
+
+    ASSERT(!metadata->rangeIsOwnedByMe(BSON("a" << 10), BSON("a" << 20)));
+    ASSERT(!metadata->rangeIsOwnedByMe(BSON("a" << 15), BSON("a" << 35)));
+    ASSERT(!metadata->rangeIsOwnedByMe(BSON("a" << 20), BSON("a" << 25)));
+    ASSERT(!metadata->rangeIsOwnedByMe(BSON("a" << 30), BSON("a" << MAXKEY)));
+}
+
 TEST_F(ThreeChunkWithRangeGapFixture, GetNextChunkFromBeginning) {
     ChunkType nextChunk;
     ASSERT(
@@ -48,20 +48,22 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/plan_yield_policy.h"
-#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/repl/repl_client_info.h"
+#include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/s/collection_sharding_runtime.h"
 #include "mongo/db/s/sharding_runtime_d_params_gen.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/s/sharding_statistics.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/remove_saver.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -76,6 +78,91 @@ const WriteConcernOptions kMajorityWriteConcern(WriteConcernOptions::kMajority,
 
 MONGO_FAIL_POINT_DEFINE(hangBeforeDoingDeletion);
 
+/**
+ * Returns the majority replication lag of this node, or zero if it is not a replica set member.
+ */
+Milliseconds getMajorityReplicationLag(OperationContext* opCtx) {
+    auto* const replCoord = repl::ReplicationCoordinator::get(opCtx);
+    if (replCoord->getReplicationMode() != repl::ReplicationCoordinator::modeReplSet) {
+        return Milliseconds(0);
+    }
+
+    const auto lastAppliedWallTime = replCoord->getMyLastAppliedOpTimeAndWallTime().wallTime;
+    const auto lastCommittedWallTime = replCoord->getLastCommittedOpTimeAndWallTime().wallTime;
+    if (lastCommittedWallTime == Date_t() || lastAppliedWallTime <= lastCommittedWallTime) {
+        return Milliseconds(0);
+    }
+    return lastAppliedWallTime - lastCommittedWallTime;
+}
+
+bool isCacheUnderPressure(OperationContext* opCtx) {
+    try {
+        return opCtx->getServiceContext()->getStorageEngine()->isCacheUnderPressure(opCtx);
+    } catch (const DBException& e) {
+        LOG(1) << "Unable to determine the storage engine cache pressure: " << redact(e);
+        return false;
+    }
+}
+
+struct ShardKeyIndexBounds {
+    const IndexDescriptor* descriptor;
+    BSONObj min;
+    BSONObj max;
+};
+
+/**
+ * Finds the index on the shard key and the bounds of 'range' in that index.
+ */
+StatusWith<ShardKeyIndexBounds> getShardKeyIndexBounds(OperationContext* opCtx,
+                                                       Collection* collection,
+                                                       BSONObj const& keyPattern,
+                                                       ChunkRange const& range) {
+    auto const& nss = collection->ns();
+
+    // The IndexChunk has a keyPattern that may apply to more than one index - we need to
+    // select the index and get the full index keyPattern here.
+    auto catalog = collection->getIndexCatalog();
+    const IndexDescriptor* idx = catalog->findShardKeyPrefixedIndex(opCtx, keyPattern, false);
+    if (!idx) {
+        std::string msg = str::stream()
+            << "Unable to find shard key index for " << keyPattern.toString() << " in " << nss.ns();
+        LOG(0) << msg;
+        return {ErrorCodes::InternalError, msg};
+    }
+
+    // Extend bounds to match the index we found
+    const KeyPattern indexKeyPattern(idx->keyPattern());
+    const auto extend = [&](const auto& key) {
+        return Helpers::toKeyFormat(indexKeyPattern.extendRangeBound(key, false));
+    };
+
+    const auto min = extend(range.getMin());
+    const auto max = extend(range.getMax());
+
+    const auto indexName = idx->indexName();
+    const IndexDescriptor* descriptor =
+        collection->getIndexCatalog()->findIndexByName(opCtx, indexName);
+    if (!descriptor) {
+        std::string msg = str::stream()
+            << "shard key index with name " << indexName << " on '" << nss.ns() << "' was dropped";
+        LOG(0) << msg;
+        return {ErrorCodes::InternalError, msg};
+    }
+
+    return ShardKeyIndexBounds{descriptor, min, max};
+}
+
+/**
+ * Estimates the number of documents in a range which is about to be deleted, assuming that the
+ * documents on this shard are spread evenly over the chunks it owns and the range. Scanning the
+ * range instead would hold the collection lock and delay the first batch of deletions.
+ */
+long long estimateDocsInRange(OperationContext* opCtx,
+                              Collection* collection,
+                              const CollectionMetadata& metadata) {
+    return collection->numRecords(opCtx) / static_cast<long long>(metadata.getChunks().size() + 1);
+}
+
 boost::optional<DeleteNotification> checkOverlap(std::list<Deletion> const& deletions,
                                                  ChunkRange const& range) {
     // Start search with newest entries by using reverse iterators
@@ -105,17 +192,19 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
     int maxToDelete,
     CollectionRangeDeleter* forTestOnly) {
 
+    // An explicit batch size, whether passed in or configured, turns off the pacing of the batches
     if (maxToDelete <= 0) {
         maxToDelete = rangeDeleterBatchSize.load();
-        if (maxToDelete <= 0) {
-            maxToDelete = std::max(int(internalQueryExecYieldIterations.load()), 1);
-        }
     }
+    const bool adaptive = maxToDelete <= 0;
 
     StatusWith<int> swNumDeleted = 0;
+    Milliseconds batchDelay(rangeDeleterBatchDelayMS.load());
 
     auto range = boost::optional<ChunkRange>(boost::none);
     auto notification = DeleteNotification();
+    std::shared_ptr<RangeDeletionProgress> progress;
+    bool estimateDocsInRangeFirst = false;
 
     {
         UninterruptibleLockGuard noInterrupt(opCtx->lockState());
@@ -159,9 +248,21 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
             }
 
             invariant(!orphans.empty());
-            const auto& frontRange = orphans.front().range;
+            auto& front = orphans.front();
+            const auto& frontRange = front.range;
             range.emplace(frontRange.getMin().getOwned(), frontRange.getMax().getOwned());
-            notification = orphans.front().notification;
+            notification = front.notification;
+
+            if (!front.progress) {
+                front.progress = ShardingStatistics::get(opCtx).registerRangeDeletion(
+                    nss.ns(), frontRange.getMin(), frontRange.getMax());
+                estimateDocsInRangeFirst = true;
+            }
+            progress = front.progress;
+
+            if (adaptive) {
+                maxToDelete = self->_pacer.batchSize();
+            }
         }
 
         invariant(range);
@@ -194,6 +295,11 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
             metadataManager->getActiveMetadata(metadataManager, boost::none);
         const auto& metadata = *scopedCollectionMetadata;
 
+        if (estimateDocsInRangeFirst) {
+            progress->setDocsInRange(estimateDocsInRange(opCtx, collection, *metadata));
+        }
+
+        Timer batchTimer;
         try {
             swNumDeleted = self->_doDeletion(
                 opCtx, collection, metadata->getKeyPattern(), *range, maxToDelete);
@@ -201,6 +307,20 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
             swNumDeleted = e.toStatus();
             warning() << e.what();
         }
+
+        if (swNumDeleted.isOK()) {
+            int nextBatchSize = maxToDelete;
+            if (adaptive) {
+                self->_pacer.onBatchCompleted({maxToDelete,
+                                               swNumDeleted.getValue(),
+                                               Milliseconds(batchTimer.millis()),
+                                               getMajorityReplicationLag(opCtx),
+                                               isCacheUnderPressure(opCtx)});
+                nextBatchSize = self->_pacer.batchSize();
+                batchDelay = self->_pacer.batchDelay();
+            }
+            progress->onBatchCompleted(swNumDeleted.getValue(), nextBatchSize, batchDelay);
+        }
     }  // drop autoColl
 
     bool continueDeleting = swNumDeleted.isOK() && swNumDeleted.getValue() > 0;
@@ -281,14 +401,14 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
                    << redact(self->_orphans.front().range.toString()) << " next.";
         }
 
-        return Date_t::now() + Milliseconds(rangeDeleterBatchDelayMS.load());
+        return Date_t::now() + batchDelay;
     }
 
     invariant(range);
     invariant(continueDeleting);
 
     notification.abandon();
-    return Date_t::now() + Milliseconds(rangeDeleterBatchDelayMS.load());
+    return Date_t::now() + batchDelay;
 }
 
 bool CollectionRangeDeleter::_checkCollectionMetadataStillValid(
@@ -343,38 +463,16 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
 
     auto const& nss = collection->ns();
 
-    // The IndexChunk has a keyPattern that may apply to more than one index - we need to
-    // select the index and get the full index keyPattern here.
-    auto catalog = collection->getIndexCatalog();
-    const IndexDescriptor* idx = catalog->findShardKeyPrefixedIndex(opCtx, keyPattern, false);
-    if (!idx) {
-        std::string msg = str::stream()
-            << "Unable to find shard key index for " << keyPattern.toString() << " in " << nss.ns();
-        LOG(0) << msg;
-        return {ErrorCodes::InternalError, msg};
+    auto swBounds = getShardKeyIndexBounds(opCtx, collection, keyPattern, range);
+    if (!swBounds.isOK()) {
+        return swBounds.getStatus();
     }
-
-    // Extend bounds to match the index we found
-    const KeyPattern indexKeyPattern(idx->keyPattern());
-    const auto extend = [&](const auto& key) {
-        return Helpers::toKeyFormat(indexKeyPattern.extendRangeBound(key, false));
-    };
-
-    const auto min = extend(range.getMin());
-    const auto max = extend(range.getMax());
+    const auto& min = swBounds.getValue().min;
+    const auto& max = swBounds.getValue().max;
+    const IndexDescriptor* descriptor = swBounds.getValue().descriptor;
 
     LOG(1) << "begin removal of " << min << " to " << max << " in " << nss.ns();
 
-    const auto indexName = idx->indexName();
-    const IndexDescriptor* descriptor =
-        collection->getIndexCatalog()->findIndexByName(opCtx, indexName);
-    if (!descriptor) {
-        std::string msg = str::stream()
-            << "shard key index with name " << indexName << " on '" << nss.ns() << "' was dropped";
-        LOG(0) << msg;
-        return {ErrorCodes::InternalError, msg};
-    }
-
     auto deleteStageParams = std::make_unique<DeleteStageParams>();
     deleteStageParams->fromMigrate = true;
     deleteStageParams->isMulti = true;
@@ -506,6 +604,45 @@ void CollectionRangeDeleter::_pop(Status result) {
     _orphans.pop_front();
 }
 
+// RangeDeleterPacer
+
+const Milliseconds RangeDeleterPacer::kBackOffDelay{100};
+const Milliseconds RangeDeleterPacer::kMaxBatchDelay{5000};
+
+int RangeDeleterPacer::batchSize() const {
+    return std::max(std::min(_batchSize, rangeDeleterMaxBatchSize.load()), 1);
+}
+
+Milliseconds RangeDeleterPacer::batchDelay() const {
+    return std::max(_batchDelay, Milliseconds(rangeDeleterBatchDelayMS.load()));
+}
+
+void RangeDeleterPacer::onBatchCompleted(const BatchObservation& observation) {
+    const Milliseconds targetBatchTime(rangeDeleterTargetBatchTimeMS.load());
+    const Seconds maxReplicationLag(rangeDeleterMaxReplicationLagSecs.load());
+
+    if (observation.cacheUnderPressure || observation.replicationLag > maxReplicationLag) {
+        _batchSize = std::max(observation.batchSize / 2, kMinBatchSize);
+        _batchDelay = std::min(std::max(_batchDelay * 2, kBackOffDelay), kMaxBatchDelay);
+    } else if (observation.batchTime > targetBatchTime) {
+        const double scale = double(durationCount<Milliseconds>(targetBatchTime)) /
+            durationCount<Milliseconds>(observation.batchTime);
+        _batchSize = std::max(static_cast<int>(observation.batchSize * scale), kMinBatchSize);
+    } else {
+        _batchDelay = _batchDelay / 2;
+
+        // Only a full batch tells how long a larger one would take
+        if (observation.numDeleted >= observation.batchSize) {
+            const int growth = observation.batchTime * 2 < targetBatchTime
+                ? observation.batchSize
+                : observation.batchSize / 8;
+            _batchSize = observation.batchSize + std::max(growth, 1);
+        }
+    }
+
+    _batchSize = std::min(_batchSize, rangeDeleterMaxBatchSize.load());
+}
+
 // DeleteNotification
 
 CollectionRangeDeleter::DeleteNotification::DeleteNotification()
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <list>
+#include <memory>
 
 #include "mongo/db/namespace_string.h"
 #include "mongo/executor/task_executor.h"
@@ -43,16 +44,54 @@ class Collection;
 class MetadataManager;
 class OperationContext;
 
+class RangeDeletionProgress;
+
 // The maximum number of documents to delete in a single batch during range deletion.
 // secondaryThrottle and rangeDeleterBatchDelayMS apply between each batch.
-// Must be positive or 0 (the default), which means to use the value of
-// internalQueryExecYieldIterations (or 1 if that's negative or zero).
+// Must be positive or 0 (the default), which means that RangeDeleterPacer chooses the batch size.
 extern AtomicWord<int> rangeDeleterBatchSize;
 
 // After completing a batch of document deletions, the time in millis to wait before commencing the
-// next batch of deletions.
+// next batch of deletions. When RangeDeleterPacer chooses the batch size, this is the least delay.
 extern AtomicWord<int> rangeDeleterBatchDelayMS;
 
+/**
+ * Adapts the size of the batches in which a collection's range deleter deletes documents, and the
+ * delay between them, to the load on the node which the previous batches observed.
+ *
+ * While batches finish well within rangeDeleterTargetBatchTimeMS and the node keeps up, the batches
+ * grow up to rangeDeleterMaxBatchSize and the delay shrinks to rangeDeleterBatchDelayMS. A batch
+ * which takes longer than the target holds up foreground operations for too long, so the next one
+ * is shrunk in proportion. If the storage engine cache is under pressure or majority replication
+ * lags by more than rangeDeleterMaxReplicationLagSecs, the batch size is halved and the delay
+ * doubled, so that the node can catch up.
+ */
+class RangeDeleterPacer {
+public:
+    // What the range deleter observed around a batch of deletions.
+    struct BatchObservation {
+        int batchSize;
+        int numDeleted;
+        Milliseconds batchTime;
+        Milliseconds replicationLag;
+        bool cacheUnderPressure;
+    };
+
+    static constexpr int kInitialBatchSize = 128;
+    static constexpr int kMinBatchSize = 16;
+    static const Milliseconds kBackOffDelay;
+    static const Milliseconds kMaxBatchDelay;
+
+    int batchSize() const;
+    Milliseconds batchDelay() const;
+
+    void onBatchCompleted(const BatchObservation& observation);
+
+private:
+    int _batchSize{kInitialBatchSize};
+    Milliseconds _batchDelay{0};
+};
+
 class CollectionRangeDeleter {
     CollectionRangeDeleter(const CollectionRangeDeleter&) = delete;
     CollectionRangeDeleter& operator=(const CollectionRangeDeleter&) = delete;
@@ -118,6 +157,9 @@ public:
         ChunkRange range;
         Date_t whenToDelete;  // A value of Date_t{} means immediately.
         DeleteNotification notification{};
+
+        // Set once the deletion of the range has started.
+        std::shared_ptr<RangeDeletionProgress> progress;
     };
 
     CollectionRangeDeleter();
@@ -222,6 +264,10 @@ private:
     // TODO SERVER-41606: Remove this function when we refactor CollectionRangeDeleter.
     bool _throwWriteConflictForTest{false};
 
+    // Only used by cleanUpNextRange, of which at most one call is scheduled at a time for each
+    // collection.
+    RangeDeleterPacer _pacer;
+
     /**
      * Ranges scheduled for deletion.  The front of the list will be in active process of deletion.
      * As each range is completed, its notification is signaled before it is popped.
@@ -40,7 +40,9 @@
 #include "mongo/db/keypattern.h"
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/s/collection_sharding_runtime.h"
+#include "mongo/db/s/sharding_runtime_d_params_gen.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/s/sharding_statistics.h"
 #include "mongo/s/balancer_configuration.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/client/shard_registry.h"
@@ -414,5 +416,105 @@ TEST_F(CollectionRangeDeleterTest, RetryOnWriteConflictException) {
     ASSERT_EQUALS(2ULL, dbclient.count(kNss.toString(), BSON(kShardKey << LT << 5)));
 }
 
+// Tests that the progress of a range deletion is reported until the range is done.
+TEST_F(CollectionRangeDeleterTest, ReportsProgressOfRangeDeletion) {
+    CollectionRangeDeleter rangeDeleter;
+    DBDirectClient dbclient(operationContext());
+    dbclient.insert(kNss.toString(), BSON(kShardKey << 1));
+    dbclient.insert(kNss.toString(), BSON(kShardKey << 2));
+    dbclient.insert(kNss.toString(), BSON(kShardKey << 3));
+
+    std::list<Deletion> ranges;
+    ranges.emplace_back(
+        Deletion{ChunkRange(BSON(kShardKey << 0), BSON(kShardKey << 10)), Date_t{}});
+    rangeDeleter.add(std::move(ranges));
+
+    const auto reportRangeDeletions = [&] {
+        BSONObjBuilder builder;
+        ShardingStatistics::get(operationContext()).report(&builder);
+        return builder.obj()["rangeDeletions"].Array();
+    };
+    ASSERT_EQ(0u, reportRangeDeletions().size());
+
+    ASSERT_TRUE(next(rangeDeleter, 1));
+    const auto rangeDeletions = reportRangeDeletions();
+    ASSERT_EQ(1u, rangeDeletions.size());
+    const auto progress = rangeDeletions[0].Obj();
+    ASSERT_EQ(kNss.ns(), progress["ns"].String());
+    ASSERT_BSONOBJ_EQ(BSON(kShardKey << 0), progress["min"].Obj());
+    ASSERT_EQ(1, progress["docsDeleted"].numberLong());
+    ASSERT_EQ(2, progress["estimatedDocsRemaining"].numberLong());
+
+    ASSERT_TRUE(next(rangeDeleter, 100));
+    ASSERT_TRUE(next(rangeDeleter, 100));
+    ASSERT_TRUE(rangeDeleter.isEmpty());
+    ASSERT_EQ(0u, reportRangeDeletions().size());
+}
+
+RangeDeleterPacer::BatchObservation makeObservation(int batchSize,
+                                                    int numDeleted,
+                                                    Milliseconds batchTime) {
+    return {batchSize, numDeleted, batchTime, Milliseconds(0), false};
+}
+
+TEST(RangeDeleterPacerTest, GrowsFullBatchesWhichFinishQuickly) {
+    RangeDeleterPacer pacer;
+    const int initialBatchSize = pacer.batchSize();
+
+    pacer.onBatchCompleted(makeObservation(initialBatchSize, initialBatchSize, Milliseconds(1)));
+    ASSERT_EQ(2 * initialBatchSize, pacer.batchSize());
+    ASSERT_EQ(Milliseconds(rangeDeleterBatchDelayMS.load()), pacer.batchDelay());
+
+    // A batch which was not full does not show that a larger one would be quick
+    pacer.onBatchCompleted(makeObservation(pacer.batchSize(), 1, Milliseconds(1)));
+    ASSERT_EQ(2 * initialBatchSize, pacer.batchSize());
+}
+
+TEST(RangeDeleterPacerTest, BatchSizeIsBoundedByTheMaxBatchSize) {
+    RangeDeleterPacer pacer;
+    for (int i = 0; i < 20; ++i) {
+        pacer.onBatchCompleted(
+            makeObservation(pacer.batchSize(), pacer.batchSize(), Milliseconds(0)));
+    }
+    ASSERT_EQ(rangeDeleterMaxBatchSize.load(), pacer.batchSize());
+}
+
+TEST(RangeDeleterPacerTest, ShrinksBatchesWhichTakeLongerThanTheTarget) {
+    RangeDeleterPacer pacer;
+    const int batchSize = pacer.batchSize();
+    const Milliseconds targetBatchTime(rangeDeleterTargetBatchTimeMS.load());
+
+    pacer.onBatchCompleted(makeObservation(batchSize, batchSize, targetBatchTime * 2));
+    ASSERT_EQ(batchSize / 2, pacer.batchSize());
+}
+
+TEST(RangeDeleterPacerTest, BacksOffUnderCachePressureAndReplicationLag) {
+    RangeDeleterPacer pacer;
+    const int batchSize = pacer.batchSize();
+
+    pacer.onBatchCompleted({batchSize, batchSize, Milliseconds(1), Milliseconds(0), true});
+    ASSERT_EQ(batchSize / 2, pacer.batchSize());
+    ASSERT_EQ(RangeDeleterPacer::kBackOffDelay, pacer.batchDelay());
+
+    const Seconds maxReplicationLag(rangeDeleterMaxReplicationLagSecs.load());
+    pacer.onBatchCompleted({pacer.batchSize(),
+                            pacer.batchSize(),
+                            Milliseconds(1),
+                            maxReplicationLag + Seconds(1),
+                            false});
+    ASSERT_EQ(batchSize / 4, pacer.batchSize());
+    ASSERT_EQ(RangeDeleterPacer::kBackOffDelay * 2, pacer.batchDelay());
+
+    // Once the node has caught up, the delay decays back
+    pacer.onBatchCompleted(makeObservation(pacer.batchSize(), 0, Milliseconds(1)));
+    ASSERT_EQ(RangeDeleterPacer::kBackOffDelay, pacer.batchDelay());
+
+    for (int i = 0; i < 10; ++i) {
+        pacer.onBatchCompleted({pacer.batchSize(), 0, Milliseconds(1), Milliseconds(0), true});
+    }
+    ASSERT_EQ(RangeDeleterPacer::kMinBatchSize, pacer.batchSize());
+    ASSERT_EQ(RangeDeleterPacer::kMaxBatchDelay, pacer.batchDelay());
+}
+
 }  // namespace
 }  // namespace mongo
@@ -70,6 +70,10 @@ const char kRecvChunkAbort[] = "_recvChunkAbort";
 
 const int kMaxObjectPerChunk{250000};
 
+// Upper bound on the number of record ids a single call to nextCloneBatch claims from the clone
+// set at a time
+const size_t kMaxCloneLocsPerClaim{1024};
+
 bool isInRange(const BSONObj& obj,
                const BSONObj& min,
                const BSONObj& max,
@@ -616,37 +620,61 @@ Status MigrationChunkClonerSourceLegacy::nextCloneBatch(OperationContext* opCtx,
                            internalQueryExecYieldIterations.load(),
                            Milliseconds(internalQueryExecYieldPeriodMS.load()));
 
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-    auto iter = _cloneLocs.begin();
+    // The record ids are claimed from the clone set in slices and fetched without holding the
+    // mutex, so that concurrent callers never return the same document. Whatever does not fit in
+    // the batch is put back for the next call.
+    std::vector<RecordId> claimed;
+    while (true) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            const size_t numToClaim = std::min<size_t>(
+                kMaxCloneLocsPerClaim,
+                BSONObjMaxUserSize / std::max<uint64_t>(_averageObjectSizeForCloneLocs, 1) + 1);
 
-    for (; iter != _cloneLocs.end(); ++iter) {
-        // We must always make progress in this method by at least one document because empty return
-        // indicates there is no more initial clone data.
-        if (arrBuilder->arrSize() && tracker.intervalHasElapsed()) {
-            break;
+            auto claimEnd = _cloneLocs.begin();
+            while (claimEnd != _cloneLocs.end() && claimed.size() < numToClaim) {
+                claimed.push_back(*claimEnd++);
+            }
+            _cloneLocs.erase(_cloneLocs.begin(), claimEnd);
         }
 
-        auto nextRecordId = *iter;
-
-        lk.unlock();
+        if (claimed.empty()) {
+            break;
+        }
 
-        Snapshotted<BSONObj> doc;
-        if (collection->findDoc(opCtx, nextRecordId, &doc)) {
-            // Use the builder size instead of accumulating the document sizes directly so
-            // that we take into consideration the overhead of BSONArray indices.
-            if (arrBuilder->arrSize() &&
-                (arrBuilder->len() + doc.value().objsize() + 1024) > BSONObjMaxUserSize) {
+        auto iter = claimed.begin();
+        bool batchFull = false;
+        for (; iter != claimed.end(); ++iter) {
+            // We must always make progress in this method by at least one document because empty
+            // return indicates there is no more initial clone data.
+            if (arrBuilder->arrSize() && tracker.intervalHasElapsed()) {
+                batchFull = true;
                 break;
             }
 
-            arrBuilder->append(doc.value());
-            ShardingStatistics::get(opCtx).countDocsClonedOnDonor.addAndFetch(1);
+            Snapshotted<BSONObj> doc;
+            if (collection->findDoc(opCtx, *iter, &doc)) {
+                // Use the builder size instead of accumulating the document sizes directly so
+                // that we take into consideration the overhead of BSONArray indices.
+                if (arrBuilder->arrSize() &&
+                    (arrBuilder->len() + doc.value().objsize() + 1024) > BSONObjMaxUserSize) {
+                    batchFull = true;
+                    break;
+                }
+
+                arrBuilder->append(doc.value());
+                ShardingStatistics::get(opCtx).countDocsClonedOnDonor.addAndFetch(1);
+            }
         }
 
-        lk.lock();
-    }
+        if (batchFull) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _cloneLocs.insert(iter, claimed.end());
+            break;
+        }
 
-    _cloneLocs.erase(_cloneLocs.begin(), iter);
+        claimed.clear();
+    }
 
     return Status::OK();
 }
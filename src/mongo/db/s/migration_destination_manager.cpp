@@ -33,6 +33,7 @@
 
 #include "mongo/db/s/migration_destination_manager.h"
 
+#include <algorithm>
 #include <list>
 #include <vector>
 
@@ -54,6 +55,7 @@
 #include "mongo/db/s/sharding_runtime_d_params_gen.h"
 #include "mongo/db/s/sharding_statistics.h"
 #include "mongo/db/s/start_chunk_clone_request.h"
+#include "mongo/db/server_options.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/remove_saver.h"
 #include "mongo/s/catalog/type_chunk.h"
@@ -200,6 +202,68 @@ BSONObj createTransferModsRequest(const NamespaceString& nss, const MigrationSes
     return builder.obj();
 }
 
+/**
+ * Fetches batches of the initial clone from the donor and inserts them, with the fetching of the
+ * next batch overlapping the insertion of the previous one, until the donor returns an empty
+ * batch. Returns the optime of the last insert.
+ */
+repl::OpTime cloneDocumentsOverStream(
+    OperationContext* opCtx,
+    const std::function<void(OperationContext*, BSONObj)>& insertBatchFn,
+    const std::function<BSONObj(OperationContext*)>& fetchBatchFn) {
+    SingleProducerSingleConsumerQueue<BSONObj>::Options options;
+    options.maxQueueDepth = 1;
+
+    SingleProducerSingleConsumerQueue<BSONObj> batches(options);
+    repl::OpTime lastOpApplied;
+
+    stdx::thread inserterThread{[&] {
+        ThreadClient tc("chunkInserter", opCtx->getServiceContext());
+        auto inserterOpCtx = Client::getCurrent()->makeOperationContext();
+        auto consumerGuard = makeGuard([&] {
+            batches.closeConsumerEnd();
+            lastOpApplied = repl::ReplClientInfo::forClient(inserterOpCtx->getClient()).getLastOp();
+        });
+
+        try {
+            while (true) {
+                auto nextBatch = batches.pop(inserterOpCtx.get());
+                auto arr = nextBatch["objects"].Obj();
+                if (arr.isEmpty()) {
+                    return;
+                }
+                insertBatchFn(inserterOpCtx.get(), arr);
+            }
+        } catch (...) {
+            stdx::lock_guard<Client> lk(*opCtx->getClient());
+            opCtx->getServiceContext()->killOperation(lk, opCtx, ErrorCodes::Error(51008));
+            log() << "Batch insertion failed " << causedBy(redact(exceptionToStatus()));
+        }
+    }};
+    auto inserterThreadJoinGuard = makeGuard([&] {
+        batches.closeProducerEnd();
+        inserterThread.join();
+    });
+
+    while (true) {
+        opCtx->checkForInterrupt();
+
+        auto res = fetchBatchFn(opCtx);
+
+        opCtx->checkForInterrupt();
+        batches.push(res.getOwned(), opCtx);
+        auto arr = res["objects"].Obj();
+        if (arr.isEmpty()) {
+            inserterThreadJoinGuard.dismiss();
+            inserterThread.join();
+            opCtx->checkForInterrupt();
+            break;
+        }
+    }
+
+    return lastOpApplied;
+}
+
 // Enabling / disabling these fail points pauses / resumes MigrateStatus::_go(), the thread which
 // receives a chunk migration from the donor.
 MONGO_FAIL_POINT_DEFINE(migrateThreadHangAtStep1);
@@ -378,58 +442,88 @@ Status MigrationDestinationManager::start(OperationContext* opCtx,
 repl::OpTime MigrationDestinationManager::cloneDocumentsFromDonor(
     OperationContext* opCtx,
     std::function<void(OperationContext*, BSONObj)> insertBatchFn,
-    std::function<BSONObj(OperationContext*)> fetchBatchFn) {
-
-    SingleProducerSingleConsumerQueue<BSONObj>::Options options;
-    options.maxQueueDepth = 1;
+    std::function<BSONObj(OperationContext*)> fetchBatchFn,
+    int numStreams) {
+    if (numStreams <= 1) {
+        return cloneDocumentsOverStream(opCtx, insertBatchFn, fetchBatchFn);
+    }
 
-    SingleProducerSingleConsumerQueue<BSONObj> batches(options);
+    // The donor hands out disjoint sets of documents to concurrent _migrateClone requests, so each
+    // stream runs its own fetch and insert pipeline until the donor has nothing left to give it.
+    // The first stream runs on the calling thread.
+    stdx::mutex mutex;
+    Status firstError = Status::OK();
+    std::vector<OperationContext*> streamOpCtxs;
     repl::OpTime lastOpApplied;
 
-    stdx::thread inserterThread{[&] {
-        ThreadClient tc("chunkInserter", opCtx->getServiceContext());
-        auto inserterOpCtx = Client::getCurrent()->makeOperationContext();
-        auto consumerGuard = makeGuard([&] {
-            batches.closeConsumerEnd();
-            lastOpApplied = repl::ReplClientInfo::forClient(inserterOpCtx->getClient()).getLastOp();
-        });
+    // Records the first error and interrupts the streams on other threads. The calling thread is
+    // interrupted as well when the failure comes from one of them. The error may be any error which
+    // a fetch or an insert returns, so the streams are killed with a fixed interruption code, and
+    // the saved error is thrown once they have all stopped.
+    auto onStreamFailed = [&](const Status& status, bool interruptCaller) {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        if (firstError.isOK()) {
+            firstError = status;
+        }
 
-        try {
-            while (true) {
-                auto nextBatch = batches.pop(inserterOpCtx.get());
-                auto arr = nextBatch["objects"].Obj();
-                if (arr.isEmpty()) {
+        if (interruptCaller) {
+            stdx::lock_guard<Client> clientLock(*opCtx->getClient());
+            opCtx->getServiceContext()->killOperation(clientLock, opCtx, ErrorCodes::Error(51008));
+        }
+
+        for (auto streamOpCtx : streamOpCtxs) {
+            stdx::lock_guard<Client> clientLock(*streamOpCtx->getClient());
+            streamOpCtx->getServiceContext()->killOperation(
+                clientLock, streamOpCtx, ErrorCodes::Error(51008));
+        }
+    };
+
+    std::vector<stdx::thread> streams;
+    for (int i = 1; i < numStreams; ++i) {
+        streams.emplace_back([&, i] {
+            ThreadClient tc(str::stream() << "chunkCloner-" << i, opCtx->getServiceContext());
+            auto streamOpCtx = Client::getCurrent()->makeOperationContext();
+
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                if (!firstError.isOK()) {
                     return;
                 }
-                insertBatchFn(inserterOpCtx.get(), arr);
+                streamOpCtxs.push_back(streamOpCtx.get());
             }
-        } catch (...) {
-            stdx::lock_guard<Client> lk(*opCtx->getClient());
-            opCtx->getServiceContext()->killOperation(lk, opCtx, ErrorCodes::Error(51008));
-            log() << "Batch insertion failed " << causedBy(redact(exceptionToStatus()));
-        }
-    }};
-    auto inserterThreadJoinGuard = makeGuard([&] {
-        batches.closeProducerEnd();
-        inserterThread.join();
-    });
+            ON_BLOCK_EXIT([&] {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                streamOpCtxs.erase(
+                    std::find(streamOpCtxs.begin(), streamOpCtxs.end(), streamOpCtx.get()));
+            });
 
-    while (true) {
-        opCtx->checkForInterrupt();
+            try {
+                const auto streamLastOp =
+                    cloneDocumentsOverStream(streamOpCtx.get(), insertBatchFn, fetchBatchFn);
 
-        auto res = fetchBatchFn(opCtx);
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                lastOpApplied = std::max(lastOpApplied, streamLastOp);
+            } catch (const DBException& ex) {
+                onStreamFailed(ex.toStatus(), true);
+            }
+        });
+    }
 
-        opCtx->checkForInterrupt();
-        batches.push(res.getOwned(), opCtx);
-        auto arr = res["objects"].Obj();
-        if (arr.isEmpty()) {
-            inserterThreadJoinGuard.dismiss();
-            inserterThread.join();
-            opCtx->checkForInterrupt();
-            break;
-        }
+    try {
+        const auto streamLastOp = cloneDocumentsOverStream(opCtx, insertBatchFn, fetchBatchFn);
+
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        lastOpApplied = std::max(lastOpApplied, streamLastOp);
+    } catch (const DBException& ex) {
+        onStreamFailed(ex.toStatus(), false);
+    }
+
+    for (auto& stream : streams) {
+        stream.join();
     }
 
+    // If another stream failed first, report its error rather than the interruption it caused
+    uassertStatusOK(firstError);
     return lastOpApplied;
 }
 
@@ -844,6 +938,7 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx) {
             }
         };
 
+        AtomicWord<long long> numCloneBatches{0};
         auto fetchBatchFn = [&](OperationContext* opCtx) {
             auto res = uassertStatusOKWithContext(
                 fromShard->runCommand(opCtx,
@@ -856,14 +951,30 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx) {
             uassertStatusOKWithContext(Shard::CommandResponse::getEffectiveStatus(res),
                                        "_migrateClone failed: ");
 
+            numCloneBatches.addAndFetch(1);
             return res.response;
         };
 
+        // Donors which do not yet hand out disjoint batches to concurrent requests are only
+        // excluded by the feature compatibility version
+        const int numCloneStreams = serverGlobalParams.featureCompatibility.getVersion() ==
+                ServerGlobalParams::FeatureCompatibility::Version::kFullyUpgradedTo44
+            ? migrateCloneConcurrency.load()
+            : 1;
+
         // If running on a replicated system, we'll need to flush the docs we cloned to the
         // secondaries
-        lastOpApplied = cloneDocumentsFromDonor(opCtx, insertBatchFn, fetchBatchFn);
+        lastOpApplied =
+            cloneDocumentsFromDonor(opCtx, insertBatchFn, fetchBatchFn, numCloneStreams);
 
         timing.done(3);
+        {
+            stdx::lock_guard<stdx::mutex> sl(_mutex);
+            timing.appendDetails(BSON("clone" << BSON("numStreams" << numCloneStreams
+                                                      << "numBatches" << numCloneBatches.load()
+                                                      << "docsCloned" << _numCloned
+                                                      << "bytesCloned" << _clonedBytes)));
+        }
         MONGO_FAIL_POINT_PAUSE_WHILE_SET(migrateThreadHangAtStep3);
 
         if (MONGO_FAIL_POINT(failMigrationLeaveOrphans)) {
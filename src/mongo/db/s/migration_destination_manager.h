@@ -109,12 +109,14 @@ public:
                  const WriteConcernOptions& writeConcern);
 
     /**
-     * Clones documents from a donor shard.
+     * Clones documents from a donor shard, over 'numStreams' concurrent fetch and insert pipelines.
+     * Throws the first error any of them encounters.
      */
     static repl::OpTime cloneDocumentsFromDonor(
         OperationContext* opCtx,
         std::function<void(OperationContext*, BSONObj)> insertBatchFn,
-        std::function<BSONObj(OperationContext*)> fetchBatchFn);
+        std::function<BSONObj(OperationContext*)> fetchBatchFn,
+        int numStreams = 1);
 
     /**
      * Idempotent method, which causes the current ongoing migration to abort only if it has the
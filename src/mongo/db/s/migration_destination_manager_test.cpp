@@ -30,7 +30,10 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/s/migration_destination_manager.h"
+#include "mongo/s/database_version_helpers.h"
 #include "mongo/s/shard_server_test_fixture.h"
+#include "mongo/s/stale_exception.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -157,5 +160,98 @@ TEST_F(MigrationDestinationManagerTest, CloneDocumentsCatchesInsertErrors) {
     ASSERT_EQ(operationContext()->getKillStatus(), 51008);
 }
 
+// Tests that concurrent streams each clone a disjoint part of the documents handed out by the donor
+// and that together they clone all of them.
+TEST_F(MigrationDestinationManagerTest, CloneDocumentsFromDonorOverSeveralStreams) {
+    const int kNumDocs = 1000;
+    const int kDocsPerBatch = 7;
+
+    stdx::mutex mutex;
+    int nextDocToFetch = 0;
+    std::vector<int> timesInserted(kNumDocs, 0);
+
+    auto fetchBatchFn = [&](OperationContext* opCtx) {
+        BSONArrayBuilder arrayBuilder;
+        {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            for (int i = 0; i < kDocsPerBatch && nextDocToFetch < kNumDocs; ++i) {
+                arrayBuilder.append(createDocument(nextDocToFetch++));
+            }
+        }
+
+        BSONObjBuilder fetchBatchResultBuilder;
+        fetchBatchResultBuilder.append("objects", arrayBuilder.arr());
+        return fetchBatchResultBuilder.obj();
+    };
+
+    auto insertBatchFn = [&](OperationContext* opCtx, BSONObj docs) {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        for (auto&& docToClone : docs) {
+            ++timesInserted[docToClone.Obj()["_id"].numberInt()];
+        }
+    };
+
+    MigrationDestinationManager::cloneDocumentsFromDonor(
+        operationContext(), insertBatchFn, fetchBatchFn, 4);
+
+    for (int i = 0; i < kNumDocs; ++i) {
+        ASSERT_EQ(1, timesInserted[i]) << "document " << i;
+    }
+}
+
+// Tests that a fetch error on any of the streams is thrown on the main thread with its original
+// code, rather than as the interruption it causes there.
+TEST_F(MigrationDestinationManagerTest, CloneDocumentsOverSeveralStreamsThrowsFetchErrors) {
+    stdx::mutex mutex;
+    int numFetches = 0;
+
+    auto fetchBatchFn = [&](OperationContext* opCtx) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            if (++numFetches > 5) {
+                uasserted(ErrorCodes::NetworkTimeout, "network error");
+            }
+        }
+
+        BSONObjBuilder fetchBatchResultBuilder;
+        fetchBatchResultBuilder.append("objects", createDocumentsToCloneArray());
+        return fetchBatchResultBuilder.obj();
+    };
+
+    auto insertBatchFn = [&](OperationContext* opCtx, BSONObj docs) {};
+
+    ASSERT_THROWS_CODE_AND_WHAT(MigrationDestinationManager::cloneDocumentsFromDonor(
+                                    operationContext(), insertBatchFn, fetchBatchFn, 3),
+                                DBException,
+                                ErrorCodes::NetworkTimeout,
+                                "network error");
+}
+
+// Tests that an error which is not an interruption, and which carries extra information, fails
+// the clone with that error when a stream other than the calling thread's runs into it.
+TEST_F(MigrationDestinationManagerTest, CloneDocumentsOverSeveralStreamsThrowsErrorsWithExtraInfo) {
+    const auto callerOpCtx = operationContext();
+
+    auto fetchBatchFn = [&](OperationContext* opCtx) {
+        // Only the streams on other threads fail, so the calling thread must be interrupted
+        if (opCtx != callerOpCtx) {
+            uasserted(StaleDbRoutingVersion("db", databaseVersion::makeNew(), boost::none),
+                      "stale database version");
+        }
+
+        BSONObjBuilder fetchBatchResultBuilder;
+        fetchBatchResultBuilder.append("objects", createDocumentsToCloneArray());
+        return fetchBatchResultBuilder.obj();
+    };
+
+    auto insertBatchFn = [&](OperationContext* opCtx, BSONObj docs) {};
+
+    ASSERT_THROWS_CODE_AND_WHAT(MigrationDestinationManager::cloneDocumentsFromDonor(
+                                    callerOpCtx, insertBatchFn, fetchBatchFn, 3),
+                                DBException,
+                                ErrorCodes::StaleDbVersion,
+                                "stale database version");
+}
+
 }  // namespace
 }  // namespace mongo
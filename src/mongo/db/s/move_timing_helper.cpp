@@ -112,4 +112,8 @@ void MoveTimingHelper::done(int step) {
     _t.reset();
 }
 
+void MoveTimingHelper::appendDetails(const BSONObj& details) {
+    _b.appendElements(details);
+}
+
 }  // namespace mongo
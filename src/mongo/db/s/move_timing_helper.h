@@ -55,6 +55,11 @@ public:
 
     void done(int step);
 
+    /**
+     * Adds the fields of 'details' to the change log entry, next to the timings of the steps.
+     */
+    void appendDetails(const BSONObj& details);
+
 private:
     // Measures how long the receiving of a chunk takes
     Timer _t;
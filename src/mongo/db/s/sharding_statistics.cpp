@@ -31,6 +31,8 @@
 
 #include "mongo/db/s/sharding_statistics.h"
 
+#include <algorithm>
+
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/service_context.h"
@@ -63,6 +65,77 @@ void ShardingStatistics::report(BSONObjBuilder* builder) const {
     builder->append("countRecipientMoveChunkStarted", countRecipientMoveChunkStarted.load());
     builder->append("countDocsDeletedOnDonor", countDocsDeletedOnDonor.load());
     builder->append("countDonorMoveChunkLockTimeout", countDonorMoveChunkLockTimeout.load());
+
+    BSONArrayBuilder rangeDeletions(builder->subarrayStart("rangeDeletions"));
+    stdx::lock_guard<stdx::mutex> lk(_rangeDeletionsMutex);
+    for (auto it = _rangeDeletions.begin(); it != _rangeDeletions.end();) {
+        if (auto progress = it->lock()) {
+            BSONObjBuilder rangeBuilder(rangeDeletions.subobjStart());
+            progress->report(&rangeBuilder);
+            ++it;
+        } else {
+            it = _rangeDeletions.erase(it);
+        }
+    }
+}
+
+std::shared_ptr<RangeDeletionProgress> ShardingStatistics::registerRangeDeletion(std::string ns,
+                                                                                 BSONObj min,
+                                                                                 BSONObj max) {
+    auto progress = std::make_shared<RangeDeletionProgress>(
+        std::move(ns), std::move(min).getOwned(), std::move(max).getOwned());
+
+    stdx::lock_guard<stdx::mutex> lk(_rangeDeletionsMutex);
+    _rangeDeletions.remove_if([](const auto& entry) { return entry.expired(); });
+    _rangeDeletions.push_back(progress);
+    return progress;
+}
+
+RangeDeletionProgress::RangeDeletionProgress(std::string ns, BSONObj min, BSONObj max)
+    : _ns(std::move(ns)), _min(std::move(min)), _max(std::move(max)), _startedAt(Date_t::now()) {}
+
+void RangeDeletionProgress::setDocsInRange(long long docsInRange) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _docsInRange = docsInRange;
+}
+
+void RangeDeletionProgress::onBatchCompleted(long long numDeleted,
+                                             int nextBatchSize,
+                                             Milliseconds nextBatchDelay) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _docsDeleted += numDeleted;
+    ++_numBatches;
+    _nextBatchSize = nextBatchSize;
+    _nextBatchDelay = nextBatchDelay;
+}
+
+void RangeDeletionProgress::report(BSONObjBuilder* builder) const {
+    const auto now = Date_t::now();
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    builder->append("ns", _ns);
+    builder->append("min", _min);
+    builder->append("max", _max);
+    builder->append("startedAt", _startedAt);
+    builder->append("docsDeleted", _docsDeleted);
+    builder->append("numBatches", _numBatches);
+    builder->append("nextBatchSize", _nextBatchSize);
+    builder->append("nextBatchDelayMillis", durationCount<Milliseconds>(_nextBatchDelay));
+
+    if (!_docsInRange) {
+        return;
+    }
+
+    // The estimate may be off, and documents inserted into the range since are not accounted for
+    const long long docsRemaining = std::max(*_docsInRange - _docsDeleted, 0LL);
+    builder->append("estimatedDocsRemaining", docsRemaining);
+
+    const auto elapsed = now - _startedAt;
+    if (_docsDeleted > 0 && elapsed > Milliseconds(0)) {
+        const double millisPerDoc = double(durationCount<Milliseconds>(elapsed)) / _docsDeleted;
+        builder->append("estimatedCompletion",
+                        now + Milliseconds(static_cast<long long>(millisPerDoc * docsRemaining)));
+    }
 }
 
 }  // namespace mongo
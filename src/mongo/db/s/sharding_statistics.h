@@ -29,7 +29,16 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "mongo/bson/bsonobj.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/duration.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -37,6 +46,45 @@ class BSONObjBuilder;
 class OperationContext;
 class ServiceContext;
 
+/**
+ * The progress of the deletion of one range of orphaned documents, which is reported in
+ * serverStatus for as long as the range deleter holds on to it.
+ */
+class RangeDeletionProgress {
+public:
+    RangeDeletionProgress(std::string ns, BSONObj min, BSONObj max);
+
+    /**
+     * Records an estimate of how many documents the range contained when its deletion started.
+     */
+    void setDocsInRange(long long docsInRange);
+
+    /**
+     * Records a completed batch of deletions and the pacing chosen for the next one.
+     */
+    void onBatchCompleted(long long numDeleted, int nextBatchSize, Milliseconds nextBatchDelay);
+
+    /**
+     * Appends the progress and, if the number of documents in the range has been estimated, the
+     * estimated time of completion at the current deletion rate.
+     */
+    void report(BSONObjBuilder* builder) const;
+
+private:
+    const std::string _ns;
+    const BSONObj _min;
+    const BSONObj _max;
+    const Date_t _startedAt;
+
+    mutable stdx::mutex _mutex;
+
+    boost::optional<long long> _docsInRange;
+    long long _docsDeleted{0};
+    long long _numBatches{0};
+    int _nextBatchSize{0};
+    Milliseconds _nextBatchDelay{0};
+};
+
 /**
  * Encapsulates per-process statistics for the sharding subsystem.
  */
@@ -101,6 +149,21 @@ struct ShardingStatistics {
      * Reports the accumulated statistics for serverStatus.
      */
     void report(BSONObjBuilder* builder) const;
+
+    /**
+     * Starts reporting the progress of the deletion of the range [min, max) of 'ns', until the
+     * returned object is destroyed.
+     */
+    std::shared_ptr<RangeDeletionProgress> registerRangeDeletion(std::string ns,
+                                                                 BSONObj min,
+                                                                 BSONObj max);
+
+private:
+    mutable stdx::mutex _rangeDeletionsMutex;
+
+    // The range deletions in progress, in the order in which they started. Entries for ranges which
+    // are done are pruned lazily.
+    mutable std::list<std::weak_ptr<RangeDeletionProgress>> _rangeDeletions;
 };
 
 }  // namespace mongo
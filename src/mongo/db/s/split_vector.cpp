@@ -44,6 +44,8 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/shard_key_pattern.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -52,6 +54,16 @@ namespace {
 const int kMaxObjectPerChunk{250000};
 const int estimatedAdditionalBytesPerItemInBSONArray{2};
 
+// The fewest sampled documents within a chunk from which its split points are estimated. Below
+// that, the relative standard error of the estimated number of documents in the chunk exceeds 10%.
+const long long kMinSamplesPerChunk{100};
+
+// Sampling stops early once every chunk has this many sampled documents
+const long long kTargetSamplesPerChunk{1000};
+
+// How often the sampling loop checks for interrupts and whether it has sampled enough
+const long long kSamplingCheckInterval{128};
+
 BSONObj prettyKey(const BSONObj& keyPattern, const BSONObj& key) {
     return key.replaceFieldNames(keyPattern).clientReadable();
 }
@@ -323,4 +335,163 @@ StatusWith<std::vector<BSONObj>> splitVector(OperationContext* opCtx,
     return splitKeys;
 }
 
+std::vector<StatusWith<std::vector<BSONObj>>> splitVectorFromSample(
+    OperationContext* opCtx,
+    const NamespaceString& nss,
+    const BSONObj& keyPattern,
+    const std::vector<ChunkRange>& ranges,
+    long long maxChunkSizeBytes,
+    long long maxSampledDocs) {
+    std::vector<boost::optional<std::vector<BSONObj>>> sampledSplitKeys(ranges.size());
+
+    [&] {
+        if (maxSampledDocs <= 0 || maxChunkSizeBytes <= 0) {
+            return;
+        }
+
+        AutoGetCollection autoColl(opCtx, nss, MODE_IS);
+
+        Collection* const collection = autoColl.getCollection();
+        if (!collection) {
+            return;
+        }
+
+        const long long recCount = collection->numRecords(opCtx);
+        const long long dataSize = collection->dataSize(opCtx);
+        if (recCount == 0 || dataSize < maxChunkSizeBytes) {
+            return;
+        }
+
+        // A chunk which is due for a split holds about 'maxChunkSizeBytes' of data. Don't spend
+        // the I/O on sampling if it is unlikely to find enough documents in such a chunk.
+        if (maxSampledDocs * (double(maxChunkSizeBytes) / dataSize) < kMinSamplesPerChunk) {
+            return;
+        }
+
+        auto cursor = collection->getRecordStore()->getRandomCursor(opCtx);
+        if (!cursor) {
+            return;
+        }
+
+        const ShardKeyPattern shardKeyPattern(keyPattern);
+        std::vector<std::vector<BSONObj>> sampledKeys(ranges.size());
+
+        Timer timer;
+        long long numSampled = 0;
+        while (numSampled < maxSampledDocs) {
+            if (numSampled % kSamplingCheckInterval == 0) {
+                opCtx->checkForInterrupt();
+
+                if (std::all_of(sampledKeys.begin(), sampledKeys.end(), [](const auto& keys) {
+                        return keys.size() >= size_t(kTargetSamplesPerChunk);
+                    })) {
+                    break;
+                }
+            }
+
+            auto record = cursor->next();
+            if (!record) {
+                break;
+            }
+            ++numSampled;
+
+            auto shardKey = shardKeyPattern.extractShardKeyFromDoc(record->data.toBson());
+            if (shardKey.isEmpty()) {
+                continue;
+            }
+
+            for (size_t i = 0; i < ranges.size(); ++i) {
+                if (ranges[i].containsKey(shardKey)) {
+                    sampledKeys[i].push_back(shardKey.getOwned());
+                    break;
+                }
+            }
+        }
+
+        const long long avgRecSize = std::max(dataSize / recCount, 1LL);
+        const long long keyCount =
+            std::min(maxChunkSizeBytes / (2 * avgRecSize), (long long)kMaxObjectPerChunk);
+
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            const long long numSampledInChunk = sampledKeys[i].size();
+            if (numSampledInChunk < kMinSamplesPerChunk) {
+                LOG(1) << "sampled only " << numSampledInChunk << " of " << numSampled
+                       << " documents in chunk " << nss << " " << redact(ranges[i].toString())
+                       << ", falling back to scanning the chunk for split points";
+                continue;
+            }
+
+            const long long estimatedDocsInChunk = recCount * numSampledInChunk / numSampled;
+            sampledSplitKeys[i] =
+                splitPointsFromSample(std::move(sampledKeys[i]), estimatedDocsInChunk, keyCount);
+
+            LOG(1) << "picked " << sampledSplitKeys[i]->size() << " split points for chunk " << nss
+                   << " " << redact(ranges[i].toString()) << " from " << numSampledInChunk
+                   << " sampled documents out of an estimated " << estimatedDocsInChunk;
+        }
+
+        if (timer.millis() > serverGlobalParams.slowMS) {
+            warning() << "Sampling " << numSampled << " documents for split points of "
+                      << ranges.size() << " chunks in " << nss.toString() << " took "
+                      << timer.millis() << "ms";
+        }
+    }();
+
+    std::vector<StatusWith<std::vector<BSONObj>>> splitKeys;
+    splitKeys.reserve(ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        if (sampledSplitKeys[i]) {
+            splitKeys.emplace_back(std::move(*sampledSplitKeys[i]));
+            continue;
+        }
+
+        splitKeys.emplace_back(splitVector(opCtx,
+                                           nss,
+                                           keyPattern,
+                                           ranges[i].getMin(),
+                                           ranges[i].getMax(),
+                                           false,
+                                           boost::none,
+                                           boost::none,
+                                           boost::none,
+                                           maxChunkSizeBytes));
+    }
+
+    return splitKeys;
+}
+
+std::vector<BSONObj> splitPointsFromSample(std::vector<BSONObj> sampledKeys,
+                                           long long estimatedDocsInChunk,
+                                           long long keyCount) {
+    std::vector<BSONObj> splitKeys;
+    if (sampledKeys.empty() || estimatedDocsInChunk <= 0 || keyCount <= 0) {
+        return splitKeys;
+    }
+
+    const auto lessThan = SimpleBSONObjComparator::kInstance.makeLessThan();
+    std::sort(sampledKeys.begin(), sampledKeys.end(), lessThan);
+
+    // Like the index walk, split after every 'keyCount' documents, which corresponds to every
+    // 'samplesPerChunk' sampled keys. The smallest sampled key stands in for the start of the
+    // chunk. All instances of a key must live in the same chunk, so a key which is the same as the
+    // previous split point moves the split point to the next larger key.
+    const double samplesPerChunk = double(keyCount) * sampledKeys.size() / estimatedDocsInChunk;
+    for (double pos = samplesPerChunk; pos < sampledKeys.size(); pos += samplesPerChunk) {
+        const auto& previous = splitKeys.empty() ? sampledKeys.front() : splitKeys.back();
+
+        auto it = sampledKeys.begin() + size_t(pos);
+        if (it->woCompare(previous) == 0) {
+            it = std::upper_bound(it, sampledKeys.end(), previous, lessThan);
+            if (it == sampledKeys.end()) {
+                break;
+            }
+            pos = it - sampledKeys.begin();
+        }
+
+        splitKeys.push_back(*it);
+    }
+
+    return splitKeys;
+}
+
 }  // namespace mongo
@@ -35,6 +35,7 @@
 namespace mongo {
 
 class BSONObj;
+class ChunkRange;
 class NamespaceString;
 class OperationContext;
 template <typename T>
@@ -67,4 +68,32 @@ StatusWith<std::vector<BSONObj>> splitVector(OperationContext* opCtx,
                                              boost::optional<long long> maxChunkSize,
                                              boost::optional<long long> maxChunkSizeBytes);
 
+/**
+ * Determines the split points for each of the chunks in 'ranges' the way splitVector does for a
+ * maximum chunk size of 'maxChunkSizeBytes', but estimates them from a single random sample of at
+ * most 'maxSampledDocs' documents of the collection, shared between all the chunks, instead of
+ * walking the shard key index over each of them.
+ *
+ * A chunk only gets sampled split points if enough of the sampled documents fall within it to
+ * bound the error of the estimate. The split points of any other chunk, and of all chunks when
+ * the storage engine has no random cursor or 'maxSampledDocs' is 0, come from splitVector.
+ */
+std::vector<StatusWith<std::vector<BSONObj>>> splitVectorFromSample(
+    OperationContext* opCtx,
+    const NamespaceString& nss,
+    const BSONObj& keyPattern,
+    const std::vector<ChunkRange>& ranges,
+    long long maxChunkSizeBytes,
+    long long maxSampledDocs);
+
+/**
+ * Picks split points from the shard keys of documents sampled uniformly from a chunk, which is
+ * estimated to hold 'estimatedDocsInChunk' documents, such that each resulting chunk holds about
+ * 'keyCount' documents. Keys which would split off no sampled documents are skipped. Exposed for
+ * unit testing.
+ */
+std::vector<BSONObj> splitPointsFromSample(std::vector<BSONObj> sampledKeys,
+                                           long long estimatedDocsInChunk,
+                                           long long keyCount);
+
 }  // namespace mongo
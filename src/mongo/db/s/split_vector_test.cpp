@@ -33,6 +33,7 @@
 
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/s/split_vector.h"
+#include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/shard_server_test_fixture.h"
 #include "mongo/unittest/unittest.h"
 
@@ -301,6 +302,83 @@ TEST_F(SplitVectorTest, NoMaxChunkSize) {
     ASSERT_EQUALS(status.code(), ErrorCodes::InvalidOptions);
 }
 
+TEST_F(SplitVectorTest, SplitVectorFromSampleMatchesSplitVectorWithoutRandomCursor) {
+    // The storage engine of the test fixture has no random cursor, so every chunk is scanned
+    const std::vector<ChunkRange> ranges{ChunkRange(BSON(kPattern << 0), BSON(kPattern << 50)),
+                                         ChunkRange(BSON(kPattern << 50), BSON(kPattern << 100))};
+    auto splitKeysByChunk = splitVectorFromSample(
+        operationContext(), kNss, BSON(kPattern << 1), ranges, getDocSizeBytes() * 20LL, 10000);
+    ASSERT_EQ(ranges.size(), splitKeysByChunk.size());
+
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        std::vector<BSONObj> expected =
+            unittest::assertGet(splitVector(operationContext(),
+                                            kNss,
+                                            BSON(kPattern << 1),
+                                            ranges[i].getMin(),
+                                            ranges[i].getMax(),
+                                            false,
+                                            boost::none,
+                                            boost::none,
+                                            boost::none,
+                                            getDocSizeBytes() * 20LL));
+        std::vector<BSONObj> splitKeys = unittest::assertGet(splitKeysByChunk[i]);
+        ASSERT_EQ(splitKeys.size(), expected.size());
+
+        for (size_t j = 0; j < expected.size(); ++j) {
+            ASSERT_BSONOBJ_EQ(splitKeys[j], expected[j]);
+        }
+    }
+}
+
+TEST_F(SplitVectorTest, SplitVectorFromSampleReportsErrorsPerChunk) {
+    const std::vector<ChunkRange> ranges{ChunkRange(BSON(kPattern << 0), BSON(kPattern << 100))};
+    auto splitKeysByChunk =
+        splitVectorFromSample(operationContext(), kNss, BSON("foo" << 1), ranges, 1LL, 10000);
+    ASSERT_EQ(1U, splitKeysByChunk.size());
+    ASSERT_EQUALS(splitKeysByChunk[0].getStatus().code(), ErrorCodes::IndexNotFound);
+}
+
+std::vector<BSONObj> makeSampledKeys(const std::vector<int>& values) {
+    std::vector<BSONObj> keys;
+    for (auto value : values) {
+        keys.push_back(BSON(kPattern << value));
+    }
+    return keys;
+}
+
+TEST(SplitPointsFromSampleTest, SplitsEveryKeyCountDocuments) {
+    // Every tenth of 1000 documents is sampled, in no particular order
+    std::vector<int> values;
+    for (int i = 99; i >= 0; --i) {
+        values.push_back(i * 10);
+    }
+
+    auto splitKeys = splitPointsFromSample(makeSampledKeys(values), 1000, 250);
+    std::vector<BSONObj> expected = makeSampledKeys({250, 500, 750});
+    ASSERT_EQ(splitKeys.size(), expected.size());
+
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_BSONOBJ_EQ(splitKeys[i], expected[i]);
+    }
+}
+
+TEST(SplitPointsFromSampleTest, FrequentKeysAreNotSplitPointsTwice) {
+    auto splitKeys =
+        splitPointsFromSample(makeSampledKeys({0, 1, 1, 1, 1, 1, 1, 1, 2, 3}), 10, 2);
+    std::vector<BSONObj> expected = makeSampledKeys({1, 2});
+    ASSERT_EQ(splitKeys.size(), expected.size());
+
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_BSONOBJ_EQ(splitKeys[i], expected[i]);
+    }
+}
+
+TEST(SplitPointsFromSampleTest, NoSplitPointsForSmallChunk) {
+    ASSERT(splitPointsFromSample(makeSampledKeys({0, 1, 2, 3}), 100, 100).empty());
+    ASSERT(splitPointsFromSample({}, 100, 10).empty());
+}
+
 const NamespaceString kJumboNss = NamespaceString("foo", "bar2");
 const std::string kJumboPattern = "a";
 
@@ -33,8 +33,10 @@
 
 #include "mongo/db/service_context.h"
 
+#include <cstddef>
 #include <list>
 #include <memory>
+#include <new>
 
 #include "mongo/base/init.h"
 #include "mongo/bson/bsonobj.h"
@@ -49,6 +51,7 @@
 #include "mongo/transport/transport_layer.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 #include "mongo/util/system_clock_source.h"
 #include "mongo/util/system_tick_source.h"
@@ -232,8 +235,47 @@ void ServiceContext::ClientDeleter::operator()(Client* client) const {
     delete client;
 }
 
+namespace {
+
+// Each OperationContext made by a ServiceContext is placed at the start of a block of memory which
+// also holds its decorations, after this offset. When the OperationContext is destroyed, its
+// Client keeps the block for its next OperationContext, so that the common case of running one
+// operation after another on a Client doesn't allocate either. The decorations themselves are
+// still constructed and destroyed with each OperationContext, which resets them.
+constexpr std::size_t kOperationContextDecorationsOffset =
+    (sizeof(OperationContext) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) *
+    alignof(std::max_align_t);
+MONGO_STATIC_ASSERT(alignof(OperationContext) <= alignof(std::max_align_t));
+
+std::size_t operationContextBlockSize() {
+    // Decorations are only declared during static initialization, so the size is fixed by now.
+    static const std::size_t size =
+        kOperationContextDecorationsOffset + OperationContext::getDecorationBufferSizeBytes();
+    return size;
+}
+
+struct OperationContextBlockDeleter {
+    void operator()(OperationContext* opCtx) const {
+        opCtx->~OperationContext();
+        ::operator delete(opCtx);
+    }
+};
+
+}  // namespace
+
 ServiceContext::UniqueOperationContext ServiceContext::makeOperationContext(Client* client) {
-    auto opCtx = std::make_unique<OperationContext>(client, _nextOpId.fetchAndAdd(1));
+    void* block = client->_recycledOperationContextBlock.swap(nullptr);
+    if (!block) {
+        block = ::operator new(operationContextBlockSize());
+    }
+    auto freeBlock = makeGuard([&] { ::operator delete(block); });
+    std::unique_ptr<OperationContext, OperationContextBlockDeleter> opCtx(
+        new (block) OperationContext(client,
+                                     _nextOpId.fetchAndAdd(1),
+                                     static_cast<unsigned char*>(block) +
+                                         kOperationContextDecorationsOffset));
+    freeBlock.dismiss();
+
     if (client->session()) {
         _numCurrentOps.addAndFetch(1);
     }
@@ -272,7 +314,10 @@ void ServiceContext::OperationContextDeleter::operator()(OperationContext* opCtx
     opCtx->getBaton()->detach();
 
     onDestroy(opCtx, service->_clientObservers);
-    delete opCtx;
+    opCtx->~OperationContext();
+
+    // Keep the memory for the client's next OperationContext, unless it already has some.
+    ::operator delete(client->_recycledOperationContextBlock.swap(opCtx));
 }
 
 void ServiceContext::registerClientObserver(std::unique_ptr<ClientObserver> observer) {
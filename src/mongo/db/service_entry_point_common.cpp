@@ -117,6 +117,9 @@ ServerStatusMetricField<Counter64> displayNotMasterUnackWrites(
 namespace {
 using logger::LogComponent;
 
+// Field of the getMore command carrying the commit point the client last learned of.
+constexpr auto kLastKnownCommittedOpTimeFieldName = "lastKnownCommittedOpTime"_sd;
+
 void generateLegacyQueryErrorResponse(const AssertionException& exception,
                                       const QueryMessage& queryMessage,
                                       CurOp* curop,
@@ -1074,6 +1077,27 @@ DbResponse receivedCommands(OperationContext* opCtx,
         if (responseObj.getField("ok").trueValue() && !cursorObj.isEmpty()) {
             dbResponse.exhaustNS = cursorObj.getField("ns").String();
             dbResponse.exhaustCursorId = cursorObj.getField("id").numberLong();
+
+            // An exhaust getMore tailing the oplog would otherwise replay the commit point the
+            // client knew about when it started the stream, and the awaitData wait would return
+            // immediately on every synthetic getMore once the commit point moves past it. Advance
+            // the client's last known commit point to the one reported in this response instead.
+            if (request.getCommandName() == "getMore"_sd &&
+                request.body.hasField(kLastKnownCommittedOpTimeFieldName) &&
+                responseObj.hasField(rpc::kOplogQueryMetadataFieldName)) {
+                auto oqMetadata = rpc::OplogQueryMetadata::readFromMetadata(responseObj);
+                if (oqMetadata.isOK()) {
+                    BSONObjBuilder nextInvocationBob;
+                    for (auto&& elem : request.body) {
+                        if (elem.fieldNameStringData() != kLastKnownCommittedOpTimeFieldName) {
+                            nextInvocationBob.append(elem);
+                        }
+                    }
+                    oqMetadata.getValue().getLastOpCommitted().opTime.append(
+                        &nextInvocationBob, kLastKnownCommittedOpTimeFieldName.toString());
+                    dbResponse.nextInvocation = nextInvocationBob.obj();
+                }
+            }
         }
     }
 
@@ -82,6 +82,7 @@
 #include "mongo/platform/atomic_word.h"
 #include "mongo/util/background.h"
 #include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/concurrency/ticket_controller.h"
 #include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/exit.h"
@@ -489,8 +490,190 @@ private:
 namespace {
 TicketHolder openWriteTransaction(128);
 TicketHolder openReadTransaction(128);
+
+// Created by the WiredTigerTicketController thread when it starts. The mutex is held while a
+// controller is updated or its statistics are reported.
+stdx::mutex ticketControllersMutex;
+std::unique_ptr<TicketController> writeTicketController;
+std::unique_ptr<TicketController> readTicketController;
 }  // namespace
 
+/**
+ * While wiredTigerAdaptiveConcurrentTransactions is set, periodically resizes the read and write
+ * ticket pools to the number of tickets chosen by a TicketController for each of them.
+ */
+class WiredTigerKVEngine::WiredTigerTicketController : public BackgroundJob {
+public:
+    explicit WiredTigerTicketController(WiredTigerSessionCache* sessionCache)
+        : BackgroundJob(false /* deleteSelf */), _sessionCache(sessionCache) {}
+
+    virtual string name() const {
+        return "WTTicketController";
+    }
+
+    virtual void run() {
+        ThreadClient tc(name(), getGlobalServiceContext());
+        LOG(1) << "starting " << name() << " thread";
+
+        {
+            TicketController::Options options;
+            options.minTickets = gWiredTigerAdaptiveConcurrentTransactionsMin;
+            options.maxTickets =
+                std::max(options.minTickets, gWiredTigerAdaptiveConcurrentTransactionsMax);
+
+            stdx::lock_guard<stdx::mutex> lk(ticketControllersMutex);
+            writeTicketController = std::make_unique<TicketController>(options);
+            readTicketController = std::make_unique<TicketController>(options);
+        }
+
+        PoolSampler writeSampler(&openWriteTransaction);
+        PoolSampler readSampler(&openReadTransaction);
+        bool enabled = false;
+        Date_t intervalStart;
+        long long lastAppEvictions = 0;
+
+        while (!_shuttingDown.load()) {
+            {
+                stdx::unique_lock<stdx::mutex> lock(_mutex);
+                MONGO_IDLE_THREAD_BLOCK;
+                // Sample the number of tickets in use several times per interval.
+                _condvar.wait_for(lock, kSamplePeriod.toSystemDuration());
+            }
+
+            if (!gWiredTigerAdaptiveConcurrentTransactions.load()) {
+                enabled = false;
+                continue;
+            }
+
+            const Date_t now = Date_t::now();
+            if (!enabled) {
+                // Start a fresh interval, since the pools may have been resized by hand meanwhile.
+                enabled = true;
+                intervalStart = now;
+                lastAppEvictions = _getAppEvictions();
+                writeSampler.reset();
+                readSampler.reset();
+                continue;
+            }
+
+            writeSampler.sampleUsed();
+            readSampler.sampleUsed();
+
+            const Milliseconds interval = now - intervalStart;
+            if (interval <
+                Milliseconds(gWiredTigerAdaptiveConcurrentTransactionsIntervalMillis.load())) {
+                continue;
+            }
+
+            // Application threads only evict pages when eviction can't keep up with the cache
+            // usage, which more concurrent transactions would only make worse.
+            const long long appEvictions = _getAppEvictions();
+            const bool cachePressure = appEvictions > lastAppEvictions;
+            lastAppEvictions = appEvictions;
+            intervalStart = now;
+
+            _adjust("write", writeTicketController.get(), &writeSampler, interval, cachePressure);
+            _adjust("read", readTicketController.get(), &readSampler, interval, cachePressure);
+        }
+        LOG(1) << "stopping " << name() << " thread";
+    }
+
+    void shutdown() {
+        _shuttingDown.store(true);
+        {
+            stdx::unique_lock<stdx::mutex> lock(_mutex);
+            _condvar.notify_one();
+        }
+        wait();
+    }
+
+private:
+    static constexpr Milliseconds kSamplePeriod{100};
+
+    /**
+     * Accumulates the load on a ticket pool between two adjustments of its size.
+     */
+    class PoolSampler {
+    public:
+        explicit PoolSampler(TicketHolder* holder) : _holder(holder) {
+            reset();
+        }
+
+        TicketHolder* holder() const {
+            return _holder;
+        }
+
+        void reset() {
+            _numReleased = _holder->numReleased();
+            _numWaited = _holder->numWaited();
+            _usedSum = 0;
+            _numUsedSamples = 0;
+        }
+
+        void sampleUsed() {
+            _usedSum += _holder->used();
+            ++_numUsedSamples;
+        }
+
+        TicketController::Sample take(Milliseconds interval, bool cachePressure) {
+            TicketController::Sample sample;
+            sample.interval = interval;
+            sample.numReleased = _holder->numReleased() - _numReleased;
+            sample.numWaited = _holder->numWaited() - _numWaited;
+            sample.averageUsed = _numUsedSamples ? _usedSum / _numUsedSamples : 0;
+            sample.cachePressure = cachePressure;
+            reset();
+            return sample;
+        }
+
+    private:
+        TicketHolder* const _holder;
+        long long _numReleased = 0;
+        long long _numWaited = 0;
+        double _usedSum = 0;
+        int _numUsedSamples = 0;
+    };
+
+    long long _getAppEvictions() {
+        auto session = _sessionCache->getSession();
+        auto result = WiredTigerUtil::getStatisticsValue(
+            session->getSession(), "statistics:", "", WT_STAT_CONN_CACHE_EVICTION_APP);
+        return result.isOK() ? result.getValue() : 0;
+    }
+
+    void _adjust(StringData poolName,
+                 TicketController* controller,
+                 PoolSampler* sampler,
+                 Milliseconds interval,
+                 bool cachePressure) {
+        const int currentTickets = sampler->holder()->outof();
+        int newTickets;
+        {
+            stdx::lock_guard<stdx::mutex> lk(ticketControllersMutex);
+            newTickets = controller->update(currentTickets, sampler->take(interval, cachePressure));
+        }
+        if (newTickets == currentTickets) {
+            return;
+        }
+
+        // Shrinking the pool waits for tickets in use to be released.
+        Status status = sampler->holder()->resize(newTickets);
+        if (!status.isOK()) {
+            warning() << "Failed to resize the WiredTiger " << poolName << " ticket pool to "
+                      << newTickets << ": " << status;
+            return;
+        }
+        LOG(1) << "Resized the WiredTiger " << poolName << " ticket pool from " << currentTickets
+               << " to " << newTickets << " tickets";
+    }
+
+    WiredTigerSessionCache* _sessionCache;
+    AtomicWord<bool> _shuttingDown{false};
+
+    stdx::mutex _mutex;  // protects _condvar
+    stdx::condition_variable _condvar;
+};
+
 OpenWriteTransactionParam::OpenWriteTransactionParam(StringData name, ServerParameterType spt)
     : ServerParameter(name, spt), _data(&openWriteTransaction) {}
 
@@ -703,6 +886,9 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
     _sessionSweeper = std::make_unique<WiredTigerSessionSweeper>(_sessionCache.get());
     _sessionSweeper->go();
 
+    _ticketController = std::make_unique<WiredTigerTicketController>(_sessionCache.get());
+    _ticketController->go();
+
     // Until the Replication layer installs a real callback, prevent truncating the oplog.
     setOldestActiveTransactionTimestampCallback(
         [](Timestamp) { return StatusWith(boost::make_optional(Timestamp::min())); });
@@ -760,12 +946,17 @@ void WiredTigerKVEngine::startAsyncThreads() {
 }
 
 void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
+    stdx::lock_guard<stdx::mutex> lk(ticketControllersMutex);
     BSONObjBuilder bb(b.subobjStart("concurrentTransactions"));
     {
         BSONObjBuilder bbb(bb.subobjStart("write"));
         bbb.append("out", openWriteTransaction.used());
         bbb.append("available", openWriteTransaction.available());
         bbb.append("totalTickets", openWriteTransaction.outof());
+        if (gWiredTigerAdaptiveConcurrentTransactions.load() && writeTicketController) {
+            BSONObjBuilder adaptive(bbb.subobjStart("adaptive"));
+            writeTicketController->appendStats(&adaptive);
+        }
         bbb.done();
     }
     {
@@ -773,6 +964,10 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("out", openReadTransaction.used());
         bbb.append("available", openReadTransaction.available());
         bbb.append("totalTickets", openReadTransaction.outof());
+        if (gWiredTigerAdaptiveConcurrentTransactions.load() && readTicketController) {
+            BSONObjBuilder adaptive(bbb.subobjStart("adaptive"));
+            readTicketController->appendStats(&adaptive);
+        }
         bbb.done();
     }
     bb.done();
@@ -854,6 +1049,11 @@ void WiredTigerKVEngine::cleanShutdown() {
         _sessionSweeper->shutdown();
         log() << "Finished shutting down session sweeper thread";
     }
+    if (_ticketController) {
+        log() << "Shutting down ticket controller thread";
+        _ticketController->shutdown();
+        log() << "Finished shutting down ticket controller thread";
+    }
     if (_journalFlusher) {
         log() << "Shutting down journal flusher thread";
         _journalFlusher->shutdown();
@@ -0,0 +1,64 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/update/update_executor.h"
+
+#include "mongo/db/update/doc_diff.h"
+#include "mongo/db/update/log_builder.h"
+#include "mongo/db/update/object_replace_executor.h"
+
+namespace mongo {
+
+/**
+ * An UpdateExecutor which applies a '$v: 2' oplog entry, i.e. a document diff computed by
+ * doc_diff::computeDiff() against the pre-image of the update. Only used for oplog application.
+ */
+class DeltaExecutor : public UpdateExecutor {
+public:
+    explicit DeltaExecutor(BSONObj diff) : _diff(diff.getOwned()) {}
+
+    ApplyResult applyUpdate(ApplyParams applyParams) const final {
+        auto postImage =
+            doc_diff::applyDiff(applyParams.element.getDocument().getObject(), _diff);
+        return ObjectReplaceExecutor::applyReplacementUpdate(applyParams, postImage, true);
+    }
+
+    Value serialize() const final {
+        return Value(BSON(LogBuilder::kUpdateSemanticsFieldName
+                          << static_cast<int>(UpdateSemantics::kDelta)
+                          << LogBuilder::kDeltaFieldName << _diff));
+    }
+
+private:
+    BSONObj _diff;
+};
+
+}  // namespace mongo
@@ -0,0 +1,417 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/update/doc_diff.h"
+
+#include <algorithm>
+#include <map>
+
+#include "mongo/base/error_codes.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/str.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+namespace doc_diff {
+
+namespace {
+
+constexpr StringData kDeleteSectionFieldName = "d"_sd;
+constexpr StringData kUpdateSectionFieldName = "u"_sd;
+constexpr StringData kInsertSectionFieldName = "i"_sd;
+constexpr StringData kArrayHeaderFieldName = "a"_sd;
+constexpr char kSubDiffPrefix = 's';
+constexpr char kArrayUpdatePrefix = 'u';
+
+bool computeObjectDiff(const BSONObj& pre, const BSONObj& post, BSONObjBuilder* builder);
+bool computeArrayDiff(const BSONObj& pre, const BSONObj& post, BSONObjBuilder* builder);
+
+bool valuesEqual(const BSONElement& lhs, const BSONElement& rhs) {
+    return lhs.type() == rhs.type() && lhs.binaryEqualValues(rhs);
+}
+
+/**
+ * Records the change of a field from 'preElem' to 'postElem'. When both are objects or both are
+ * arrays and the recursive diff is smaller than the new value, the sub-diff is appended to
+ * 'subDiffs' under 'subDiffFieldName'; otherwise the new value is appended to 'updates' under
+ * 'updateFieldName'.
+ */
+void appendElementDiff(const BSONElement& preElem,
+                       const BSONElement& postElem,
+                       StringData updateFieldName,
+                       BSONObjBuilder* updates,
+                       StringData subDiffFieldName,
+                       BSONObjBuilder* subDiffs) {
+    if (preElem.type() == postElem.type() &&
+        (postElem.type() == BSONType::Object || postElem.type() == BSONType::Array)) {
+        BSONObjBuilder subDiffBuilder;
+        bool diffed = postElem.type() == BSONType::Object
+            ? computeObjectDiff(preElem.Obj(), postElem.Obj(), &subDiffBuilder)
+            : computeArrayDiff(preElem.Obj(), postElem.Obj(), &subDiffBuilder);
+        if (diffed) {
+            auto subDiff = subDiffBuilder.done();
+            if (subDiff.objsize() < postElem.valuesize()) {
+                subDiffs->append(subDiffFieldName, subDiff);
+                return;
+            }
+        }
+    }
+    updates->appendAs(postElem, updateFieldName);
+}
+
+/**
+ * Appends to 'builder' the diff which turns object 'pre' into object 'post'. Returns false if the
+ * objects cannot be diffed because one of them has duplicate field names.
+ */
+bool computeObjectDiff(const BSONObj& pre, const BSONObj& post, BSONObjBuilder* builder) {
+    StringMap<BSONElement> preFields;
+    for (auto&& elem : pre) {
+        if (!preFields.emplace(elem.fieldNameStringData().toString(), elem).second) {
+            return false;
+        }
+    }
+    StringMap<BSONElement> postFields;
+    for (auto&& elem : post) {
+        if (!postFields.emplace(elem.fieldNameStringData().toString(), elem).second) {
+            return false;
+        }
+    }
+
+    BSONObjBuilder deletes;
+    BSONObjBuilder updates;
+    BSONObjBuilder inserts;
+    BSONObjBuilder subDiffs;
+
+    for (auto&& elem : pre) {
+        if (postFields.find(elem.fieldNameStringData()) == postFields.end()) {
+            deletes.appendBool(elem.fieldNameStringData(), false);
+        }
+    }
+
+    // Fields which survive keep their position relative to one another and inserted fields go at
+    // the end, so once a field of 'post' is out of order with respect to 'pre', it and every field
+    // after it must be removed and appended again.
+    BSONObjIterator preIt(pre);
+    bool appending = false;
+    for (auto&& postElem : post) {
+        auto fieldName = postElem.fieldNameStringData();
+        if (!appending) {
+            while (preIt.more() &&
+                   postFields.find((*preIt).fieldNameStringData()) == postFields.end()) {
+                preIt.next();
+            }
+            if (preIt.more() && (*preIt).fieldNameStringData() == fieldName) {
+                auto preElem = preIt.next();
+                if (!valuesEqual(preElem, postElem)) {
+                    std::string subDiffFieldName = str::stream() << kSubDiffPrefix << fieldName;
+                    appendElementDiff(
+                        preElem, postElem, fieldName, &updates, subDiffFieldName, &subDiffs);
+                }
+                continue;
+            }
+            appending = true;
+        }
+        if (preFields.find(fieldName) != preFields.end()) {
+            deletes.appendBool(fieldName, false);
+        }
+        inserts.append(postElem);
+    }
+
+    if (!deletes.asTempObj().isEmpty()) {
+        builder->append(kDeleteSectionFieldName, deletes.done());
+    }
+    if (!updates.asTempObj().isEmpty()) {
+        builder->append(kUpdateSectionFieldName, updates.done());
+    }
+    if (!inserts.asTempObj().isEmpty()) {
+        builder->append(kInsertSectionFieldName, inserts.done());
+    }
+    builder->appendElements(subDiffs.done());
+    return true;
+}
+
+/**
+ * Appends to 'builder' the diff which turns array 'pre' into array 'post'. Returns false if 'post'
+ * is shorter than 'pre', since array diffs only describe arrays which keep or grow their length.
+ */
+bool computeArrayDiff(const BSONObj& pre, const BSONObj& post, BSONObjBuilder* builder) {
+    std::vector<BSONElement> preElems;
+    pre.elems(preElems);
+    std::vector<BSONElement> postElems;
+    post.elems(postElems);
+    if (postElems.size() < preElems.size()) {
+        return false;
+    }
+
+    builder->appendBool(kArrayHeaderFieldName, true);
+    for (size_t i = 0; i < postElems.size(); ++i) {
+        if (i < preElems.size() && valuesEqual(preElems[i], postElems[i])) {
+            continue;
+        }
+
+        std::string updateFieldName = str::stream() << kArrayUpdatePrefix << i;
+        if (i >= preElems.size()) {
+            builder->appendAs(postElems[i], updateFieldName);
+            continue;
+        }
+        std::string subDiffFieldName = str::stream() << kSubDiffPrefix << i;
+        appendElementDiff(
+            preElems[i], postElems[i], updateFieldName, builder, subDiffFieldName, builder);
+    }
+    return true;
+}
+
+BSONObj applyObjectDiff(const BSONObj& pre, const BSONObj& diff);
+BSONObj applyArrayDiff(const BSONObj& pre, const BSONObj& diff);
+
+bool isArrayDiff(const BSONObj& diff) {
+    return diff[kArrayHeaderFieldName].trueValue();
+}
+
+/**
+ * Applies 'subDiff' to 'preElem', which may be missing or of the wrong type if the sub-diff is
+ * being re-applied, and returns the result along with whether it is an array.
+ */
+std::pair<BSONObj, bool> applySubDiff(const BSONElement& preElem, const BSONElement& subDiff) {
+    uassert(ErrorCodes::FailedToParse,
+            str::stream() << "Sub-diff '" << subDiff.fieldNameStringData()
+                          << "' must be an object",
+            subDiff.type() == BSONType::Object);
+
+    auto diff = subDiff.embeddedObject();
+    if (isArrayDiff(diff)) {
+        auto preArray = preElem.type() == BSONType::Array ? preElem.embeddedObject() : BSONObj();
+        return {applyArrayDiff(preArray, diff), true};
+    }
+    auto preObj = preElem.type() == BSONType::Object ? preElem.embeddedObject() : BSONObj();
+    return {applyObjectDiff(preObj, diff), false};
+}
+
+void appendSubDiffResult(StringData fieldName,
+                         const std::pair<BSONObj, bool>& result,
+                         BSONObjBuilder* builder) {
+    if (result.second) {
+        builder->appendArray(fieldName, result.first);
+    } else {
+        builder->append(fieldName, result.first);
+    }
+}
+
+StringMap<BSONElement> parseDiffSection(const BSONElement& section) {
+    uassert(ErrorCodes::FailedToParse,
+            str::stream() << "Diff section '" << section.fieldNameStringData()
+                          << "' must be an object",
+            section.type() == BSONType::Object);
+
+    StringMap<BSONElement> fields;
+    for (auto&& elem : section.embeddedObject()) {
+        fields.emplace(elem.fieldNameStringData().toString(), elem);
+    }
+    return fields;
+}
+
+BSONObj applyObjectDiff(const BSONObj& pre, const BSONObj& diff) {
+    StringMap<BSONElement> deletes;
+    StringMap<BSONElement> updates;
+    StringMap<BSONElement> subDiffs;
+    StringMap<BSONElement> inserts;
+    BSONObj updateSection;
+    BSONObj insertSection;
+    for (auto&& elem : diff) {
+        auto fieldName = elem.fieldNameStringData();
+        if (fieldName == kDeleteSectionFieldName) {
+            deletes = parseDiffSection(elem);
+        } else if (fieldName == kUpdateSectionFieldName) {
+            updates = parseDiffSection(elem);
+            updateSection = elem.embeddedObject();
+        } else if (fieldName == kInsertSectionFieldName) {
+            inserts = parseDiffSection(elem);
+            insertSection = elem.embeddedObject();
+        } else {
+            uassert(ErrorCodes::FailedToParse,
+                    str::stream() << "Unrecognized field in document diff: '" << fieldName << "'",
+                    !fieldName.empty() && fieldName[0] == kSubDiffPrefix);
+            subDiffs.emplace(fieldName.substr(1).toString(), elem);
+        }
+    }
+
+    BSONObjBuilder builder;
+    StringSet seen;
+    for (auto&& preElem : pre) {
+        auto fieldName = preElem.fieldNameStringData();
+        seen.insert(fieldName.toString());
+
+        // Inserted fields are appended below. A field which is already present can only have
+        // been inserted by an earlier application of this diff.
+        if (deletes.count(fieldName) || inserts.count(fieldName)) {
+            continue;
+        }
+        if (auto it = updates.find(fieldName); it != updates.end()) {
+            builder.appendAs(it->second, fieldName);
+        } else if (auto it = subDiffs.find(fieldName); it != subDiffs.end()) {
+            appendSubDiffResult(fieldName, applySubDiff(preElem, it->second), &builder);
+        } else {
+            builder.append(preElem);
+        }
+    }
+
+    // Updates and sub-diffs of fields which are absent from 'pre' are appended, so that
+    // re-applying a diff to a document that has since lost the field still converges.
+    for (auto&& elem : updateSection) {
+        if (!seen.count(elem.fieldNameStringData())) {
+            builder.append(elem);
+        }
+    }
+    for (auto&& elem : diff) {
+        auto fieldName = elem.fieldNameStringData();
+        if (fieldName.empty() || fieldName[0] != kSubDiffPrefix ||
+            seen.count(fieldName.substr(1))) {
+            continue;
+        }
+        appendSubDiffResult(fieldName.substr(1), applySubDiff(BSONElement(), elem), &builder);
+    }
+    builder.appendElements(insertSection);
+    return builder.obj();
+}
+
+BSONObj applyArrayDiff(const BSONObj& pre, const BSONObj& diff) {
+    std::map<size_t, BSONElement> updates;
+    std::map<size_t, BSONElement> subDiffs;
+    size_t length = 0;
+    for (auto&& elem : diff) {
+        auto fieldName = elem.fieldNameStringData();
+        if (fieldName == kArrayHeaderFieldName) {
+            continue;
+        }
+
+        auto index = fieldName.empty() ? boost::none
+                                       : str::parseUnsignedBase10Integer(fieldName.substr(1));
+        uassert(ErrorCodes::FailedToParse,
+                str::stream() << "Unrecognized field in array diff: '" << fieldName << "'",
+                index &&
+                    (fieldName[0] == kArrayUpdatePrefix || fieldName[0] == kSubDiffPrefix));
+        (fieldName[0] == kArrayUpdatePrefix ? updates : subDiffs)[*index] = elem;
+        length = std::max(length, *index + 1);
+    }
+
+    std::vector<BSONElement> preElems;
+    pre.elems(preElems);
+    length = std::max(length, preElems.size());
+
+    BSONObjBuilder builder;
+    for (size_t i = 0; i < length; ++i) {
+        auto fieldName = std::to_string(i);
+        auto preElem = i < preElems.size() ? preElems[i] : BSONElement();
+        if (auto it = updates.find(i); it != updates.end()) {
+            builder.appendAs(it->second, fieldName);
+        } else if (auto it = subDiffs.find(i); it != subDiffs.end()) {
+            appendSubDiffResult(fieldName, applySubDiff(preElem, it->second), &builder);
+        } else if (!preElem.eoo()) {
+            builder.append(preElem);
+        } else {
+            builder.appendNull(fieldName);
+        }
+    }
+    return builder.obj();
+}
+
+void flattenDiffAtPath(const BSONObj& diff,
+                       const std::string& prefix,
+                       BSONObjBuilder* updatedFields,
+                       std::vector<std::string>* removedFields) {
+    auto path = [&](StringData fieldName) { return prefix + fieldName.toString(); };
+
+    if (isArrayDiff(diff)) {
+        for (auto&& elem : diff) {
+            auto fieldName = elem.fieldNameStringData();
+            if (fieldName == kArrayHeaderFieldName) {
+                continue;
+            }
+            if (fieldName[0] == kArrayUpdatePrefix) {
+                updatedFields->appendAs(elem, path(fieldName.substr(1)));
+            } else {
+                flattenDiffAtPath(
+                    elem.Obj(), path(fieldName.substr(1)) + '.', updatedFields, removedFields);
+            }
+        }
+        return;
+    }
+
+    // A field which is moved is deleted and inserted again, but it has not been removed.
+    auto inserted = diff[kInsertSectionFieldName];
+    auto insertSection = inserted.type() == BSONType::Object ? inserted.Obj() : BSONObj();
+
+    for (auto&& elem : diff) {
+        auto fieldName = elem.fieldNameStringData();
+        if (fieldName == kDeleteSectionFieldName) {
+            for (auto&& deleted : elem.Obj()) {
+                if (!insertSection.hasField(deleted.fieldNameStringData())) {
+                    removedFields->push_back(path(deleted.fieldNameStringData()));
+                }
+            }
+        } else if (fieldName == kUpdateSectionFieldName || fieldName == kInsertSectionFieldName) {
+            for (auto&& updated : elem.Obj()) {
+                updatedFields->appendAs(updated, path(updated.fieldNameStringData()));
+            }
+        } else {
+            flattenDiffAtPath(
+                elem.Obj(), path(fieldName.substr(1)) + '.', updatedFields, removedFields);
+        }
+    }
+}
+
+}  // namespace
+
+boost::optional<BSONObj> computeDiff(const BSONObj& pre, const BSONObj& post) {
+    BSONObjBuilder builder;
+    if (!computeObjectDiff(pre, post, &builder)) {
+        return boost::none;
+    }
+
+    auto diff = builder.obj();
+    if (diff.objsize() >= post.objsize()) {
+        return boost::none;
+    }
+    return diff;
+}
+
+BSONObj applyDiff(const BSONObj& pre, const BSONObj& diff) {
+    return applyObjectDiff(pre, diff);
+}
+
+void flattenDiff(const BSONObj& diff,
+                 BSONObjBuilder* updatedFields,
+                 std::vector<std::string>* removedFields) {
+    flattenDiffAtPath(diff, "", updatedFields, removedFields);
+}
+
+}  // namespace doc_diff
+}  // namespace mongo
@@ -0,0 +1,78 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+
+namespace mongo {
+namespace doc_diff {
+
+/**
+ * A compact structural description of how one document differs from another, used as the body of
+ * '$v: 2' update oplog entries. An object diff has the shape
+ *
+ *   {d: {<field>: false, ...},    // fields removed from the document
+ *    u: {<field>: <value>, ...},  // fields whose value is replaced in place
+ *    i: {<field>: <value>, ...},  // fields appended after all remaining fields
+ *    s<field>: <sub-diff>, ...}   // objects or arrays which are modified recursively
+ *
+ * and an array diff has the shape {a: true, u<index>: <value>, s<index>: <sub-diff>, ...}. Array
+ * diffs never shrink an array; a shortened array is recorded as a plain update of the field.
+ */
+
+/**
+ * Computes a diff which, when passed to applyDiff() along with 'pre', produces exactly 'post'
+ * (including field order). Returns boost::none when the diff would not be smaller than 'post', or
+ * when either document contains duplicate field names at the top level.
+ */
+boost::optional<BSONObj> computeDiff(const BSONObj& pre, const BSONObj& post);
+
+/**
+ * Applies 'diff' to 'pre' and returns the resulting document. Applying a diff more than once, or
+ * to a document which already reflects part of it, yields the same result as applying it once to
+ * the original pre-image, as is required for oplog application. Throws if 'diff' is malformed.
+ */
+BSONObj applyDiff(const BSONObj& pre, const BSONObj& diff);
+
+/**
+ * Flattens 'diff' into the dotted paths it sets and the dotted paths it removes, in the format used
+ * by the 'updateDescription' of change stream update events.
+ */
+void flattenDiff(const BSONObj& diff,
+                 BSONObjBuilder* updatedFields,
+                 std::vector<std::string>* removedFields);
+
+}  // namespace doc_diff
+}  // namespace mongo
@@ -0,0 +1,155 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/update/doc_diff.h"
+
+#include "mongo/bson/bsonmisc.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Computes the diff from 'pre' to 'post', checks that it applies back to exactly 'post' (including
+ * on re-application) and returns it.
+ */
+BSONObj assertRoundTrip(const BSONObj& pre, const BSONObj& post) {
+    auto diff = doc_diff::computeDiff(pre, post);
+    ASSERT(diff);
+    ASSERT_LT(diff->objsize(), post.objsize());
+
+    auto applied = doc_diff::applyDiff(pre, *diff);
+    ASSERT_BSONOBJ_EQ(post, applied);
+    ASSERT_TRUE(post.binaryEqual(applied));
+    ASSERT_TRUE(post.binaryEqual(doc_diff::applyDiff(applied, *diff)));
+    return *diff;
+}
+
+// Padding which makes the documents below large enough for a diff to be worthwhile.
+const std::string kPad(100, 'x');
+
+TEST(DocDiffTest, UpdatesSingleField) {
+    auto pre = BSON("_id" << 1 << "a" << 1 << "pad" << kPad);
+    auto post = BSON("_id" << 1 << "a" << 2 << "pad" << kPad);
+    ASSERT_BSONOBJ_EQ(fromjson("{u: {a: 2}}"), assertRoundTrip(pre, post));
+}
+
+TEST(DocDiffTest, DeletesAndInsertsFields) {
+    auto pre = BSON("_id" << 1 << "a" << 1 << "pad" << kPad);
+    auto post = BSON("_id" << 1 << "pad" << kPad << "b" << 2);
+    ASSERT_BSONOBJ_EQ(fromjson("{d: {a: false}, i: {b: 2}}"), assertRoundTrip(pre, post));
+}
+
+TEST(DocDiffTest, ReordersFieldsByReinsertingThem) {
+    auto pre = BSON("_id" << 1 << "pad" << kPad << "a" << 1 << "b" << 2);
+    auto post = BSON("_id" << 1 << "pad" << kPad << "b" << 2 << "a" << 1);
+    ASSERT_BSONOBJ_EQ(fromjson("{d: {b: false, a: false}, i: {b: 2, a: 1}}"),
+                      assertRoundTrip(pre, post));
+}
+
+TEST(DocDiffTest, RecursesIntoSubObjects) {
+    auto pre = BSON("_id" << 1 << "obj" << BSON("a" << 1 << "pad" << kPad));
+    auto post = BSON("_id" << 1 << "obj" << BSON("a" << 2 << "pad" << kPad));
+    ASSERT_BSONOBJ_EQ(fromjson("{sobj: {u: {a: 2}}}"), assertRoundTrip(pre, post));
+}
+
+TEST(DocDiffTest, RecursesIntoArrays) {
+    auto pre = BSON("_id" << 1 << "arr" << BSON_ARRAY(kPad << 1 << BSON("a" << 1)));
+    auto post = BSON("_id" << 1 << "arr" << BSON_ARRAY(kPad << 2 << BSON("a" << 1) << 3));
+    ASSERT_BSONOBJ_EQ(fromjson("{sarr: {a: true, u1: 2, u3: 3}}"), assertRoundTrip(pre, post));
+}
+
+TEST(DocDiffTest, ShortenedArrayIsReplacedInFull) {
+    auto pre = BSON("_id" << 1 << "pad" << kPad << "arr" << BSON_ARRAY(1 << 2 << 3));
+    auto post = BSON("_id" << 1 << "pad" << kPad << "arr" << BSON_ARRAY(1));
+    ASSERT_BSONOBJ_EQ(fromjson("{u: {arr: [1]}}"), assertRoundTrip(pre, post));
+}
+
+TEST(DocDiffTest, ChangedTypeIsReplacedInFull) {
+    auto pre = BSON("_id" << 1 << "pad" << kPad << "a" << BSON("b" << 1));
+    auto post = BSON("_id" << 1 << "pad" << kPad << "a" << BSON_ARRAY(1));
+    ASSERT_BSONOBJ_EQ(fromjson("{u: {a: [1]}}"), assertRoundTrip(pre, post));
+}
+
+TEST(DocDiffTest, NoDiffWhenNotSmallerThanPostImage) {
+    ASSERT_FALSE(doc_diff::computeDiff(BSON("a" << 1), BSON("b" << 2)));
+}
+
+TEST(DocDiffTest, NoDiffWithDuplicateFieldNames) {
+    auto pre = BSON("a" << 1 << "a" << 2 << "pad" << kPad);
+    auto post = BSON("a" << 3 << "pad" << kPad);
+    ASSERT_FALSE(doc_diff::computeDiff(pre, post));
+}
+
+TEST(DocDiffTest, ApplyingToDocumentMissingUpdatedFieldAppendsIt) {
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1, b: 1, a: 2, c: {d: 1}}"),
+                      doc_diff::applyDiff(fromjson("{_id: 1, b: 1}"),
+                                          fromjson("{u: {a: 2}, sc: {i: {d: 1}}}")));
+}
+
+TEST(DocDiffTest, ApplyingMalformedDiffThrows) {
+    ASSERT_THROWS_CODE(doc_diff::applyDiff(fromjson("{a: 1}"), fromjson("{x: 1}")),
+                       DBException,
+                       ErrorCodes::FailedToParse);
+    ASSERT_THROWS_CODE(
+        doc_diff::applyDiff(fromjson("{a: [1]}"), fromjson("{sa: {a: true, x: 1}}")),
+        DBException,
+        ErrorCodes::FailedToParse);
+}
+
+TEST(DocDiffTest, FlattenDiffProducesDottedPaths) {
+    BSONObjBuilder updatedFields;
+    std::vector<std::string> removedFields;
+    doc_diff::flattenDiff(fromjson("{d: {x: false}, u: {a: 1}, i: {b: 2},"
+                                   " sobj: {u: {c: 3}}, sarr: {a: true, u2: 4}}"),
+                          &updatedFields,
+                          &removedFields);
+    ASSERT_BSONOBJ_EQ(fromjson("{a: 1, b: 2, 'obj.c': 3, 'arr.2': 4}"), updatedFields.obj());
+    ASSERT_EQ(1U, removedFields.size());
+    ASSERT_EQ("x", removedFields[0]);
+}
+
+TEST(DocDiffTest, FlattenDiffDoesNotReportReorderedFieldsAsRemoved) {
+    auto pre = BSON("_id" << 1 << "pad" << kPad << "a" << 1 << "b" << 2 << "c" << 3);
+    auto post = BSON("_id" << 1 << "pad" << kPad << "b" << 2 << "a" << 1);
+    auto diff = assertRoundTrip(pre, post);
+
+    BSONObjBuilder updatedFields;
+    std::vector<std::string> removedFields;
+    doc_diff::flattenDiff(diff, &updatedFields, &removedFields);
+    ASSERT_BSONOBJ_EQ(fromjson("{b: 2, a: 1}"), updatedFields.obj());
+    ASSERT_EQ(1U, removedFields.size());
+    ASSERT_EQ("c", removedFields[0]);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -40,6 +40,7 @@ const char kUnset[] = "$unset";
 }  // namespace
 
 constexpr StringData LogBuilder::kUpdateSemanticsFieldName;
+constexpr StringData LogBuilder::kDeltaFieldName;
 
 inline Status LogBuilder::addToSection(Element newElt, Element* section, const char* sectionName) {
     // If we don't already have this section, try to create it now.
@@ -172,6 +173,27 @@ Status LogBuilder::getReplacementObject(Element* outElt) {
     return Status::OK();
 }
 
+Status LogBuilder::setDelta(const BSONObj& diff) {
+    if (hasObjectReplacement() || _setAccumulator.ok() || _unsetAccumulator.ok()) {
+        return Status(ErrorCodes::IllegalOperation,
+                      "LogBuilder: Invalid attempt to add a diff to a log with existing object "
+                      "replacement or $set/$unset entries");
+    }
+
+    Status status = setUpdateSemantics(UpdateSemantics::kDelta);
+    if (!status.isOK())
+        return status;
+
+    mutablebson::Document& doc = _logRoot.getDocument();
+    const Element diffElement = doc.makeElementObject(kDeltaFieldName, diff);
+    if (!diffElement.ok())
+        return Status(ErrorCodes::InternalError, "LogBuilder: failed to construct diff Element");
+
+    // A diff excludes any other kind of entry, including an object replacement.
+    _objectReplacementAccumulator = doc.end();
+    return _logRoot.pushBack(diffElement);
+}
+
 inline bool LogBuilder::hasObjectReplacement() const {
     if (!_objectReplacementAccumulator.ok())
         return false;
@@ -43,6 +43,11 @@ enum class UpdateSemantics {
     // system introduces support for arrayFilters and $[] syntax.
     kUpdateNode = 1,
 
+    // The change to the document is described by a structural diff against its pre-image, stored
+    // in a "diff" field alongside "$v" (see doc_diff.h). Used to log pipeline-style updates
+    // without writing out the full post-image.
+    kDelta = 2,
+
     // Must be last.
     kNumUpdateSemantics
 };
@@ -55,6 +60,7 @@ enum class UpdateSemantics {
 class LogBuilder {
 public:
     static constexpr StringData kUpdateSemanticsFieldName = "$v"_sd;
+    static constexpr StringData kDeltaFieldName = "diff"_sd;
 
     /** Construct a new LogBuilder. Log entries will be recorded as new children under the
      *  'logRoot' Element, which must be of type mongo::Object and have no children.
@@ -125,6 +131,12 @@ public:
      */
     Status getReplacementObject(mutablebson::Element* outElt);
 
+    /**
+     * Record the update as the document diff 'diff', along with a "$v" field of 'kDelta'. Fails
+     * if the log already has $set/$unset entries, an object replacement or a "$v" field.
+     */
+    Status setDelta(const BSONObj& diff);
+
 private:
     // Returns true if the object replacement accumulator is valid and has children, false
     // otherwise.
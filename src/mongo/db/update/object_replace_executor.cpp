@@ -36,6 +36,7 @@
 #include "mongo/db/logical_clock.h"
 #include "mongo/db/logical_time.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/update/doc_diff.h"
 #include "mongo/db/update/storage_validation.h"
 
 namespace mongo {
@@ -141,6 +142,15 @@ UpdateExecutor::ApplyResult ObjectReplaceExecutor::applyReplacementUpdate(
         }
     }
 
+    if (applyParams.logBuilder && applyParams.allowDeltaLogging) {
+        auto diff =
+            doc_diff::computeDiff(originalDoc, applyParams.element.getDocument().getObject());
+        if (diff) {
+            invariant(applyParams.logBuilder->setDelta(*diff));
+            return ApplyResult();
+        }
+    }
+
     if (applyParams.logBuilder) {
         auto replacementObject = applyParams.logBuilder->getDocument().end();
         invariant(applyParams.logBuilder->getReplacementObject(&replacementObject));
@@ -47,7 +47,8 @@ class ObjectReplaceExecutor : public UpdateExecutor {
 public:
     // Applies a replacement style update to 'applyParams.element'. If
     // 'replacementDocContainsIdField' is false then the _id field from the original document will
-    // be preserved.
+    // be preserved. If 'applyParams.allowDeltaLogging' is set, the update is logged as a diff
+    // against the original document whenever the diff is smaller than the new document.
     static ApplyResult applyReplacementUpdate(ApplyParams applyParams,
                                               const BSONObj& replacementDoc,
                                               bool replacementDocContainsIdField);
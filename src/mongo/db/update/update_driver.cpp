@@ -38,7 +38,9 @@
 #include "mongo/db/field_ref.h"
 #include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/matcher/extensions_callback_noop.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/update/delta_executor.h"
 #include "mongo/db/update/log_builder.h"
 #include "mongo/db/update/modifier_table.h"
 #include "mongo/db/update/object_replace_executor.h"
@@ -60,8 +62,10 @@ StatusWith<UpdateSemantics> updateSemanticsFromElement(BSONElement element) {
 
     auto updateSemantics = element.numberLong();
 
-    // As of 3.7, we only support one version of the update language.
-    if (updateSemantics != static_cast<int>(UpdateSemantics::kUpdateNode)) {
+    // As of 3.7, we only support one version of the update language. Oplog entries may also carry
+    // a document diff in place of an update expression.
+    if (updateSemantics != static_cast<int>(UpdateSemantics::kUpdateNode) &&
+        updateSemantics != static_cast<int>(UpdateSemantics::kDelta)) {
         return {ErrorCodes::Error(40682),
                 str::stream() << "Unrecognized value for '$v' (UpdateSemantics) field: "
                               << updateSemantics};
@@ -178,7 +182,8 @@ void UpdateDriver::parse(
     // Some versions of mongod support more than one version of the update language and look for a
     // $v "UpdateSemantics" field when applying an oplog entry, in order to know which version of
     // the update language to apply with. We currently only support the 'kUpdateNode' version, but
-    // we parse $v and check its value for compatibility.
+    // we parse $v and check its value for compatibility. A 'kDelta' entry carries a document diff
+    // rather than an update expression.
     auto updateExpr = updateMod.getUpdateClassic();
     BSONElement updateSemanticsElement = updateExpr[LogBuilder::kUpdateSemanticsFieldName];
     if (updateSemanticsElement) {
@@ -186,7 +191,22 @@ void UpdateDriver::parse(
                 "The $v update field is only recognized internally",
                 _fromOplogApplication);
 
-        uassertStatusOK(updateSemanticsFromElement(updateSemanticsElement));
+        auto updateSemantics = uassertStatusOK(updateSemanticsFromElement(updateSemanticsElement));
+        if (updateSemantics == UpdateSemantics::kDelta) {
+            uassert(ErrorCodes::FailedToParse,
+                    "arrayFilters may not be specified for delta-style updates",
+                    arrayFilters.empty());
+
+            auto diff = updateExpr[LogBuilder::kDeltaFieldName];
+            uassert(ErrorCodes::FailedToParse,
+                    str::stream() << "Delta-style update must have an object '"
+                                  << LogBuilder::kDeltaFieldName << "' field",
+                    diff.type() == BSONType::Object);
+
+            _updateExecutor = std::make_unique<DeltaExecutor>(diff.embeddedObject());
+            _updateType = UpdateType::kDelta;
+            return;
+        }
     }
 
     auto root = std::make_unique<UpdateObjectNode>();
@@ -254,7 +274,8 @@ Status UpdateDriver::update(StringData matchedField,
     // TODO: assert that update() is called at most once in a !_multi case.
 
     _affectIndices =
-        ((_updateType == UpdateType::kReplacement || _updateType == UpdateType::kPipeline) &&
+        ((_updateType == UpdateType::kReplacement || _updateType == UpdateType::kPipeline ||
+          _updateType == UpdateType::kDelta) &&
          (_indexedFields != nullptr));
 
     _logDoc.reset();
@@ -272,6 +293,15 @@ Status UpdateDriver::update(StringData matchedField,
 
     if (_logOp && logOpRec) {
         applyParams.logBuilder = &logBuilder;
+
+        // A pipeline-style update may be logged as a diff against the pre-image, which only nodes
+        // in featureCompatibilityVersion 4.4 know how to apply. Replacement-style updates are
+        // always logged in full, since change streams report them with the full document.
+        applyParams.allowDeltaLogging = _updateType == UpdateType::kPipeline &&
+            internalQueryEnableDeltaOplogEntries.load() &&
+            serverGlobalParams.featureCompatibility.isVersionInitialized() &&
+            serverGlobalParams.featureCompatibility.getVersion() ==
+                ServerGlobalParams::FeatureCompatibility::Version::kFullyUpgradedTo44;
     }
 
     invariant(_updateExecutor);
@@ -117,6 +117,35 @@ TEST(Parse, ParseUpdateWithPipelineAndVariables) {
     ASSERT_TRUE(driver.type() == UpdateDriver::UpdateType::kPipeline);
 }
 
+TEST(Parse, DeltaFromOplogApplication) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    UpdateDriver driver(expCtx);
+    driver.setFromOplogApplication(true);
+    std::map<StringData, std::unique_ptr<ExpressionWithPlaceholder>> arrayFilters;
+    ASSERT_DOES_NOT_THROW(
+        driver.parse(fromjson("{$v: 2, diff: {u: {a: 2}, i: {c: 1}}}"), arrayFilters));
+    ASSERT_TRUE(driver.type() == UpdateDriver::UpdateType::kDelta);
+
+    const bool validateForStorage = true;
+    const FieldRefSet emptyImmutablePaths;
+    const bool isInsert = false;
+    bool modified = false;
+    mutablebson::Document doc(fromjson("{_id: 1, a: 1, b: 1}"));
+    ASSERT_OK(driver.update(
+        StringData(), &doc, validateForStorage, emptyImmutablePaths, isInsert, nullptr, &modified));
+    ASSERT_TRUE(modified);
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1, a: 2, b: 1, c: 1}"), doc.getObject());
+}
+
+TEST(Parse, DeltaRequiresOplogApplication) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    UpdateDriver driver(expCtx);
+    std::map<StringData, std::unique_ptr<ExpressionWithPlaceholder>> arrayFilters;
+    ASSERT_THROWS_CODE(driver.parse(fromjson("{$v: 2, diff: {u: {a: 2}}}"), arrayFilters),
+                       AssertionException,
+                       ErrorCodes::FailedToParse);
+}
+
 TEST(Parse, EmptyMod) {
     boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
     UpdateDriver driver(expCtx);
@@ -80,6 +80,10 @@ public:
         // If provided, UpdateNode::apply will log the update here.
         LogBuilder* logBuilder = nullptr;
 
+        // If true, a replacement of the document may be logged as a diff against the pre-image
+        // when that is smaller than the post-image.
+        bool allowDeltaLogging = false;
+
         // If provided, UpdateNode::apply will populate this with a path to each modified field.
         FieldRefSetWithStorage* modifiedPaths = nullptr;
     };
@@ -50,11 +50,16 @@
 using namespace fmt::literals;
 
 // One interesting implementation note herein concerns how setup() and
-// refresh() are invoked outside of the global lock, but setTimeout is not.
+// refresh() are invoked outside of the specific pool's lock, but setTimeout is not.
 // This implementation detail simplifies mocks, allowing them to return
 // synchronously sometimes, whereas having timeouts fire instantly adds little
 // value. In practice, dumping the locks is always safe (because we restrict
 // ourselves to operations over the connection).
+//
+// Each SpecificPool's state is guarded by its own mutex, so that requests for different hosts do
+// not contend with each other. The ConnectionPool's mutex only guards the map of specific pools.
+// When both are needed, the ConnectionPool's mutex is acquired first, and it is never acquired
+// while holding the mutex of a specific pool.
 
 namespace mongo {
 
@@ -206,7 +211,7 @@ class ConnectionPool::SpecificPool final
 
 public:
     /**
-     * Whenever a function enters a specific pool, the function needs to be guarded by the lock.
+     * Whenever a function enters a specific pool, the function needs to be guarded by its lock.
      *
      * This callback also (perhaps overly aggressively) binds a shared pointer to the guard.
      * It is *always* safe to reference the original specific pool in the guarded function object.
@@ -221,7 +226,7 @@ public:
     auto guardCallback(Callback&& cb) {
         return
             [this, cb = std::forward<Callback>(cb), anchor = shared_from_this()](auto&&... args) {
-                stdx::lock_guard lk(_parent->_mutex);
+                stdx::lock_guard lk(_mutex);
                 cb(std::forward<decltype(args)>(args)...);
                 updateState();
             };
@@ -233,7 +238,7 @@ public:
     ~SpecificPool();
 
     /**
-     * Create and initialize a SpecificPool
+     * Create and initialize a SpecificPool. Must be called with the parent's mutex held.
      */
     static auto make(std::shared_ptr<ConnectionPool> parent,
                      const HostAndPort& hostAndPort,
@@ -248,8 +253,7 @@ public:
     void updateState();
 
     /**
-     * Gets a connection from the specific pool. Sinks a unique_lock from the
-     * parent to preserve the lock on _mutex
+     * Gets a connection from the specific pool. Must be called with _mutex held.
      */
     Future<ConnectionHandle> getConnection(Milliseconds timeout);
 
@@ -258,6 +262,8 @@ public:
      * and calls processFailure below with the status provided. This immediately removes this pool
      * from the ConnectionPool. The actual destruction will happen eventually as ConnectionHandles
      * are deleted.
+     *
+     * Must be called with both the parent's mutex and _mutex held.
      */
     void triggerShutdown(const Status& status);
 
@@ -322,6 +328,22 @@ public:
         _tags = mutateFunc(_tags);
     }
 
+    bool isShutdown() const {
+        return _health.isShutdown;
+    }
+
+    /**
+     * Returns true if the pool has neither requests waiting for a connection nor checked out
+     * connections.
+     */
+    bool isIdle() const {
+        return _requests.empty() && _checkedOutPool.empty();
+    }
+
+    stdx::mutex& getMutex() const {
+        return _mutex;
+    }
+
     void fassertSSLModeIs(transport::ConnectSSLMode desired) const {
         if (desired != _sslMode) {
             severe() << "Mixing ssl modes for a single host is not supported";
@@ -382,6 +404,9 @@ private:
 
     const PoolId _id;
 
+    // Guards all of the state below
+    mutable stdx::mutex _mutex;
+
     LRUOwnershipPool _readyPool;
     OwnershipPool _processingPool;
     OwnershipPool _droppedProcessingPool;
@@ -423,6 +448,7 @@ auto ConnectionPool::SpecificPool::make(std::shared_ptr<ConnectionPool> parent,
     controller.addHost(pool->_id, hostAndPort);
 
     // Set our timers and health
+    stdx::lock_guard lk(pool->_mutex);
     pool->updateEventTimer();
     pool->updateHealth();
     return pool;
@@ -470,6 +496,7 @@ void ConnectionPool::shutdown() {
 
     for (const auto& pair : pools) {
         stdx::lock_guard lk(_mutex);
+        stdx::lock_guard poolLk(pair.second->getMutex());
         pair.second->triggerShutdown(
             Status(ErrorCodes::ShutdownInProgress, "Shutting down the connection pool"));
     }
@@ -484,6 +511,7 @@ void ConnectionPool::dropConnections(const HostAndPort& hostAndPort) {
         return;
 
     auto& pool = iter->second;
+    stdx::lock_guard poolLk(pool->getMutex());
     pool->triggerShutdown(
         Status(ErrorCodes::PooledConnectionsDropped, "Pooled connections dropped"));
 }
@@ -491,8 +519,11 @@ void ConnectionPool::dropConnections(const HostAndPort& hostAndPort) {
 void ConnectionPool::dropConnections(transport::Session::TagMask tags) {
     stdx::lock_guard lk(_mutex);
 
-    for (const auto& pair : _pools) {
+    // Shutting down a pool removes it from _pools, so iterate over a copy
+    auto pools = _pools;
+    for (const auto& pair : pools) {
         auto& pool = pair.second;
+        stdx::lock_guard poolLk(pool->getMutex());
 
         if (pool->matchesTags(tags))
             continue;
@@ -513,6 +544,7 @@ void ConnectionPool::mutateTags(
         return;
 
     auto pool = iter->second;
+    stdx::lock_guard poolLk(pool->getMutex());
     pool->mutateTags(mutateFunc);
 }
 
@@ -531,21 +563,34 @@ void ConnectionPool::get_forTest(const HostAndPort& hostAndPort,
 SemiFuture<ConnectionPool::ConnectionHandle> ConnectionPool::get(const HostAndPort& hostAndPort,
                                                                  transport::ConnectSSLMode sslMode,
                                                                  Milliseconds timeout) {
-    stdx::lock_guard lk(_mutex);
+    while (true) {
+        auto pool = [&] {
+            stdx::lock_guard lk(_mutex);
+
+            auto& pool = _pools[hostAndPort];
+            if (!pool) {
+                pool = SpecificPool::make(shared_from_this(), hostAndPort, sslMode);
+            } else {
+                pool->fassertSSLModeIs(sslMode);
+            }
 
-    auto& pool = _pools[hostAndPort];
-    if (!pool) {
-        pool = SpecificPool::make(shared_from_this(), hostAndPort, sslMode);
-    } else {
-        pool->fassertSSLModeIs(sslMode);
-    }
+            invariant(pool);
+            return pool;
+        }();
 
-    invariant(pool);
+        stdx::lock_guard lk(pool->getMutex());
 
-    auto connFuture = pool->getConnection(timeout);
-    pool->updateState();
+        // The pool may have been shut down and removed from _pools since we looked it up, in which
+        // case another lookup finds or makes its replacement
+        if (pool->isShutdown()) {
+            continue;
+        }
 
-    return std::move(connFuture).semi();
+        auto connFuture = pool->getConnection(timeout);
+        pool->updateState();
+
+        return std::move(connFuture).semi();
+    }
 }
 
 void ConnectionPool::appendConnectionStats(ConnectionPoolStats* stats) const {
@@ -555,6 +600,7 @@ void ConnectionPool::appendConnectionStats(ConnectionPoolStats* stats) const {
         HostAndPort host = kv.first;
 
         auto& pool = kv.second;
+        stdx::lock_guard poolLk(pool->getMutex());
         ConnectionStatsPer hostStats{pool->inUseConnections(),
                                      pool->availableConnections(),
                                      pool->createdConnections(),
@@ -567,6 +613,7 @@ size_t ConnectionPool::getNumConnectionsPerHost(const HostAndPort& hostAndPort)
     stdx::lock_guard lk(_mutex);
     auto iter = _pools.find(hostAndPort);
     if (iter != _pools.end()) {
+        stdx::lock_guard poolLk(iter->second->getMutex());
         return iter->second->openConnections();
     }
 
@@ -652,7 +699,7 @@ Future<ConnectionPool::ConnectionHandle> ConnectionPool::SpecificPool::getConnec
 
 auto ConnectionPool::SpecificPool::makeHandle(ConnectionInterface* connection) -> ConnectionHandle {
     auto deleter = [this, anchor = shared_from_this()](ConnectionInterface* connection) {
-        stdx::lock_guard lk(_parent->_mutex);
+        stdx::lock_guard lk(_mutex);
         returnConnection(connection);
         _lastActiveTime = _parent->_factory->now();
         updateState();
@@ -1052,56 +1099,79 @@ void ConnectionPool::SpecificPool::updateEventTimer() {
 }
 
 void ConnectionPool::SpecificPool::updateController() {
-    if (_health.isShutdown) {
-        return;
-    }
-
     auto& controller = *_parent->_controller;
 
     // Update our own state
-    HostState state{
-        _health,
-        requestsPending(),
-        refreshingConnections(),
-        availableConnections(),
-        inUseConnections(),
-    };
-    LOG(kDiagnosticLogLevel) << "Updating controller for " << _hostAndPort
-                             << " with State: " << state;
-    auto hostGroup = controller.updateHost(_id, std::move(state));
-
-    // If we can shutdown, then do so
-    if (hostGroup.canShutdown) {
-        for (const auto& host : hostGroup.hosts) {
-            auto it = _parent->_pools.find(host);
-            if (it == _parent->_pools.end()) {
-                continue;
-            }
-
-            auto& pool = it->second;
+    auto hostGroup = [&]() -> boost::optional<HostGroupState> {
+        stdx::lock_guard lk(_mutex);
+        _updateScheduled = false;
 
-            // At the moment, controllers will never mark for shutdown a pool with active
-            // connections or pending requests. isExpired is never true if these invariants are
-            // false. That's not to say that it's a terrible idea, but if this happens then we
-            // should review what it means to be expired.
+        if (_health.isShutdown) {
+            return boost::none;
+        }
 
-            invariant(pool->_checkedOutPool.empty());
-            invariant(pool->_requests.empty());
+        HostState state{
+            _health,
+            requestsPending(),
+            refreshingConnections(),
+            availableConnections(),
+            inUseConnections(),
+        };
+        LOG(kDiagnosticLogLevel) << "Updating controller for " << _hostAndPort
+                                 << " with State: " << state;
+        return controller.updateHost(_id, std::move(state));
+    }();
 
-            pool->triggerShutdown(Status(ErrorCodes::ShutdownInProgress,
-                                         str::stream() << "Pool for " << host << " has expired."));
-        }
+    if (!hostGroup) {
         return;
     }
 
+    // The rest of the group is managed under the parent's lock, which cannot be acquired while
+    // holding our own
+    {
+        stdx::lock_guard lk(_parent->_mutex);
+
+        if (hostGroup->canShutdown) {
+            // Lock the whole group, so that no pool in it gets a request while it is shut down
+            std::vector<std::shared_ptr<SpecificPool>> pools;
+            std::vector<stdx::unique_lock<stdx::mutex>> poolLocks;
+            for (const auto& host : hostGroup->hosts) {
+                auto it = _parent->_pools.find(host);
+                if (it == _parent->_pools.end()) {
+                    continue;
+                }
+
+                pools.push_back(it->second);
+                poolLocks.emplace_back(it->second->_mutex);
+            }
 
-    // Make sure all related hosts exist
-    for (const auto& host : hostGroup.hosts) {
-        if (auto& pool = _parent->_pools[host]; !pool) {
-            pool = SpecificPool::make(_parent, host, _sslMode);
+            // The controller only marks for shutdown pools which have neither active connections
+            // nor pending requests. Since the pools are no longer locked while the controller
+            // decides, a pool may have been asked for a connection since. In that case the next
+            // update for that pool tells the controller so.
+            const auto isGroupIdle = std::all_of(
+                pools.begin(), pools.end(), [](const auto& pool) { return pool->isIdle(); });
+            if (!isGroupIdle) {
+                return;
+            }
+
+            for (const auto& pool : pools) {
+                pool->triggerShutdown(
+                    Status(ErrorCodes::ShutdownInProgress,
+                           str::stream() << "Pool for " << pool->host() << " has expired."));
+            }
+            return;
+        }
+
+        // Make sure all related hosts exist
+        for (const auto& host : hostGroup->hosts) {
+            if (auto& pool = _parent->_pools[host]; !pool) {
+                pool = SpecificPool::make(_parent, host, _sslMode);
+            }
         }
     }
 
+    stdx::lock_guard lk(_mutex);
     spawnConnections();
 }
 
@@ -1124,8 +1194,6 @@ void ConnectionPool::SpecificPool::updateState() {
         .getAsync([this, anchor = shared_from_this()](Status&& status) mutable {
             invariant(status);
 
-            stdx::lock_guard lk(_parent->_mutex);
-            _updateScheduled = false;
             updateController();
         });
 }
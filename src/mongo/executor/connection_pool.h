@@ -254,7 +254,9 @@ private:
 
     std::shared_ptr<ControllerInterface> _controller;
 
-    // The global mutex for specific pool access and the generation counter
+    // Guards the map of specific pools and the pool id counter. Each SpecificPool guards its own
+    // state with a mutex of its own, which may be acquired while holding this one, but not the
+    // other way around.
     mutable stdx::mutex _mutex;
     PoolId _nextPoolId = 0;
     stdx::unordered_map<HostAndPort, std::shared_ptr<SpecificPool>> _pools;
@@ -0,0 +1,183 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/executor/connection_pool.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+namespace executor {
+namespace {
+
+/**
+ * A timer which never fires. The benchmark runs for much less than any of the pool's timeouts.
+ */
+class NoopTimer final : public ConnectionPool::TimerInterface {
+public:
+    void setTimeout(Milliseconds timeout, TimeoutCallback cb) override {}
+
+    void cancelTimeout() override {}
+
+    Date_t now() override {
+        return Date_t::now();
+    }
+};
+
+/**
+ * A connection whose setup and refresh succeed as soon as the executor gets to them.
+ */
+class NoopConnection final : public ConnectionPool::ConnectionInterface {
+public:
+    NoopConnection(const HostAndPort& hostAndPort,
+                   size_t generation,
+                   std::shared_ptr<OutOfLineExecutor> executor)
+        : ConnectionInterface(generation),
+          _hostAndPort(hostAndPort),
+          _executor(std::move(executor)) {}
+
+    void setTimeout(Milliseconds timeout, TimeoutCallback cb) override {}
+
+    void cancelTimeout() override {}
+
+    Date_t now() override {
+        return Date_t::now();
+    }
+
+    const HostAndPort& getHostAndPort() const override {
+        return _hostAndPort;
+    }
+
+    transport::ConnectSSLMode getSslMode() const override {
+        return transport::kGlobalSSLMode;
+    }
+
+    bool isHealthy() override {
+        return true;
+    }
+
+protected:
+    void setup(Milliseconds timeout, SetupCallback cb) override {
+        // The pool holds its lock while calling setup(), so the callback has to run later
+        _executor->schedule([this, cb = std::move(cb)](Status) mutable {
+            indicateUsed();
+            cb(this, Status::OK());
+        });
+    }
+
+    void refresh(Milliseconds timeout, RefreshCallback cb) override {
+        _executor->schedule([this, cb = std::move(cb)](Status) mutable {
+            indicateUsed();
+            indicateSuccess();
+            cb(this, Status::OK());
+        });
+    }
+
+private:
+    const HostAndPort _hostAndPort;
+    const std::shared_ptr<OutOfLineExecutor> _executor;
+};
+
+class NoopFactory final : public ConnectionPool::DependentTypeFactoryInterface {
+public:
+    explicit NoopFactory(std::shared_ptr<OutOfLineExecutor> executor)
+        : _executor(std::move(executor)) {}
+
+    std::shared_ptr<ConnectionPool::ConnectionInterface> makeConnection(
+        const HostAndPort& hostAndPort,
+        transport::ConnectSSLMode sslMode,
+        size_t generation) override {
+        return std::make_shared<NoopConnection>(hostAndPort, generation, _executor);
+    }
+
+    const std::shared_ptr<OutOfLineExecutor>& getExecutor() override {
+        return _executor;
+    }
+
+    std::shared_ptr<ConnectionPool::TimerInterface> makeTimer() override {
+        return std::make_shared<NoopTimer>();
+    }
+
+    Date_t now() override {
+        return Date_t::now();
+    }
+
+    void shutdown() override {}
+
+private:
+    const std::shared_ptr<OutOfLineExecutor> _executor;
+};
+
+std::shared_ptr<ThreadPool> executor;
+std::shared_ptr<ConnectionPool> pool;
+
+/**
+ * Each thread repeatedly checks a connection to one of state.range(0) hosts out of a shared
+ * ConnectionPool and returns it, as a mongos does when it fans requests out to its shards.
+ */
+void BM_getAndReturnConnection(benchmark::State& state) {
+    const auto numHosts = state.range(0);
+
+    if (state.thread_index == 0) {
+        ThreadPool::Options options;
+        options.poolName = "ConnectionPoolBM";
+        options.minThreads = 2;
+        options.maxThreads = 2;
+        executor = std::make_shared<ThreadPool>(std::move(options));
+        executor->startup();
+
+        pool = std::make_shared<ConnectionPool>(std::make_shared<NoopFactory>(executor), "bench");
+    }
+
+    const HostAndPort host("host", 27017 + state.thread_index % numHosts);
+    for (auto _ : state) {
+        auto conn = pool->get(host, transport::kGlobalSSLMode, Seconds{10}).get();
+        conn->indicateSuccess();
+    }
+
+    if (state.thread_index == 0) {
+        pool->shutdown();
+        pool.reset();
+        executor->shutdown();
+        executor->join();
+        executor.reset();
+    }
+}
+
+BENCHMARK(BM_getAndReturnConnection)
+    ->Arg(1)
+    ->Arg(64)
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace executor
+}  // namespace mongo
@@ -33,12 +33,16 @@
 
 #include "mongo/s/async_requests_sender.h"
 
+#include <algorithm>
 #include <fmt/format.h>
 #include <memory>
 
 #include "mongo/client/remote_command_targeter.h"
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/db/query/killcursors_request.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/s/async_requests_sender_gen.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
 #include "mongo/transport/baton.h"
@@ -56,6 +60,171 @@ namespace {
 // Maximum number of retries for network and replication notMaster errors (per host).
 const int kMaxNumFailedHostRetryAttempts = 3;
 
+// Upper bound on the latency sample taken from a single operation. A command which is slow because
+// of the work it does, rather than because of its host, thus moves the host's moving average of
+// operation latency by less than the default latency window of host selection.
+const Milliseconds kMaxOperationLatencySample{100};
+
+/**
+ * Reports the time the command in 'cbData' took to the targeter of its shard, provided that it
+ * succeeded and that its duration depends on the host. A getMore is not sampled, as it may wait
+ * for new results, and it is bound to the host of its cursor in any case.
+ */
+void noteOperationLatency(RemoteCommandTargeter* targeter,
+                          const executor::TaskExecutor::RemoteCommandOnAnyCallbackArgs& cbData) {
+    if (!cbData.response.target || !cbData.response.elapsedMillis || !cbData.response.isOK() ||
+        !getStatusFromCommandResult(cbData.response.data).isOK()) {
+        return;
+    }
+
+    if (cbData.request.cmdObj.firstElementFieldNameStringData() == "getMore"_sd) {
+        return;
+    }
+
+    targeter->noteOperationLatency(
+        *cbData.response.target,
+        std::min(*cbData.response.elapsedMillis, kMaxOperationLatencySample));
+}
+
+/**
+ * The state shared by the requests which a hedged read sends to different hosts of a shard. The
+ * requests run on the scoped executor and the baton of the ARS, so that they are cancelled along
+ * with it, but their callbacks may still run as the ARS goes out of scope and so only refer to
+ * this state and not to the ARS.
+ */
+class HedgedRead {
+public:
+    using RemoteCommandOnAnyCallbackArgs = executor::TaskExecutor::RemoteCommandOnAnyCallbackArgs;
+
+    HedgedRead(std::shared_ptr<executor::TaskExecutor> executor,
+               BatonHandle baton,
+               std::shared_ptr<executor::TaskExecutor> cleanupExecutor,
+               std::shared_ptr<RemoteCommandTargeter> targeter,
+               bool mayOpenCursor,
+               Promise<RemoteCommandOnAnyCallbackArgs> promise)
+        : _executor(std::move(executor)),
+          _baton(std::move(baton)),
+          _cleanupExecutor(std::move(cleanupExecutor)),
+          _targeter(std::move(targeter)),
+          _mayOpenCursor(mayOpenCursor),
+          _promise(std::move(promise)) {}
+
+    /**
+     * Sends the request to the single host it targets, unless the read has already completed.
+     */
+    static Status send(const std::shared_ptr<HedgedRead>& hedgedRead,
+                       const executor::RemoteCommandRequestOnAny& request) {
+        stdx::unique_lock<stdx::mutex> lk(hedgedRead->_mutex);
+        if (hedgedRead->_decided) {
+            return Status::OK();
+        }
+
+        ++hedgedRead->_outstanding;
+        lk.unlock();
+
+        auto swHandle = hedgedRead->_executor->scheduleRemoteCommandOnAny(
+            request,
+            [hedgedRead](const RemoteCommandOnAnyCallbackArgs& cbData) {
+                hedgedRead->_onResponse(cbData);
+            },
+            hedgedRead->_baton);
+
+        lk.lock();
+        if (!swHandle.isOK()) {
+            --hedgedRead->_outstanding;
+            return swHandle.getStatus();
+        }
+
+        if (hedgedRead->_decided && !hedgedRead->_mayOpenCursor) {
+            lk.unlock();
+            hedgedRead->_executor->cancel(swHandle.getValue());
+            return Status::OK();
+        }
+
+        hedgedRead->_handles.push_back(std::move(swHandle.getValue()));
+        return Status::OK();
+    }
+
+private:
+    void _onResponse(const RemoteCommandOnAnyCallbackArgs& cbData) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        --_outstanding;
+
+        const bool succeeded =
+            cbData.response.isOK() && getStatusFromCommandResult(cbData.response.data).isOK();
+        if (!_decided && (succeeded || _outstanding == 0)) {
+            _decided = true;
+            auto handles = std::move(_handles);
+            lk.unlock();
+
+            // The requests which are still running will not be used. Unless they may leave a cursor
+            // open on their host, which is only known once they complete, stop waiting for them.
+            if (!_mayOpenCursor) {
+                for (const auto& handle : handles) {
+                    _executor->cancel(handle);
+                }
+            }
+
+            _promise.emplaceValue(cbData);
+            return;
+        }
+        lk.unlock();
+
+        if (cbData.response.status == ErrorCodes::CallbackCanceled || !cbData.response.target) {
+            return;
+        }
+
+        // The losing host is typically the slow one, so make sure its latency is accounted for
+        noteOperationLatency(_targeter.get(), cbData);
+
+        if (!cbData.response.isOK()) {
+            return;
+        }
+
+        auto swCursorResponse = CursorResponse::parseFromBSON(cbData.response.data);
+        if (!swCursorResponse.isOK() || swCursorResponse.getValue().getCursorId() == 0) {
+            return;
+        }
+
+        const auto& nss = swCursorResponse.getValue().getNSS();
+        executor::RemoteCommandRequest request(
+            *cbData.response.target,
+            nss.db().toString(),
+            KillCursorsRequest(nss, {swCursorResponse.getValue().getCursorId()}).toBSON(),
+            nullptr);
+
+        // We do not process the response to the killCursors request (we make a good-faith attempt
+        // at cleaning up the cursor, but ignore any returned errors). It is sent on the underlying
+        // executor, since the ARS may go out of scope and cancel its requests at any time.
+        _cleanupExecutor->scheduleRemoteCommand(request, [](auto const&) {}).getStatus().ignore();
+    }
+
+    // The scoped executor and the baton of the ARS, on which the requests are sent
+    const std::shared_ptr<executor::TaskExecutor> _executor;
+    const BatonHandle _baton;
+
+    // The executor underlying '_executor', used to kill the cursors left open by losing requests
+    const std::shared_ptr<executor::TaskExecutor> _cleanupExecutor;
+
+    const std::shared_ptr<RemoteCommandTargeter> _targeter;
+
+    // Whether the command may leave a cursor open on the host which runs it
+    const bool _mayOpenCursor;
+
+    stdx::mutex _mutex;
+
+    // Set once the response to return has been received
+    bool _decided{false};
+
+    // The number of requests which have been sent and have not completed
+    int _outstanding{0};
+
+    // The callback handles of the requests which have been sent
+    std::vector<executor::TaskExecutor::CallbackHandle> _handles;
+
+    Promise<RemoteCommandOnAnyCallbackArgs> _promise;
+};
+
 }  // namespace
 
 AsyncRequestsSender::AsyncRequestsSender(OperationContext* opCtx,
@@ -68,18 +237,31 @@ AsyncRequestsSender::AsyncRequestsSender(OperationContext* opCtx,
       _db(dbName.toString()),
       _readPreference(readPreference),
       _retryPolicy(retryPolicy),
+      _executor(executor),
       _subExecutor(std::move(executor)),
       _subBaton(opCtx->getBaton()->makeSubBaton()) {
 
-    _remotesLeft = requests.size();
-
     // Initialize command metadata to handle the read preference.
     _metadataObj = readPreference.toContainingBSON();
 
-    _remotes.reserve(requests.size());
+    addRequests(requests);
+}
+
+void AsyncRequestsSender::addRequests(const std::vector<AsyncRequestsSender::Request>& requests) {
+    _remotesLeft += requests.size();
+
     for (const auto& request : requests) {
+        auto& remote =
+            _remotes.emplace_back(this, request.shardId, request.cmdObj, _remotes.size());
+
+        // Once interrupted, the executor no longer runs anything, so fail the request right away
+        if (!_interruptStatus.isOK()) {
+            _responseQueue.push(std::move(remote).makeFailedResponse(_interruptStatus));
+            continue;
+        }
+
         // Kick off requests immediately.
-        _remotes.emplace_back(this, request.shardId, request.cmdObj).executeRequest();
+        remote.executeRequest();
     }
 }
 
@@ -133,8 +315,12 @@ AsyncRequestsSender::Request::Request(ShardId shardId, BSONObj cmdObj)
 
 AsyncRequestsSender::RemoteData::RemoteData(AsyncRequestsSender* ars,
                                             ShardId shardId,
-                                            BSONObj cmdObj)
-    : _ars(ars), _shardId(std::move(shardId)), _cmdObj(std::move(cmdObj)) {}
+                                            BSONObj cmdObj,
+                                            size_t requestIndex)
+    : _ars(ars),
+      _shardId(std::move(shardId)),
+      _cmdObj(std::move(cmdObj)),
+      _requestIndex(requestIndex) {}
 
 std::shared_ptr<Shard> AsyncRequestsSender::RemoteData::getShard() {
     // TODO: Pass down an OperationContext* to use here.
@@ -147,11 +333,15 @@ void AsyncRequestsSender::RemoteData::executeRequest() {
         .getAsync([this](StatusWith<RemoteCommandOnAnyCallbackArgs> rcr) {
             _done = true;
             if (rcr.isOK()) {
-                _ars->_responseQueue.push(
-                    {std::move(_shardId), rcr.getValue().response, std::move(_shardHostAndPort)});
+                _ars->_responseQueue.push({std::move(_shardId),
+                                           rcr.getValue().response,
+                                           std::move(_shardHostAndPort),
+                                           _requestIndex});
             } else {
-                _ars->_responseQueue.push(
-                    {std::move(_shardId), rcr.getStatus(), std::move(_shardHostAndPort)});
+                _ars->_responseQueue.push({std::move(_shardId),
+                                           rcr.getStatus(),
+                                           std::move(_shardHostAndPort),
+                                           _requestIndex});
             }
         });
 }
@@ -181,6 +371,13 @@ SemiFuture<std::vector<HostAndPort>> AsyncRequestsSender::RemoteData::resolveSha
 
 auto AsyncRequestsSender::RemoteData::scheduleRemoteCommand(std::vector<HostAndPort>&& hostAndPorts)
     -> SemiFuture<RemoteCommandOnAnyCallbackArgs> {
+    // Only reads which may run on any of several hosts are hedged
+    const Milliseconds hedgingDelay(gReadHedgingDelayMS.load());
+    if (hedgingDelay > Milliseconds(0) && hostAndPorts.size() > 1 &&
+        _ars->_readPreference.pref != ReadPreference::PrimaryOnly) {
+        return scheduleHedgedRemoteCommand(std::move(hostAndPorts), hedgingDelay);
+    }
+
     executor::RemoteCommandRequestOnAny request(
         std::move(hostAndPorts), _ars->_db, _cmdObj, _ars->_metadataObj, _ars->_opCtx);
 
@@ -200,11 +397,75 @@ auto AsyncRequestsSender::RemoteData::scheduleRemoteCommand(std::vector<HostAndP
     return std::move(f).semi();
 }
 
+auto AsyncRequestsSender::RemoteData::scheduleHedgedRemoteCommand(
+    std::vector<HostAndPort>&& hostAndPorts, Milliseconds hedgingDelay)
+    -> SemiFuture<RemoteCommandOnAnyCallbackArgs> {
+    const auto shard = getShard();
+    uassert(ErrorCodes::ShardNotFound, str::stream() << "Could not find shard " << _shardId, shard);
+
+    // Commands which open a cursor are left to complete on the losing host, so that the cursor can
+    // be killed, rather than be left behind until it times out
+    const auto cmdName = _cmdObj.firstElementFieldNameStringData();
+    const bool mayOpenCursor = cmdName == "find"_sd || cmdName == "aggregate"_sd;
+
+    auto [p, f] = makePromiseFuture<RemoteCommandOnAnyCallbackArgs>();
+    auto hedgedRead = std::make_shared<HedgedRead>(*_ars->_subExecutor,
+                                                   *_ars->_subBaton,
+                                                   _ars->_executor,
+                                                   shard->getTargeter(),
+                                                   mayOpenCursor,
+                                                   std::move(p));
+
+    // Failures to schedule skip the retry loop
+    uassertStatusOK(HedgedRead::send(hedgedRead,
+                                     {{hostAndPorts[0]},
+                                      _ars->_db,
+                                      _cmdObj,
+                                      _ars->_metadataObj,
+                                      _ars->_opCtx}));
+
+    // The timer is scheduled on the scoped executor and the hedged request is sent from the baton,
+    // so that the request is only ever built while the ARS and its OperationContext are alive
+    auto [timerPromise, timerFuture] = makePromiseFuture<void>();
+    auto swTimerHandle = _ars->_subExecutor->scheduleWorkAt(
+        _ars->_subExecutor->now() + hedgingDelay,
+        [p = std::make_shared<Promise<void>>(std::move(timerPromise))](
+            const executor::TaskExecutor::CallbackArgs& args) {
+            if (args.status.isOK()) {
+                p->emplaceValue();
+            } else {
+                p->setError(args.status);
+            }
+        });
+    if (!swTimerHandle.isOK()) {
+        return std::move(f).semi();
+    }
+
+    std::move(timerFuture)
+        .thenRunOn(*_ars->_subBaton)
+        .getAsync([this, hedgedRead, host = std::move(hostAndPorts[1])](Status status) {
+            if (!status.isOK()) {
+                return;
+            }
+
+            LOG(3) << "Hedging read to remote " << _shardId << " by also sending it to host "
+                   << host;
+            HedgedRead::send(hedgedRead,
+                             {{host}, _ars->_db, _cmdObj, _ars->_metadataObj, _ars->_opCtx})
+                .ignore();
+        });
+
+    return std::move(f).semi();
+}
 
 auto AsyncRequestsSender::RemoteData::handleResponse(RemoteCommandOnAnyCallbackArgs&& rcr)
     -> SemiFuture<RemoteCommandOnAnyCallbackArgs> {
     if (rcr.response.target) {
         _shardHostAndPort = rcr.response.target;
+
+        if (auto shard = getShard()) {
+            noteOperationLatency(shard->getTargeter().get(), rcr);
+        }
     }
 
     auto status = rcr.response.status;
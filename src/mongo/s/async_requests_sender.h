@@ -30,6 +30,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <deque>
 #include <vector>
 
 #include "mongo/base/status_with.h"
@@ -124,6 +125,10 @@ public:
         // The exact host on which the remote command was run. Is unset if the shard could not be
         // found or no shard hosts matching the readPreference could be found.
         boost::optional<HostAndPort> shardHostAndPort;
+
+        // The position of the request among all the requests given to this ARS, first at
+        // construction and then through addRequests().
+        size_t requestIndex{0};
     };
 
     /**
@@ -137,6 +142,14 @@ public:
                         const ReadPreferenceSetting& readPreference,
                         Shard::RetryPolicy retryPolicy);
 
+    /**
+     * Schedules more requests immediately, while those scheduled earlier may still be outstanding.
+     * Their responses are returned by next() along with those of the earlier requests.
+     *
+     * Note: Must only be called from the thread calling next().
+     */
+    void addRequests(const std::vector<AsyncRequestsSender::Request>& requests);
+
     /**
      * Returns true if responses for all requests have been returned via next().
      */
@@ -174,7 +187,10 @@ private:
         /**
          * Creates a new uninitialized remote state with a command to send.
          */
-        RemoteData(AsyncRequestsSender* ars, ShardId shardId, BSONObj cmdObj);
+        RemoteData(AsyncRequestsSender* ars,
+                   ShardId shardId,
+                   BSONObj cmdObj,
+                   size_t requestIndex);
 
         /**
          * Returns the Shard object associated with this remote.
@@ -192,7 +208,10 @@ private:
          * Extracts a failed response from the remote, given an interruption status.
          */
         Response makeFailedResponse(Status status) && {
-            return {std::move(_shardId), std::move(status), std::move(_shardHostAndPort)};
+            return {std::move(_shardId),
+                    std::move(status),
+                    std::move(_shardHostAndPort),
+                    _requestIndex};
         }
 
         /**
@@ -227,6 +246,14 @@ private:
         SemiFuture<RemoteCommandOnAnyCallbackArgs> scheduleRemoteCommand(
             std::vector<HostAndPort>&& hostAndPort);
 
+        /**
+         * Sends the command to the first of the given hosts and, if it has not completed after
+         * 'hedgingDelay', to the second one as well. The first successful response is returned,
+         * or the last response if none of them succeeded.
+         */
+        SemiFuture<RemoteCommandOnAnyCallbackArgs> scheduleHedgedRemoteCommand(
+            std::vector<HostAndPort>&& hostAndPorts, Milliseconds hedgingDelay);
+
         /**
          * Handles the remote response
          */
@@ -250,6 +277,9 @@ private:
 
         // The number of times we've retried sending the command to this remote.
         int _retryCount = 0;
+
+        // The position of the request among all the requests given to the ARS.
+        const size_t _requestIndex;
     };
 
     OperationContext* _opCtx;
@@ -267,11 +297,16 @@ private:
     // The policy to use when deciding whether to retry on an error.
     Shard::RetryPolicy _retryPolicy;
 
-    // Data tracking the state of our communication with each of the remote nodes.
-    std::vector<RemoteData> _remotes;
+    // The executor underlying _subExecutor. Used to kill the cursors which the losing requests of
+    // hedged reads leave open, which may need to happen after the ARS has gone out of scope.
+    std::shared_ptr<executor::TaskExecutor> _executor;
+
+    // Data tracking the state of our communication with each of the remote nodes. A deque, so that
+    // adding requests does not move the remotes which outstanding callbacks refer to.
+    std::deque<RemoteData> _remotes;
 
     // Number of remotes we haven't returned final results from.
-    size_t _remotesLeft;
+    size_t _remotesLeft{0};
 
     // Queue of responses.  We don't actually take advantage of the thread safety of the queue, but
     // instead use it to collect results while waiting on a condvar (which allows us to use our
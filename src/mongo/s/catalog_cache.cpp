@@ -37,6 +37,7 @@
 #include "mongo/db/logical_clock.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
 #include "mongo/db/repl/optime_with.h"
+#include "mongo/platform/bits.h"
 #include "mongo/s/catalog/type_collection.h"
 #include "mongo/s/catalog/type_database.h"
 #include "mongo/s/client/shard_registry.h"
@@ -414,10 +415,15 @@ void CatalogCache::invalidateShardedCollection(const NamespaceString& nss) {
         return;
     }
 
-    if (itDb->second.find(nss.ns()) == itDb->second.end()) {
-        itDb->second[nss.ns()] = std::make_shared<CollectionRoutingInfoEntry>();
+    auto& collEntry = itDb->second[nss.ns()];
+    if (!collEntry) {
+        collEntry = std::make_shared<CollectionRoutingInfoEntry>();
     }
-    itDb->second[nss.ns()]->needsRefresh = true;
+
+    if (collEntry->refreshCompletionNotification) {
+        collEntry->invalidatedDuringRefresh = true;
+    }
+    collEntry->needsRefresh = true;
 }
 
 void CatalogCache::purgeCollection(const NamespaceString& nss) {
@@ -460,6 +466,43 @@ void CatalogCache::report(BSONObjBuilder* builder) const {
     cacheStatsBuilder.append("numCollectionEntries", static_cast<long long>(numCollectionEntries));
 
     _stats.report(&cacheStatsBuilder);
+
+    // Only the collections which spent the most time refreshing are reported, so that the size of
+    // the report does not grow with the number of collections
+    const size_t kMaxCollectionsWithRefreshLatencies = 20;
+    // The latencies keep changing while they are sorted, so they are sorted by a snapshot
+    struct CollectionEntry {
+        long long totalMillis;
+        std::string ns;
+        std::shared_ptr<CollectionRoutingInfoEntry> entry;
+    };
+    std::vector<CollectionEntry> collEntries;
+    {
+        stdx::lock_guard<stdx::mutex> ul(_mutex);
+        for (const auto& dbEntry : _collectionsByDb) {
+            for (const auto& collEntry : dbEntry.second) {
+                if (collEntry.second->refreshLatencies.count() > 0) {
+                    collEntries.push_back({collEntry.second->refreshLatencies.totalMillis(),
+                                           collEntry.first,
+                                           collEntry.second});
+                }
+            }
+        }
+    }
+
+    const auto numReported = std::min(collEntries.size(), kMaxCollectionsWithRefreshLatencies);
+    std::partial_sort(collEntries.begin(),
+                      collEntries.begin() + numReported,
+                      collEntries.end(),
+                      [](const auto& lhs, const auto& rhs) {
+                          return lhs.totalMillis > rhs.totalMillis;
+                      });
+
+    BSONObjBuilder latenciesBuilder(cacheStatsBuilder.subobjStart("collectionRefreshLatencies"));
+    for (size_t i = 0; i < numReported; ++i) {
+        BSONObjBuilder collBuilder(latenciesBuilder.subobjStart(collEntries[i].ns));
+        collEntries[i].entry->refreshLatencies.report(&collBuilder);
+    }
 }
 
 void CatalogCache::_scheduleDatabaseRefresh(WithLock lk,
@@ -541,6 +584,10 @@ void CatalogCache::_scheduleCollectionRefresh(WithLock lk,
                                               int refreshAttempt) {
     const auto existingRoutingInfo = collEntry->routingInfo;
 
+    // The refresh about to be scheduled observes all the changes which caused the invalidations so
+    // far, so they don't require a follow-up refresh
+    collEntry->invalidatedDuringRefresh = false;
+
     // If we have an existing chunk manager, the refresh is considered "incremental", regardless of
     // how many chunks are in the differential
     const bool isIncremental(existingRoutingInfo);
@@ -554,9 +601,11 @@ void CatalogCache::_scheduleCollectionRefresh(WithLock lk,
     }
 
     // Invoked when one iteration of getChunksSince has completed, whether with success or error
-    const auto onRefreshCompleted = [this, t = Timer(), nss, isIncremental, existingRoutingInfo](
-                                        const Status& status,
-                                        RoutingTableHistory* routingInfoAfterRefresh) {
+    const auto onRefreshCompleted =
+        [ this, t = Timer(), collEntry, nss, isIncremental, existingRoutingInfo ](
+            const Status& status, RoutingTableHistory* routingInfoAfterRefresh) {
+        collEntry->refreshLatencies.record(Milliseconds(t.millis()));
+
         if (isIncremental) {
             _stats.numActiveIncrementalRefreshes.subtractAndFetch(1);
         } else {
@@ -624,7 +673,9 @@ void CatalogCache::_scheduleCollectionRefresh(WithLock lk,
 
         stdx::lock_guard<stdx::mutex> lg(_mutex);
 
-        collEntry->needsRefresh = false;
+        // Threads waiting for the refresh will find that the entry still needs a refresh if it
+        // was invalidated in the meantime and will all join a single follow-up refresh
+        collEntry->needsRefresh = collEntry->invalidatedDuringRefresh;
         collEntry->refreshCompletionNotification->set(Status::OK());
         collEntry->refreshCompletionNotification = nullptr;
 
@@ -679,6 +730,35 @@ void CatalogCache::Stats::report(BSONObjBuilder* builder) const {
     builder->append("countFailedRefreshes", countFailedRefreshes.load());
 }
 
+void CatalogCache::RefreshLatencyHistogram::record(Milliseconds duration) {
+    const long long millis = std::max(durationCount<Milliseconds>(duration), 0LL);
+
+    // Bucket i > 0 holds the durations whose highest set bit is bit i - 1
+    const int bucket =
+        millis == 0 ? 0 : std::min(64 - countLeadingZeros64(millis), kNumBuckets - 1);
+
+    _buckets[bucket].addAndFetch(1);
+    _count.addAndFetch(1);
+    _totalMillis.addAndFetch(millis);
+}
+
+void CatalogCache::RefreshLatencyHistogram::report(BSONObjBuilder* builder) const {
+    builder->append("count", _count.load());
+    builder->append("totalMillis", _totalMillis.load());
+
+    BSONArrayBuilder arrayBuilder(builder->subarrayStart("histogram"));
+    for (int i = 0; i < kNumBuckets; ++i) {
+        const auto count = _buckets[i].load();
+        if (count == 0)
+            continue;
+        BSONObjBuilder entryBuilder(arrayBuilder.subobjStart());
+        entryBuilder.append("millis", i == 0 ? 0LL : 1LL << (i - 1));
+        entryBuilder.append("count", count);
+        entryBuilder.doneFast();
+    }
+    arrayBuilder.doneFast();
+}
+
 CachedDatabaseInfo::CachedDatabaseInfo(DatabaseType dbt, std::shared_ptr<Shard> primaryShard)
     : _dbt(std::move(dbt)), _primaryShard(std::move(primaryShard)) {}
 
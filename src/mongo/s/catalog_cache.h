@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
 
 #include "mongo/base/string_data.h"
@@ -41,6 +42,7 @@
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/notification.h"
 #include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/duration.h"
 #include "mongo/util/string_map.h"
 
 namespace mongo {
@@ -223,7 +225,10 @@ public:
 
     /**
      * Non-blocking method, which indiscriminately causes the routing table for the specified
-     * namespace to be refreshed the next time getCollectionRoutingInfo is called.
+     * namespace to be refreshed the next time getCollectionRoutingInfo is called. If a refresh is
+     * already in progress, another one is performed after it completes, since the one in progress
+     * may not observe the change which caused the invalidation. All the invalidations which arrive
+     * while a refresh is in progress share the same follow-up refresh.
      */
     void invalidateShardedCollection(const NamespaceString& nss);
 
@@ -255,6 +260,36 @@ private:
     friend class CachedDatabaseInfo;
     friend class CachedCollectionRoutingInfo;
 
+    /**
+     * Distribution of the durations of the refresh attempts for a single collection. The bucket
+     * with index i > 0 counts the attempts which took between 2^(i - 1) and 2^i milliseconds,
+     * with the first and the last buckets also counting all the shorter and longer ones.
+     */
+    class RefreshLatencyHistogram {
+    public:
+        static constexpr int kNumBuckets = 20;
+
+        void record(Milliseconds duration);
+
+        long long count() const {
+            return _count.load();
+        }
+
+        long long totalMillis() const {
+            return _totalMillis.load();
+        }
+
+        /**
+         * Appends the number of attempts, their total duration and the non-empty buckets.
+         */
+        void report(BSONObjBuilder* builder) const;
+
+    private:
+        std::array<AtomicWord<long long>, kNumBuckets> _buckets;
+        AtomicWord<long long> _count;
+        AtomicWord<long long> _totalMillis;
+    };
+
     /**
      * Cache entry describing a collection.
      */
@@ -267,8 +302,15 @@ private:
         // needsRefresh is true)
         std::shared_ptr<Notification<Status>> refreshCompletionNotification;
 
+        // Set if the entry was invalidated after the refresh in progress started, in which case
+        // the entry still needs a refresh once it completes
+        bool invalidatedDuringRefresh{false};
+
         // Contains the cached routing information (only available if needsRefresh is false)
         std::shared_ptr<RoutingTableHistory> routingInfo;
+
+        // Durations of the refreshes of this collection since the entry was created
+        RefreshLatencyHistogram refreshLatencies;
     };
 
     /**
@@ -648,5 +648,64 @@ TEST_F(CatalogCacheRefreshTest, IncrementalLoadAfterMoveLastChunk) {
     ASSERT_EQ(version, cm->getVersion({"1"}));
 }
 
+TEST_F(CatalogCacheRefreshTest, InvalidationDuringRefreshCausesSingleFollowUpRefresh) {
+    const ShardKeyPattern shardKeyPattern(BSON("_id" << 1));
+
+    auto initialRoutingInfo(makeChunkManager(kNss, shardKeyPattern, nullptr, true, {}));
+    ASSERT_EQ(1, initialRoutingInfo->numChunks());
+
+    ChunkVersion version = initialRoutingInfo->getVersion();
+
+    auto future = scheduleRoutingInfoRefresh(kNss);
+
+    expectGetCollection(version.epoch(), shardKeyPattern);
+
+    // Invalidate the collection twice while the refresh is waiting for the chunks
+    auto const catalogCache = Grid::get(getServiceContext())->catalogCache();
+    catalogCache->invalidateShardedCollection(kNss);
+    catalogCache->invalidateShardedCollection(kNss);
+
+    expectFindSendBSONObjVector(kConfigHostAndPort, [&]() {
+        ChunkType chunk(kNss,
+                        {shardKeyPattern.getKeyPattern().globalMin(),
+                         shardKeyPattern.getKeyPattern().globalMax()},
+                        version,
+                        {"0"});
+        chunk.setName(OID::gen());
+
+        return std::vector<BSONObj>{chunk.toConfigBSON()};
+    }());
+
+    // Both invalidations are covered by a single follow-up refresh, which observes a split
+    expectGetCollection(version.epoch(), shardKeyPattern);
+    expectFindSendBSONObjVector(kConfigHostAndPort, [&]() {
+        version.incMajor();
+        ChunkType chunk1(
+            kNss, {shardKeyPattern.getKeyPattern().globalMin(), BSON("_id" << 0)}, version, {"0"});
+        chunk1.setName(OID::gen());
+
+        version.incMinor();
+        ChunkType chunk2(
+            kNss, {BSON("_id" << 0), shardKeyPattern.getKeyPattern().globalMax()}, version, {"0"});
+        chunk2.setName(OID::gen());
+
+        return std::vector<BSONObj>{chunk1.toConfigBSON(), chunk2.toConfigBSON()};
+    }());
+
+    auto routingInfo = future.default_timed_get();
+    ASSERT(routingInfo->cm());
+    auto cm = routingInfo->cm();
+
+    ASSERT_EQ(2, cm->numChunks());
+    ASSERT_EQ(version, cm->getVersion());
+
+    // The initial load and both refreshes are reflected in the latencies of the collection
+    BSONObjBuilder reportBuilder;
+    catalogCache->report(&reportBuilder);
+    const auto report = reportBuilder.obj();
+    const auto latencies = report["catalogCache"]["collectionRefreshLatencies"];
+    ASSERT_EQ(3, latencies[kNss.ns()]["count"].numberLong());
+}
+
 }  // namespace
 }  // namespace mongo
@@ -58,6 +58,26 @@ void checkAllElementsAreOfType(BSONType type, const BSONObj& o) {
     }
 }
 
+/**
+ * Throws ConflictingOperationInProgress unless the range of 'right' starts exactly where the range
+ * of 'left', which precedes it in the routing table, ends.
+ */
+void checkChunksAreContiguous(const ChunkInfo& left, const ChunkInfo& right) {
+    const auto& leftMax = left.getMax();
+    const auto& rightMin = right.getMin();
+    if (SimpleBSONObjComparator::kInstance.evaluate(leftMax == rightMin)) {
+        return;
+    }
+
+    uasserted(ErrorCodes::ConflictingOperationInProgress,
+              str::stream() << (SimpleBSONObjComparator::kInstance.evaluate(leftMax < rightMin)
+                                    ? "Gap"
+                                    : "Overlap")
+                            << " exists in the routing table between chunks "
+                            << left.getRange().toString() << " and "
+                            << right.getRange().toString());
+}
+
 std::string extractKeyStringInternal(const BSONObj& shardKeyValue, Ordering ordering) {
     BSONObjBuilder strippedKeyValue;
     for (const auto& elem : shardKeyValue) {
@@ -70,13 +90,264 @@ std::string extractKeyStringInternal(const BSONObj& shardKeyValue, Ordering orde
 
 }  // namespace
 
+ChunkMap::Block::Block(std::vector<Entry>::const_iterator begin,
+                       std::vector<Entry>::const_iterator end) {
+    invariant(begin != end);
+    invariant(size_t(end - begin) <= kMaxBlockSize);
+
+    _keyEnds.reserve(end - begin);
+    _chunks.reserve(end - begin);
+    for (auto it = begin; it != end; ++it) {
+        _keys.append(it->keyString);
+        _keyEnds.push_back(_keys.size());
+        _chunks.push_back(it->chunk);
+    }
+}
+
+size_t ChunkMap::Block::upperBound(StringData keyString) const {
+    size_t low = 0, high = size();
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (keyAt(mid).compare(keyString) <= 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+size_t ChunkMap::Block::lowerBound(StringData keyString) const {
+    size_t low = 0, high = size();
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (keyAt(mid).compare(keyString) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+ChunkMap::ConstIterator ChunkMap::upperBound(StringData keyString) const {
+    const auto it = std::partition_point(_blocks.begin(), _blocks.end(), [&](const auto& block) {
+        return block->lastKey().compare(keyString) <= 0;
+    });
+    if (it == _blocks.end()) {
+        return end();
+    }
+    return {&_blocks, size_t(it - _blocks.begin()), (*it)->upperBound(keyString)};
+}
+
+ChunkMap::ConstIterator ChunkMap::lowerBound(StringData keyString) const {
+    const auto it = std::partition_point(_blocks.begin(), _blocks.end(), [&](const auto& block) {
+        return block->lastKey().compare(keyString) < 0;
+    });
+    if (it == _blocks.end()) {
+        return end();
+    }
+    return {&_blocks, size_t(it - _blocks.begin()), (*it)->lowerBound(keyString)};
+}
+
+ChunkMap::Updater::Updater(const ChunkMap& base) : _size(base._size) {
+    _slots.reserve(base._blocks.size());
+    for (const auto& block : base._blocks) {
+        _slots.push_back({block, {}});
+    }
+}
+
+size_t ChunkMap::Updater::_slotSize(const Slot& slot) {
+    return slot.block ? slot.block->size() : slot.entries.size();
+}
+
+StringData ChunkMap::Updater::_keyAt(const Slot& slot, size_t pos) {
+    return slot.block ? slot.block->keyAt(pos) : StringData(slot.entries[pos].keyString);
+}
+
+const std::shared_ptr<ChunkInfo>& ChunkMap::Updater::_chunkAt(const Slot& slot, size_t pos) {
+    return slot.block ? slot.block->chunkAt(pos) : slot.entries[pos].chunk;
+}
+
+ChunkMap::Updater::Position ChunkMap::Updater::_upperBound(StringData keyString) const {
+    const auto it = std::partition_point(_slots.begin(), _slots.end(), [&](const Slot& slot) {
+        return _keyAt(slot, _slotSize(slot) - 1).compare(keyString) <= 0;
+    });
+    if (it == _slots.end()) {
+        return {_slots.size(), 0};
+    }
+
+    const size_t slot = it - _slots.begin();
+    if (it->block) {
+        return {slot, it->block->upperBound(keyString)};
+    }
+
+    const auto entryIt = std::upper_bound(
+        it->entries.begin(), it->entries.end(), keyString, [](StringData key, const Entry& entry) {
+            return key.compare(entry.keyString) < 0;
+        });
+    return {slot, size_t(entryIt - it->entries.begin())};
+}
+
+ChunkMap::Updater::Position ChunkMap::Updater::_next(Position position) const {
+    if (++position.pos == _slotSize(_slots[position.slot])) {
+        return {position.slot + 1, 0};
+    }
+    return position;
+}
+
+std::vector<ChunkMap::Entry>& ChunkMap::Updater::_thaw(size_t slot) {
+    auto& target = _slots[slot];
+    if (target.block) {
+        target.entries.reserve(target.block->size());
+        for (size_t i = 0; i < target.block->size(); ++i) {
+            target.entries.push_back({target.block->keyAt(i).toString(), target.block->chunkAt(i)});
+        }
+        target.block.reset();
+    }
+    return target.entries;
+}
+
+void ChunkMap::Updater::_erase(Position low, Position high) {
+    if (low == high) {
+        return;
+    }
+
+    if (low.slot == high.slot) {
+        auto& entries = _thaw(low.slot);
+        entries.erase(entries.begin() + low.pos, entries.begin() + high.pos);
+        _size -= high.pos - low.pos;
+        if (entries.empty()) {
+            _slots.erase(_slots.begin() + low.slot);
+        }
+        return;
+    }
+
+    // Slots which lie entirely within the erased range are dropped without being copied
+    size_t firstDropped = low.slot;
+    if (low.pos > 0) {
+        auto& entries = _thaw(low.slot);
+        _size -= entries.size() - low.pos;
+        entries.erase(entries.begin() + low.pos, entries.end());
+        ++firstDropped;
+    }
+
+    if (high.slot < _slots.size() && high.pos > 0) {
+        auto& entries = _thaw(high.slot);
+        entries.erase(entries.begin(), entries.begin() + high.pos);
+        _size -= high.pos;
+    }
+
+    for (size_t i = firstDropped; i < high.slot; ++i) {
+        _size -= _slotSize(_slots[i]);
+    }
+    _slots.erase(_slots.begin() + firstDropped, _slots.begin() + high.slot);
+}
+
+void ChunkMap::Updater::_insert(std::string keyString, std::shared_ptr<ChunkInfo> chunk) {
+    // The chunk belongs to the first slot whose last key does not sort before its own key, or, if
+    // there is no such slot, at the end of the last one
+    auto it = std::partition_point(_slots.begin(), _slots.end(), [&](const Slot& slot) {
+        return _keyAt(slot, _slotSize(slot) - 1).compare(keyString) < 0;
+    });
+    if (it == _slots.end()) {
+        if (_slots.empty()) {
+            it = _slots.insert(_slots.end(), Slot());
+        } else {
+            --it;
+        }
+    }
+
+    const size_t slot = it - _slots.begin();
+    auto& entries = _thaw(slot);
+    const auto entryIt = std::lower_bound(
+        entries.begin(), entries.end(), keyString, [](const Entry& entry, StringData key) {
+            return StringData(entry.keyString).compare(key) < 0;
+        });
+    entries.insert(entryIt, Entry{std::move(keyString), std::move(chunk)});
+    ++_size;
+
+    // Keep the copied slots short, so that inserting into them stays cheap
+    if (entries.size() > 2 * kMaxBlockSize) {
+        Slot upperHalf;
+        upperHalf.entries.assign(std::make_move_iterator(entries.begin() + kMaxBlockSize),
+                                 std::make_move_iterator(entries.end()));
+        entries.resize(kMaxBlockSize);
+        _slots.insert(_slots.begin() + slot + 1, std::move(upperHalf));
+    }
+}
+
+std::shared_ptr<ChunkInfo> ChunkMap::Updater::replace(
+    StringData minKeyString,
+    std::string maxKeyString,
+    std::shared_ptr<ChunkInfo> chunk,
+    std::vector<std::shared_ptr<ChunkInfo>>* replacedChunks) {
+    // Returns the first chunk with a max key that is > min - implies that the chunk overlaps min
+    const auto low = _upperBound(minKeyString);
+
+    // Returns the first chunk with a max key that is > max - implies that the next chunk cannot
+    // not overlap max
+    const auto high = _upperBound(maxKeyString);
+
+    std::shared_ptr<ChunkInfo> replaced;
+    if (low.slot < _slots.size() && (low == high || _next(low) == high)) {
+        replaced = _chunkAt(_slots[low.slot], low.pos);
+    }
+
+    if (replacedChunks) {
+        for (auto position = low; !(position == high); position = _next(position)) {
+            replacedChunks->push_back(_chunkAt(_slots[position.slot], position.pos));
+        }
+    }
+
+    _erase(low, high);
+    _insert(std::move(maxKeyString), std::move(chunk));
+
+    return replaced;
+}
+
+ChunkMap ChunkMap::Updater::done() {
+    ChunkMap result;
+    result._size = _size;
+
+    // Runs of consecutive copied slots are rebuilt into as few blocks as possible, of nearly equal
+    // sizes
+    std::vector<Entry> pending;
+    const auto flushPending = [&] {
+        const size_t numBlocks = (pending.size() + kMaxBlockSize - 1) / kMaxBlockSize;
+        auto begin = pending.cbegin();
+        for (size_t i = 0; i < numBlocks; ++i) {
+            const auto end = pending.cbegin() + pending.size() * (i + 1) / numBlocks;
+            result._blocks.push_back(std::make_shared<const Block>(begin, end));
+            begin = end;
+        }
+        pending.clear();
+    };
+
+    for (auto& slot : _slots) {
+        if (slot.block) {
+            flushPending();
+            result._blocks.push_back(std::move(slot.block));
+        } else {
+            pending.insert(pending.end(),
+                           std::make_move_iterator(slot.entries.begin()),
+                           std::make_move_iterator(slot.entries.end()));
+        }
+    }
+    flushPending();
+
+    _slots.clear();
+    return result;
+}
+
 RoutingTableHistory::RoutingTableHistory(NamespaceString nss,
                                          boost::optional<UUID> uuid,
                                          KeyPattern shardKeyPattern,
                                          std::unique_ptr<CollatorInterface> defaultCollator,
                                          bool unique,
-                                         ChunkInfoMap chunkMap,
-                                         ChunkVersion collectionVersion)
+                                         ChunkMap chunkMap,
+                                         ChunkVersion collectionVersion,
+                                         ShardVersionMap shardVersions)
     : _sequenceNumber(nextCMSequenceNumber.addAndFetch(1)),
       _nss(std::move(nss)),
       _uuid(uuid),
@@ -86,7 +357,7 @@ RoutingTableHistory::RoutingTableHistory(NamespaceString nss,
       _unique(unique),
       _chunkMap(std::move(chunkMap)),
       _collectionVersion(collectionVersion),
-      _shardVersions(_constructShardVersionMap()) {}
+      _shardVersions(std::move(shardVersions)) {}
 
 Chunk ChunkManager::findIntersectingChunk(const BSONObj& shardKey, const BSONObj& collation) const {
     const bool hasSimpleCollation = (collation.isEmpty() && !_rt->getDefaultCollator()) ||
@@ -100,25 +371,25 @@ Chunk ChunkManager::findIntersectingChunk(const BSONObj& shardKey, const BSONObj
         }
     }
 
-    const auto it = _rt->getChunkMap().upper_bound(_rt->_extractKeyString(shardKey));
+    const auto it = _rt->getChunkMap().upperBound(_rt->_extractKeyString(shardKey));
     uassert(ErrorCodes::ShardKeyNotFound,
             str::stream() << "Cannot target single shard using key " << shardKey,
-            it != _rt->getChunkMap().end() && it->second->containsKey(shardKey));
+            it != _rt->getChunkMap().end() && (*it)->containsKey(shardKey));
 
-    return Chunk(*(it->second), _clusterTime);
+    return Chunk(**it, _clusterTime);
 }
 
 bool ChunkManager::keyBelongsToShard(const BSONObj& shardKey, const ShardId& shardId) const {
     if (shardKey.isEmpty())
         return false;
 
-    const auto it = _rt->getChunkMap().upper_bound(_rt->_extractKeyString(shardKey));
+    const auto it = _rt->getChunkMap().upperBound(_rt->_extractKeyString(shardKey));
     if (it == _rt->getChunkMap().end())
         return false;
 
-    invariant(it->second->containsKey(shardKey));
+    invariant((*it)->containsKey(shardKey));
 
-    return it->second->getShardIdAt(_clusterTime) == shardId;
+    return (*it)->getShardIdAt(_clusterTime) == shardId;
 }
 
 void ChunkManager::getShardIdsForQuery(OperationContext* opCtx,
@@ -182,7 +453,7 @@ void ChunkManager::getShardIdsForQuery(OperationContext* opCtx,
     // For now, we satisfy that assumption by adding a shard with no matches rather than returning
     // an empty set of shards.
     if (shardIds->empty()) {
-        shardIds->insert(_rt->getChunkMap().begin()->second->getShardIdAt(_clusterTime));
+        shardIds->insert((*_rt->getChunkMap().begin())->getShardIdAt(_clusterTime));
     }
 }
 
@@ -191,7 +462,7 @@ void ChunkManager::getShardIdsForRange(const BSONObj& min,
                                        std::set<ShardId>* shardIds) const {
     const auto bounds = _rt->overlappingRanges(min, max, true);
     for (auto it = bounds.first; it != bounds.second; ++it) {
-        shardIds->insert(it->second->getShardIdAt(_clusterTime));
+        shardIds->insert((*it)->getShardIdAt(_clusterTime));
 
         // No need to iterate through the rest of the ranges, because we already know we need to use
         // all shards.
@@ -204,18 +475,42 @@ void ChunkManager::getShardIdsForRange(const BSONObj& min,
 bool ChunkManager::rangeOverlapsShard(const ChunkRange& range, const ShardId& shardId) const {
     const auto bounds = _rt->overlappingRanges(range.getMin(), range.getMax(), false);
     const auto it = std::find_if(bounds.first, bounds.second, [this, &shardId](const auto& scr) {
-        return scr.second->getShardIdAt(_clusterTime) == shardId;
+        return scr->getShardIdAt(_clusterTime) == shardId;
     });
 
     return it != bounds.second;
 }
 
+bool ChunkManager::rangeIsOwnedByShard(const BSONObj& min,
+                                       const BSONObj& max,
+                                       const ShardId& shardId) const {
+    const auto& chunkMap = _rt->getChunkMap();
+    const auto last = chunkMap.upperBound(_rt->_extractKeyString(max));
+
+    // The global max key is not contained in any chunk
+    if (last == chunkMap.end()) {
+        return false;
+    }
+
+    for (auto it = chunkMap.upperBound(_rt->_extractKeyString(min)); it != chunkMap.end(); ++it) {
+        if ((*it)->getShardIdAt(_clusterTime) != shardId) {
+            return false;
+        }
+
+        if (it == last) {
+            return true;
+        }
+    }
+
+    MONGO_UNREACHABLE;
+}
+
 ChunkManager::ConstRangeOfChunks ChunkManager::getNextChunkOnShard(const BSONObj& shardKey,
                                                                    const ShardId& shardId) const {
-    for (auto it = _rt->getChunkMap().upper_bound(_rt->_extractKeyString(shardKey));
+    for (auto it = _rt->getChunkMap().upperBound(_rt->_extractKeyString(shardKey));
          it != _rt->getChunkMap().end();
          ++it) {
-        const auto& chunk = it->second;
+        const auto& chunk = *it;
         if (chunk->getShardIdAt(_clusterTime) == shardId) {
             const auto begin = it;
             const auto end = ++it;
@@ -233,15 +528,15 @@ void RoutingTableHistory::getAllShardIds(std::set<ShardId>* all) const {
                    [](const ShardVersionMap::value_type& pair) { return pair.first; });
 }
 
-std::pair<ChunkInfoMap::const_iterator, ChunkInfoMap::const_iterator>
+std::pair<ChunkMap::const_iterator, ChunkMap::const_iterator>
 RoutingTableHistory::overlappingRanges(const BSONObj& min,
                                        const BSONObj& max,
                                        bool isMaxInclusive) const {
 
-    const auto itMin = _chunkMap.upper_bound(_extractKeyString(min));
+    const auto itMin = _chunkMap.upperBound(_extractKeyString(min));
     const auto itMax = [this, &max, isMaxInclusive]() {
-        auto it = isMaxInclusive ? _chunkMap.upper_bound(_extractKeyString(max))
-                                 : _chunkMap.lower_bound(_extractKeyString(max));
+        auto it = isMaxInclusive ? _chunkMap.upperBound(_extractKeyString(max))
+                                 : _chunkMap.lowerBound(_extractKeyString(max));
         return it == _chunkMap.end() ? it : ++it;
     }();
 
@@ -384,7 +679,7 @@ ChunkVersion RoutingTableHistory::getVersion(const ShardId& shardName) const {
         return ChunkVersion(0, 0, _collectionVersion.epoch());
     }
 
-    return it->second;
+    return it->second.shardVersion;
 }
 
 std::string RoutingTableHistory::toString() const {
@@ -393,98 +688,104 @@ std::string RoutingTableHistory::toString() const {
 
     sb << "Chunks:\n";
     for (const auto& chunk : _chunkMap) {
-        sb << "\t" << chunk.second->toString() << '\n';
+        sb << "\t" << chunk->toString() << '\n';
     }
 
     sb << "Shard versions:\n";
     for (const auto& entry : _shardVersions) {
-        sb << "\t" << entry.first << ": " << entry.second.toString() << '\n';
+        sb << "\t" << entry.first << ": " << entry.second.shardVersion.toString() << '\n';
     }
 
     return sb.str();
 }
 
-ShardVersionMap RoutingTableHistory::_constructShardVersionMap() const {
-    const OID& epoch = _collectionVersion.epoch();
+ShardVersionMap RoutingTableHistory::_constructShardVersionMap(
+    const ChunkMap& chunkMap, const ChunkVersion& collectionVersion) const {
+    const OID& epoch = collectionVersion.epoch();
 
     ShardVersionMap shardVersions;
-    ChunkInfoMap::const_iterator current = _chunkMap.cbegin();
+    ChunkMap::const_iterator current = chunkMap.begin();
 
-    boost::optional<BSONObj> firstMin = boost::none;
-    boost::optional<BSONObj> lastMax = boost::none;
+    std::shared_ptr<ChunkInfo> lastChunkInPreviousRange;
 
-    while (current != _chunkMap.cend()) {
-        const auto& firstChunkInRange = current->second;
+    while (current != chunkMap.end()) {
+        const auto& firstChunkInRange = *current;
         const auto& currentRangeShardId = firstChunkInRange->getShardIdAt(boost::none);
 
         // Tracks the max shard version for the shard on which the current range will reside
         auto shardVersionIt = shardVersions.find(currentRangeShardId);
         if (shardVersionIt == shardVersions.end()) {
             shardVersionIt =
-                shardVersions.emplace(currentRangeShardId, ChunkVersion(0, 0, epoch)).first;
+                shardVersions
+                    .emplace(currentRangeShardId,
+                             ShardVersionTargetingInfo{ChunkVersion(0, 0, epoch), 0})
+                    .first;
         }
 
-        auto& maxShardVersion = shardVersionIt->second;
-
-        current =
-            std::find_if(current,
-                         _chunkMap.cend(),
-                         [&currentRangeShardId,
-                          &maxShardVersion](const ChunkInfoMap::value_type& chunkMapEntry) {
-                             const auto& currentChunk = chunkMapEntry.second;
+        auto& shardInfo = shardVersionIt->second;
 
-                             if (currentChunk->getShardIdAt(boost::none) != currentRangeShardId)
-                                 return true;
+        current = std::find_if(
+            current,
+            chunkMap.end(),
+            [&currentRangeShardId, &shardInfo](const std::shared_ptr<ChunkInfo>& currentChunk) {
+                if (currentChunk->getShardIdAt(boost::none) != currentRangeShardId)
+                    return true;
 
-                             if (currentChunk->getLastmod() > maxShardVersion)
-                                 maxShardVersion = currentChunk->getLastmod();
+                if (currentChunk->getLastmod() > shardInfo.shardVersion)
+                    shardInfo.shardVersion = currentChunk->getLastmod();
 
-                             return false;
-                         });
-
-        const auto rangeLast = std::prev(current);
-
-        const auto& rangeMin = firstChunkInRange->getMin();
-        const auto& rangeMax = rangeLast->second->getMax();
+                ++shardInfo.numChunks;
+                return false;
+            });
 
         // Check the continuity of the chunks map
-        if (lastMax && !SimpleBSONObjComparator::kInstance.evaluate(*lastMax == rangeMin)) {
-            if (SimpleBSONObjComparator::kInstance.evaluate(*lastMax < rangeMin))
-                uasserted(ErrorCodes::ConflictingOperationInProgress,
-                          str::stream()
-                              << "Gap exists in the routing table between chunks "
-                              << _chunkMap.at(_extractKeyString(*lastMax))->getRange().toString()
-                              << " and " << rangeLast->second->getRange().toString());
-            else
-                uasserted(ErrorCodes::ConflictingOperationInProgress,
-                          str::stream()
-                              << "Overlap exists in the routing table between chunks "
-                              << _chunkMap.at(_extractKeyString(*lastMax))->getRange().toString()
-                              << " and " << rangeLast->second->getRange().toString());
+        if (lastChunkInPreviousRange) {
+            checkChunksAreContiguous(*lastChunkInPreviousRange, *firstChunkInRange);
         }
 
-        if (!firstMin)
-            firstMin = rangeMin;
-
-        lastMax = rangeMax;
+        lastChunkInPreviousRange = *std::prev(current);
 
         // If a shard has chunks it must have a shard version, otherwise we have an invalid chunk
         // somewhere, which should have been caught at chunk load time
-        invariant(maxShardVersion.isSet());
+        invariant(shardInfo.shardVersion.isSet());
     }
 
-    if (!_chunkMap.empty()) {
+    if (!chunkMap.empty()) {
         invariant(!shardVersions.empty());
-        invariant(firstMin.is_initialized());
-        invariant(lastMax.is_initialized());
 
-        checkAllElementsAreOfType(MinKey, firstMin.get());
-        checkAllElementsAreOfType(MaxKey, lastMax.get());
+        checkAllElementsAreOfType(MinKey, (*chunkMap.begin())->getMin());
+        checkAllElementsAreOfType(MaxKey, lastChunkInPreviousRange->getMax());
     }
 
     return shardVersions;
 }
 
+void RoutingTableHistory::_checkChangedChunksAreContiguous(
+    const ChunkMap& chunkMap, const std::vector<std::string>& changedMaxKeyStrings) const {
+    invariant(!chunkMap.empty());
+
+    checkAllElementsAreOfType(MinKey, (*chunkMap.begin())->getMin());
+    checkAllElementsAreOfType(MaxKey, (*std::prev(chunkMap.end()))->getMax());
+
+    // Any gap or overlap introduced by the changes must border on the chunk which ended up
+    // covering the max key of one of the changed chunks
+    for (const auto& maxKeyString : changedMaxKeyStrings) {
+        const auto it = chunkMap.lowerBound(maxKeyString);
+        if (it == chunkMap.end()) {
+            continue;
+        }
+
+        if (it != chunkMap.begin()) {
+            checkChunksAreContiguous(**std::prev(it), **it);
+        }
+
+        const auto next = std::next(it);
+        if (next != chunkMap.end()) {
+            checkChunksAreContiguous(**it, **next);
+        }
+    }
+}
+
 std::string RoutingTableHistory::_extractKeyString(const BSONObj& shardKeyValue) const {
     return extractKeyStringInternal(shardKeyValue, _shardKeyOrdering);
 }
@@ -503,7 +804,8 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeNew(
                                std::move(defaultCollator),
                                std::move(unique),
                                {},
-                               {0, 0, epoch})
+                               {0, 0, epoch},
+                               {})
         .makeUpdated(chunks);
 }
 
@@ -511,7 +813,18 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
     const std::vector<ChunkType>& changedChunks) {
 
     const auto startingCollectionVersion = getVersion();
-    auto chunkMap = _chunkMap;
+    ChunkMap::Updater chunkMapUpdater(_chunkMap);
+
+    // The shard versions are maintained along with the chunk map, so that the cost of an update
+    // depends only on the number of changed chunks rather than on the size of the routing table.
+    // Since the changed chunks come in version order, each of them has the highest version of all
+    // the chunks applied so far. The only case which requires going over all the chunks again is
+    // when a shard loses the chunk with its highest version without getting any newer one.
+    ShardVersionMap shardVersions(_shardVersions);
+    std::set<ShardId> shardsWhichLostMaxChunk;
+    std::vector<std::string> changedMaxKeyStrings;
+    changedMaxKeyStrings.reserve(changedChunks.size());
+    std::vector<std::shared_ptr<ChunkInfo>> replacedChunks;
 
     ChunkVersion collectionVersion = startingCollectionVersion;
     for (const auto& chunk : changedChunks) {
@@ -528,44 +841,53 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
         invariant(chunkVersion >= collectionVersion);
         collectionVersion = chunkVersion;
 
-        const auto chunkMinKeyString = _extractKeyString(chunk.getMin());
-        const auto chunkMaxKeyString = _extractKeyString(chunk.getMax());
-
-        // Returns the first chunk with a max key that is > min - implies that the chunk overlaps
-        // min
-        const auto low = chunkMap.upper_bound(chunkMinKeyString);
-
-        // Returns the first chunk with a max key that is > max - implies that the next chunk cannot
-        // not overlap max
-        const auto high = chunkMap.upper_bound(chunkMaxKeyString);
-
-        // If we are in the middle of splitting a chunk, for the first few
-        // chunks inserted, low == high, because both lookups will point to the
-        // same chunk (the one being split). If we're inserting the last chunk
-        // for the current chunk being split, low will point to the chunk that
-        // we're splitting, and high will point to the next chunk past the one
-        // we're splitting (which could be chunkMap.end()). In this case,
-        // std::distance(low, high) == 1. Lastly, this does not apply during
-        // the creation of the original routing table, in which case the map is
-        // empty and the first chunk that is inserted will find that low ==
-        // high, but low == chunkMap.end(), and we aren't doing a split in that
-        // case.
-        auto foundSingleChunk =
-            ((low == high || std::distance(low, high) == 1) && low != chunkMap.end());
-
+        // Erase all chunks from the map, which overlap the chunk we got from the persistent store,
+        // and insert only the chunk itself.
+        //
+        // If we are in the middle of splitting a chunk, for the first few chunks inserted, the only
+        // chunk which overlaps them is the one being split. For the last chunk inserted for the
+        // chunk being split, the only chunk overlapping it is the one it replaces. In both cases
+        // the updater returns the chunk being split, so that the bytes written to it carry over
+        // to the chunks resulting from the split. This does not apply during the creation of the
+        // original routing table, in which case the map is empty and no chunk is returned.
         auto newChunk = std::make_shared<ChunkInfo>(chunk);
-        if (foundSingleChunk) {
-            auto chunkBeingReplacedBySplit = low->second;
+        changedMaxKeyStrings.push_back(_extractKeyString(chunk.getMax()));
+        replacedChunks.clear();
+        const auto chunkBeingReplacedBySplit =
+            chunkMapUpdater.replace(_extractKeyString(chunk.getMin()),
+                                    changedMaxKeyStrings.back(),
+                                    newChunk,
+                                    &replacedChunks);
+        if (chunkBeingReplacedBySplit) {
             auto bytesInReplacedChunk =
                 chunkBeingReplacedBySplit->getWritesTracker()->getBytesWritten();
             newChunk->getWritesTracker()->addBytesWritten(bytesInReplacedChunk);
         }
 
-        // Erase all chunks from the map, which overlap the chunk we got from the persistent store
-        chunkMap.erase(low, high);
+        for (const auto& replacedChunk : replacedChunks) {
+            const auto& shardId = replacedChunk->getShardIdAt(boost::none);
+            auto it = shardVersions.find(shardId);
+            invariant(it != shardVersions.end());
+
+            if (--it->second.numChunks == 0) {
+                shardVersions.erase(it);
+                shardsWhichLostMaxChunk.erase(shardId);
+            } else if (replacedChunk->getLastmod() == it->second.shardVersion) {
+                shardsWhichLostMaxChunk.insert(shardId);
+            }
+        }
 
-        // Insert only the chunk itself
-        chunkMap.insert(std::make_pair(chunkMaxKeyString, newChunk));
+        const auto& shardId = newChunk->getShardIdAt(boost::none);
+        auto& shardInfo =
+            shardVersions
+                .emplace(shardId,
+                         ShardVersionTargetingInfo{ChunkVersion(0, 0, chunkVersion.epoch()), 0})
+                .first->second;
+        if (chunkVersion > shardInfo.shardVersion) {
+            shardInfo.shardVersion = chunkVersion;
+        }
+        ++shardInfo.numChunks;
+        shardsWhichLostMaxChunk.erase(shardId);
     }
 
     // If at least one diff was applied, the metadata is correct, but it might not have changed so
@@ -579,6 +901,13 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
         return shared_from_this();
     }
 
+    auto chunkMap = chunkMapUpdater.done();
+    if (!shardsWhichLostMaxChunk.empty()) {
+        shardVersions = _constructShardVersionMap(chunkMap, collectionVersion);
+    } else {
+        _checkChangedChunksAreContiguous(chunkMap, changedMaxKeyStrings);
+    }
+
     return std::shared_ptr<RoutingTableHistory>(
         new RoutingTableHistory(_nss,
                                 _uuid,
@@ -586,7 +915,8 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
                                 CollatorInterface::cloneCollator(getDefaultCollator()),
                                 isUnique(),
                                 std::move(chunkMap),
-                                collectionVersion));
+                                collectionVersion,
+                                std::move(shardVersions)));
 }
 
 }  // namespace mongo
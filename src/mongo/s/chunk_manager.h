@@ -29,11 +29,13 @@
 
 #pragma once
 
+#include <iterator>
 #include <map>
 #include <set>
 #include <string>
 #include <vector>
 
+#include "mongo/base/string_data.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/s/chunk.h"
@@ -49,11 +51,235 @@ struct QuerySolutionNode;
 class OperationContext;
 class ChunkManager;
 
-// Ordered map from the max for each chunk to an entry describing the chunk
-using ChunkInfoMap = std::map<std::string, std::shared_ptr<ChunkInfo>>;
+/**
+ * Ordered map from the KeyString encoding of the max key of each chunk to the entry describing that
+ * chunk.
+ *
+ * The chunks are kept in blocks of consecutive chunks, each of which stores the encoded max keys of
+ * its chunks back to back in a single buffer. A lookup is therefore a binary search over the blocks
+ * followed by one within a contiguous buffer, rather than a walk down a tree of individually
+ * allocated nodes. Blocks are immutable once built and are shared between the maps of successive
+ * versions of a routing table, so that an incremental refresh only copies the blocks it touches.
+ */
+class ChunkMap {
+    struct Entry {
+        std::string keyString;
+        std::shared_ptr<ChunkInfo> chunk;
+    };
+
+    /**
+     * A run of consecutive chunks, no more than kMaxBlockSize long.
+     */
+    class Block {
+    public:
+        Block(std::vector<Entry>::const_iterator begin, std::vector<Entry>::const_iterator end);
+
+        size_t size() const {
+            return _chunks.size();
+        }
+
+        StringData keyAt(size_t i) const {
+            const uint32_t start = i ? _keyEnds[i - 1] : 0;
+            return StringData(_keys.data() + start, _keyEnds[i] - start);
+        }
+
+        StringData lastKey() const {
+            return keyAt(size() - 1);
+        }
+
+        const std::shared_ptr<ChunkInfo>& chunkAt(size_t i) const {
+            return _chunks[i];
+        }
+
+        /**
+         * Return the index of the first chunk whose key sorts after (upperBound) or not before
+         * (lowerBound) 'keyString', or size() if there is none.
+         */
+        size_t upperBound(StringData keyString) const;
+        size_t lowerBound(StringData keyString) const;
+
+    private:
+        // The keys of all chunks concatenated, and the offset at which each of them ends
+        std::string _keys;
+        std::vector<uint32_t> _keyEnds;
+
+        std::vector<std::shared_ptr<ChunkInfo>> _chunks;
+    };
+
+    using BlockVector = std::vector<std::shared_ptr<const Block>>;
+
+public:
+    // The maximum number of chunks stored in a single block
+    static constexpr size_t kMaxBlockSize = 256;
+
+    class ConstIterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = std::shared_ptr<ChunkInfo>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        ConstIterator() = default;
+
+        reference operator*() const {
+            return (*_blocks)[_block]->chunkAt(_pos);
+        }
+        pointer operator->() const {
+            return &operator*();
+        }
+
+        /**
+         * Returns the KeyString encoding of the max key of the current chunk.
+         */
+        StringData keyString() const {
+            return (*_blocks)[_block]->keyAt(_pos);
+        }
+
+        ConstIterator& operator++() {
+            if (++_pos == (*_blocks)[_block]->size()) {
+                ++_block;
+                _pos = 0;
+            }
+            return *this;
+        }
+        ConstIterator operator++(int) {
+            auto result = *this;
+            ++*this;
+            return result;
+        }
+        ConstIterator& operator--() {
+            if (_pos == 0) {
+                _pos = (*_blocks)[--_block]->size();
+            }
+            --_pos;
+            return *this;
+        }
+        ConstIterator operator--(int) {
+            auto result = *this;
+            --*this;
+            return result;
+        }
+
+        bool operator==(const ConstIterator& other) const {
+            return _block == other._block && _pos == other._pos && _blocks == other._blocks;
+        }
+        bool operator!=(const ConstIterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        friend class ChunkMap;
+
+        ConstIterator(const BlockVector* blocks, size_t block, size_t pos)
+            : _blocks(blocks), _block(block), _pos(pos) {}
+
+        const BlockVector* _blocks{nullptr};
+        size_t _block{0};
+        size_t _pos{0};
+    };
+
+    using const_iterator = ConstIterator;
+
+    /**
+     * Applies a sequence of changed chunks on top of an existing map. The blocks of the existing
+     * map which no change touches are shared with the resulting map rather than copied.
+     */
+    class Updater {
+    public:
+        explicit Updater(const ChunkMap& base);
+
+        /**
+         * Replaces all chunks whose max key sorts after 'minKeyString' and not after
+         * 'maxKeyString' with 'chunk', whose max key is 'maxKeyString'. If at most one existing
+         * chunk overlaps 'chunk', that is 'chunk' is either being split out of it or replaces it
+         * outright, returns that chunk, and nullptr otherwise. If 'replacedChunks' is not null,
+         * all the chunks which were removed from the map are appended to it.
+         */
+        std::shared_ptr<ChunkInfo> replace(
+            StringData minKeyString,
+            std::string maxKeyString,
+            std::shared_ptr<ChunkInfo> chunk,
+            std::vector<std::shared_ptr<ChunkInfo>>* replacedChunks = nullptr);
+
+        /**
+         * Returns the resulting map. The updater must not be used afterwards.
+         */
+        ChunkMap done();
+
+    private:
+        // A block of the map under construction, which is either still shared with the base map
+        // or has been copied into 'entries' because a change touched it
+        struct Slot {
+            std::shared_ptr<const Block> block;
+            std::vector<Entry> entries;
+        };
+
+        struct Position {
+            size_t slot;
+            size_t pos;
+
+            bool operator==(const Position& other) const {
+                return slot == other.slot && pos == other.pos;
+            }
+        };
+
+        static size_t _slotSize(const Slot& slot);
+        static StringData _keyAt(const Slot& slot, size_t pos);
+        static const std::shared_ptr<ChunkInfo>& _chunkAt(const Slot& slot, size_t pos);
+
+        Position _upperBound(StringData keyString) const;
+        Position _next(Position position) const;
+
+        std::vector<Entry>& _thaw(size_t slot);
+
+        void _erase(Position low, Position high);
+        void _insert(std::string keyString, std::shared_ptr<ChunkInfo> chunk);
+
+        std::vector<Slot> _slots;
+        size_t _size;
+    };
+
+    ChunkMap() = default;
+
+    ConstIterator begin() const {
+        return {&_blocks, 0, 0};
+    }
+    ConstIterator end() const {
+        return {&_blocks, _blocks.size(), 0};
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * Return the first chunk whose max key sorts after (upperBound) or not before (lowerBound)
+     * 'keyString', or end() if there is none.
+     */
+    ConstIterator upperBound(StringData keyString) const;
+    ConstIterator lowerBound(StringData keyString) const;
+
+private:
+    BlockVector _blocks;
+    size_t _size{0};
+};
+
+struct ShardVersionTargetingInfo {
+    // Max chunk version for the shard
+    ChunkVersion shardVersion;
+
+    // Number of chunks owned by the shard, so that the entry can be dropped when a routing table
+    // update moves the last of them away
+    size_t numChunks{0};
+};
 
 // Map from a shard is to the max chunk version on that shard
-using ShardVersionMap = std::map<ShardId, ChunkVersion>;
+using ShardVersionMap = std::map<ShardId, ShardVersionTargetingInfo>;
 
 /**
  * In-memory representation of the routing table for a single sharded collection at various points
@@ -122,7 +348,7 @@ public:
 
     ChunkVersion getVersion(const ShardId& shardId) const;
 
-    const ChunkInfoMap& getChunkMap() const {
+    const ChunkMap& getChunkMap() const {
         return _chunkMap;
     }
 
@@ -146,7 +372,7 @@ public:
         return _uuid;
     }
 
-    std::pair<ChunkInfoMap::const_iterator, ChunkInfoMap::const_iterator> overlappingRanges(
+    std::pair<ChunkMap::const_iterator, ChunkMap::const_iterator> overlappingRanges(
         const BSONObj& min, const BSONObj& max, bool isMaxInclusive) const;
 
 
@@ -156,13 +382,24 @@ private:
                         KeyPattern shardKeyPattern,
                         std::unique_ptr<CollatorInterface> defaultCollator,
                         bool unique,
-                        ChunkInfoMap chunkMap,
-                        ChunkVersion collectionVersion);
+                        ChunkMap chunkMap,
+                        ChunkVersion collectionVersion,
+                        ShardVersionMap shardVersions);
+
+    /**
+     * Does a single pass over 'chunkMap' and constructs the ShardVersionMap object, checking that
+     * the chunks cover the entire shard key space without gaps or overlaps.
+     */
+    ShardVersionMap _constructShardVersionMap(const ChunkMap& chunkMap,
+                                              const ChunkVersion& collectionVersion) const;
 
     /**
-     * Does a single pass over the chunkMap and constructs the ShardVersionMap object.
+     * Checks that 'chunkMap', which is the result of applying changes to a map known to cover the
+     * entire shard key space, still does so. Only the neighbourhoods of the changed chunks, whose
+     * max keys are 'changedMaxKeyStrings', are inspected.
      */
-    ShardVersionMap _constructShardVersionMap() const;
+    void _checkChangedChunksAreContiguous(
+        const ChunkMap& chunkMap, const std::vector<std::string>& changedMaxKeyStrings) const;
 
     std::string _extractKeyString(const BSONObj& shardKeyValue) const;
 
@@ -189,7 +426,7 @@ private:
 
     // Map from the max for each chunk to an entry describing the chunk. The union of all chunks'
     // ranges must cover the complete space from [MinKey, MaxKey).
-    const ChunkInfoMap _chunkMap;
+    const ChunkMap _chunkMap;
 
     // Max version across all chunks
     const ChunkVersion _collectionVersion;
@@ -211,7 +448,7 @@ public:
     class ConstChunkIterator {
     public:
         ConstChunkIterator() = default;
-        explicit ConstChunkIterator(ChunkInfoMap::const_iterator iter,
+        explicit ConstChunkIterator(ChunkMap::const_iterator iter,
                                     boost::optional<Timestamp> clusterTime)
             : _iter{std::move(iter)}, _clusterTime{std::move(clusterTime)} {}
 
@@ -229,11 +466,11 @@ public:
             return !(*this == other);
         }
         const Chunk operator*() const {
-            return Chunk{*_iter->second, _clusterTime};
+            return Chunk{**_iter, _clusterTime};
         }
 
     private:
-        ChunkInfoMap::const_iterator _iter;
+        ChunkMap::const_iterator _iter;
         boost::optional<Timestamp> _clusterTime;
     };
 
@@ -289,8 +526,8 @@ public:
     }
 
     ConstRangeOfChunks chunks() const {
-        return {ConstChunkIterator{_rt->getChunkMap().cbegin(), _clusterTime},
-                ConstChunkIterator{_rt->getChunkMap().cend(), _clusterTime}};
+        return {ConstChunkIterator{_rt->getChunkMap().begin(), _clusterTime},
+                ConstChunkIterator{_rt->getChunkMap().end(), _clusterTime}};
     }
 
     int numChunks() const {
@@ -309,6 +546,12 @@ public:
      */
     bool rangeOverlapsShard(const ChunkRange& range, const ShardId& shardId) const;
 
+    /**
+     * Returns true if every key between "min" and "max", both inclusive, falls within a chunk owned
+     * by the shard with the given "shardId". "min" must not sort after "max".
+     */
+    bool rangeIsOwnedByShard(const BSONObj& min, const BSONObj& max, const ShardId& shardId) const;
+
     /**
      * Given a shardKey, returns the first chunk which is owned by shardId and overlaps or sorts
      * after that shardKey. The returned iterator range always contains one or zero entries. If zero
@@ -122,7 +122,36 @@ void BM_IncrementalRefreshOfPessimalBalancedDistribution(benchmark::State& state
     }
 }
 
-BENCHMARK(BM_IncrementalRefreshOfPessimalBalancedDistribution)->Args({2, 50000});
+BENCHMARK(BM_IncrementalRefreshOfPessimalBalancedDistribution)
+    ->Args({2, 50000})
+    ->Args({2, 1000000});
+
+void BM_IncrementalRefreshAfterSplit(benchmark::State& state) {
+    const int nShards = state.range(0);
+    const int nChunks = state.range(1);
+    auto cm = makeChunkManagerWithOptimalBalancedDistribution(nShards, nChunks);
+
+    // Split a chunk in the middle of the routing table into two
+    const auto chunkToSplit = getRangeForChunk(nChunks / 2, nChunks);
+    const auto splitPoint = BSON("_id" << chunkToSplit.getMin()["_id"].numberInt() + 50);
+    const auto shardId = optimalShardSelector(nChunks / 2, nShards, nChunks);
+
+    auto postSplitVersion = cm->getChunkManager()->getVersion();
+    const auto collName = NamespaceString(cm->getChunkManager()->getns());
+    std::vector<ChunkType> newChunks;
+    postSplitVersion.incMinor();
+    newChunks.emplace_back(
+        collName, ChunkRange(chunkToSplit.getMin(), splitPoint), postSplitVersion, shardId);
+    postSplitVersion.incMinor();
+    newChunks.emplace_back(
+        collName, ChunkRange(splitPoint, chunkToSplit.getMax()), postSplitVersion, shardId);
+
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(runIncrementalUpdate(*cm, newChunks));
+    }
+}
+
+BENCHMARK(BM_IncrementalRefreshAfterSplit)->Args({2, 50000})->Args({2, 1000000});
 
 template <typename ShardSelectorFn>
 auto BM_FullBuildOfChunkManager(benchmark::State& state, ShardSelectorFn selectShard) {
@@ -291,6 +320,62 @@ void BM_KeyBelongsToMe(benchmark::State& state,
     state.SetItemsProcessed(state.iterations());
 }
 
+std::vector<BSONObj> makeSortedKeys(int nChunks) {
+    auto keys = makeKeys(nChunks);
+    std::sort(keys.begin(), keys.end(), SimpleBSONObjComparator::kInstance.makeLessThan());
+    return keys;
+}
+
+// Filters the shard keys in the order an index scan over the shard key would return them, looking
+// each of them up in the routing table
+template <typename CollectionMetadataBuilderFn>
+void BM_KeyBelongsToMeInKeyOrder(benchmark::State& state,
+                                 CollectionMetadataBuilderFn makeCollectionMetadata) {
+    const int nShards = state.range(0);
+    const int nChunks = state.range(1);
+
+    auto cm = makeCollectionMetadata(nShards, nChunks);
+    auto keys = makeSortedKeys(nChunks);
+    auto keysIter = makeCircularIterator(keys);
+
+    size_t nOwned = 0;
+
+    for (auto keepRunning : state) {
+        if (cm->keyBelongsToMe(*keysIter)) {
+            ++nOwned;
+        }
+        ++keysIter;
+    }
+
+    state.counters["nOwned"] = nOwned;
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Same as above, but only looks up the keys which fall outside of the chunk of the previous key
+template <typename CollectionMetadataBuilderFn>
+void BM_KeyBelongsToMeInKeyOrderWithLastChunk(benchmark::State& state,
+                                              CollectionMetadataBuilderFn makeCollectionMetadata) {
+    const int nShards = state.range(0);
+    const int nChunks = state.range(1);
+
+    auto cm = makeCollectionMetadata(nShards, nChunks);
+    auto keys = makeSortedKeys(nChunks);
+    auto keysIter = makeCircularIterator(keys);
+
+    size_t nOwned = 0;
+    boost::optional<Chunk> lastChunk;
+
+    for (auto keepRunning : state) {
+        if (cm->keyBelongsToMe(*keysIter, &lastChunk)) {
+            ++nOwned;
+        }
+        ++keysIter;
+    }
+
+    state.counters["nOwned"] = nOwned;
+    state.SetItemsProcessed(state.iterations());
+}
+
 template <typename CollectionMetadataBuilderFn>
 void BM_RangeOverlapsChunk(benchmark::State& state,
                            CollectionMetadataBuilderFn makeCollectionMetadata) {
@@ -348,7 +433,27 @@ MONGO_INITIALIZER(RegisterBenchmarks)(InitializerContext* context) {
             ->Args({10, 50000})
             ->Args({100, 50000})
             ->Args({1000, 50000})
-            ->Args({2, 2});
+            ->Args({2, 2})
+            ->Args({2, 1000000})
+            ->Args({100, 1000000});
+    }
+
+    std::initializer_list<benchmark::internal::Benchmark*> filteringBmCases{
+        REGISTER_BENCHMARK_CAPTURE(BM_KeyBelongsToMeInKeyOrder,
+                                   Pessimal,
+                                   makeChunkManagerWithPessimalBalancedDistribution),
+        REGISTER_BENCHMARK_CAPTURE(
+            BM_KeyBelongsToMeInKeyOrder, Optimal, makeChunkManagerWithOptimalBalancedDistribution),
+        REGISTER_BENCHMARK_CAPTURE(BM_KeyBelongsToMeInKeyOrderWithLastChunk,
+                                   Pessimal,
+                                   makeChunkManagerWithPessimalBalancedDistribution),
+        REGISTER_BENCHMARK_CAPTURE(BM_KeyBelongsToMeInKeyOrderWithLastChunk,
+                                   Optimal,
+                                   makeChunkManagerWithOptimalBalancedDistribution),
+    };
+
+    for (auto bmCase : filteringBmCases) {
+        bmCase->Args({2, 1000})->Args({2, 100000})->Args({10, 100000});
     }
 
     return Status::OK();
@@ -39,6 +39,7 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/util/assert_util.h"
@@ -79,6 +80,53 @@ int compareSortKeys(BSONObj leftSortKey, BSONObj rightSortKey, BSONObj sortKeyPa
     return leftSortKey.woCompare(rightSortKey, sortKeyPattern, considerFieldName);
 }
 
+/**
+ * Returns the orderings with which to encode the sort keys for 'sortPattern' into KeyStrings. An
+ * Ordering describes at most Ordering::kMaxCompoundIndexKeys fields, so there is one for each
+ * slice of that many fields of the pattern.
+ */
+std::vector<Ordering> makeSortKeyOrderings(const BSONObj& sortPattern) {
+    std::vector<Ordering> orderings;
+    BSONObjIterator it(sortPattern);
+    do {
+        BSONObjBuilder slice;
+        for (size_t i = 0; i < Ordering::kMaxCompoundIndexKeys && it.more(); ++i) {
+            slice.append(it.next());
+        }
+        orderings.push_back(Ordering::make(slice.obj()));
+    } while (it.more());
+    return orderings;
+}
+
+/**
+ * Encodes 'sortKey' into a KeyString, such that comparing the encoded keys with memcmp agrees with
+ * compareSortKeys(). Strings need no collation since mongod has already mapped them to their ICU
+ * comparison keys.
+ */
+KeyString::Value encodeSortKey(const BSONObj& sortKey, const std::vector<Ordering>& orderings) {
+    if (orderings.size() == 1) {
+        return KeyString::HeapBuilder(KeyString::Version::V1, sortKey, orderings.front())
+            .release();
+    }
+
+    // The sort keys for a pattern all have the same number of fields and encoded values are
+    // self-delimiting, so concatenating the encodings of the slices preserves the order of the
+    // whole sort keys. The type bits are dropped, since these keys are never decoded.
+    BufBuilder buffer;
+    BSONObjIterator it(sortKey);
+    for (const auto& ordering : orderings) {
+        BSONObjBuilder slice;
+        for (size_t i = 0; i < Ordering::kMaxCompoundIndexKeys && it.more(); ++i) {
+            slice.append(it.next());
+        }
+        KeyString::Builder encodedSlice(KeyString::Version::V1, slice.obj(), ordering);
+        buffer.appendBuf(encodedSlice.getBuffer(), encodedSlice.getSize());
+    }
+    const int32_t keySize = buffer.len();
+    buffer.appendChar(0);
+    return {KeyString::Version::V1, keySize, buffer.len(), buffer.release()};
+}
+
 }  // namespace
 
 AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
@@ -91,8 +139,7 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
       // since that is not supported we treat boost::none (unspecified) to mean 'kNormal'.
       _tailableMode(params.getTailableMode().value_or(TailableModeEnum::kNormal)),
       _params(std::move(params)),
-      _mergeQueue(MergingComparator(
-          _remotes, _params.getSort().value_or(BSONObj()), _params.getCompareWholeSortKey())),
+      _sortKeyOrderings(makeSortKeyOrderings(_params.getSort().value_or(BSONObj()))),
       _promisedMinSortKeys(PromisedMinSortKeyComparator(_params.getSort().value_or(BSONObj()))) {
     if (params.getTxnNumber()) {
         invariant(params.getSessionId());
@@ -103,6 +150,7 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
         _remotes.emplace_back(remote.getHostAndPort(),
                               remote.getCursorResponse().getNSS(),
                               remote.getCursorResponse().getCursorId());
+        _mergeTree.addStream();
 
         // We don't check the return value of _addBatchToBuffer here; if there was an error,
         // it will be stored in the remote and the first call to ready() will return true.
@@ -184,6 +232,7 @@ void AsyncResultsMerger::addNewShardCursors(std::vector<RemoteCursor>&& newCurso
         _remotes.emplace_back(remote.getHostAndPort(),
                               remote.getCursorResponse().getNSS(),
                               remote.getCursorResponse().getCursorId());
+        _mergeTree.addStream();
         _addBatchToBuffer(lk, newIndex, remote.getCursorResponse());
     }
 }
@@ -242,11 +291,11 @@ bool AsyncResultsMerger::_readySorted(WithLock lk) {
 }
 
 bool AsyncResultsMerger::_readySortedTailable(WithLock lk) {
-    if (_mergeQueue.empty()) {
+    if (_mergeTree.empty()) {
         return false;
     }
 
-    auto smallestRemote = _mergeQueue.top();
+    auto smallestRemote = _mergeTree.top();
     auto smallestResult = _remotes[smallestRemote].docBuffer.front();
     auto keyWeWantToReturn =
         extractSortKey(*smallestResult.getResult(), _params.getCompareWholeSortKey());
@@ -290,16 +339,15 @@ StatusWith<ClusterQueryResult> AsyncResultsMerger::nextReady() {
     return _params.getSort() ? _nextReadySorted(lk) : _nextReadyUnsorted(lk);
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock lk) {
     // Tailable non-awaitData cursors cannot have a sort.
     invariant(_tailableMode != TailableModeEnum::kTailable);
 
-    if (_mergeQueue.empty()) {
+    if (_mergeTree.empty()) {
         return {};
     }
 
-    size_t smallestRemote = _mergeQueue.top();
-    _mergeQueue.pop();
+    size_t smallestRemote = _mergeTree.top();
 
     invariant(!_remotes[smallestRemote].docBuffer.empty());
     invariant(_remotes[smallestRemote].status.isOK());
@@ -307,11 +355,8 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
     _remotes[smallestRemote].docBuffer.pop();
 
-    // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
-    // next result.
-    if (!_remotes[smallestRemote].docBuffer.empty()) {
-        _mergeQueue.push(smallestRemote);
-    }
+    // Replay the merge with the next result from 'smallestRemote', if it has a next result.
+    _updateMergeTree(lk, smallestRemote);
 
     // For sorted tailable awaitData cursors, update the high water mark to the document's sort key.
     if (_tailableMode == TailableModeEnum::kTailableAndAwaitData) {
@@ -322,6 +367,18 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     return front;
 }
 
+void AsyncResultsMerger::_updateMergeTree(WithLock, size_t remoteIndex) {
+    const auto& remote = _remotes[remoteIndex];
+    if (!remote.hasNext()) {
+        _mergeTree.clearKey(remoteIndex);
+        return;
+    }
+
+    const auto sortKey =
+        extractSortKey(*remote.docBuffer.front().getResult(), _params.getCompareWholeSortKey());
+    _mergeTree.setKey(remoteIndex, encodeSortKey(sortKey, _sortKeyOrderings));
+}
+
 ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
     size_t remotesAttempted = 0;
     while (remotesAttempted < _remotes.size()) {
@@ -635,6 +692,7 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
                                            size_t remoteIndex,
                                            const CursorResponse& response) {
     auto& remote = _remotes[remoteIndex];
+    const bool hadBufferedResults = remote.hasNext();
     _updateRemoteMetadata(lk, remoteIndex, response);
     for (const auto& obj : response.getBatch()) {
         // If there's a sort, we're expecting the remote node to have given us back a sort key.
@@ -660,10 +718,10 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
         ++remote.fetchedCount;
     }
 
-    // If we're doing a sorted merge, then we have to make sure to put this remote onto the merge
-    // queue.
-    if (_params.getSort() && !response.getBatch().empty()) {
-        _mergeQueue.push(remoteIndex);
+    // If we're doing a sorted merge, then we have to make sure that this remote competes in the
+    // merge with its first new result.
+    if (_params.getSort() && !hadBufferedResults && remote.hasNext()) {
+        _updateMergeTree(lk, remoteIndex);
     }
     return true;
 }
@@ -771,18 +829,9 @@ bool AsyncResultsMerger::RemoteCursorData::exhausted() const {
 }
 
 //
-// AsyncResultsMerger::MergingComparator
+// AsyncResultsMerger::PromisedMinSortKeyComparator
 //
 
-bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
-    const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
-    const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
-
-    return compareSortKeys(extractSortKey(*leftDoc.getResult(), _compareWholeSortKey),
-                           extractSortKey(*rightDoc.getResult(), _compareWholeSortKey),
-                           _sort) > 0;
-}
-
 bool AsyncResultsMerger::PromisedMinSortKeyComparator::operator()(
     const MinSortKeyRemoteIdPair& lhs, const MinSortKeyRemoteIdPair& rhs) const {
     auto sortKeyComp = compareSortKeys(lhs.first, rhs.first, _sort);
@@ -0,0 +1,111 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/s/query/async_results_merger.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("test.foo");
+const int kResultsPerRemote = 100;
+
+/**
+ * Makes the parameters of an AsyncResultsMerger over 'numRemotes' exhausted cursors whose results
+ * are all in their first batch, so that merging them needs no network. The results of the remotes
+ * interleave, which makes the remote with the next result change after every result.
+ */
+AsyncResultsMergerParams makeParams(int numRemotes, int numSortFields) {
+    BSONObjBuilder sortPattern;
+    for (int field = 0; field < numSortFields; ++field) {
+        sortPattern.append("f" + std::to_string(field), 1);
+    }
+
+    std::vector<RemoteCursor> remotes;
+    for (int remote = 0; remote < numRemotes; ++remote) {
+        std::vector<BSONObj> batch;
+        for (int i = 0; i < kResultsPerRemote; ++i) {
+            // All but the last sort key field tie between the remotes
+            BSONObjBuilder sortKey;
+            for (int field = 0; field < numSortFields - 1; ++field) {
+                sortKey.append("", i);
+            }
+            sortKey.append("", i * numRemotes + remote);
+            batch.push_back(BSON("_id" << i << AsyncResultsMerger::kSortKeyField << sortKey.obj()));
+        }
+
+        RemoteCursor remoteCursor;
+        remoteCursor.setShardId(ShardId(str::stream() << "shard" << remote));
+        remoteCursor.setHostAndPort(HostAndPort("host", 10000 + remote));
+        remoteCursor.setCursorResponse(CursorResponse(kNss, CursorId(0), std::move(batch)));
+        remotes.push_back(std::move(remoteCursor));
+    }
+
+    AsyncResultsMergerParams params;
+    params.setNss(kNss);
+    params.setSort(sortPattern.obj());
+    params.setRemotes(std::move(remotes));
+    return params;
+}
+
+void BM_SortedMerge(benchmark::State& state) {
+    const int numRemotes = state.range(0);
+    const int numSortFields = state.range(1);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto params = makeParams(numRemotes, numSortFields);
+        state.ResumeTiming();
+
+        // The remote cursors are already exhausted, so the merger never uses its operation context
+        // or its executor
+        AsyncResultsMerger arm(nullptr, nullptr, std::move(params));
+        while (true) {
+            invariant(arm.ready());
+            auto next = uassertStatusOK(arm.nextReady());
+            if (next.isEOF()) {
+                break;
+            }
+            benchmark::DoNotOptimize(next);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * numRemotes * kResultsPerRemote);
+}
+
+BENCHMARK(BM_SortedMerge)->Args({16, 1})->Args({256, 1})->Args({256, 3});
+
+}  // namespace
+}  // namespace mongo
@@ -443,6 +443,48 @@ TEST_F(AsyncResultsMergerTest, CompoundSortKey) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, SortKeyWithMoreFieldsThanAnOrderingDescribes) {
+    // Only the last field of the sort differs between the results, and it is sorted descending.
+    const int kNumSortFields = 40;
+    BSONObjBuilder sortBuilder;
+    for (int i = 0; i < kNumSortFields - 1; ++i) {
+        sortBuilder.append("f" + std::to_string(i), 1);
+    }
+    sortBuilder.append("f" + std::to_string(kNumSortFields - 1), -1);
+    BSONObj findCmd = BSON("find"
+                           << "testcoll"
+                           << "sort" << sortBuilder.obj());
+
+    const auto makeResult = [&](int lastField) {
+        BSONObjBuilder sortKeyBuilder;
+        for (int i = 0; i < kNumSortFields - 1; ++i) {
+            sortKeyBuilder.append("", i);
+        }
+        sortKeyBuilder.append("", lastField);
+        return BSON("$sortKey" << sortKeyBuilder.obj());
+    };
+
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(kTestNss, 0, {makeResult(3)})));
+    cursors.push_back(
+        makeRemoteCursor(kTestShardIds[1],
+                         kTestShardHosts[1],
+                         CursorResponse(kTestNss, 0, {makeResult(5), makeResult(1)})));
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[2], kTestShardHosts[2], CursorResponse(kTestNss, 0, {makeResult(4)})));
+    auto arm = makeARMFromExistingCursors(std::move(cursors), findCmd);
+
+    for (int expected : {5, 4, 3, 1}) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(makeResult(expected),
+                          *unittest::assertGet(arm->nextReady()).getResult());
+    }
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, SortedButNoSortKey) {
     BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: -1, b: 1}}");
     std::vector<RemoteCursor> cursors;
@@ -203,6 +203,62 @@ void propagateDocLimitToShards(Pipeline* shardPipe, Pipeline* mergePipe) {
     return;
 }
 
+/**
+ * If the merging half of a split $group is followed by a $sort with a limit, as is common when
+ * looking for the top groups of a high-cardinality $group, sorts the partial groups produced by
+ * each shard by their _id. The merger then merges the sorted streams and the merging $group
+ * completes each group as soon as its _id has been passed, so that it only holds one group at a
+ * time instead of the whole table of partial groups. If the $sort is on _id itself and the _id
+ * cannot be an array, each shard only needs to send the first 'limit' partial groups in the sort
+ * order, since no group beyond those on any shard can be among the first 'limit' groups of the
+ * merged result. Should an array _id turn up, the merging $group falls back to hashing.
+ *
+ * Returns the sort pattern describing the order of the shards' output, or boost::none if the
+ * pipelines were left unchanged.
+ */
+boost::optional<BSONObj> sortPartialGroupsForStreamingMerge(Pipeline* shardPipe,
+                                                            Pipeline* mergePipe) {
+    if (internalQueryDisableStreamingGroupMerge.load()) {
+        return boost::none;
+    }
+
+    const auto& mergeSources = mergePipe->getSources();
+    if (mergeSources.size() < 2) {
+        return boost::none;
+    }
+
+    auto mergingGroup = dynamic_cast<DocumentSourceGroup*>(mergeSources.front().get());
+    if (!mergingGroup || !mergingGroup->doingMerge()) {
+        return boost::none;
+    }
+
+    auto sortAfterGroup = dynamic_cast<DocumentSourceSort*>(std::next(mergeSources.begin())->get());
+    if (!sortAfterGroup || sortAfterGroup->getLimit() < 0) {
+        return boost::none;
+    }
+
+    const auto& sortPattern = sortAfterGroup->getSortKeyPattern();
+    const bool isSortOnId = sortPattern.size() == 1 && sortPattern[0].fieldPath &&
+        sortPattern[0].fieldPath->fullPath() == "_id";
+
+    // The shards may only cut off their partial groups at the limit if no group key is an array.
+    // An array sorts by one of its elements, so its partial groups need not be adjacent and a
+    // shard could send part of a group which belongs in the result without the rest.
+    const auto& shardSources = shardPipe->getSources();
+    auto shardGroup = shardSources.empty()
+        ? nullptr
+        : dynamic_cast<DocumentSourceGroup*>(shardSources.back().get());
+    const bool canLimitShards = isSortOnId && shardGroup && !shardGroup->groupKeyMayBeArray();
+
+    const BSONObj shardSortSpec =
+        BSON("_id" << ((isSortOnId && !sortPattern[0].isAscending) ? -1 : 1));
+    shardPipe->addFinalSource(DocumentSourceSort::create(
+        shardPipe->getContext(), shardSortSpec, canLimitShards ? sortAfterGroup->getLimit() : 0));
+
+    mergingGroup->setInputSortedByGroupKey(true);
+    return shardSortSpec;
+}
+
 /**
  * Adds a stage to the end of 'shardPipe' explicitly requesting all fields that 'mergePipe' needs.
  * This is only done if it heuristically determines that it is needed. This optimization can reduce
@@ -469,6 +525,9 @@ SplitPipeline splitPipeline(std::unique_ptr<Pipeline, PipelineDeleter> pipeline)
     // the final pipeline. Be Careful!
     moveFinalUnwindFromShardsToMerger(shardsPipeline.get(), mergePipeline.get());
     propagateDocLimitToShards(shardsPipeline.get(), mergePipeline.get());
+    if (!inputsSort) {
+        inputsSort = sortPartialGroupsForStreamingMerge(shardsPipeline.get(), mergePipeline.get());
+    }
     limitFieldsSentFromShardsToMerger(shardsPipeline.get(), mergePipeline.get());
 
     abandonCacheIfSentToShards(shardsPipeline.get());
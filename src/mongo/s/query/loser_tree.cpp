@@ -0,0 +1,138 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/query/loser_tree.h"
+
+#include <utility>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+LoserTree::LoserTree(size_t numStreams) : _streams(numStreams) {}
+
+size_t LoserTree::addStream() {
+    _streams.emplace_back();
+    _needsRebuild = true;
+    return _streams.size() - 1;
+}
+
+void LoserTree::setKey(size_t stream, KeyString::Value key) {
+    auto& target = _streams[stream];
+    if (!target.hasKey) {
+        target.hasKey = true;
+        ++_numStreamsWithKey;
+    }
+    target.key = std::move(key);
+    _onKeyChanged(stream);
+}
+
+void LoserTree::clearKey(size_t stream) {
+    auto& target = _streams[stream];
+    if (target.hasKey) {
+        target.hasKey = false;
+        target.key = KeyString::Value();
+        --_numStreamsWithKey;
+    }
+    _onKeyChanged(stream);
+}
+
+size_t LoserTree::top() {
+    invariant(!empty());
+    if (_needsRebuild) {
+        _rebuild();
+    }
+    return _nodes[0];
+}
+
+bool LoserTree::_beats(size_t lhs, size_t rhs) const {
+    const auto& left = _streams[lhs];
+    const auto& right = _streams[rhs];
+    if (left.hasKey != right.hasKey) {
+        return left.hasKey;
+    }
+
+    const int cmp = left.hasKey ? left.key.compare(right.key) : 0;
+    return cmp < 0 || (cmp == 0 && lhs < rhs);
+}
+
+void LoserTree::_onKeyChanged(size_t stream) {
+    if (_needsRebuild) {
+        return;
+    }
+
+    if (stream == _nodes[0]) {
+        _replayWinner();
+    } else {
+        _needsRebuild = true;
+    }
+}
+
+void LoserTree::_replayWinner() {
+    const size_t numStreams = _streams.size();
+    size_t winner = _nodes[0];
+    for (size_t pos = (numStreams + winner) / 2; pos > 0; pos /= 2) {
+        if (_beats(_nodes[pos], winner)) {
+            std::swap(_nodes[pos], winner);
+        }
+    }
+    _nodes[0] = winner;
+}
+
+void LoserTree::_rebuild() {
+    const size_t numStreams = _streams.size();
+    invariant(numStreams > 0);
+
+    // Play the matches bottom-up, remembering the winner of each internal node until its parent's
+    // match has been played
+    std::vector<size_t> winners(2 * numStreams);
+    for (size_t stream = 0; stream < numStreams; ++stream) {
+        winners[numStreams + stream] = stream;
+    }
+
+    _nodes.resize(numStreams);
+    for (size_t pos = numStreams - 1; pos > 0; --pos) {
+        const size_t left = winners[2 * pos];
+        const size_t right = winners[2 * pos + 1];
+        if (_beats(left, right)) {
+            winners[pos] = left;
+            _nodes[pos] = right;
+        } else {
+            winners[pos] = right;
+            _nodes[pos] = left;
+        }
+    }
+    _nodes[0] = numStreams > 1 ? winners[1] : 0;
+
+    _needsRebuild = false;
+}
+
+}  // namespace mongo
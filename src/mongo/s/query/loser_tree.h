@@ -0,0 +1,124 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/storage/key_string.h"
+
+namespace mongo {
+
+/**
+ * A tournament tree of losers which selects, among a set of input streams, the one whose current
+ * sort key is the smallest. Sort keys are KeyStrings, so each match of the tournament is a single
+ * memcmp. Streams without a current key (e.g. waiting for their next batch) lose every match.
+ * Ties are broken in favour of the stream with the lower index.
+ *
+ * Replacing the key of the current winner replays only the matches on its path to the root, which
+ * takes O(log n) comparisons. Changing the key of any other stream cannot be replayed that way, so
+ * the tree is instead rebuilt in O(n) the next time the winner is requested. A merge changes the
+ * winner's key once per returned result and other streams' keys only once per received batch.
+ */
+class LoserTree {
+public:
+    explicit LoserTree(size_t numStreams = 0);
+
+    /**
+     * Adds a stream without a current key and returns its index.
+     */
+    size_t addStream();
+
+    /**
+     * Sets the current key of 'stream' to 'key'.
+     */
+    void setKey(size_t stream, KeyString::Value key);
+
+    /**
+     * Marks 'stream' as having no current key.
+     */
+    void clearKey(size_t stream);
+
+    /**
+     * Returns the index of the stream with the smallest current key. Must not be called if no
+     * stream has a current key.
+     */
+    size_t top();
+
+    /**
+     * Returns true if no stream has a current key.
+     */
+    bool empty() const {
+        return _numStreamsWithKey == 0;
+    }
+
+    size_t numStreams() const {
+        return _streams.size();
+    }
+
+private:
+    struct Stream {
+        KeyString::Value key;
+        bool hasKey = false;
+    };
+
+    /**
+     * Returns true if 'lhs' wins its match against 'rhs'.
+     */
+    bool _beats(size_t lhs, size_t rhs) const;
+
+    /**
+     * Notes that the key of 'stream' has changed, either replaying its matches or scheduling a
+     * rebuild of the tree.
+     */
+    void _onKeyChanged(size_t stream);
+
+    /**
+     * Replays the matches of the current winner after its key has changed.
+     */
+    void _replayWinner();
+
+    /**
+     * Plays the whole tournament again.
+     */
+    void _rebuild();
+
+    std::vector<Stream> _streams;
+
+    // Position 0 holds the overall winner and positions [1, n) hold the loser of the match played
+    // at the corresponding internal node. The leaves are implicit: stream i sits at position n + i
+    // and the parent of position p is p / 2.
+    std::vector<size_t> _nodes;
+
+    size_t _numStreamsWithKey = 0;
+
+    bool _needsRebuild = true;
+};
+
+}  // namespace mongo
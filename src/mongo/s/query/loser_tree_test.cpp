@@ -0,0 +1,127 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/query/loser_tree.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/ordering.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+
+namespace {
+
+KeyString::Value makeKey(int value) {
+    return KeyString::HeapBuilder(KeyString::Version::V1, BSON("" << value), Ordering::make({}))
+        .release();
+}
+
+TEST(LoserTreeTest, EmptyUntilAStreamHasAKey) {
+    LoserTree tree(3);
+    ASSERT_TRUE(tree.empty());
+
+    tree.setKey(1, makeKey(7));
+    ASSERT_FALSE(tree.empty());
+    ASSERT_EQ(1u, tree.top());
+
+    tree.clearKey(1);
+    ASSERT_TRUE(tree.empty());
+}
+
+TEST(LoserTreeTest, MergesStreamsInKeyOrder) {
+    const std::vector<std::vector<int>> streams = {{1, 4, 9}, {2, 3, 10}, {5, 6, 7}, {8}, {}};
+    std::vector<size_t> positions(streams.size(), 0);
+
+    LoserTree tree(streams.size());
+    for (size_t i = 0; i < streams.size(); ++i) {
+        if (!streams[i].empty()) {
+            tree.setKey(i, makeKey(streams[i][0]));
+        }
+    }
+
+    std::vector<int> merged;
+    while (!tree.empty()) {
+        const size_t winner = tree.top();
+        merged.push_back(streams[winner][positions[winner]]);
+        if (++positions[winner] < streams[winner].size()) {
+            tree.setKey(winner, makeKey(streams[winner][positions[winner]]));
+        } else {
+            tree.clearKey(winner);
+        }
+    }
+
+    ASSERT(merged == std::vector<int>({1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
+}
+
+TEST(LoserTreeTest, TiesAreWonByTheLowerStream) {
+    LoserTree tree(4);
+    tree.setKey(3, makeKey(1));
+    tree.setKey(2, makeKey(1));
+    ASSERT_EQ(2u, tree.top());
+
+    tree.setKey(0, makeKey(1));
+    ASSERT_EQ(0u, tree.top());
+
+    tree.clearKey(0);
+    ASSERT_EQ(2u, tree.top());
+}
+
+TEST(LoserTreeTest, StreamWhichIsNotTheWinnerCanTakeTheLead) {
+    LoserTree tree(5);
+    for (size_t i = 0; i < 5; ++i) {
+        tree.setKey(i, makeKey(10 + i));
+    }
+    ASSERT_EQ(0u, tree.top());
+
+    // A stream other than the winner receives a smaller key, as when a remote which ran out of
+    // buffered results receives its next batch
+    tree.setKey(3, makeKey(5));
+    ASSERT_EQ(3u, tree.top());
+
+    tree.setKey(3, makeKey(20));
+    ASSERT_EQ(0u, tree.top());
+}
+
+TEST(LoserTreeTest, AddedStreamsCompete) {
+    LoserTree tree;
+    tree.setKey(tree.addStream(), makeKey(3));
+    ASSERT_EQ(0u, tree.top());
+
+    const size_t newStream = tree.addStream();
+    ASSERT_EQ(0u, tree.top());
+
+    tree.setKey(newStream, makeKey(2));
+    ASSERT_EQ(newStream, tree.top());
+}
+
+}  // namespace
+
+}  // namespace mongo
@@ -93,9 +93,7 @@ std::set<ChunkInfo*> getChunksInRange(std::shared_ptr<RoutingTableHistory> rt,
     std::transform(chunksFromSplitIter.first,
                    chunksFromSplitIter.second,
                    std::inserter(chunksFromSplit, chunksFromSplit.begin()),
-                   [](const std::pair<std::string, std::shared_ptr<ChunkInfo>>& pair) {
-                       return pair.second.get();
-                   });
+                   [](const std::shared_ptr<ChunkInfo>& chunkInfo) { return chunkInfo.get(); });
     return chunksFromSplit;
 }
 
@@ -108,7 +106,7 @@ std::shared_ptr<ChunkInfo> getChunkToSplit(std::shared_ptr<RoutingTableHistory>
     invariant(std::distance(chunkToSplitIter.first, chunkToSplitIter.second) <= 1);
     invariant(chunkToSplitIter.first != rt->getChunkMap().end());
 
-    return (*chunkToSplitIter.first).second;
+    return *chunkToSplitIter.first;
 }
 
 /**
@@ -136,8 +134,7 @@ void assertCorrectBytesWritten(std::shared_ptr<RoutingTableHistory> rt,
     auto chunksFromSplit = getChunksInRange(rt, minSplitBoundary, maxSplitBoundary);
     ASSERT_EQ(chunksFromSplit.size(), expectedNumChunksFromSplit);
 
-    for (auto kv : rt->getChunkMap()) {
-        auto chunkInfo = kv.second;
+    for (const auto& chunkInfo : rt->getChunkMap()) {
         auto writesTracker = chunkInfo->getWritesTracker();
         auto bytesWritten = writesTracker->getBytesWritten();
         if (chunksFromSplit.count(chunkInfo.get()) > 0) {
@@ -170,8 +167,7 @@ public:
 
         ASSERT_EQ(_rt->getChunkMap().size(), 1ull);
         // Should only be one
-        for (auto kv : _rt->getChunkMap()) {
-            auto chunkInfo = kv.second;
+        for (const auto& chunkInfo : _rt->getChunkMap()) {
             auto writesTracker = chunkInfo->getWritesTracker();
             writesTracker->addBytesWritten(_bytesInOriginalChunk);
         }
@@ -234,8 +230,7 @@ TEST_F(RoutingTableHistoryTest, SplittingOnlyChunkCopiesBytesWrittenToAllSubchun
     auto rt = splitChunk(getInitialRoutingTable(), newChunkBoundaryPoints);
 
     ASSERT_EQ(rt->getChunkMap().size(), 3ull);
-    for (auto kv : rt->getChunkMap()) {
-        auto chunkInfo = kv.second;
+    for (const auto& chunkInfo : rt->getChunkMap()) {
         auto writesTracker = chunkInfo->getWritesTracker();
         auto bytesWritten = writesTracker->getBytesWritten();
         ASSERT_EQ(bytesWritten, getBytesInOriginalChunk());
@@ -318,5 +313,120 @@ TEST_F(RoutingTableHistoryTestThreeInitialChunks,
                               expectedBytesInChunksNotSplit);
 }
 
+TEST_F(RoutingTableHistoryTestThreeInitialChunks, ShardVersionsFollowChunkMigrations) {
+    const ShardId kOtherShard("otherShard");
+    auto rt = getInitialRoutingTable();
+    auto version = rt->getVersion();
+    ASSERT_EQ(rt->getVersion(kThisShard), version);
+
+    // Move the middle chunk and bump the version of a chunk remaining on the donor
+    version.incMajor();
+    const auto movedVersion = version;
+    ChunkType movedChunk{kNss, ChunkRange{BSON("a" << 10), BSON("a" << 20)}, version, kOtherShard};
+    version.incMinor();
+    ChunkType controlChunk{
+        kNss, ChunkRange{BSON("a" << 20), getShardKeyPattern().globalMax()}, version, kThisShard};
+    rt = rt->makeUpdated({movedChunk, controlChunk});
+
+    ASSERT_EQ(rt->getVersion(), version);
+    ASSERT_EQ(rt->getVersion(kThisShard), version);
+    ASSERT_EQ(rt->getVersion(kOtherShard), movedVersion);
+
+    // Move the remaining chunks off the original shard
+    version.incMajor();
+    ChunkType firstChunk{
+        kNss, ChunkRange{getShardKeyPattern().globalMin(), BSON("a" << 10)}, version, kOtherShard};
+    version.incMajor();
+    ChunkType lastChunk{
+        kNss, ChunkRange{BSON("a" << 20), getShardKeyPattern().globalMax()}, version, kOtherShard};
+    rt = rt->makeUpdated({firstChunk, lastChunk});
+
+    ASSERT_EQ(rt->getVersion(kOtherShard), version);
+    ASSERT_EQ(rt->getVersion(kThisShard), ChunkVersion(0, 0, version.epoch()));
+
+    std::set<ShardId> shardIds;
+    rt->getAllShardIds(&shardIds);
+    ASSERT_EQ(shardIds.size(), 1ull);
+    ASSERT_EQ(*shardIds.begin(), kOtherShard);
+}
+
+TEST_F(RoutingTableHistoryTestThreeInitialChunks, ShardVersionRecomputedWhenShardLosesMaxChunk) {
+    const ShardId kOtherShard("otherShard");
+    const auto rt = getInitialRoutingTable();
+    auto version = rt->getVersion();
+
+    // The chunk with the highest version on the shard moves away without the version of any of
+    // the remaining chunks being bumped, so the shard version falls back to the highest among them
+    const auto& secondChunk = getChunkToSplit(rt, BSON("a" << 10), BSON("a" << 20));
+    const auto expectedShardVersion = secondChunk->getLastmod();
+
+    version.incMajor();
+    ChunkType movedChunk{
+        kNss, ChunkRange{BSON("a" << 20), getShardKeyPattern().globalMax()}, version, kOtherShard};
+    const auto updatedRt = rt->makeUpdated({movedChunk});
+
+    ASSERT_EQ(updatedRt->getVersion(kOtherShard), version);
+    ASSERT_EQ(updatedRt->getVersion(kThisShard), expectedShardVersion);
+}
+
+TEST_F(RoutingTableHistoryTestThreeInitialChunks, UpdateLeavingGapOrOverlapIsRejected) {
+    const auto rt = getInitialRoutingTable();
+    auto version = rt->getVersion();
+    version.incMajor();
+
+    // Only a part of the range of the chunk it replaces is covered by the new chunk
+    ChunkType gapChunk{kNss, ChunkRange{BSON("a" << 15), BSON("a" << 20)}, version, kThisShard};
+    ASSERT_THROWS_CODE(
+        rt->makeUpdated({gapChunk}), DBException, ErrorCodes::ConflictingOperationInProgress);
+
+    // The new chunk is split out of an existing chunk, but the rest of it never arrives
+    ChunkType overlapChunk{kNss, ChunkRange{BSON("a" << 10), BSON("a" << 15)}, version, kThisShard};
+    ASSERT_THROWS_CODE(
+        rt->makeUpdated({overlapChunk}), DBException, ErrorCodes::ConflictingOperationInProgress);
+}
+
+TEST_F(RoutingTableHistoryTest, UpdatesSpanningSeveralBlocksOfTheChunkMap) {
+    // Enough chunks for the chunk map to hold several blocks
+    const int blockSize = ChunkMap::kMaxBlockSize;
+    const int nChunks = 3 * blockSize + 10;
+    std::vector<BSONObj> boundaryPoints{getShardKeyPattern().globalMin()};
+    for (int i = 1; i < nChunks; ++i) {
+        boundaryPoints.push_back(BSON("a" << i * 10));
+    }
+    boundaryPoints.push_back(getShardKeyPattern().globalMax());
+
+    auto rt = splitChunk(getInitialRoutingTable(), boundaryPoints);
+    ASSERT_EQ(rt->getChunkMap().size(), size_t(nChunks));
+
+    // Merge a range of chunks which straddles the boundaries between blocks and split the chunk
+    // following it
+    auto mergedMin = BSON("a" << 100);
+    auto mergedMax = BSON("a" << (blockSize + 50) * 10);
+    auto splitPoint = BSON("a" << (blockSize + 50) * 10 + 5);
+    auto splitMax = BSON("a" << (blockSize + 51) * 10);
+    auto updatedRt = splitChunk(rt, {mergedMin, mergedMax, splitPoint, splitMax});
+
+    const size_t nMergedAway = blockSize + 40 - 1;
+    ASSERT_EQ(updatedRt->getChunkMap().size(), nChunks - nMergedAway + 1);
+
+    // The earlier routing table is unaffected by the update
+    ASSERT_EQ(rt->getChunkMap().size(), size_t(nChunks));
+    auto chunksInRange = getChunksInRange(rt, mergedMin, mergedMax);
+    ASSERT_EQ(chunksInRange.size(), nMergedAway + 1);
+
+    chunksInRange = getChunksInRange(updatedRt, mergedMin, mergedMax);
+    ASSERT_EQ(chunksInRange.size(), 1ull);
+    ASSERT_BSONOBJ_EQ((*chunksInRange.begin())->getMin(), mergedMin);
+    ASSERT_BSONOBJ_EQ((*chunksInRange.begin())->getMax(), mergedMax);
+
+    // The chunks of the updated routing table still cover the whole key space in order
+    BSONObj lastMax = getShardKeyPattern().globalMin();
+    for (const auto& chunkInfo : updatedRt->getChunkMap()) {
+        ASSERT_BSONOBJ_EQ(chunkInfo->getMin(), lastMax);
+        lastMax = chunkInfo->getMax();
+    }
+    ASSERT_BSONOBJ_EQ(lastMax, getShardKeyPattern().globalMax());
+}
+
 }  // namespace
 }  // namespace mongo
@@ -33,6 +33,10 @@
 
 #include "mongo/s/write_ops/batch_write_exec.h"
 
+#include <algorithm>
+#include <deque>
+#include <memory>
+
 #include "mongo/base/error_codes.h"
 #include "mongo/base/owned_pointer_map.h"
 #include "mongo/base/status.h"
@@ -40,14 +44,18 @@
 #include "mongo/bson/util/builder.h"
 #include "mongo/client/connection_string.h"
 #include "mongo/client/remote_command_targeter.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/executor/task_executor_pool.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
 #include "mongo/s/multi_statement_transaction_requests_sender.h"
 #include "mongo/s/transaction_router.h"
 #include "mongo/s/write_ops/batch_write_op.h"
+#include "mongo/s/write_ops/cluster_write_knobs_gen.h"
 #include "mongo/s/write_ops/write_error_detail.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -106,6 +114,402 @@ bool hasTransientTransactionError(const BatchedCommandResponse& response) {
 // applies when no writes are occurring and metadata is not changing on reload.
 const int kMaxRoundsWithoutProgress(5);
 
+/**
+ * Tracks the child batches of unordered writes which this router has outstanding on each shard, for
+ * reporting in serverStatus.
+ */
+class WritePipelineStats {
+public:
+    void noteSent(const ShardId& shardId) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto& shardStats = _shards[shardId];
+        ++shardStats.batchesSent;
+        shardStats.maxInFlight = std::max(shardStats.maxInFlight, ++shardStats.inFlight);
+    }
+
+    void noteReceived(const ShardId& shardId) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        --_shards[shardId].inFlight;
+    }
+
+    void report(BSONObjBuilder* builder) const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        for (const auto& [shardId, shardStats] : _shards) {
+            BSONObjBuilder shardBuilder(builder->subobjStart(shardId.toString()));
+            shardBuilder.append("inFlight", shardStats.inFlight);
+            shardBuilder.append("maxInFlight", shardStats.maxInFlight);
+            shardBuilder.append("batchesSent", shardStats.batchesSent);
+        }
+    }
+
+private:
+    struct ShardStats {
+        // The number of child batches currently outstanding on the shard, and the most there have
+        // been at any one time
+        long long inFlight{0};
+        long long maxInFlight{0};
+
+        long long batchesSent{0};
+    };
+
+    mutable stdx::mutex _mutex;
+    std::map<ShardId, ShardStats> _shards;
+};
+
+WritePipelineStats writePipelineStats;
+
+class WritePipelineServerStatus final : public ServerStatusSection {
+public:
+    WritePipelineServerStatus() : ServerStatusSection("shardedWritePipeline") {}
+
+    bool includeByDefault() const override {
+        return true;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx,
+                            const BSONElement& configElement) const override {
+        BSONObjBuilder result;
+        writePipelineStats.report(&result);
+        return result.obj();
+    }
+
+} writePipelineServerStatus;
+
+/**
+ * Serializes the request to send to a shard for the child batch 'batch' of 'batchOp'.
+ */
+BSONObj buildChildBatchRequest(OperationContext* opCtx,
+                               const BatchWriteOp& batchOp,
+                               const TargetedWriteBatch& batch) {
+    const auto shardBatchRequest(batchOp.buildBatchRequest(batch));
+
+    BSONObjBuilder requestBuilder;
+    shardBatchRequest.serialize(&requestBuilder);
+
+    {
+        OperationSessionInfo sessionInfo;
+
+        if (opCtx->getLogicalSessionId()) {
+            sessionInfo.setSessionId(*opCtx->getLogicalSessionId());
+        }
+
+        sessionInfo.setTxnNumber(opCtx->getTxnNumber());
+        sessionInfo.serialize(&requestBuilder);
+    }
+
+    return requestBuilder.obj();
+}
+
+/**
+ * Notes the response of a shard to the child batch 'batch' in 'batchOp', and any stale routing
+ * information which the shard reported in 'targeter'. If the shard failed any of the writes because
+ * our routing information is stale, sets 'staleStatus' to the error it reported for them.
+ *
+ * Returns false if the response failed the transaction which the batch write is part of, in which
+ * case the batch write must be abandoned.
+ */
+bool processChildBatchResponse(OperationContext* opCtx,
+                               NSTargeter& targeter,
+                               BatchWriteOp& batchOp,
+                               const TargetedWriteBatch& batch,
+                               const AsyncRequestsSender::Response& response,
+                               BatchWriteExecStats* stats,
+                               Status* staleStatus) {
+    // First check if we were able to target a shard host.
+    if (!response.shardHostAndPort) {
+        invariant(!response.swResponse.isOK());
+
+        // Record a resolve failure
+        batchOp.noteBatchError(batch, errorFromStatus(response.swResponse.getStatus()));
+
+        // TODO: It may be necessary to refresh the cache if stale, or maybe just cancel
+        // and retarget the batch
+        LOG(4) << "Unable to send write batch to " << batch.getEndpoint().shardName
+               << causedBy(response.swResponse.getStatus());
+        return true;
+    }
+
+    const auto& shardHost = *response.shardHostAndPort;
+
+    // Then check if we successfully got a response.
+    Status responseStatus = response.swResponse.getStatus();
+    BatchedCommandResponse batchedCommandResponse;
+    if (responseStatus.isOK()) {
+        std::string errMsg;
+        if (!batchedCommandResponse.parseBSON(response.swResponse.getValue().data, &errMsg) ||
+            !batchedCommandResponse.isValid(&errMsg)) {
+            responseStatus = {ErrorCodes::FailedToParse, errMsg};
+        }
+    }
+
+    if (responseStatus.isOK()) {
+        TrackedErrors trackedErrors;
+        trackedErrors.startTracking(ErrorCodes::StaleShardVersion);
+        trackedErrors.startTracking(ErrorCodes::StaleDbVersion);
+        trackedErrors.startTracking(ErrorCodes::CannotImplicitlyCreateCollection);
+
+        LOG(4) << "Write results received from " << shardHost.toString() << ": "
+               << redact(batchedCommandResponse.toStatus());
+
+        // Dispatch was ok, note response
+        batchOp.noteBatchResponse(batch, batchedCommandResponse, &trackedErrors);
+
+        // If we are in a transaction, we must fail the whole batch on any error.
+        if (TransactionRouter::get(opCtx)) {
+            // Note: this returns a bad status if any part of the batch failed.
+            auto batchStatus = batchedCommandResponse.toStatus();
+            if (!batchStatus.isOK() && batchStatus != ErrorCodes::WouldChangeOwningShard) {
+                auto newStatus = batchStatus.withContext(
+                    str::stream() << "Encountered error from " << shardHost.toString()
+                                  << " during a transaction");
+
+                batchOp.forgetTargetedBatchesOnTransactionAbortingError();
+
+                // Throw when there is a transient transaction error since this
+                // should be a top level error and not just a write error.
+                if (hasTransientTransactionError(batchedCommandResponse)) {
+                    uassertStatusOK(newStatus);
+                }
+
+                return false;
+            }
+        }
+
+        // Note if anything was stale
+        const auto& staleShardErrors = trackedErrors.getErrors(ErrorCodes::StaleShardVersion);
+        const auto& staleDbErrors = trackedErrors.getErrors(ErrorCodes::StaleDbVersion);
+
+        if (!staleShardErrors.empty()) {
+            invariant(staleDbErrors.empty());
+            noteStaleShardResponses(staleShardErrors, &targeter);
+            ++stats->numStaleShardBatches;
+            *staleStatus = staleShardErrors.front().error.toStatus();
+        }
+
+        if (!staleDbErrors.empty()) {
+            invariant(staleShardErrors.empty());
+            noteStaleDbResponses(staleDbErrors, &targeter);
+            ++stats->numStaleDbBatches;
+            *staleStatus = staleDbErrors.front().error.toStatus();
+        }
+
+        const auto& cannotImplicitlyCreateErrors =
+            trackedErrors.getErrors(ErrorCodes::CannotImplicitlyCreateCollection);
+        if (!cannotImplicitlyCreateErrors.empty()) {
+            // This forces the chunk manager to reload so we can attach the correct
+            // version on retry and make sure we route to the correct shard.
+            targeter.noteCouldNotTarget();
+
+            // It is also possible that information about which shard is the primary
+            // for this collection collection is stale, so refresh the database as
+            // well.
+            Grid::get(opCtx)->catalogCache()->invalidateDatabaseEntry(targeter.getNS().db());
+
+            *staleStatus = cannotImplicitlyCreateErrors.front().error.toStatus();
+        }
+
+        // Remember that we successfully wrote to this shard
+        // NOTE: This will record lastOps for shards where we actually didn't update
+        // or delete any documents, which preserves old behavior but is conservative
+        stats->noteWriteAt(
+            shardHost,
+            batchedCommandResponse.isLastOpSet() ? batchedCommandResponse.getLastOp()
+                                                 : repl::OpTime(),
+            batchedCommandResponse.isElectionIdSet() ? batchedCommandResponse.getElectionId()
+                                                     : OID());
+    } else {
+        // Error occurred dispatching, note it
+        const Status status = responseStatus.withContext(str::stream()
+                                                         << "Write results unavailable from "
+                                                         << shardHost);
+
+        batchOp.noteBatchError(batch, errorFromStatus(status));
+
+        LOG(4) << "Unable to receive write results from " << shardHost << causedBy(redact(status));
+
+        // If we are in a transaction, we must stop immediately (even for unordered).
+        if (TransactionRouter::get(opCtx)) {
+            batchOp.forgetTargetedBatchesOnTransactionAbortingError();
+
+            // Throw when there is a transient transaction error since this should be a top
+            // level error and not just a write error.
+            if (isTransientTransactionError(status.code(), false, false)) {
+                uassertStatusOK(status);
+            }
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Runs one round of an unordered batch write outside of a transaction. Rather than sending a single
+ * child batch to each shard and waiting for all of them to respond before targeting the next ones,
+ * this targets all the remaining writes up front and streams the resulting child batches to the
+ * shards. Each shard has up to 'maxInFlightPerShard' of its child batches outstanding and is sent
+ * the next one as soon as it responds, however far behind the other shards are.
+ *
+ * Once a shard reports that our routing information is stale, its remaining child batches whose
+ * writes all target that shard alone are not sent. Their writes are failed with the error the shard
+ * reported, so that, like the writes the shard rejected, they are retargeted in the next round once
+ * the targeter has been refreshed. A write targeting several shards is broadcast without a shard
+ * version and cannot be retried on just some of them, so the child batches which contain one are
+ * still sent.
+ *
+ * Returns false if targeting any of the writes failed.
+ */
+bool executePipelinedRound(OperationContext* opCtx,
+                           NSTargeter& targeter,
+                           const BatchedCommandRequest& clientRequest,
+                           int maxInFlightPerShard,
+                           bool recordTargetErrors,
+                           BatchWriteOp* batchOp,
+                           BatchWriteExecStats* stats) {
+    struct ShardPipeline {
+        std::deque<std::unique_ptr<TargetedWriteBatch>> queuedBatches;
+        int numInFlight{0};
+
+        // Set once the shard has reported stale routing information
+        Status staleStatus{Status::OK()};
+
+        // The child batches not sent because the shard reported stale routing information
+        std::vector<std::unique_ptr<TargetedWriteBatch>> heldBackBatches;
+    };
+
+    std::map<ShardId, ShardPipeline> pipelines;
+
+    // If waiting for a response throws, the child batches still outstanding will never be received
+    ON_BLOCK_EXIT([&] {
+        for (const auto& pipeline : pipelines) {
+            for (int i = 0; i < pipeline.second.numInFlight; ++i) {
+                writePipelineStats.noteReceived(pipeline.first);
+            }
+        }
+    });
+
+    // Each call to targetBatch() returns at most one child batch per shard, so keep targeting until
+    // all the remaining writes have been assigned to a child batch
+    Status targetStatus = Status::OK();
+    while (true) {
+        std::map<ShardId, TargetedWriteBatch*> childBatches;
+        targetStatus = batchOp->targetBatch(targeter, recordTargetErrors, &childBatches);
+        if (!targetStatus.isOK() || childBatches.empty()) {
+            break;
+        }
+
+        for (const auto& childBatch : childBatches) {
+            pipelines[childBatch.first].queuedBatches.emplace_back(childBatch.second);
+        }
+    }
+
+    if (!targetStatus.isOK()) {
+        // The child batches targeted before the error are still sent, since the writes of an
+        // unordered batch do not depend on each other
+        targeter.noteCouldNotTarget();
+        ++stats->numTargetErrors;
+    }
+
+    // All the writes of the round have been targeted, so this counts the shards each one targets
+    std::map<int, int> numShardsTargetedByWrite;
+    for (const auto& pipeline : pipelines) {
+        for (const auto& batch : pipeline.second.queuedBatches) {
+            for (const auto write : batch->getWrites()) {
+                ++numShardsTargetedByWrite[write->writeOpRef.first];
+            }
+        }
+    }
+
+    const auto targetsSingleShard = [&](const TargetedWriteBatch& batch) {
+        const auto& writes = batch.getWrites();
+        return std::all_of(writes.begin(), writes.end(), [&](const TargetedWrite* write) {
+            return numShardsTargetedByWrite[write->writeOpRef.first] == 1;
+        });
+    };
+
+    AsyncRequestsSender ars(opCtx,
+                            Grid::get(opCtx)->getExecutorPool()->getArbitraryExecutor(),
+                            clientRequest.getNS().db(),
+                            {},
+                            kPrimaryOnlyReadPreference,
+                            opCtx->getTxnNumber() ? Shard::RetryPolicy::kIdempotent
+                                                  : Shard::RetryPolicy::kNoRetry);
+
+    // The child batches which have been sent, by the index of their request
+    std::vector<std::unique_ptr<TargetedWriteBatch>> sentBatches;
+
+    const auto sendQueuedBatches = [&](const ShardId& shardId, ShardPipeline& pipeline) {
+        std::vector<AsyncRequestsSender::Request> requests;
+        while (pipeline.numInFlight < maxInFlightPerShard && !pipeline.queuedBatches.empty()) {
+            auto batch = std::move(pipeline.queuedBatches.front());
+            pipeline.queuedBatches.pop_front();
+
+            stats->noteTargetedShard(shardId);
+
+            auto request = buildChildBatchRequest(opCtx, *batchOp, *batch);
+
+            LOG(4) << "Sending write batch to " << shardId << ": " << redact(request);
+
+            requests.emplace_back(shardId, std::move(request));
+            sentBatches.push_back(std::move(batch));
+            ++pipeline.numInFlight;
+            writePipelineStats.noteSent(shardId);
+        }
+
+        ars.addRequests(requests);
+    };
+
+    for (auto& pipeline : pipelines) {
+        sendQueuedBatches(pipeline.first, pipeline.second);
+    }
+
+    while (!ars.done()) {
+        // Block until a response is available.
+        auto response = ars.next();
+
+        invariant(response.requestIndex < sentBatches.size());
+        const auto& batch = *sentBatches[response.requestIndex];
+        const auto& shardId = batch.getEndpoint().shardName;
+
+        auto& pipeline = pipelines[shardId];
+        --pipeline.numInFlight;
+        writePipelineStats.noteReceived(shardId);
+
+        Status staleStatus = Status::OK();
+        const bool canContinue = processChildBatchResponse(
+            opCtx, targeter, *batchOp, batch, response, stats, &staleStatus);
+
+        // Only the responses to writes in a transaction can abandon the batch write
+        invariant(canContinue);
+
+        if (!staleStatus.isOK() && pipeline.staleStatus.isOK()) {
+            pipeline.staleStatus = std::move(staleStatus);
+
+            std::deque<std::unique_ptr<TargetedWriteBatch>> batchesToSend;
+            for (auto& queuedBatch : pipeline.queuedBatches) {
+                if (targetsSingleShard(*queuedBatch)) {
+                    pipeline.heldBackBatches.push_back(std::move(queuedBatch));
+                } else {
+                    batchesToSend.push_back(std::move(queuedBatch));
+                }
+            }
+            pipeline.queuedBatches = std::move(batchesToSend);
+        }
+
+        sendQueuedBatches(shardId, pipeline);
+    }
+
+    for (const auto& pipeline : pipelines) {
+        invariant(pipeline.second.queuedBatches.empty());
+        for (const auto& batch : pipeline.second.heldBackBatches) {
+            batchOp->noteBatchError(*batch, errorFromStatus(pipeline.second.staleStatus));
+        }
+    }
+
+    return targetStatus.isOK();
+}
+
 }  // namespace
 
 void BatchWriteExec::executeBatch(OperationContext* opCtx,
@@ -127,6 +531,12 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
     int numRoundsWithoutProgress = 0;
     bool abortBatch = false;
 
+    // The child batches of unordered writes outside of transactions are streamed to the shards
+    const int maxInFlightPerShard =
+        !clientRequest.getWriteCommandBase().getOrdered() && !TransactionRouter::get(opCtx)
+        ? internalBatchWriteExecMaxInFlightBatchesPerShard.load()
+        : 0;
+
     while (!batchOp.isFinished() && !abortBatch) {
         //
         // Get child batches to send using the targeter
@@ -152,258 +562,134 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
         //    exactly when the metadata changed.
         //
 
-        OwnedPointerMap<ShardId, TargetedWriteBatch> childBatchesOwned;
-        std::map<ShardId, TargetedWriteBatch*>& childBatches = childBatchesOwned.mutableMap();
-
-        // If we've already had a targeting error, we've refreshed the metadata once and can
-        // record target errors definitively.
-        bool recordTargetErrors = refreshedTargeter;
-        Status targetStatus = batchOp.targetBatch(targeter, recordTargetErrors, &childBatches);
-        if (!targetStatus.isOK()) {
-            // Don't do anything until a targeter refresh
-            targeter.noteCouldNotTarget();
-            refreshedTargeter = true;
-            ++stats->numTargetErrors;
-            dassert(childBatches.size() == 0u);
-
-            if (TransactionRouter::get(opCtx)) {
-                batchOp.forgetTargetedBatchesOnTransactionAbortingError();
+        if (maxInFlightPerShard > 0) {
+            // If we've already had a targeting error, we've refreshed the metadata once and can
+            // record target errors definitively.
+            if (!executePipelinedRound(opCtx,
+                                       targeter,
+                                       clientRequest,
+                                       maxInFlightPerShard,
+                                       refreshedTargeter,
+                                       &batchOp,
+                                       stats)) {
+                refreshedTargeter = true;
+            }
+        } else {
+            OwnedPointerMap<ShardId, TargetedWriteBatch> childBatchesOwned;
+            std::map<ShardId, TargetedWriteBatch*>& childBatches = childBatchesOwned.mutableMap();
+
+            // If we've already had a targeting error, we've refreshed the metadata once and can
+            // record target errors definitively.
+            bool recordTargetErrors = refreshedTargeter;
+            Status targetStatus = batchOp.targetBatch(targeter, recordTargetErrors, &childBatches);
+            if (!targetStatus.isOK()) {
+                // Don't do anything until a targeter refresh
+                targeter.noteCouldNotTarget();
+                refreshedTargeter = true;
+                ++stats->numTargetErrors;
+                dassert(childBatches.size() == 0u);
+
+                if (TransactionRouter::get(opCtx)) {
+                    batchOp.forgetTargetedBatchesOnTransactionAbortingError();
+
+                    // Throw when there is a transient transaction error since this should be a top
+                    // level error and not just a write error.
+                    if (isTransientTransactionError(targetStatus.code(), false, false)) {
+                        uassertStatusOK(targetStatus);
+                    }
 
-                // Throw when there is a transient transaction error since this should be a top
-                // level error and not just a write error.
-                if (isTransientTransactionError(targetStatus.code(), false, false)) {
-                    uassertStatusOK(targetStatus);
+                    break;
                 }
-
-                break;
             }
-        }
-
-        //
-        // Send all child batches
-        //
-
-        const size_t numToSend = childBatches.size();
-        size_t numSent = 0;
-
-        while (numSent != numToSend) {
-            // Collect batches out on the network, mapped by endpoint
-            OwnedShardBatchMap ownedPendingBatches;
-            OwnedShardBatchMap::MapType& pendingBatches = ownedPendingBatches.mutableMap();
 
             //
-            // Construct the requests.
+            // Send all child batches
             //
 
-            std::vector<AsyncRequestsSender::Request> requests;
+            const size_t numToSend = childBatches.size();
+            size_t numSent = 0;
 
-            // Get as many batches as we can at once
-            for (auto& childBatch : childBatches) {
-                TargetedWriteBatch* const nextBatch = childBatch.second;
+            while (numSent != numToSend) {
+                // Collect batches out on the network, mapped by endpoint
+                OwnedShardBatchMap ownedPendingBatches;
+                OwnedShardBatchMap::MapType& pendingBatches = ownedPendingBatches.mutableMap();
 
-                // If the batch is nullptr, we sent it previously, so skip
-                if (!nextBatch)
-                    continue;
+                //
+                // Construct the requests.
+                //
 
-                // If we already have a batch for this shard, wait until the next time
-                const auto& targetShardId = nextBatch->getEndpoint().shardName;
+                std::vector<AsyncRequestsSender::Request> requests;
 
-                if (pendingBatches.count(targetShardId))
-                    continue;
+                // Get as many batches as we can at once
+                for (auto& childBatch : childBatches) {
+                    TargetedWriteBatch* const nextBatch = childBatch.second;
 
-                stats->noteTargetedShard(targetShardId);
+                    // If the batch is nullptr, we sent it previously, so skip
+                    if (!nextBatch)
+                        continue;
 
-                const auto request = [&] {
-                    const auto shardBatchRequest(batchOp.buildBatchRequest(*nextBatch));
+                    // If we already have a batch for this shard, wait until the next time
+                    const auto& targetShardId = nextBatch->getEndpoint().shardName;
 
-                    BSONObjBuilder requestBuilder;
-                    shardBatchRequest.serialize(&requestBuilder);
+                    if (pendingBatches.count(targetShardId))
+                        continue;
 
-                    {
-                        OperationSessionInfo sessionInfo;
+                    stats->noteTargetedShard(targetShardId);
 
-                        if (opCtx->getLogicalSessionId()) {
-                            sessionInfo.setSessionId(*opCtx->getLogicalSessionId());
-                        }
+                    const auto request = buildChildBatchRequest(opCtx, batchOp, *nextBatch);
 
-                        sessionInfo.setTxnNumber(opCtx->getTxnNumber());
-                        sessionInfo.serialize(&requestBuilder);
-                    }
-
-                    return requestBuilder.obj();
-                }();
-
-                LOG(4) << "Sending write batch to " << targetShardId << ": " << redact(request);
-
-                requests.emplace_back(targetShardId, request);
-
-                // Indicate we're done by setting the batch to nullptr. We'll only get duplicate
-                // hostEndpoints if we have broadcast and non-broadcast endpoints for the same host,
-                // so this should be pretty efficient without moving stuff around.
-                childBatch.second = nullptr;
+                    LOG(4) << "Sending write batch to " << targetShardId << ": "
+                           << redact(request);
 
-                // Recv-side is responsible for cleaning up the nextBatch when used
-                pendingBatches.emplace(targetShardId, nextBatch);
-            }
-
-            bool isRetryableWrite = opCtx->getTxnNumber() && !TransactionRouter::get(opCtx);
-
-            MultiStatementTransactionRequestsSender ars(
-                opCtx,
-                Grid::get(opCtx)->getExecutorPool()->getArbitraryExecutor(),
-                clientRequest.getNS().db().toString(),
-                requests,
-                kPrimaryOnlyReadPreference,
-                isRetryableWrite ? Shard::RetryPolicy::kIdempotent : Shard::RetryPolicy::kNoRetry);
-            numSent += pendingBatches.size();
-
-            //
-            // Receive the responses.
-            //
+                    requests.emplace_back(targetShardId, request);
 
-            while (!ars.done()) {
-                // Block until a response is available.
-                auto response = ars.next();
-
-                // Get the TargetedWriteBatch to find where to put the response
-                dassert(pendingBatches.find(response.shardId) != pendingBatches.end());
-                TargetedWriteBatch* batch = pendingBatches.find(response.shardId)->second;
-
-                // First check if we were able to target a shard host.
-                if (!response.shardHostAndPort) {
-                    invariant(!response.swResponse.isOK());
-
-                    // Record a resolve failure
-                    batchOp.noteBatchError(*batch,
-                                           errorFromStatus(response.swResponse.getStatus()));
-
-                    // TODO: It may be necessary to refresh the cache if stale, or maybe just cancel
-                    // and retarget the batch
-                    LOG(4) << "Unable to send write batch to " << batch->getEndpoint().shardName
-                           << causedBy(response.swResponse.getStatus());
-
-                    // We're done with this batch. Clean up when we can't resolve a host.
-                    auto it = childBatches.find(batch->getEndpoint().shardName);
-                    invariant(it != childBatches.end());
-                    delete it->second;
-                    it->second = nullptr;
-                    continue;
-                }
+                    // Indicate we're done by setting the batch to nullptr. We'll only get duplicate
+                    // hostEndpoints if we have broadcast and non-broadcast endpoints for the same
+                    // host, so this should be pretty efficient without moving stuff around.
+                    childBatch.second = nullptr;
 
-                const auto shardHost(std::move(*response.shardHostAndPort));
-
-                // Then check if we successfully got a response.
-                Status responseStatus = response.swResponse.getStatus();
-                BatchedCommandResponse batchedCommandResponse;
-                if (responseStatus.isOK()) {
-                    std::string errMsg;
-                    if (!batchedCommandResponse.parseBSON(response.swResponse.getValue().data,
-                                                          &errMsg) ||
-                        !batchedCommandResponse.isValid(&errMsg)) {
-                        responseStatus = {ErrorCodes::FailedToParse, errMsg};
-                    }
+                    // Recv-side is responsible for cleaning up the nextBatch when used
+                    pendingBatches.emplace(targetShardId, nextBatch);
                 }
 
-                if (responseStatus.isOK()) {
-                    TrackedErrors trackedErrors;
-                    trackedErrors.startTracking(ErrorCodes::StaleShardVersion);
-                    trackedErrors.startTracking(ErrorCodes::StaleDbVersion);
-                    trackedErrors.startTracking(ErrorCodes::CannotImplicitlyCreateCollection);
-
-                    LOG(4) << "Write results received from " << shardHost.toString() << ": "
-                           << redact(batchedCommandResponse.toStatus());
-
-                    // Dispatch was ok, note response
-                    batchOp.noteBatchResponse(*batch, batchedCommandResponse, &trackedErrors);
-
-                    // If we are in a transaction, we must fail the whole batch on any error.
-                    if (TransactionRouter::get(opCtx)) {
-                        // Note: this returns a bad status if any part of the batch failed.
-                        auto batchStatus = batchedCommandResponse.toStatus();
-                        if (!batchStatus.isOK() &&
-                            batchStatus != ErrorCodes::WouldChangeOwningShard) {
-                            auto newStatus = batchStatus.withContext(
-                                str::stream() << "Encountered error from " << shardHost.toString()
-                                              << " during a transaction");
-
-                            batchOp.forgetTargetedBatchesOnTransactionAbortingError();
-
-                            // Throw when there is a transient transaction error since this
-                            // should be a top level error and not just a write error.
-                            if (hasTransientTransactionError(batchedCommandResponse)) {
-                                uassertStatusOK(newStatus);
-                            }
-
-                            abortBatch = true;
-                            break;
-                        }
-                    }
-
-                    // Note if anything was stale
-                    const auto& staleShardErrors =
-                        trackedErrors.getErrors(ErrorCodes::StaleShardVersion);
-                    const auto& staleDbErrors = trackedErrors.getErrors(ErrorCodes::StaleDbVersion);
-
-                    if (!staleShardErrors.empty()) {
-                        invariant(staleDbErrors.empty());
-                        noteStaleShardResponses(staleShardErrors, &targeter);
-                        ++stats->numStaleShardBatches;
-                    }
-
-                    if (!staleDbErrors.empty()) {
-                        invariant(staleShardErrors.empty());
-                        noteStaleDbResponses(staleDbErrors, &targeter);
-                        ++stats->numStaleDbBatches;
-                    }
-
-                    const auto& cannotImplicitlyCreateErrors =
-                        trackedErrors.getErrors(ErrorCodes::CannotImplicitlyCreateCollection);
-                    if (!cannotImplicitlyCreateErrors.empty()) {
-                        // This forces the chunk manager to reload so we can attach the correct
-                        // version on retry and make sure we route to the correct shard.
-                        targeter.noteCouldNotTarget();
-
-                        // It is also possible that information about which shard is the primary
-                        // for this collection collection is stale, so refresh the database as
-                        // well.
-                        Grid::get(opCtx)->catalogCache()->invalidateDatabaseEntry(
-                            targeter.getNS().db());
-                    }
-
-                    // Remember that we successfully wrote to this shard
-                    // NOTE: This will record lastOps for shards where we actually didn't update
-                    // or delete any documents, which preserves old behavior but is conservative
-                    stats->noteWriteAt(shardHost,
-                                       batchedCommandResponse.isLastOpSet()
-                                           ? batchedCommandResponse.getLastOp()
-                                           : repl::OpTime(),
-                                       batchedCommandResponse.isElectionIdSet()
-                                           ? batchedCommandResponse.getElectionId()
-                                           : OID());
-                } else {
-                    // Error occurred dispatching, note it
-                    const Status status = responseStatus.withContext(
-                        str::stream() << "Write results unavailable from " << shardHost);
-
-                    batchOp.noteBatchError(*batch, errorFromStatus(status));
-
-                    LOG(4) << "Unable to receive write results from " << shardHost
-                           << causedBy(redact(status));
-
-                    // If we are in a transaction, we must stop immediately (even for unordered).
-                    if (TransactionRouter::get(opCtx)) {
-                        batchOp.forgetTargetedBatchesOnTransactionAbortingError();
+                bool isRetryableWrite = opCtx->getTxnNumber() && !TransactionRouter::get(opCtx);
+
+                MultiStatementTransactionRequestsSender ars(
+                    opCtx,
+                    Grid::get(opCtx)->getExecutorPool()->getArbitraryExecutor(),
+                    clientRequest.getNS().db().toString(),
+                    requests,
+                    kPrimaryOnlyReadPreference,
+                    isRetryableWrite ? Shard::RetryPolicy::kIdempotent
+                                     : Shard::RetryPolicy::kNoRetry);
+                numSent += pendingBatches.size();
+
+                //
+                // Receive the responses.
+                //
+
+                while (!ars.done()) {
+                    // Block until a response is available.
+                    auto response = ars.next();
+
+                    // Get the TargetedWriteBatch to find where to put the response
+                    dassert(pendingBatches.find(response.shardId) != pendingBatches.end());
+                    TargetedWriteBatch* batch = pendingBatches.find(response.shardId)->second;
+
+                    Status staleStatus = Status::OK();
+                    if (!processChildBatchResponse(
+                            opCtx, targeter, batchOp, *batch, response, stats, &staleStatus)) {
                         abortBatch = true;
-
-                        // Throw when there is a transient transaction error since this should be a
-                        // top
-                        // level error and not just a write error.
-                        if (isTransientTransactionError(status.code(), false, false)) {
-                            uassertStatusOK(status);
-                        }
-
                         break;
                     }
+
+                    if (!response.shardHostAndPort) {
+                        // We're done with this batch. Clean up when we can't resolve a host.
+                        auto it = childBatches.find(batch->getEndpoint().shardName);
+                        invariant(it != childBatches.end());
+                        delete it->second;
+                        it->second = nullptr;
+                    }
                 }
             }
         }
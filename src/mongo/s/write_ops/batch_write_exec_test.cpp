@@ -29,6 +29,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/client/remote_command_targeter_factory_mock.h"
 #include "mongo/client/remote_command_targeter_mock.h"
 #include "mongo/db/commands.h"
@@ -42,8 +43,10 @@
 #include "mongo/s/write_ops/batch_write_exec.h"
 #include "mongo/s/write_ops/batched_command_request.h"
 #include "mongo/s/write_ops/batched_command_response.h"
+#include "mongo/s/write_ops/cluster_write_knobs_gen.h"
 #include "mongo/s/write_ops/mock_ns_targeter.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -332,6 +335,88 @@ TEST_F(BatchWriteExecTest, MultiOpLarge) {
     future.default_timed_get();
 }
 
+TEST_F(BatchWriteExecTest, MultiOpLargeUnorderedIsSentInOneRound) {
+    const int kNumDocsToInsert = 100'000;
+    const std::string kDocValue(200, 'x');
+
+    std::vector<BSONObj> docsToInsert;
+    docsToInsert.reserve(kNumDocsToInsert);
+    for (int i = 0; i < kNumDocsToInsert; i++) {
+        docsToInsert.push_back(BSON("_id" << i << "someLargeKeyToWasteSpace" << kDocValue));
+    }
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase writeCommandBase;
+            writeCommandBase.setOrdered(false);
+            return writeCommandBase;
+        }());
+        insertOp.setDocuments(docsToInsert);
+        return insertOp;
+    }());
+    request.setWriteConcern(BSONObj());
+
+    // Both child batches for the shard are streamed within the same round
+    auto future = launchAsync([&] {
+        BatchedCommandResponse response;
+        BatchWriteExecStats stats;
+        BatchWriteExec::executeBatch(operationContext(), nsTargeter, request, &response, &stats);
+
+        ASSERT(response.getOk());
+        ASSERT_EQUALS(response.getN(), kNumDocsToInsert);
+        ASSERT_EQUALS(stats.numRounds, 1);
+    });
+
+    expectInsertsReturnSuccess(docsToInsert.begin(), docsToInsert.begin() + 66576);
+    expectInsertsReturnSuccess(docsToInsert.begin() + 66576, docsToInsert.end());
+
+    future.default_timed_get();
+}
+
+TEST_F(BatchWriteExecTest, MultiOpLargeUnorderedWithPipeliningDisabled) {
+    const int kNumDocsToInsert = 100'000;
+    const std::string kDocValue(200, 'x');
+
+    const auto originalMaxInFlight = internalBatchWriteExecMaxInFlightBatchesPerShard.load();
+    internalBatchWriteExecMaxInFlightBatchesPerShard.store(0);
+    ON_BLOCK_EXIT(
+        [&] { internalBatchWriteExecMaxInFlightBatchesPerShard.store(originalMaxInFlight); });
+
+    std::vector<BSONObj> docsToInsert;
+    docsToInsert.reserve(kNumDocsToInsert);
+    for (int i = 0; i < kNumDocsToInsert; i++) {
+        docsToInsert.push_back(BSON("_id" << i << "someLargeKeyToWasteSpace" << kDocValue));
+    }
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase writeCommandBase;
+            writeCommandBase.setOrdered(false);
+            return writeCommandBase;
+        }());
+        insertOp.setDocuments(docsToInsert);
+        return insertOp;
+    }());
+    request.setWriteConcern(BSONObj());
+
+    auto future = launchAsync([&] {
+        BatchedCommandResponse response;
+        BatchWriteExecStats stats;
+        BatchWriteExec::executeBatch(operationContext(), nsTargeter, request, &response, &stats);
+
+        ASSERT(response.getOk());
+        ASSERT_EQUALS(response.getN(), kNumDocsToInsert);
+        ASSERT_EQUALS(stats.numRounds, 2);
+    });
+
+    expectInsertsReturnSuccess(docsToInsert.begin(), docsToInsert.begin() + 66576);
+    expectInsertsReturnSuccess(docsToInsert.begin() + 66576, docsToInsert.end());
+
+    future.default_timed_get();
+}
+
 TEST_F(BatchWriteExecTest, SingleOpError) {
     BatchedCommandResponse errResponse;
     errResponse.setStatus({ErrorCodes::UnknownError, "mock error"});
@@ -473,6 +558,120 @@ TEST_F(BatchWriteExecTest, TooManyStaleShardOp) {
     future.default_timed_get();
 }
 
+TEST_F(BatchWriteExecTest, MultiShardWriteQueuedBehindStaleShardIsSentOnce) {
+    const HostAndPort kTestShardHost2 = HostAndPort("FakeHost2", 12345);
+    const std::string shardName2 = "FakeShard2";
+
+    // Keep a single child batch in flight per shard, so that the others queue behind it
+    const auto originalMaxInFlight = internalBatchWriteExecMaxInFlightBatchesPerShard.load();
+    internalBatchWriteExecMaxInFlightBatchesPerShard.store(1);
+    ON_BLOCK_EXIT(
+        [&] { internalBatchWriteExecMaxInFlightBatchesPerShard.store(originalMaxInFlight); });
+
+    auto targeter2 = std::make_unique<RemoteCommandTargeterMock>();
+    targeter2->setConnectionStringReturnValue(ConnectionString(kTestShardHost2));
+    targeter2->setFindHostReturnValue(kTestShardHost2);
+    targeterFactory()->addTargeterToReturn(ConnectionString(kTestShardHost2),
+                                           std::move(targeter2));
+
+    ShardType shardType;
+    shardType.setName(shardName);
+    shardType.setHost(kTestShardHost.toString());
+    ShardType shardType2;
+    shardType2.setName(shardName2);
+    shardType2.setHost(kTestShardHost2.toString());
+    setupShards({shardType, shardType2});
+
+    const auto epoch = OID::gen();
+    nsTargeter.init(nss,
+                    {MockRange(ShardEndpoint(shardName, ChunkVersion(1, 0, epoch)),
+                               BSON("x" << MINKEY),
+                               BSON("x" << 0)),
+                     MockRange(ShardEndpoint(shardName2, ChunkVersion(1, 0, epoch)),
+                               BSON("x" << 0),
+                               BSON("x" << MAXKEY))});
+
+    // The single-shard delete and the broadcast delete go to the first shard in separate child
+    // batches, since only the broadcast one is sent without a shard version
+    const BSONObj singleShardQuery = BSON("x" << -5);
+    const BSONObj multiShardQuery = BSON("x" << BSON("$gte" << -5 << "$lt" << 5));
+    BatchedCommandRequest request([&] {
+        write_ops::Delete deleteOp(nss);
+        deleteOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase writeCommandBase;
+            writeCommandBase.setOrdered(false);
+            return writeCommandBase;
+        }());
+        deleteOp.setDeletes({[&] {
+                                 write_ops::DeleteOpEntry entry;
+                                 entry.setQ(singleShardQuery);
+                                 entry.setMulti(false);
+                                 return entry;
+                             }(),
+                             [&] {
+                                 write_ops::DeleteOpEntry entry;
+                                 entry.setQ(multiShardQuery);
+                                 entry.setMulti(true);
+                                 return entry;
+                             }()});
+        return deleteOp;
+    }());
+    request.setWriteConcern(BSONObj());
+
+    auto future = launchAsync([&] {
+        BatchedCommandResponse response;
+        BatchWriteExecStats stats;
+        BatchWriteExec::executeBatch(operationContext(), nsTargeter, request, &response, &stats);
+        ASSERT(response.getOk());
+        ASSERT_FALSE(response.isErrDetailsSet());
+        ASSERT_EQ(3, response.getN());
+        ASSERT_EQ(1, stats.numStaleShardBatches);
+    });
+
+    // The first shard reports a stale version for the single-shard delete. The broadcast delete
+    // queued behind it is still sent to that shard, and is not sent a second time to either shard.
+    bool reportedStale = false;
+    int numMultiShardDeletesReceived = 0;
+    for (int i = 0; i < 4; ++i) {
+        onCommandForPoolExecutor([&](const executor::RemoteCommandRequest& request) {
+            const auto opMsgRequest(OpMsgRequest::fromDBAndBody(request.dbname, request.cmdObj));
+            const auto deleteRequest(BatchedCommandRequest::parseDelete(opMsgRequest));
+            const auto& deletes = deleteRequest.getDeleteRequest().getDeletes();
+            ASSERT_EQ(1U, deletes.size());
+
+            BatchedCommandResponse response;
+            response.setStatus(Status::OK());
+            if (SimpleBSONObjComparator::kInstance.evaluate(deletes[0].getQ() == multiShardQuery)) {
+                ++numMultiShardDeletesReceived;
+            } else if (!reportedStale) {
+                ASSERT_EQ(kTestShardHost, request.target);
+                reportedStale = true;
+
+                auto error = std::make_unique<WriteErrorDetail>();
+                error->setStatus({ErrorCodes::StaleShardVersion, "mock stale error"});
+                error->setErrInfo([&] {
+                    StaleConfigInfo sci(
+                        nss, ChunkVersion(1, 0, epoch), ChunkVersion(2, 0, epoch));
+                    BSONObjBuilder builder;
+                    sci.serialize(&builder);
+                    return builder.obj();
+                }());
+                error->setIndex(0);
+                response.addToErrDetails(error.release());
+                response.setN(0);
+                return response.toBSON();
+            }
+            response.setN(1);
+            return response.toBSON();
+        });
+    }
+
+    future.default_timed_get();
+
+    ASSERT(reportedStale);
+    ASSERT_EQ(2, numMultiShardDeletesReceived);
+}
+
 TEST_F(BatchWriteExecTest, StaleDbOp) {
     BatchedCommandRequest request([&] {
         write_ops::Insert insertOp(nss);
@@ -253,6 +253,20 @@ TEST(ZstdMessageCompressor, Overflow) {
     checkOverflow(std::make_unique<ZstdMessageCompressor>());
 }
 
+// The zlib and zstd compressors keep their contexts alive between calls, so a failed call must not
+// leave anything behind that breaks the next one.
+TEST(ZlibMessageCompressor, FidelityAfterOverflow) {
+    checkOverflow(std::make_unique<ZlibMessageCompressor>());
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, std::make_unique<ZlibMessageCompressor>());
+}
+
+TEST(ZstdMessageCompressor, FidelityAfterOverflow) {
+    checkOverflow(std::make_unique<ZstdMessageCompressor>());
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, std::make_unique<ZstdMessageCompressor>());
+}
+
 TEST(MessageCompressorManager, SERVER_28008) {
 
     // Create a client and server that will negotiate the same compressors,
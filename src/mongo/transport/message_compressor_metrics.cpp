@@ -36,6 +36,8 @@ namespace mongo {
 namespace {
 const auto kBytesIn = "bytesIn"_sd;
 const auto kBytesOut = "bytesOut"_sd;
+const auto kBytesSaved = "bytesSaved"_sd;
+const auto kTimeMicros = "timeMicros"_sd;
 }  // namespace
 
 void appendMessageCompressionStats(BSONObjBuilder* b) {
@@ -50,14 +52,18 @@ void appendMessageCompressionStats(BSONObjBuilder* b) {
         auto&& compressor = registry.getCompressor(name);
         BSONObjBuilder base(compressionSection.subobjStart(name));
 
+        const auto compressorBytesIn = compressor->getCompressorBytesIn();
+        const auto compressorBytesOut = compressor->getCompressorBytesOut();
         BSONObjBuilder compressorSection(base.subobjStart("compressor"));
-        compressorSection << kBytesIn << compressor->getCompressorBytesIn() << kBytesOut
-                          << compressor->getCompressorBytesOut();
+        compressorSection << kBytesIn << compressorBytesIn << kBytesOut << compressorBytesOut
+                          << kBytesSaved << compressorBytesIn - compressorBytesOut << kTimeMicros
+                          << compressor->getCompressorMicros();
         compressorSection.doneFast();
 
         BSONObjBuilder decompressorSection(base.subobjStart("decompressor"));
         decompressorSection << kBytesIn << compressor->getDecompressorBytesIn() << kBytesOut
-                            << compressor->getDecompressorBytesOut();
+                            << compressor->getDecompressorBytesOut() << kTimeMicros
+                            << compressor->getDecompressorMicros();
         decompressorSection.doneFast();
         base.doneFast();
     }
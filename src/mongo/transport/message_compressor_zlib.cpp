@@ -36,10 +36,73 @@
 #include "mongo/base/init.h"
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/message_compressor_zlib.h"
+#include "mongo/util/assert_util.h"
 
 #include <zlib.h>
 
 namespace mongo {
+namespace {
+
+/**
+ * compress2 and uncompress allocate and tear down a z_stream, including deflate's window and
+ * hash tables, for every message. Instead each thread keeps an initialized stream of each kind
+ * and resets it before every use, which only clears the stream's state.
+ */
+class ZlibStream {
+    ZlibStream(const ZlibStream&) = delete;
+    ZlibStream& operator=(const ZlibStream&) = delete;
+
+public:
+    explicit ZlibStream(bool deflating) : _deflating(deflating) {
+        memset(&_stream, 0, sizeof(_stream));
+        int ret = _deflating ? ::deflateInit(&_stream, Z_DEFAULT_COMPRESSION)
+                             : ::inflateInit(&_stream);
+        invariant(ret == Z_OK);
+    }
+
+    ~ZlibStream() {
+        if (_deflating) {
+            ::deflateEnd(&_stream);
+        } else {
+            ::inflateEnd(&_stream);
+        }
+    }
+
+    /**
+     * Resets the stream and points it at the given input and output.
+     */
+    z_stream* reset(ConstDataRange input, DataRange output) {
+        int ret = _deflating ? ::deflateReset(&_stream) : ::inflateReset(&_stream);
+        invariant(ret == Z_OK);
+        _stream.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(input.data()));
+        _stream.avail_in = input.length();
+        _stream.next_out = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(output.data()));
+        _stream.avail_out = output.length();
+        return &_stream;
+    }
+
+private:
+    const bool _deflating;
+    z_stream _stream;
+};
+
+ZlibStream& getThreadDeflateStream() {
+    static thread_local std::unique_ptr<ZlibStream> stream;
+    if (!stream) {
+        stream = std::make_unique<ZlibStream>(true);
+    }
+    return *stream;
+}
+
+ZlibStream& getThreadInflateStream() {
+    static thread_local std::unique_ptr<ZlibStream> stream;
+    if (!stream) {
+        stream = std::make_unique<ZlibStream>(false);
+    }
+    return *stream;
+}
+
+}  // namespace
 
 ZlibMessageCompressor::ZlibMessageCompressor() : MessageCompressorBase(MessageCompressor::kZlib) {}
 
@@ -49,34 +112,29 @@ std::size_t ZlibMessageCompressor::getMaxCompressedSize(size_t inputSize) {
 
 StatusWith<std::size_t> ZlibMessageCompressor::compressData(ConstDataRange input,
                                                             DataRange output) {
-    size_t outLength = output.length();
-    int ret = ::compress2(const_cast<Bytef*>(reinterpret_cast<const Bytef*>(output.data())),
-                          reinterpret_cast<uLongf*>(&outLength),
-                          reinterpret_cast<const Bytef*>(input.data()),
-                          input.length(),
-                          Z_DEFAULT_COMPRESSION);
-
-    if (ret != Z_OK) {
+    auto stream = getThreadDeflateStream().reset(input, output);
+    int ret = ::deflate(stream, Z_FINISH);
+
+    if (ret != Z_STREAM_END) {
         return Status{ErrorCodes::BadValue, "Could not compress input"};
     }
+    size_t outLength = stream->total_out;
     counterHitCompress(input.length(), outLength);
     return {outLength};
 }
 
 StatusWith<std::size_t> ZlibMessageCompressor::decompressData(ConstDataRange input,
                                                               DataRange output) {
-    uLongf length = output.length();
-    int ret = ::uncompress(const_cast<Bytef*>(reinterpret_cast<const Bytef*>(output.data())),
-                           &length,
-                           reinterpret_cast<const Bytef*>(input.data()),
-                           input.length());
+    auto stream = getThreadInflateStream().reset(input, output);
+    int ret = ::inflate(stream, Z_FINISH);
 
-    if (ret != Z_OK) {
+    if (ret != Z_STREAM_END) {
         return Status{ErrorCodes::BadValue, "Compressed message was invalid or corrupted"};
     }
 
-    counterHitDecompress(input.length(), output.length());
-    return {output.length()};
+    size_t outLength = stream->total_out;
+    counterHitDecompress(input.length(), outLength);
+    return {outLength};
 }
 
 
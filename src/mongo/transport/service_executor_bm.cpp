@@ -0,0 +1,194 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/dbmessage.h"
+#include "mongo/db/service_context.h"
+#include "mongo/rpc/op_msg.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/transport/mock_session.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/transport/service_executor_adaptive.h"
+#include "mongo/transport/service_executor_work_stealing.h"
+#include "mongo/transport/service_state_machine.h"
+#include "mongo/transport/transport_layer_asio.h"
+#include "mongo/transport/transport_layer_mock.h"
+#include "mongo/util/processinfo.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+
+// The number of requests each session sends before the client closes it
+constexpr int kMessagesPerSession = 100;
+
+Message buildOpMsg(BSONObj input) {
+    OpMsgBuilder builder;
+    builder.setBody(input);
+    return builder.finish();
+}
+
+/**
+ * A ServiceEntryPoint which answers every request with {ok: 1}, so that the benchmarks measure the
+ * cost of the executor and the ServiceStateMachine rather than of running commands.
+ */
+class OkServiceEntryPoint : public ServiceEntryPoint {
+public:
+    void startSession(SessionHandle session) override {}
+
+    DbResponse handleRequest(OperationContext* opCtx, const Message& request) override {
+        DbResponse dbResponse;
+        dbResponse.response = buildOpMsg(BSON("ok" << 1));
+        return dbResponse;
+    }
+
+    void endAllSessions(Session::TagMask tags) override {}
+
+    Status start() override {
+        return Status::OK();
+    }
+
+    bool shutdown(Milliseconds timeout) override {
+        return true;
+    }
+
+    void appendStats(BSONObjBuilder*) const override {}
+
+    size_t numOpenSessions() const override {
+        return 0;
+    }
+};
+
+/**
+ * A session which sources a fixed number of ping requests and then reports that the client closed
+ * it. It does not touch the state of the TransportLayerMock, which is not thread safe.
+ */
+class PingSession : public MockSession {
+public:
+    PingSession(TransportLayer* tl, int numMessages)
+        : MockSession(tl), _remainingMessages(numMessages) {}
+
+    StatusWith<Message> sourceMessage() override {
+        if (_remainingMessages-- <= 0) {
+            return TransportLayer::TicketSessionClosedStatus;
+        }
+        return buildOpMsg(BSON("ping" << 1));
+    }
+
+    Status sinkMessage(Message message) override {
+        return Status::OK();
+    }
+
+    void end() override {}
+
+private:
+    int _remainingMessages;
+};
+
+/**
+ * Runs the given number of sessions concurrently on the executor, each of which sends
+ * kMessagesPerSession requests, and waits for all of them to end.
+ */
+void runSessions(ServiceContext* svcCtx, TransportLayer* tl, int numSessions) {
+    stdx::mutex mutex;
+    stdx::condition_variable cond;
+    int remainingSessions = numSessions;
+
+    for (int i = 0; i < numSessions; ++i) {
+        auto ssm = ServiceStateMachine::create(
+            svcCtx, std::make_shared<PingSession>(tl, kMessagesPerSession), Mode::kAsynchronous);
+        ssm->setCleanupHook([&] {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            if (--remainingSessions == 0) {
+                cond.notify_one();
+            }
+        });
+        ssm->start(ServiceStateMachine::Ownership::kOwned);
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    cond.wait(lk, [&] { return remainingSessions == 0; });
+}
+
+template <typename MakeExecutor>
+void runBenchmark(benchmark::State& state, MakeExecutor makeExecutor) {
+    const auto numSessions = static_cast<int>(state.range(0));
+
+    setGlobalServiceContext(ServiceContext::make());
+    auto svcCtx = getGlobalServiceContext();
+    svcCtx->setServiceEntryPoint(std::make_unique<OkServiceEntryPoint>());
+
+    // The reactors come from a TransportLayerASIO, but the sessions are mocked out, so that the
+    // benchmark does not depend on the speed of the loopback interface
+    TransportLayerASIO asioTL(TransportLayerASIO::Options(), nullptr);
+    TransportLayerMock mockTL;
+
+    auto executor = makeExecutor(svcCtx, &asioTL);
+    auto executorPtr = executor.get();
+    svcCtx->setServiceExecutor(std::move(executor));
+    invariant(executorPtr->start());
+
+    for (auto _ : state) {
+        runSessions(svcCtx, &mockTL, numSessions);
+    }
+
+    invariant(executorPtr->shutdown(Seconds{10}));
+    state.SetItemsProcessed(state.iterations() * numSessions * kMessagesPerSession);
+
+    setGlobalServiceContext({});
+}
+
+void BM_adaptiveExecutor(benchmark::State& state) {
+    runBenchmark(state, [](ServiceContext* svcCtx, TransportLayerASIO* tl) {
+        return std::make_unique<ServiceExecutorAdaptive>(
+            svcCtx, tl->getReactor(TransportLayer::kNewReactor));
+    });
+}
+
+void BM_workStealingExecutor(benchmark::State& state) {
+    runBenchmark(state, [](ServiceContext* svcCtx, TransportLayerASIO* tl) {
+        std::vector<ReactorHandle> reactors;
+        for (size_t i = 0; i < ProcessInfo::getNumAvailableCores(); ++i) {
+            reactors.push_back(tl->getReactor(TransportLayer::kNewReactor));
+        }
+        return std::make_unique<ServiceExecutorWorkStealing>(svcCtx, std::move(reactors));
+    });
+}
+
+BENCHMARK(BM_adaptiveExecutor)->Arg(1)->Arg(16)->Arg(256)->UseRealTime();
+BENCHMARK(BM_workStealingExecutor)->Arg(1)->Arg(16)->Arg(256)->UseRealTime();
+
+}  // namespace
+}  // namespace transport
+}  // namespace mongo
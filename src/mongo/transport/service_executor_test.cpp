@@ -37,6 +37,7 @@
 #include "mongo/transport/service_executor_adaptive.h"
 #include "mongo/transport/service_executor_synchronous.h"
 #include "mongo/transport/service_executor_task_names.h"
+#include "mongo/transport/service_executor_work_stealing.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
@@ -83,6 +84,18 @@ struct TestOptions : public ServiceExecutorAdaptive::Options {
     }
 };
 
+struct WorkStealingTestOptions : public ServiceExecutorWorkStealing::Options {
+    Milliseconds blockedTaskTimeout() const final {
+        return blockedTimeout;
+    }
+
+    int recursionLimit() const final {
+        return 0;
+    }
+
+    Milliseconds blockedTimeout{100};
+};
+
 /* This implements the portions of the transport::Reactor based on ASIO, but leaves out
  * the methods not needed by ServiceExecutors.
  *
@@ -164,6 +177,27 @@ protected:
     std::shared_ptr<asio::io_context> asioIOCtx;
 };
 
+class ServiceExecutorWorkStealingFixture : public unittest::Test {
+protected:
+    void setUp() override {
+        auto scOwned = ServiceContext::make();
+        setGlobalServiceContext(std::move(scOwned));
+
+        auto configOwned = std::make_unique<WorkStealingTestOptions>();
+        executorConfig = configOwned.get();
+
+        std::vector<ReactorHandle> reactors;
+        for (int i = 0; i < 2; ++i) {
+            reactors.push_back(std::make_shared<ASIOReactor>());
+        }
+        executor = std::make_unique<ServiceExecutorWorkStealing>(
+            getGlobalServiceContext(), std::move(reactors), std::move(configOwned));
+    }
+
+    WorkStealingTestOptions* executorConfig;
+    std::unique_ptr<ServiceExecutorWorkStealing> executor;
+};
+
 class ServiceExecutorSynchronousFixture : public unittest::Test {
 protected:
     void setUp() override {
@@ -206,6 +240,76 @@ TEST_F(ServiceExecutorAdaptiveFixture, ScheduleFailsBeforeStartup) {
     scheduleBasicTask(executor.get(), false);
 }
 
+/**
+ * Schedules a task which schedules numChildren tasks on the worker running it, and blocks until
+ * they have all run. Since the worker itself is busy, they have to be run by another thread.
+ */
+void scheduleBlockingTask(ServiceExecutor* exec, int numChildren) {
+    stdx::condition_variable cond;
+    stdx::mutex mutex;
+    int numRun = 0;
+    bool done = false;
+
+    auto task = [&] {
+        for (int i = 0; i < numChildren; ++i) {
+            ASSERT_OK(exec->schedule(
+                [&] {
+                    stdx::lock_guard<stdx::mutex> lk(mutex);
+                    ++numRun;
+                    cond.notify_all();
+                },
+                ServiceExecutor::kEmptyFlags,
+                ServiceExecutorTaskName::kSSMProcessMessage));
+        }
+
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cond.wait(lk, [&] { return numRun == numChildren; });
+        done = true;
+        cond.notify_all();
+    };
+
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    ASSERT_OK(exec->schedule(
+        std::move(task), ServiceExecutor::kEmptyFlags, ServiceExecutorTaskName::kSSMStartSession));
+    cond.wait(lk, [&] { return done; });
+}
+
+TEST_F(ServiceExecutorWorkStealingFixture, BasicTaskRuns) {
+    ASSERT_OK(executor->start());
+    auto guard = makeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    scheduleBasicTask(executor.get(), true);
+}
+
+TEST_F(ServiceExecutorWorkStealingFixture, ScheduleFailsBeforeStartup) {
+    scheduleBasicTask(executor.get(), false);
+}
+
+TEST_F(ServiceExecutorWorkStealingFixture, IdleWorkerStealsFromBusyWorker) {
+    // Make sure that the tasks do not get run by a helper thread instead
+    executorConfig->blockedTimeout = Minutes{10};
+    ASSERT_OK(executor->start());
+    auto guard = makeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    scheduleBlockingTask(executor.get(), 2);
+
+    BSONObjBuilder bob;
+    executor->appendStats(&bob);
+    ASSERT_EQ(bob.obj()["totalStolen"].numberLong(), 2);
+}
+
+TEST_F(ServiceExecutorWorkStealingFixture, HelperRunsTasksOfBlockedWorker) {
+    ASSERT_OK(executor->start());
+    auto guard = makeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    // A single queued task does not wake an idle worker, so only a helper thread can run it
+    scheduleBlockingTask(executor.get(), 1);
+
+    BSONObjBuilder bob;
+    executor->appendStats(&bob);
+    ASSERT_EQ(bob.obj()["helperThreadsStarted"].numberLong(), 1);
+}
+
 TEST_F(ServiceExecutorSynchronousFixture, BasicTaskRuns) {
     ASSERT_OK(executor->start());
     auto guard = makeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
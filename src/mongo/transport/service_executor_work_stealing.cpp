@@ -0,0 +1,426 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor;
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/service_executor_work_stealing.h"
+
+#include "mongo/transport/service_entry_point_utils.h"
+#include "mongo/transport/service_executor_gen.h"
+#include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace transport {
+
+namespace {
+constexpr auto kTotalQueued = "totalQueued"_sd;
+constexpr auto kTotalExecuted = "totalExecuted"_sd;
+constexpr auto kTotalStolen = "totalStolen"_sd;
+constexpr auto kTotalTimeExecutingUs = "totalTimeExecutingMicros"_sd;
+constexpr auto kTotalTimeQueuedUs = "totalTimeQueuedMicros"_sd;
+constexpr auto kWorkers = "workers"_sd;
+constexpr auto kThreadsRunning = "threadsRunning"_sd;
+constexpr auto kHelperThreadsStarted = "helperThreadsStarted"_sd;
+constexpr auto kExecutorLabel = "executor"_sd;
+constexpr auto kExecutorName = "workStealing"_sd;
+
+// The amount of time each worker runs its reactor before checking whether the executor is still
+// running. Shutting down stops the reactors, so this does not delay shutdown.
+constexpr Milliseconds kWorkerRunTime{1000};
+
+// The number of tasks a worker runs before letting its reactor handle networking again
+constexpr int kMaxTasksPerRun = 16;
+
+int64_t ticksToMicros(TickSource::Tick ticks, TickSource* tickSource) {
+    invariant(tickSource->getTicksPerSecond() >= 1000000);
+    return tickSource->ticksTo<Microseconds>(ticks).count();
+}
+
+struct ServerParameterOptions : public ServiceExecutorWorkStealing::Options {
+    Milliseconds blockedTaskTimeout() const final {
+        return Milliseconds{workStealingServiceExecutorBlockedTaskMillis.load()};
+    }
+
+    int recursionLimit() const final {
+        return workStealingServiceExecutorRecursionLimit.load();
+    }
+};
+
+}  // namespace
+
+thread_local ServiceExecutorWorkStealing::Worker* ServiceExecutorWorkStealing::_localWorker =
+    nullptr;
+thread_local ServiceExecutorWorkStealing::ThreadState*
+    ServiceExecutorWorkStealing::_localThreadState = nullptr;
+thread_local int ServiceExecutorWorkStealing::_localRecursionDepth = 0;
+
+int ServiceExecutorWorkStealing::workerCount() {
+    int value = workStealingServiceExecutorThreads.load();
+    if (value == -1) {
+        value = static_cast<int>(ProcessInfo::getNumAvailableCores());
+        log() << "No thread count configured for executor. Using number of cores: " << value;
+    }
+    return std::max(value, 1);
+}
+
+ServiceExecutorWorkStealing::ServiceExecutorWorkStealing(ServiceContext* ctx,
+                                                         std::vector<ReactorHandle> reactors)
+    : ServiceExecutorWorkStealing(
+          ctx, std::move(reactors), std::make_unique<ServerParameterOptions>()) {}
+
+ServiceExecutorWorkStealing::ServiceExecutorWorkStealing(ServiceContext* ctx,
+                                                         std::vector<ReactorHandle> reactors,
+                                                         std::unique_ptr<Options> config)
+    : _config(std::move(config)), _tickSource(ctx->getTickSource()) {
+    invariant(!reactors.empty());
+
+    _workers.reserve(reactors.size());
+    for (size_t i = 0; i < reactors.size(); ++i) {
+        _workers.push_back(std::make_unique<Worker>(i, std::move(reactors[i])));
+    }
+}
+
+ServiceExecutorWorkStealing::~ServiceExecutorWorkStealing() {
+    invariant(!_isRunning.load());
+}
+
+Status ServiceExecutorWorkStealing::start() {
+    invariant(!_isRunning.load());
+    _isRunning.store(true);
+
+    for (size_t i = 0; i < _workers.size(); ++i) {
+        auto status = _startThread([this, i] { _workerThreadRoutine(i); });
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
+    _controllerThread =
+        stdx::thread(&ServiceExecutorWorkStealing::_controllerThreadRoutine, this);
+
+    return Status::OK();
+}
+
+Status ServiceExecutorWorkStealing::shutdown(Milliseconds timeout) {
+    if (!_isRunning.load())
+        return Status::OK();
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_controllerMutex);
+        _isRunning.store(false);
+        _controllerCondition.notify_one();
+    }
+    _controllerThread.join();
+
+    for (auto& worker : _workers) {
+        worker->reactor->stop();
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(_threadsMutex);
+    bool result = _deathCondition.wait_for(
+        lk, timeout.toSystemDuration(), [&] { return _threadsRunning == 0; });
+
+    return result
+        ? Status::OK()
+        : Status(ErrorCodes::Error::ExceededTimeLimit,
+                 "work-stealing executor couldn't shutdown all worker threads within time limit.");
+}
+
+Status ServiceExecutorWorkStealing::schedule(Task task,
+                                             ScheduleFlags flags,
+                                             ServiceExecutorTaskName taskName) {
+    if (!_isRunning.load()) {
+        return {ErrorCodes::ShutdownInProgress, "Executor is not running"};
+    }
+
+    const auto scheduleTicks = _tickSource->getTicks();
+    auto wrappedTask = [this, task = std::move(task), scheduleTicks] {
+        const auto start = _tickSource->getTicks();
+        _totalSpentQueued.addAndFetch(start - scheduleTicks);
+
+        // Tasks which run recursively are part of the task which scheduled them, so only the
+        // outermost one marks the thread as busy
+        if (_localRecursionDepth++ == 0) {
+            _localThreadState->taskStartTicks.store(std::max<TickSource::Tick>(start, 1));
+        }
+        const auto guard = makeGuard([this, start] {
+            if (--_localRecursionDepth == 0) {
+                _localThreadState->taskStartTicks.store(0);
+            }
+            _totalExecuted.addAndFetch(1);
+            _totalSpentExecuting.addAndFetch(_tickSource->getTicks() - start);
+        });
+
+        task();
+    };
+
+    _totalQueued.addAndFetch(1);
+
+    // Tasks scheduled from a worker stay on it. Since the pool of workers is fixed, deferred tasks
+    // are treated like any other.
+    if (_localWorker && (flags & kMayRecurse) &&
+        (_localRecursionDepth + 1 < _config->recursionLimit())) {
+        wrappedTask();
+        return Status::OK();
+    }
+
+    auto worker = _localWorker;
+    if (!worker) {
+        worker = _workers[_nextWorker.fetchAndAdd(1) % _workers.size()].get();
+    }
+    _pushTask(worker, std::move(wrappedTask));
+
+    return Status::OK();
+}
+
+void ServiceExecutorWorkStealing::_pushTask(Worker* worker, Task task) {
+    size_t numQueued;
+    {
+        stdx::lock_guard<stdx::mutex> lk(worker->mutex);
+        worker->tasks.push_back(std::move(task));
+        numQueued = worker->tasks.size();
+    }
+
+    _scheduleRunTasks(worker);
+
+    // A worker which has a backlog while it is running a task cannot get to all of it soon, so let
+    // an idle worker help with it
+    if (numQueued > 1 && worker->threadState.taskStartTicks.load() != 0) {
+        _wakeIdleWorker(worker);
+    }
+}
+
+boost::optional<ServiceExecutor::Task> ServiceExecutorWorkStealing::_popTask(Worker* worker) {
+    {
+        stdx::lock_guard<stdx::mutex> lk(worker->mutex);
+        if (!worker->tasks.empty()) {
+            auto task = std::move(worker->tasks.front());
+            worker->tasks.pop_front();
+            return std::move(task);
+        }
+    }
+
+    // Steal from the back of the other queues, which their owners will get to last
+    for (size_t i = 1; i < _workers.size(); ++i) {
+        auto& victim = *_workers[(worker->id + i) % _workers.size()];
+        stdx::lock_guard<stdx::mutex> lk(victim.mutex);
+        if (!victim.tasks.empty()) {
+            auto task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            _totalStolen.addAndFetch(1);
+            return std::move(task);
+        }
+    }
+
+    return boost::none;
+}
+
+void ServiceExecutorWorkStealing::_runTasks(Worker* worker) {
+    worker->runScheduled.store(false);
+    worker->idle.store(false);
+
+    for (int i = 0; i < kMaxTasksPerRun; ++i) {
+        if (!_isRunning.load()) {
+            return;
+        }
+
+        auto task = _popTask(worker);
+        if (!task) {
+            worker->idle.store(true);
+            return;
+        }
+
+        (*task)();
+    }
+
+    // There may be more to do, but give the reactor a chance to handle networking first
+    _scheduleRunTasks(worker);
+}
+
+void ServiceExecutorWorkStealing::_scheduleRunTasks(Worker* worker) {
+    if (worker->runScheduled.swap(true)) {
+        return;
+    }
+
+    worker->reactor->schedule([this, worker](Status status) {
+        if (status.isOK()) {
+            _runTasks(worker);
+        }
+    });
+}
+
+void ServiceExecutorWorkStealing::_wakeIdleWorker(const Worker* busyWorker) {
+    for (size_t i = 1; i < _workers.size(); ++i) {
+        auto& worker = *_workers[(busyWorker->id + i) % _workers.size()];
+        if (worker.idle.swap(false)) {
+            _scheduleRunTasks(&worker);
+            return;
+        }
+    }
+}
+
+bool ServiceExecutorWorkStealing::_isBlocked(const Worker& worker) const {
+    if (worker.threadState.markedIdle.load()) {
+        return true;
+    }
+
+    const auto taskStartTicks = worker.threadState.taskStartTicks.load();
+    if (taskStartTicks == 0) {
+        return false;
+    }
+
+    const auto timeoutTicks = durationCount<Milliseconds>(_config->blockedTaskTimeout()) *
+        _tickSource->getTicksPerSecond() / 1000;
+    return _tickSource->getTicks() - taskStartTicks >= timeoutTicks;
+}
+
+Status ServiceExecutorWorkStealing::_startThread(std::function<void()> routine) {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+        ++_threadsRunning;
+    }
+
+    auto status = launchServiceWorkerThread([this, routine = std::move(routine)] {
+        routine();
+
+        stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+        --_threadsRunning;
+        _deathCondition.notify_one();
+    });
+
+    if (!status.isOK()) {
+        stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+        --_threadsRunning;
+    }
+    return status;
+}
+
+void ServiceExecutorWorkStealing::_workerThreadRoutine(size_t workerId) {
+    auto& worker = *_workers[workerId];
+    _localWorker = &worker;
+    _localThreadState = &worker.threadState;
+    IdleThreadBlock::setIdleFlagForThread(&worker.threadState.markedIdle);
+    {
+        std::string threadName = str::stream() << "worker-" << workerId;
+        setThreadName(threadName);
+    }
+
+    LOG(1) << "Started new database worker thread " << workerId;
+
+    while (_isRunning.load()) {
+        worker.reactor->runFor(kWorkerRunTime);
+    }
+
+    IdleThreadBlock::setIdleFlagForThread(nullptr);
+}
+
+void ServiceExecutorWorkStealing::_helperThreadRoutine(size_t workerId) {
+    auto& worker = *_workers[workerId];
+    const auto guard = makeGuard([&worker] { worker.helped.store(false); });
+
+    // The helper queues the tasks it schedules on the worker it helps, but has a state of its own,
+    // so that the worker is still seen as blocked until it is done with its task
+    ThreadState threadState;
+    _localWorker = &worker;
+    _localThreadState = &threadState;
+    {
+        std::string threadName = str::stream() << "worker-" << workerId << "-helper";
+        setThreadName(threadName);
+    }
+
+    while (_isRunning.load() && _isBlocked(worker)) {
+        worker.reactor->runFor(_config->blockedTaskTimeout());
+    }
+}
+
+/*
+ * A worker which runs a long task, such as an operation waiting for a lock or a slow query, cannot
+ * handle the networking of the connections on its reactor or run the tasks queued on it until it
+ * is done. While the controller thread finds a worker in that state, it has a helper thread run
+ * its reactor, which also runs the tasks queued on the worker.
+ */
+void ServiceExecutorWorkStealing::_controllerThreadRoutine() {
+    setThreadName("worker-controller"_sd);
+
+    stdx::unique_lock<stdx::mutex> lk(_controllerMutex);
+    while (_isRunning.load()) {
+        const auto checkInterval =
+            std::max(Milliseconds{1}, _config->blockedTaskTimeout() / 2);
+        _controllerCondition.wait_for(
+            lk, checkInterval.toSystemDuration(), [this] { return !_isRunning.load(); });
+
+        if (!_isRunning.load())
+            break;
+
+        for (auto& worker : _workers) {
+            if (!_isBlocked(*worker) || worker->helped.swap(true)) {
+                continue;
+            }
+
+            LOG(1) << "Worker " << worker->id
+                   << " is blocked, starting helper thread to run its networking and tasks";
+            _totalHelpersStarted.addAndFetch(1);
+
+            const auto workerId = worker->id;
+            auto status = _startThread([this, workerId] { _helperThreadRoutine(workerId); });
+            if (!status.isOK()) {
+                warning() << "Failed to launch helper thread: " << status;
+                worker->helped.store(false);
+            }
+        }
+    }
+}
+
+void ServiceExecutorWorkStealing::appendStats(BSONObjBuilder* bob) const {
+    int threadsRunning;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+        threadsRunning = _threadsRunning;
+    }
+
+    *bob << kExecutorLabel << kExecutorName                                                 //
+         << kTotalQueued << _totalQueued.load()                                             //
+         << kTotalExecuted << _totalExecuted.load()                                         //
+         << kTotalStolen << _totalStolen.load()                                             //
+         << kTotalTimeExecutingUs << ticksToMicros(_totalSpentExecuting.load(), _tickSource)  //
+         << kTotalTimeQueuedUs << ticksToMicros(_totalSpentQueued.load(), _tickSource)      //
+         << kWorkers << static_cast<int>(_workers.size())                                   //
+         << kThreadsRunning << threadsRunning                                               //
+         << kHelperThreadsStarted << _totalHelpersStarted.load();
+}
+
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,198 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <boost/optional.hpp>
+#include <vector>
+
+#include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/service_executor.h"
+#include "mongo/transport/service_executor_task_names.h"
+#include "mongo/transport/transport_layer.h"
+#include "mongo/util/tick_source.h"
+
+namespace mongo {
+namespace transport {
+
+/**
+ * This is an ASIO-based ServiceExecutor with a fixed pool of worker threads, typically one per
+ * core. Each worker runs its own reactor, on which the transport layer places the sockets of a
+ * share of the accepted connections, so that the networking of a connection is handled by a single
+ * worker. Tasks scheduled from a worker are queued on that worker, and workers which have nothing
+ * to do take tasks from the queues of workers which are busy.
+ *
+ * A controller thread watches for workers which have been running the same task for longer than
+ * the configured blocked task timeout, or which are waiting in an IdleThreadBlock, and starts a
+ * helper thread to run the reactor of such a worker until it is done, so that the connections of
+ * that worker are not stalled by a single long operation.
+ */
+class ServiceExecutorWorkStealing final : public ServiceExecutor {
+public:
+    struct Options {
+        virtual ~Options() = default;
+
+        // The amount of time a worker may run a single task before it is considered blocked and
+        // its reactor is handed to a helper thread.
+        virtual Milliseconds blockedTaskTimeout() const = 0;
+
+        // The maximum allowable depth of recursion for tasks scheduled with the MayRecurse flag
+        // before stack unwinding is forced.
+        virtual int recursionLimit() const = 0;
+    };
+
+    /**
+     * Returns the number of worker threads to start, and so the number of reactors to give to the
+     * constructor.
+     */
+    static int workerCount();
+
+    /**
+     * Starts one worker for each of the given reactors.
+     */
+    ServiceExecutorWorkStealing(ServiceContext* ctx, std::vector<ReactorHandle> reactors);
+    ServiceExecutorWorkStealing(ServiceContext* ctx,
+                                std::vector<ReactorHandle> reactors,
+                                std::unique_ptr<Options> config);
+
+    ~ServiceExecutorWorkStealing();
+
+    Status start() override;
+    Status shutdown(Milliseconds timeout) override;
+    Status schedule(Task task, ScheduleFlags flags, ServiceExecutorTaskName taskName) override;
+
+    Mode transportMode() const override {
+        return Mode::kAsynchronous;
+    }
+
+    void appendStats(BSONObjBuilder* bob) const override;
+
+private:
+    /**
+     * The state of a thread which runs tasks, which other threads look at to tell whether it is
+     * blocked.
+     */
+    struct ThreadState {
+        // The tick at which the task being run started, or zero if no task is being run
+        AtomicWord<TickSource::Tick> taskStartTicks{0};
+
+        // Raised while the thread is in an IdleThreadBlock
+        AtomicWord<bool> markedIdle{false};
+    };
+
+    struct Worker {
+        Worker(size_t id, ReactorHandle reactor) : id(id), reactor(std::move(reactor)) {}
+
+        const size_t id;
+        const ReactorHandle reactor;
+
+        // The tasks scheduled from this worker, which it runs from the front and other workers
+        // steal from the back
+        stdx::mutex mutex;
+        std::deque<Task> tasks;
+
+        // Set while a call to _runTasks() is scheduled on the reactor and has not started yet
+        AtomicWord<bool> runScheduled{false};
+
+        // Set while the worker has no tasks to run and is only waiting for networking
+        AtomicWord<bool> idle{true};
+
+        // Set while a helper thread runs the reactor of this worker
+        AtomicWord<bool> helped{false};
+
+        ThreadState threadState;
+    };
+
+    void _workerThreadRoutine(size_t workerId);
+    void _helperThreadRoutine(size_t workerId);
+    void _controllerThreadRoutine();
+
+    /**
+     * Queues the task on the given worker and makes sure that the worker, or an idle worker if
+     * this one is busy, gets to run it.
+     */
+    void _pushTask(Worker* worker, Task task);
+
+    /**
+     * Pops the next task of the worker, or steals one from another worker if it has none.
+     */
+    boost::optional<Task> _popTask(Worker* worker);
+
+    /**
+     * Runs the tasks queued on the worker, and those it can steal, from the worker's reactor.
+     */
+    void _runTasks(Worker* worker);
+
+    void _scheduleRunTasks(Worker* worker);
+    void _wakeIdleWorker(const Worker* busyWorker);
+    bool _isBlocked(const Worker& worker) const;
+    Status _startThread(std::function<void()> routine);
+
+    std::unique_ptr<Options> _config;
+
+    TickSource* const _tickSource;
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    AtomicWord<bool> _isRunning{false};
+
+    // Used to spread the tasks scheduled from other threads over the workers
+    AtomicWord<size_t> _nextWorker{0};
+
+    stdx::thread _controllerThread;
+    stdx::mutex _controllerMutex;
+    stdx::condition_variable _controllerCondition;
+
+    // Threads signal this condition variable when they exit so we can gracefully shutdown the
+    // executor.
+    mutable stdx::mutex _threadsMutex;
+    stdx::condition_variable _deathCondition;
+    int _threadsRunning{0};
+
+    static thread_local Worker* _localWorker;
+    static thread_local ThreadState* _localThreadState;
+    static thread_local int _localRecursionDepth;
+
+    // These counters are only used for reporting in serverStatus.
+    AtomicWord<int64_t> _totalQueued{0};
+    AtomicWord<int64_t> _totalExecuted{0};
+    AtomicWord<int64_t> _totalStolen{0};
+    AtomicWord<int64_t> _totalHelpersStarted{0};
+    AtomicWord<TickSource::Tick> _totalSpentQueued{0};
+    AtomicWord<TickSource::Tick> _totalSpentExecuting{0};
+};
+
+}  // namespace transport
+}  // namespace mongo
@@ -133,6 +133,15 @@ Message makeExhaustMessage(Message requestMsg, DbResponse* dbresponse) {
         OpMsg::appendChecksum(&dbresponse->response);
     }
 
+    // If the command asked for a different body on its next invocation, serialize it in place of
+    // the original request, keeping the original request's flags.
+    if (dbresponse->nextInvocation) {
+        const auto flags = OpMsg::flags(requestMsg) & ~OpMsg::kChecksumPresent;
+        request.body = *dbresponse->nextInvocation;
+        requestMsg = request.serialize();
+        OpMsg::replaceFlags(&requestMsg, flags);
+    }
+
     // Return an augmented form of the initial request, which is to be used as the next request to
     // be processed by the database. The id of the response is used as the request id of this
     // 'synthetic' request. Re-checksum if needed.
@@ -352,7 +352,7 @@ private:
 
         auto headerBuffer = SharedBuffer::allocate(kHeaderSize);
         auto ptr = headerBuffer.get();
-        return read(asio::buffer(ptr, kHeaderSize), baton)
+        return readHeader(asio::buffer(ptr, kHeaderSize), baton)
             .then([headerBuffer = std::move(headerBuffer), this, baton]() mutable {
                 if (checkForHTTPRequest(asio::buffer(headerBuffer.get(), kHeaderSize))) {
                     return sendHTTPResponse(baton);
@@ -380,8 +380,20 @@ private:
                 auto buffer = SharedBuffer::allocate(msgLen);
                 memcpy(buffer.get(), headerBuffer.get(), kHeaderSize);
 
+                // Whatever part of the body was read along with the header does not need to be read
+                // again
                 MsgData::View msgView(buffer.get());
-                return read(asio::buffer(msgView.data(), msgView.dataLen()), baton)
+                const auto bodyLen = size_t(msgView.dataLen());
+                const auto bodyReadAhead = takeReadAhead(msgView.data(), bodyLen);
+                if (bodyReadAhead == bodyLen) {
+                    if (_isIngressSession) {
+                        networkCounter.hitPhysicalIn(msgLen);
+                    }
+                    return Future<Message>::makeReady(Message(std::move(buffer)));
+                }
+
+                return read(asio::buffer(msgView.data() + bodyReadAhead, bodyLen - bodyReadAhead),
+                            baton)
                     .then([this, buffer = std::move(buffer), msgLen]() mutable {
                         if (_isIngressSession) {
                             networkCounter.hitPhysicalIn(msgLen);
@@ -391,6 +403,108 @@ private:
             });
     }
 
+    /**
+     * Reads a message header into 'buffer'. When possible, the header is read along with as much of
+     * the rest of the message, and of the messages pipelined after it, as is available on the
+     * socket, so that a small message takes a single read rather than two.
+     */
+    Future<void> readHeader(const asio::mutable_buffer& buffer, const BatonHandle& baton) {
+        if (!canReadAhead()) {
+            return read(buffer, baton);
+        }
+
+        return fillReadAhead(buffer.size(), baton).then([this, buffer] {
+            const auto taken = takeReadAhead(static_cast<char*>(buffer.data()), buffer.size());
+            invariant(taken == buffer.size());
+        });
+    }
+
+    bool canReadAhead() const {
+#ifdef MONGO_CONFIG_SSL
+        // Bytes read ahead from an SSL connection would still have to be decrypted, and the first
+        // read of an ingress connection is needed to tell whether it uses SSL at all.
+        if (_sslSocket || !_ranHandshake) {
+            return false;
+        }
+#endif
+        return true;
+    }
+
+    size_t readAheadSize() const {
+        return _readAheadEnd - _readAheadBegin;
+    }
+
+    /**
+     * Moves up to 'size' bytes from the read ahead buffer into 'dest' and returns how many were
+     * moved. The buffer is released once it is empty, so that idle connections do not hold one.
+     */
+    size_t takeReadAhead(char* dest, size_t size) {
+        const auto taken = std::min(size, readAheadSize());
+        if (taken == 0) {
+            return 0;
+        }
+
+        memcpy(dest, _readAheadBuffer.get() + _readAheadBegin, taken);
+        _readAheadBegin += taken;
+        if (_readAheadBegin == _readAheadEnd) {
+            _readAheadBuffer.reset();
+            _readAheadBegin = _readAheadEnd = 0;
+        }
+        return taken;
+    }
+
+    /**
+     * Reads from the socket until the read ahead buffer holds at least 'minSize' bytes. Each read
+     * takes as many bytes as are available and fit in the buffer.
+     */
+    Future<void> fillReadAhead(size_t minSize, const BatonHandle& baton) {
+        invariant(minSize <= kReadAheadBytes);
+
+        while (readAheadSize() < minSize) {
+            if (!_readAheadBuffer) {
+                _readAheadBuffer = std::make_unique<char[]>(kReadAheadBytes);
+            } else if (_readAheadBegin > 0) {
+                memmove(_readAheadBuffer.get(),
+                        _readAheadBuffer.get() + _readAheadBegin,
+                        readAheadSize());
+                _readAheadEnd -= _readAheadBegin;
+                _readAheadBegin = 0;
+            }
+
+            std::error_code ec;
+            _readAheadEnd += _socket.read_some(
+                asio::buffer(_readAheadBuffer.get() + _readAheadEnd,
+                             kReadAheadBytes - _readAheadEnd),
+                ec);
+            if (!ec) {
+                continue;
+            }
+
+            if (readAheadSize() == 0) {
+                _readAheadBuffer.reset();
+                _readAheadBegin = _readAheadEnd = 0;
+            }
+
+            if (((ec == asio::error::would_block) || (ec == asio::error::try_again)) &&
+                (_blockingMode == Async)) {
+                // Only wait for the socket to become readable, so that no buffer is held while the
+                // connection is idle
+                auto readable = [&] {
+                    if (baton && baton->networking()) {
+                        return baton->networking()->addSession(*this, NetworkingBaton::Type::In);
+                    }
+                    return _socket.async_wait(GenericSocket::wait_read, UseFuture{});
+                }();
+                return std::move(readable).then(
+                    [this, minSize, baton] { return fillReadAhead(minSize, baton); });
+            }
+
+            return futurize(ec);
+        }
+
+        return Future<void>::makeReady();
+    }
+
     template <typename MutableBufferSequence>
     Future<void> read(const MutableBufferSequence& buffers, const BatonHandle& baton = nullptr) {
 #ifdef MONGO_CONFIG_SSL
@@ -705,6 +819,13 @@ private:
     bool _ranHandshake = false;
 #endif
 
+    // The bytes which were read from the socket ahead of the message being sourced. Only allocated
+    // while it holds any.
+    static constexpr size_t kReadAheadBytes = 16 * 1024;
+    std::unique_ptr<char[]> _readAheadBuffer;
+    size_t _readAheadBegin = 0;
+    size_t _readAheadEnd = 0;
+
     TransportLayerASIO* const _tl;
     bool _isIngressSession;
 };
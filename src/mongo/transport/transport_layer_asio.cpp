@@ -39,6 +39,7 @@
 
 #include "mongo/config.h"
 
+#include "mongo/base/checked_cast.h"
 #include "mongo/base/system_error.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/service_context.h"
@@ -855,6 +856,15 @@ ReactorHandle TransportLayerASIO::getReactor(WhichReactor which) {
     MONGO_UNREACHABLE;
 }
 
+void TransportLayerASIO::setIngressReactors(std::vector<ReactorHandle> reactors) {
+    invariant(!_running.load());
+
+    _workerReactors.clear();
+    for (auto& reactor : reactors) {
+        _workerReactors.push_back(checked_pointer_cast<ASIOReactor>(std::move(reactor)));
+    }
+}
+
 void TransportLayerASIO::_acceptConnection(GenericAcceptor& acceptor) {
     auto acceptCb = [this, &acceptor](const std::error_code& ec, GenericSocket peerSocket) mutable {
         if (!_running.load())
@@ -878,7 +888,10 @@ void TransportLayerASIO::_acceptConnection(GenericAcceptor& acceptor) {
         _acceptConnection(acceptor);
     };
 
-    acceptor.async_accept(*_ingressReactor, std::move(acceptCb));
+    auto& reactor = _workerReactors.empty()
+        ? *_ingressReactor
+        : *_workerReactors[_nextWorkerReactor++ % _workerReactors.size()];
+    acceptor.async_accept(reactor, std::move(acceptCb));
 }
 
 #ifdef MONGO_CONFIG_SSL
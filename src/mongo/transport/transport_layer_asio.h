@@ -128,6 +128,14 @@ public:
 
     ReactorHandle getReactor(WhichReactor which) final;
 
+    /**
+     * Places the sockets of accepted connections on the given reactors, in turn, rather than on
+     * the ingress reactor, so that a service executor which runs a reactor on each of its threads
+     * handles the networking of its own connections. The reactors must have been returned by
+     * getReactor(kNewReactor). Must be called before start().
+     */
+    void setIngressReactors(std::vector<ReactorHandle> reactors);
+
     Status start() final;
 
     void shutdown() final;
@@ -188,6 +196,11 @@ private:
     std::shared_ptr<ASIOReactor> _egressReactor;
     std::shared_ptr<ASIOReactor> _acceptorReactor;
 
+    // If not empty, accepted sockets are placed on these reactors instead of the _ingressReactor.
+    // Only accessed from the thread which accepts connections once started.
+    std::vector<std::shared_ptr<ASIOReactor>> _workerReactors;
+    size_t _nextWorkerReactor = 0;
+
 #ifdef MONGO_CONFIG_SSL
     std::unique_ptr<asio::ssl::context> _ingressSSLContext;
     std::unique_ptr<asio::ssl::context> _egressSSLContext;
@@ -271,6 +271,14 @@ public:
     }
 
     void sendMessage() {
+        sendMessages(1);
+    }
+
+    /**
+     * Sends 'count' ping messages with a single write, so that the server is likely to receive
+     * them all at once.
+     */
+    void sendMessages(int count) {
         OpMsgBuilder builder;
         builder.setBody(BSON("ping" << 1));
         Message msg = builder.finish();
@@ -278,8 +286,13 @@ public:
         msg.header().setId(0);
         OpMsg::appendChecksum(&msg);
 
+        std::string data;
+        for (int i = 0; i < count; ++i) {
+            data.append(msg.buf(), msg.size());
+        }
+
         std::error_code ec;
-        asio::write(_sock, asio::buffer(msg.buf(), msg.size()), ec);
+        asio::write(_sock, asio::buffer(data), ec);
         ASSERT_FALSE(ec);
     }
 
@@ -380,5 +393,41 @@ TEST(TransportLayerASIO, SwitchTimeoutModes) {
     tla->shutdown();
 }
 
+/* check that messages which arrive together are all sourced, whole and in order */
+class PipelinedMessagesSEP : public TimeoutSEP {
+public:
+    static constexpr int kNumMessages = 5;
+
+    void startSession(transport::SessionHandle session) override {
+        log() << "Accepted connection from " << session->remote();
+        startWorkerThread([this, session = std::move(session)]() mutable {
+            for (int i = 0; i < kNumMessages; ++i) {
+                auto swMessage = session->sourceMessage();
+                ASSERT_OK(swMessage.getStatus());
+                auto request = OpMsg::parse(swMessage.getValue());
+                ASSERT_BSONOBJ_EQ(request.body, BSON("ping" << 1));
+            }
+
+            session->setTimeout(Milliseconds{500});
+            ASSERT_EQ(session->sourceMessage().getStatus(), ErrorCodes::NetworkTimeout);
+
+            session.reset();
+            notifyComplete();
+        });
+    }
+};
+
+TEST(TransportLayerASIO, SourcePipelinedMessages) {
+    PipelinedMessagesSEP sep;
+    auto tla = makeAndStartTL(&sep);
+
+    TimeoutConnector connector(tla->listenerPort(), false);
+    connector.sendMessage();
+    connector.sendMessages(PipelinedMessagesSEP::kNumMessages - 1);
+
+    sep.waitForTimeout();
+    tla->shutdown();
+}
+
 }  // namespace
 }  // namespace mongo
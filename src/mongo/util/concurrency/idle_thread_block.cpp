@@ -39,13 +39,27 @@ thread_local const char* idleThreadLocation = nullptr;
 }  // namespace for_debuggers
 using for_debuggers::idleThreadLocation;
 
+namespace {
+thread_local AtomicWord<bool>* idleFlag = nullptr;
+}  // namespace
+
 void IdleThreadBlock::beginIdleThreadBlock(const char* location) {
     invariant(!idleThreadLocation);
     idleThreadLocation = location;
+    if (idleFlag) {
+        idleFlag->store(true);
+    }
 }
 
 void IdleThreadBlock::endIdleThreadBlock() {
     invariant(idleThreadLocation);
     idleThreadLocation = nullptr;
+    if (idleFlag) {
+        idleFlag->store(false);
+    }
+}
+
+void IdleThreadBlock::setIdleFlagForThread(AtomicWord<bool>* flag) {
+    idleFlag = flag;
 }
 }  // namespace mongo
@@ -31,6 +31,7 @@
 
 #include <boost/preprocessor/stringize.hpp>
 
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
@@ -58,6 +59,12 @@ public:
     // functionality to a C api.
     static void beginIdleThreadBlock(const char* location);
     static void endIdleThreadBlock();
+
+    /**
+     * Makes the current thread raise 'flag' while it is in an IdleThreadBlock, so that other
+     * threads can tell that it is waiting rather than working. Pass nullptr to stop doing so.
+     */
+    static void setIdleFlagForThread(AtomicWord<bool>* flag);
 };
 
 /**
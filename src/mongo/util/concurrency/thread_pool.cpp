@@ -35,6 +35,7 @@
 
 #include "mongo/base/status.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/platform/pause.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/concurrency/idle_thread_block.h"
 #include "mongo/util/concurrency/thread_name.h"
@@ -48,6 +49,9 @@ namespace {
 // Counter used to assign unique names to otherwise-unnamed thread pools.
 AtomicWord<int> nextUnnamedThreadPoolId{1};
 
+// Number of times an idle worker of a work-stealing pool looks for tasks before going to sleep.
+constexpr size_t kIdleWorkerSpins = 100;
+
 /**
  * Sets defaults and checks bounds limits on "options", and returns it.
  *
@@ -71,11 +75,18 @@ ThreadPool::Options cleanUpOptions(ThreadPool::Options&& options) {
                  << options.maxThreads;
         fassertFailed(28686);
     }
+    if (options.workStealing && options.maxThreads == ThreadPool::Options::kUnlimited) {
+        severe() << "Tried to create work-stealing pool " << options.poolName
+                 << " without a maximum number of threads";
+        fassertFailed(4614400);
+    }
     return {std::move(options)};
 }
 
 }  // namespace
 
+thread_local ThreadPool::Worker* ThreadPool::_currentWorker = nullptr;
+
 ThreadPool::ThreadPool(Options options) : _options(cleanUpOptions(std::move(options))) {}
 
 ThreadPool::~ThreadPool() {
@@ -91,6 +102,7 @@ ThreadPool::~ThreadPool() {
     }
     invariant(_threads.empty());
     invariant(_pendingTasks.empty());
+    invariant(_numQueuedTasks.load() == 0);
 }
 
 void ThreadPool::startup() {
@@ -102,6 +114,15 @@ void ThreadPool::startup() {
     }
     _setState_inlock(running);
     invariant(_threads.empty());
+    if (_options.workStealing) {
+        for (size_t i = 0; i < _options.maxThreads; ++i) {
+            _workers.emplace_back(std::make_unique<Worker>(this, i));
+        }
+        for (size_t i = 0; i < _options.maxThreads; ++i) {
+            _startWorkerThread_inlock();
+        }
+        return;
+    }
     const size_t numToStart =
         std::min(_options.maxThreads, std::max(_options.minThreads, _pendingTasks.size()));
     for (size_t i = 0; i < numToStart; ++i) {
@@ -120,6 +141,11 @@ void ThreadPool::_shutdown_inlock() {
         case running:
             _setState_inlock(joinRequired);
             _workAvailable.notify_all();
+            if (_options.workStealing) {
+                _acceptingTasks.store(false);
+                stdx::lock_guard<stdx::mutex> parkLk(_parkMutex);
+                _workerWake.notify_all();
+            }
             return;
         case joinRequired:
         case joining:
@@ -151,6 +177,27 @@ void ThreadPool::_join_inlock(stdx::unique_lock<stdx::mutex>* lk) {
         MONGO_UNREACHABLE;
     });
     _setState_inlock(joining);
+    if (_options.workStealing) {
+        // The workers run all the tasks they can find before exiting. Tasks can still be added by
+        // schedule() calls which began before shutdown, so wait for those before running the
+        // leftover tasks.
+        ThreadList threadsToJoin;
+        swap(threadsToJoin, _threads);
+        lk->unlock();
+        for (auto& t : threadsToJoin) {
+            t.join();
+        }
+        while (_numSchedulingThreads.load() > 0) {
+            stdx::this_thread::yield();
+        }
+        if (_numQueuedTasks.load() > 0) {
+            _drainPendingTasks();
+        }
+        lk->lock();
+        invariant(_state == joining);
+        _setState_inlock(shutdownComplete);
+        return;
+    }
     ++_numIdleThreads;
     if (!_pendingTasks.empty()) {
         lk->unlock();
@@ -177,6 +224,23 @@ void ThreadPool::_drainPendingTasks() {
             << _options.threadNamePrefix << _nextThreadId++;
         setThreadName(threadName);
         _options.onCreateThread(threadName);
+        if (_options.workStealing) {
+            // No worker threads are left, and any task scheduled from here on is rejected.
+            if (_workers.empty()) {
+                // A pool which was never started has no workers to queue its tasks on.
+                Worker worker(this, 0);
+                while (auto task = _findTask(&worker)) {
+                    _runTask(std::move(task));
+                }
+                return;
+            }
+            for (auto& worker : _workers) {
+                while (auto task = _findTask(worker.get())) {
+                    _runTask(std::move(task));
+                }
+            }
+            return;
+        }
         stdx::unique_lock<stdx::mutex> lock(_mutex);
         while (!_pendingTasks.empty()) {
             _doOneTask(&lock);
@@ -186,6 +250,11 @@ void ThreadPool::_drainPendingTasks() {
 }
 
 void ThreadPool::schedule(Task task) {
+    if (_options.workStealing) {
+        _scheduleWorkStealing(std::move(task));
+        return;
+    }
+
     stdx::unique_lock<stdx::mutex> lk(_mutex);
 
     switch (_state) {
@@ -222,6 +291,16 @@ void ThreadPool::schedule(Task task) {
 
 void ThreadPool::waitForIdle() {
     stdx::unique_lock<stdx::mutex> lk(_mutex);
+    if (_options.workStealing) {
+        // Tasks are counted as running before they stop being counted as queued, so check the
+        // queued tasks first.
+        _numIdleWaiters.addAndFetch(1);
+        _poolIsIdle.wait(lk, [this] {
+            return _numQueuedTasks.load() == 0 && _numRunningTasks.load() == 0;
+        });
+        _numIdleWaiters.subtractAndFetch(1);
+        return;
+    }
     // If there are any pending tasks, or non-idle threads, the pool is not idle.
     while (!_pendingTasks.empty() || _numIdleThreads < _threads.size()) {
         _poolIsIdle.wait(lk);
@@ -233,18 +312,31 @@ ThreadPool::Stats ThreadPool::getStats() const {
     Stats result;
     result.options = _options;
     result.numThreads = _threads.size();
+    if (_options.workStealing) {
+        const auto numRunningTasks = _numRunningTasks.load();
+        result.numIdleThreads =
+            result.numThreads > numRunningTasks ? result.numThreads - numRunningTasks : 0;
+        result.numPendingTasks = _numQueuedTasks.load();
+        return result;
+    }
     result.numIdleThreads = _numIdleThreads;
     result.numPendingTasks = _pendingTasks.size();
     result.lastFullUtilizationDate = _lastFullUtilizationDate;
     return result;
 }
 
-void ThreadPool::_workerThreadBody(ThreadPool* pool, const std::string& threadName) {
+void ThreadPool::_workerThreadBody(ThreadPool* pool,
+                                   const std::string& threadName,
+                                   Worker* worker) {
     setThreadName(threadName);
     pool->_options.onCreateThread(threadName);
     const auto poolName = pool->_options.poolName;
     LOG(1) << "starting thread in pool " << poolName;
-    pool->_consumeTasks();
+    if (worker) {
+        pool->_consumeTasksWorkStealing(worker);
+    } else {
+        pool->_consumeTasks();
+    }
 
     // At this point, another thread may have destroyed "pool", if this thread chose to detach
     // itself and remove itself from pool->_threads before releasing pool->_mutex.  Do not access
@@ -370,8 +462,10 @@ void ThreadPool::_startWorkerThread_inlock() {
     }
     invariant(_threads.size() < _options.maxThreads);
     const std::string threadName = str::stream() << _options.threadNamePrefix << _nextThreadId++;
+    Worker* worker = _options.workStealing ? _workers[_threads.size()].get() : nullptr;
     try {
-        _threads.emplace_back([this, threadName] { _workerThreadBody(this, threadName); });
+        _threads.emplace_back(
+            [this, threadName, worker] { _workerThreadBody(this, threadName, worker); });
         ++_numIdleThreads;
     } catch (const std::exception& ex) {
         error() << "Failed to start " << threadName << "; " << _threads.size()
@@ -380,6 +474,207 @@ void ThreadPool::_startWorkerThread_inlock() {
     }
 }
 
+void ThreadPool::_scheduleWorkStealing(Task task) {
+    // join() waits for the workers to exit before running leftover tasks, so only schedule() calls
+    // from outside of the pool need to be tracked.
+    auto worker = _currentWorker;
+    const bool fromWorker = worker && worker->pool == this;
+    if (!fromWorker) {
+        _numSchedulingThreads.addAndFetch(1);
+    }
+    if (!_acceptingTasks.load()) {
+        // The pool may be destroyed as soon as this thread stops counting as scheduling, so build
+        // the status before that, and run the task after.
+        Status status(ErrorCodes::ShutdownInProgress,
+                      str::stream() << "Shutdown of thread pool " << _options.poolName
+                                    << " in progress");
+        if (!fromWorker) {
+            _numSchedulingThreads.subtractAndFetch(1);
+        }
+        task(std::move(status));
+        return;
+    }
+
+    // The task is counted before it is queued, so that a worker which sees no queued tasks can
+    // safely go to sleep.
+    _numQueuedTasks.addAndFetch(1);
+    if (fromWorker) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(worker->mutex);
+            worker->tasks.emplace_back(std::move(task));
+            worker->numTasks.addAndFetch(1);
+        }
+        _wakeWorkerIfNeeded();
+        return;
+    }
+
+    auto injected = new InjectedTask{std::move(task), _injectedTasks.load()};
+    while (!_injectedTasks.compareAndSwap(&injected->next, injected)) {
+    }
+    _wakeWorkerIfNeeded();
+
+    // Once this is decremented, the pool may be joined and destroyed.
+    _numSchedulingThreads.subtractAndFetch(1);
+}
+
+ThreadPool::Task ThreadPool::_findTask(Worker* worker) {
+    auto task = [&]() -> Task {
+        if (worker->numTasks.load() > 0) {
+            stdx::lock_guard<stdx::mutex> lk(worker->mutex);
+            if (!worker->tasks.empty()) {
+                Task task = std::move(worker->tasks.front());
+                worker->tasks.pop_front();
+                worker->numTasks.subtractAndFetch(1);
+                return task;
+            }
+        }
+
+        if (auto task = _takeInjectedTasks(worker)) {
+            return task;
+        }
+
+        // Steal the newer half of another worker's tasks, so that this worker doesn't come back to
+        // steal again for every task.
+        const auto numWorkers = _workers.size();
+        for (size_t i = 1; i < numWorkers; ++i) {
+            auto victim = _workers[(worker->index + i) % numWorkers].get();
+            if (victim->numTasks.load() == 0) {
+                continue;
+            }
+            TaskList stolen;
+            {
+                stdx::lock_guard<stdx::mutex> lk(victim->mutex);
+                const auto numToSteal = (victim->tasks.size() + 1) / 2;
+                for (size_t j = 0; j < numToSteal; ++j) {
+                    stolen.emplace_front(std::move(victim->tasks.back()));
+                    victim->tasks.pop_back();
+                }
+                victim->numTasks.subtractAndFetch(numToSteal);
+            }
+            if (stolen.empty()) {
+                continue;
+            }
+            Task task = std::move(stolen.front());
+            stolen.pop_front();
+            if (!stolen.empty()) {
+                stdx::lock_guard<stdx::mutex> lk(worker->mutex);
+                worker->numTasks.addAndFetch(stolen.size());
+                std::move(stolen.begin(), stolen.end(), std::back_inserter(worker->tasks));
+            }
+            return task;
+        }
+        return Task();
+    }();
+
+    if (task) {
+        _numRunningTasks.addAndFetch(1);
+        _numQueuedTasks.subtractAndFetch(1);
+    }
+    return task;
+}
+
+ThreadPool::Task ThreadPool::_takeInjectedTasks(Worker* worker) {
+    if (!_injectedTasks.load()) {
+        return Task();
+    }
+    auto newest = _injectedTasks.swap(nullptr);
+    if (!newest) {
+        return Task();
+    }
+
+    // Reverse the list, so that the tasks start in the order in which they were scheduled.
+    InjectedTask* oldest = nullptr;
+    while (newest) {
+        auto next = newest->next;
+        newest->next = oldest;
+        oldest = newest;
+        newest = next;
+    }
+
+    std::unique_ptr<InjectedTask> first(oldest);
+    if (auto rest = first->next) {
+        stdx::lock_guard<stdx::mutex> lk(worker->mutex);
+        size_t numTasks = 0;
+        while (rest) {
+            std::unique_ptr<InjectedTask> injected(rest);
+            rest = injected->next;
+            worker->tasks.emplace_back(std::move(injected->task));
+            ++numTasks;
+        }
+        worker->numTasks.addAndFetch(numTasks);
+    }
+    return std::move(first->task);
+}
+
+ThreadPool::Task ThreadPool::_waitForTask(Worker* worker) {
+    if (auto task = _findTask(worker)) {
+        return task;
+    }
+
+    // At most about half of the workers spin at once, so that spinning workers don't take too much
+    // CPU time away from the ones running tasks. The others go to sleep right away.
+    const auto numSpinningWorkers = _numSpinningWorkers.addAndFetch(1);
+    for (size_t spins = 2 * numSpinningWorkers > _workers.size() + 1 ? kIdleWorkerSpins : 0;;
+         ++spins) {
+        if (auto task = _findTask(worker)) {
+            _numSpinningWorkers.subtractAndFetch(1);
+            // Other workers may be asleep because this one was going to pick up the remaining
+            // tasks.
+            if (_numQueuedTasks.load() > 0) {
+                _wakeWorkerIfNeeded();
+            }
+            return task;
+        }
+        if (!_acceptingTasks.load()) {
+            _numSpinningWorkers.subtractAndFetch(1);
+            return Task();
+        }
+        if (spins < kIdleWorkerSpins) {
+            MONGO_YIELD_CORE_FOR_SMT();
+            continue;
+        }
+
+        // Counting this worker as parked before it stops counting as spinning, and before checking
+        // for queued tasks, ensures that either it sees a task which schedule() added, or
+        // schedule() sees it parked and wakes it up.
+        stdx::unique_lock<stdx::mutex> lk(_parkMutex);
+        _numParkedWorkers.addAndFetch(1);
+        _numSpinningWorkers.subtractAndFetch(1);
+        if (_numQueuedTasks.load() == 0 && _acceptingTasks.load()) {
+            MONGO_IDLE_THREAD_BLOCK;
+            _workerWake.wait(lk);
+        }
+        _numParkedWorkers.subtractAndFetch(1);
+        _numSpinningWorkers.addAndFetch(1);
+        spins = 0;
+    }
+}
+
+void ThreadPool::_wakeWorkerIfNeeded() {
+    if (_numSpinningWorkers.load() > 0 || _numParkedWorkers.load() == 0) {
+        return;
+    }
+    stdx::lock_guard<stdx::mutex> lk(_parkMutex);
+    _workerWake.notify_one();
+}
+
+void ThreadPool::_runTask(Task task) noexcept {
+    task(Status::OK());
+    if (_numRunningTasks.subtractAndFetch(1) == 0 && _numQueuedTasks.load() == 0 &&
+        _numIdleWaiters.load() > 0) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _poolIsIdle.notify_all();
+    }
+}
+
+void ThreadPool::_consumeTasksWorkStealing(Worker* worker) {
+    _currentWorker = worker;
+    while (auto task = _waitForTask(worker)) {
+        _runTask(std::move(task));
+    }
+    _currentWorker = nullptr;
+}
+
 void ThreadPool::_setState_inlock(const LifecycleState newState) {
     if (newState == _state) {
         return;
@@ -31,9 +31,11 @@
 
 #include <deque>
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/stdx/thread.h"
@@ -91,6 +93,16 @@ public:
         // This function is run before each worker thread begins consuming tasks.
         using OnCreateThreadFn = std::function<void(const std::string& threadName)>;
         OnCreateThreadFn onCreateThread = [](const std::string&) {};
+
+        // If true, each worker thread keeps its own queue of tasks, and idle workers steal tasks
+        // from the queues of busy ones, instead of all workers sharing one queue guarded by the
+        // pool's mutex. Tasks scheduled by threads outside the pool are handed to the workers
+        // through a lock-free list, and idle workers spin for a short while before going to sleep.
+        //
+        // A work-stealing pool starts maxThreads threads at startup and never reaps them, so
+        // minThreads and maxIdleThreadAge are ignored and maxThreads may not be kUnlimited. Tasks
+        // are not guaranteed to start in the order in which they were scheduled.
+        bool workStealing = false;
     };
 
     /**
@@ -109,7 +121,8 @@ public:
         // The number of tasks waiting to be executed by the pool.
         size_t numPendingTasks;
 
-        // The last time that no threads in the pool were idle.
+        // The last time that no threads in the pool were idle. Not maintained by work-stealing
+        // pools.
         Date_t lastFullUtilizationDate;
     };
 
@@ -146,6 +159,35 @@ private:
     using TaskList = std::deque<Task>;
     using ThreadList = std::vector<stdx::thread>;
 
+    /**
+     * A task scheduled on a work-stealing pool by a thread which is not one of its workers. These
+     * form a singly linked list, newest first, rooted at _injectedTasks.
+     */
+    struct InjectedTask {
+        Task task;
+        InjectedTask* next;
+    };
+
+    /**
+     * State of one worker thread of a work-stealing pool.
+     */
+    struct Worker {
+        Worker(ThreadPool* pool, size_t index) : pool(pool), index(index) {}
+
+        ThreadPool* const pool;
+        const size_t index;
+
+        // Guards "tasks". The worker runs tasks from the front of its queue, while other workers
+        // steal from the back.
+        stdx::mutex mutex;
+        TaskList tasks;
+
+        // The size of "tasks", which may be read without holding "mutex".
+        AtomicWord<size_t> numTasks{0};
+    };
+
+    using WorkerList = std::vector<std::unique_ptr<Worker>>;
+
     /**
      * Representation of the stage of life of a thread pool.
      *
@@ -168,7 +210,7 @@ private:
      * As such, it is advisable to pass the pool pointer as an explicit argument, rather
      * than as the implicit "this" argument.
      */
-    static void _workerThreadBody(ThreadPool* pool, const std::string& threadName);
+    static void _workerThreadBody(ThreadPool* pool, const std::string& threadName, Worker* worker);
 
     /**
      * Starts a worker thread, unless _options.maxThreads threads are already running or
@@ -181,6 +223,48 @@ private:
      */
     void _consumeTasks();
 
+    /**
+     * This is the run loop of a worker thread of a work-stealing pool, invoked by
+     * _workerThreadBody.
+     */
+    void _consumeTasksWorkStealing(Worker* worker);
+
+    /**
+     * Implementation of schedule for work-stealing pools. Does not take _mutex.
+     */
+    void _scheduleWorkStealing(Task task);
+
+    /**
+     * Returns the next task for "worker" to run, taking it from, in order of preference, the
+     * worker's own queue, the tasks scheduled from outside the pool, or another worker's queue.
+     * Returns an empty task if there is none.
+     */
+    Task _findTask(Worker* worker);
+
+    /**
+     * Takes all tasks scheduled from outside the pool, returns the oldest of them and queues the
+     * rest on "worker". Returns an empty task if there is none.
+     */
+    Task _takeInjectedTasks(Worker* worker);
+
+    /**
+     * Spins, and then sleeps, until a task is available for "worker" and returns it. Returns an
+     * empty task once the pool is shutting down and no tasks are left.
+     */
+    Task _waitForTask(Worker* worker);
+
+    /**
+     * Wakes up a sleeping worker of a work-stealing pool, unless some worker is already looking
+     * for tasks.
+     */
+    void _wakeWorkerIfNeeded();
+
+    /**
+     * Runs a task which _findTask returned, and notifies waitForIdle callers if the pool became
+     * idle.
+     */
+    void _runTask(Task task) noexcept;
+
     /**
      * Implementation of shutdown once _mutex is locked.
      */
@@ -245,6 +329,41 @@ private:
 
     // The last time that _pendingTasks.size() grew to be at least _threads.size().
     Date_t _lastFullUtilizationDate;
+
+    //
+    // The members below are only used by work-stealing pools, and are not guarded by _mutex.
+    //
+
+    // The worker thread of a work-stealing pool which is running on this thread, if any.
+    static thread_local Worker* _currentWorker;
+
+    // One entry per worker thread. Filled in by startup(), and not modified afterwards.
+    WorkerList _workers;
+
+    // Tasks scheduled by threads outside of the pool, newest first.
+    AtomicWord<InjectedTask*> _injectedTasks{nullptr};
+
+    // False once shutdown() has been called; schedule() then rejects new tasks.
+    AtomicWord<bool> _acceptingTasks{true};
+
+    // Number of schedule() calls which are adding a task. join() waits for these to finish before
+    // running the tasks which are left over.
+    AtomicWord<size_t> _numSchedulingThreads{0};
+
+    // Number of tasks which are queued, and number of tasks which are being run.
+    AtomicWord<size_t> _numQueuedTasks{0};
+    AtomicWord<size_t> _numRunningTasks{0};
+
+    // Number of workers which are looking for tasks, and number of workers which are asleep.
+    AtomicWord<size_t> _numSpinningWorkers{0};
+    AtomicWord<size_t> _numParkedWorkers{0};
+
+    // Number of waitForIdle() callers waiting on _poolIsIdle.
+    AtomicWord<size_t> _numIdleWaiters{0};
+
+    // Guards sleeping and waking up workers, signaled through _workerWake.
+    stdx::mutex _parkMutex;
+    stdx::condition_variable _workerWake;
 };
 
 }  // namespace mongo
@@ -0,0 +1,113 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+namespace {
+
+// Number of tasks run per benchmark iteration.
+constexpr int64_t kTasksPerIteration = 10000;
+
+std::unique_ptr<ThreadPool> makePool(benchmark::State& state) {
+    ThreadPool::Options options;
+    options.poolName = "ThreadPoolBM";
+    options.workStealing = state.range(0);
+    options.minThreads = options.maxThreads = state.range(1);
+    auto pool = std::make_unique<ThreadPool>(std::move(options));
+    pool->startup();
+    return pool;
+}
+
+/**
+ * Schedules short tasks from a thread outside of the pool, as the oplog applier does with its
+ * writer pool, and waits for them to finish.
+ */
+void BM_ScheduleFromOutside(benchmark::State& state) {
+    auto pool = makePool(state);
+    AtomicWord<int64_t> counter;
+
+    for (auto keepRunning : state) {
+        for (int64_t i = 0; i < kTasksPerIteration; ++i) {
+            pool->schedule([&](auto status) { counter.fetchAndAdd(1); });
+        }
+        pool->waitForIdle();
+    }
+
+    pool->shutdown();
+    pool->join();
+    state.SetItemsProcessed(state.iterations() * kTasksPerIteration);
+}
+
+/**
+ * Schedules one task per worker from outside of the pool, each of which schedules an equal share
+ * of short tasks from inside the pool, and waits for them all to finish.
+ */
+void BM_ScheduleFromWorkers(benchmark::State& state) {
+    auto pool = makePool(state);
+    const int64_t numWorkers = state.range(1);
+    const int64_t tasksPerWorker = kTasksPerIteration / numWorkers;
+    AtomicWord<int64_t> counter;
+
+    for (auto keepRunning : state) {
+        for (int64_t i = 0; i < numWorkers; ++i) {
+            pool->schedule([&](auto status) {
+                for (int64_t j = 0; j < tasksPerWorker; ++j) {
+                    pool->schedule([&](auto status) { counter.fetchAndAdd(1); });
+                }
+            });
+        }
+        pool->waitForIdle();
+    }
+
+    pool->shutdown();
+    pool->join();
+    state.SetItemsProcessed(state.iterations() * numWorkers * tasksPerWorker);
+}
+
+void poolArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"workStealing", "threads"});
+    for (int workStealing : {0, 1}) {
+        for (int threads : {1, 4, 16, 64}) {
+            b->Args({workStealing, threads});
+        }
+    }
+}
+
+BENCHMARK(BM_ScheduleFromOutside)->Apply(poolArgs)->UseRealTime();
+BENCHMARK(BM_ScheduleFromWorkers)->Apply(poolArgs)->UseRealTime();
+
+}  // namespace
+}  // namespace mongo
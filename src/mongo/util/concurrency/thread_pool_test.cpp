@@ -32,6 +32,7 @@
 #include "mongo/platform/basic.h"
 
 #include <boost/optional.hpp>
+#include <vector>
 
 #include "mongo/base/init.h"
 #include "mongo/stdx/condition_variable.h"
@@ -53,6 +54,11 @@ using namespace mongo;
 MONGO_INITIALIZER(ThreadPoolCommonTests)(InitializerContext*) {
     addTestsForThreadPool("ThreadPoolCommon",
                           []() { return std::make_unique<ThreadPool>(ThreadPool::Options()); });
+    addTestsForThreadPool("ThreadPoolWorkStealingCommon", []() {
+        ThreadPool::Options options;
+        options.workStealing = true;
+        return std::make_unique<ThreadPool>(options);
+    });
     return Status::OK();
 }
 
@@ -202,6 +208,15 @@ DEATH_TEST(ThreadPoolTest,
     ThreadPool pool(options);
 }
 
+DEATH_TEST(ThreadPoolTest,
+           WorkStealingUnlimitedThreadsDies,
+           "without a maximum number of threads") {
+    ThreadPool::Options options;
+    options.workStealing = true;
+    options.maxThreads = ThreadPool::Options::kUnlimited;
+    ThreadPool pool(options);
+}
+
 TEST(ThreadPoolTest, LivePoolCleanedByDestructor) {
     ThreadPool pool((ThreadPool::Options()));
     pool.startup();
@@ -279,4 +294,72 @@ TEST_F(ThreadPoolTest, ThreadPoolRunsOnCreateThreadFunctionBeforeConsumingTasks)
     ASSERT_EQUALS(options.threadNamePrefix + "0", taskThreadName);
 }
 
+TEST_F(ThreadPoolTest, WorkStealingPoolStartsMaxThreads) {
+    ThreadPool::Options options;
+    options.workStealing = true;
+    options.minThreads = 1;
+    options.maxThreads = 4;
+    auto& pool = makePool(options);
+    pool.startup();
+    auto stats = pool.getStats();
+    ASSERT_EQ(4U, stats.numThreads);
+    ASSERT_EQ(4U, stats.numIdleThreads);
+    ASSERT_EQ(0U, stats.numPendingTasks);
+}
+
+TEST_F(ThreadPoolTest, WorkStealingPoolRunsTasksOfBlockedWorker) {
+    ThreadPool::Options options;
+    options.workStealing = true;
+    options.maxThreads = 2;
+    auto& pool = makePool(options);
+    pool.startup();
+
+    // The first task blocks its worker after queueing more tasks on that worker, which the other
+    // worker has to steal.
+    const size_t kNumStolenTasks = 10;
+    size_t numStolenTasksRun = 0;
+    stdx::condition_variable stolenTasksRun;
+    pool.schedule([&](auto status) {
+        ASSERT_OK(status);
+        for (size_t i = 0; i < kNumStolenTasks; ++i) {
+            pool.schedule([&](auto status) {
+                ASSERT_OK(status);
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                if (++numStolenTasksRun == kNumStolenTasks) {
+                    stolenTasksRun.notify_all();
+                }
+            });
+        }
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        stolenTasksRun.wait(lk, [&] { return numStolenTasksRun == kNumStolenTasks; });
+    });
+    pool.waitForIdle();
+    ASSERT_EQ(kNumStolenTasks, numStolenTasksRun);
+
+    auto stats = pool.getStats();
+    ASSERT_EQ(2U, stats.numIdleThreads);
+    ASSERT_EQ(0U, stats.numPendingTasks);
+}
+
+TEST_F(ThreadPoolTest, WorkStealingPoolDrainsTasksOfUnstartedPoolInOrder) {
+    ThreadPool::Options options;
+    options.workStealing = true;
+    options.maxThreads = 2;
+    auto& pool = makePool(options);
+
+    std::vector<int> order;
+    for (int i = 0; i < 5; ++i) {
+        pool.schedule([&order, i](auto status) {
+            ASSERT_OK(status);
+            order.push_back(i);
+        });
+    }
+    pool.shutdown();
+    pool.join();
+    ASSERT_EQ(5U, order.size());
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_EQ(i, order[i]);
+    }
+}
+
 }  // namespace
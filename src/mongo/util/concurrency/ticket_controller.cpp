@@ -0,0 +1,113 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/ticket_controller.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+StringData TicketController::reasonToString(Reason reason) {
+    switch (reason) {
+        case Reason::kNoThroughput:
+            return "noThroughput"_sd;
+        case Reason::kNotQueueing:
+            return "notQueueing"_sd;
+        case Reason::kImproved:
+            return "improved"_sd;
+        case Reason::kWorsened:
+            return "worsened"_sd;
+        case Reason::kCachePressure:
+            return "cachePressure"_sd;
+    }
+    MONGO_UNREACHABLE;
+}
+
+int TicketController::update(int currentTickets, const Sample& sample) {
+    const double intervalSecs = durationCount<Microseconds>(sample.interval) / 1'000'000.0;
+    if (sample.numReleased <= 0 || intervalSecs <= 0) {
+        _lastPower = 0;
+        _lastThroughput = 0;
+        _lastLatency = Microseconds{0};
+        _lastReason = Reason::kNoThroughput;
+        return currentTickets;
+    }
+
+    // By Little's law, the average number of operations holding a ticket is the rate at which they
+    // finish times the average time each one holds its ticket.
+    const double throughput = sample.numReleased / intervalSecs;
+    const double latencySecs = std::max(sample.averageUsed, 1.0) / throughput;
+    const double power = throughput / latencySecs;
+    _lastThroughput = throughput;
+    _lastLatency = Microseconds{static_cast<long long>(latencySecs * 1'000'000)};
+
+    const int step = std::max(1, static_cast<int>(currentTickets * _options.stepFraction));
+    int newTickets = currentTickets;
+    if (sample.cachePressure) {
+        _lastReason = Reason::kCachePressure;
+        _growing = false;
+        newTickets = currentTickets - step;
+    } else if (sample.numWaited <= 0) {
+        // Once operations queue again, start by trying more tickets.
+        _lastReason = Reason::kNotQueueing;
+        _growing = true;
+    } else {
+        if (_lastPower > 0 && power < _lastPower) {
+            _lastReason = Reason::kWorsened;
+            _growing = !_growing;
+        } else {
+            _lastReason = Reason::kImproved;
+        }
+        newTickets = _growing ? currentTickets + step : currentTickets - step;
+    }
+    _lastPower = power;
+
+    newTickets = std::max(_options.minTickets, std::min(_options.maxTickets, newTickets));
+    if (newTickets > currentTickets) {
+        ++_numIncreases;
+    } else if (newTickets < currentTickets) {
+        ++_numDecreases;
+    }
+    return newTickets;
+}
+
+void TicketController::appendStats(BSONObjBuilder* builder) const {
+    builder->append("throughput", _lastThroughput);
+    builder->append("latencyMicros", durationCount<Microseconds>(_lastLatency));
+    builder->append("lastReason", reasonToString(_lastReason));
+    builder->append("increases", _numIncreases);
+    builder->append("decreases", _numDecreases);
+}
+
+}  // namespace mongo
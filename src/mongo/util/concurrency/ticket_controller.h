@@ -0,0 +1,131 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/string_data.h"
+#include "mongo/util/duration.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+/**
+ * Decides how many tickets a TicketHolder should hand out, from periodic samples of the load on
+ * it. Too few tickets leave CPUs idle while operations queue for tickets, while too many make
+ * operations compete for CPU and storage engine cache without finishing any faster.
+ *
+ * While operations are queueing for tickets, the controller looks for the number of tickets which
+ * maximizes throughput divided by latency, by moving the number of tickets in steps and reversing
+ * direction whenever a step made that ratio worse. Latency is derived from throughput and the
+ * average number of tickets in use, using Little's law. When the storage engine reports cache
+ * pressure the controller shrinks the pool regardless, and while nobody queues for tickets it
+ * leaves the pool as it is.
+ *
+ * The controller only makes decisions; the caller samples the TicketHolder and resizes it. Not
+ * thread-safe.
+ */
+class TicketController {
+public:
+    struct Options {
+        // Bounds on the number of tickets the controller chooses.
+        int minTickets = 16;
+        int maxTickets = 512;
+
+        // Each adjustment changes the number of tickets by this fraction, and by at least one.
+        double stepFraction = 0.1;
+    };
+
+    /**
+     * The load on a TicketHolder over one sampling interval.
+     */
+    struct Sample {
+        // Length of the interval.
+        Milliseconds interval;
+
+        // Number of tickets released, and so of operations which finished, during the interval.
+        long long numReleased = 0;
+
+        // Number of times an operation had to wait for a ticket during the interval.
+        long long numWaited = 0;
+
+        // Average number of tickets in use during the interval.
+        double averageUsed = 0;
+
+        // Whether the storage engine was short of cache during the interval.
+        bool cachePressure = false;
+    };
+
+    enum class Reason {
+        // No operation finished during the interval, so there is nothing to go by.
+        kNoThroughput,
+        // No operation waited for a ticket, so the number of tickets doesn't limit anything.
+        kNotQueueing,
+        // Operations queued for tickets, and the last step improved throughput over latency.
+        kImproved,
+        // Operations queued for tickets, and the last step made throughput over latency worse.
+        kWorsened,
+        // The storage engine was short of cache.
+        kCachePressure,
+    };
+
+    static StringData reasonToString(Reason reason);
+
+    explicit TicketController(Options options) : _options(std::move(options)) {}
+
+    /**
+     * Returns the number of tickets to use for the next interval, given the number of tickets used
+     * during the interval described by "sample".
+     */
+    int update(int currentTickets, const Sample& sample);
+
+    /**
+     * Appends the controller's latest measurements and decision, and its number of adjustments.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
+private:
+    const Options _options;
+
+    // Whether the next step while operations are queueing grows the pool.
+    bool _growing = true;
+
+    // Throughput divided by latency during the previous interval, or 0 if it wasn't measured.
+    double _lastPower = 0;
+
+    // Measurements and decision from the latest interval.
+    double _lastThroughput = 0;
+    Microseconds _lastLatency{0};
+    Reason _lastReason = Reason::kNoThroughput;
+
+    long long _numIncreases = 0;
+    long long _numDecreases = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,175 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/ticket_controller.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * A deterministic model of a server, on which every operation needs "serviceTime" on one of
+ * "numCores" CPUs. Running more operations than there are CPUs makes each one take longer, and
+ * running more than "cacheLimit" at once makes them evict each other's data from the cache, which
+ * slows them down further.
+ */
+struct SimulatedServer {
+    int numCores = 32;
+    int cacheLimit = std::numeric_limits<int>::max();
+    Milliseconds serviceTime{1};
+
+    // Number of clients which want to run an operation at any time.
+    int demand = 1000;
+
+    TicketController::Sample run(int tickets, Milliseconds interval) const {
+        const int running = std::min(tickets, demand);
+        double latency = durationCount<Milliseconds>(serviceTime) *
+            std::max(1.0, static_cast<double>(running) / numCores);
+        const bool cachePressure = running > cacheLimit;
+        if (cachePressure) {
+            latency *= 1.0 + static_cast<double>(running - cacheLimit) / cacheLimit;
+        }
+
+        TicketController::Sample sample;
+        sample.interval = interval;
+        sample.numReleased =
+            static_cast<long long>(running * durationCount<Milliseconds>(interval) / latency);
+        sample.numWaited = std::max(0, demand - tickets);
+        sample.averageUsed = running;
+        sample.cachePressure = cachePressure;
+        return sample;
+    }
+};
+
+/**
+ * Runs "controller" against "server" for "numIntervals" intervals, starting with "tickets"
+ * tickets, and returns the number of tickets chosen after each interval.
+ */
+std::vector<int> simulate(TicketController& controller,
+                          const SimulatedServer& server,
+                          int tickets,
+                          int numIntervals) {
+    std::vector<int> history;
+    for (int i = 0; i < numIntervals; ++i) {
+        tickets = controller.update(tickets, server.run(tickets, Seconds{1}));
+        history.push_back(tickets);
+    }
+    return history;
+}
+
+/**
+ * Asserts that over the last "numIntervals" entries of "history", the number of tickets stayed
+ * within [min, max].
+ */
+void assertSettledWithin(const std::vector<int>& history, int numIntervals, int min, int max) {
+    ASSERT_GTE(history.size(), static_cast<size_t>(numIntervals));
+    for (auto it = history.end() - numIntervals; it != history.end(); ++it) {
+        ASSERT_GTE(*it, min);
+        ASSERT_LTE(*it, max);
+    }
+}
+
+TEST(TicketControllerTest, ShrinksToNumberOfCores) {
+    TicketController controller({});
+    SimulatedServer server;
+    server.numCores = 32;
+    auto history = simulate(controller, server, 128, 100);
+    assertSettledWithin(history, 20, 26, 40);
+}
+
+TEST(TicketControllerTest, GrowsToNumberOfCores) {
+    TicketController controller({});
+    SimulatedServer server;
+    server.numCores = 256;
+    auto history = simulate(controller, server, 16, 100);
+    assertSettledWithin(history, 20, 205, 320);
+}
+
+TEST(TicketControllerTest, StaysBelowCacheLimit) {
+    TicketController controller({});
+    SimulatedServer server;
+    server.numCores = 256;
+    server.cacheLimit = 64;
+    auto history = simulate(controller, server, 128, 100);
+    assertSettledWithin(history, 20, 51, 71);
+
+    BSONObjBuilder builder;
+    controller.appendStats(&builder);
+    ASSERT_GT(builder.obj()["decreases"].numberLong(), 0);
+}
+
+TEST(TicketControllerTest, KeepsTicketsWhenNotQueueing) {
+    TicketController controller({});
+    SimulatedServer server;
+    server.demand = 10;
+    auto history = simulate(controller, server, 128, 10);
+    assertSettledWithin(history, 10, 128, 128);
+
+    BSONObjBuilder builder;
+    controller.appendStats(&builder);
+    ASSERT_EQ(builder.obj()["lastReason"].str(), "notQueueing");
+}
+
+TEST(TicketControllerTest, KeepsTicketsWithoutThroughput) {
+    TicketController controller({});
+    TicketController::Sample sample;
+    sample.interval = Seconds{1};
+    sample.numWaited = 100;
+    sample.averageUsed = 128;
+    ASSERT_EQ(128, controller.update(128, sample));
+}
+
+TEST(TicketControllerTest, StaysWithinBounds) {
+    TicketController::Options options;
+    options.minTickets = 20;
+    options.maxTickets = 100;
+    SimulatedServer server;
+
+    {
+        TicketController controller(options);
+        server.numCores = 4;
+        auto history = simulate(controller, server, 50, 100);
+        ASSERT_EQ(20, *std::min_element(history.begin(), history.end()));
+    }
+    {
+        TicketController controller(options);
+        server.numCores = 1000;
+        auto history = simulate(controller, server, 50, 100);
+        ASSERT_EQ(100, *std::max_element(history.begin(), history.end()));
+    }
+}
+
+}  // namespace
+}  // namespace mongo
@@ -93,6 +93,11 @@ void TicketHolder::waitForTicket(OperationContext* opCtx) {
 }
 
 bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
+    if (tryAcquire()) {
+        return true;
+    }
+    _numWaited.fetchAndAdd(1);
+
     const Milliseconds intervalMs(500);
     struct timespec ts;
 
@@ -125,6 +130,7 @@ bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
 
 void TicketHolder::release() {
     check(sem_post(&_sem));
+    _numReleased.fetchAndAdd(1);
 }
 
 Status TicketHolder::resize(int newSize) {
@@ -140,12 +146,17 @@ Status TicketHolder::resize(int newSize) {
                                     << "; given " << newSize);
 
     while (_outof.load() < newSize) {
-        release();
+        check(sem_post(&_sem));
         _outof.fetchAndAdd(1);
     }
 
+    // Takes the tickets directly rather than through waitForTicket(), since the resize is not an
+    // operation waiting for a ticket and must not be reported by numWaited().
     while (_outof.load() > newSize) {
-        waitForTicket();
+        while (0 != sem_wait(&_sem)) {
+            if (errno != EINTR)
+                failWithErrno(errno);
+        }
         _outof.subtractAndFetch(1);
     }
 
@@ -180,6 +191,10 @@ bool TicketHolder::tryAcquire() {
 
 void TicketHolder::waitForTicket(OperationContext* opCtx) {
     stdx::unique_lock<stdx::mutex> lk(_mutex);
+    if (_tryAcquire()) {
+        return;
+    }
+    _numWaited.fetchAndAdd(1);
 
     if (opCtx) {
         opCtx->waitForConditionOrInterrupt(_newTicket, lk, [this] { return _tryAcquire(); });
@@ -190,6 +205,10 @@ void TicketHolder::waitForTicket(OperationContext* opCtx) {
 
 bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
     stdx::unique_lock<stdx::mutex> lk(_mutex);
+    if (_tryAcquire()) {
+        return true;
+    }
+    _numWaited.fetchAndAdd(1);
 
     if (opCtx) {
         return opCtx->waitForConditionOrInterruptUntil(
@@ -206,6 +225,7 @@ void TicketHolder::release() {
         _num++;
     }
     _newTicket.notify_one();
+    _numReleased.fetchAndAdd(1);
 }
 
 Status TicketHolder::resize(int newSize) {
@@ -33,6 +33,7 @@
 #endif
 
 #include "mongo/db/operation_context.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/mutex.h"
@@ -81,7 +82,26 @@ public:
 
     int outof() const;
 
+    /**
+     * Returns the number of tickets released since this TicketHolder was created, which is the
+     * number of operations which finished using a ticket.
+     */
+    long long numReleased() const {
+        return _numReleased.load();
+    }
+
+    /**
+     * Returns the number of times a waitForTicket or waitForTicketUntil caller could not get a
+     * ticket right away and had to wait for one.
+     */
+    long long numWaited() const {
+        return _numWaited.load();
+    }
+
 private:
+    AtomicWord<long long> _numReleased;
+    AtomicWord<long long> _numWaited;
+
 #if defined(__linux__)
     mutable sem_t _sem;
 
@@ -32,6 +32,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/ticketholder.h"
 
@@ -72,4 +73,23 @@ TEST(TicketholderTest, BasicTimeout) {
     holder.release();
     ASSERT_EQ(holder.used(), 0);
 }
+
+#if defined(__linux__)
+// Only the semaphore-based implementation waits for tickets to be released when shrinking
+TEST(TicketholderTest, ShrinkingDoesNotCountAsWaiting) {
+    TicketHolder holder(6);
+    for (int i = 0; i < 6; ++i) {
+        ASSERT(holder.tryAcquire());
+    }
+
+    // The resize has to wait for a ticket to be released before it can remove it
+    stdx::thread resizer([&] { ASSERT_OK(holder.resize(5)); });
+    holder.release();
+    resizer.join();
+
+    ASSERT_EQ(holder.outof(), 5);
+    ASSERT_EQ(holder.used(), 5);
+    ASSERT_EQ(holder.numWaited(), 0);
+}
+#endif
 }  // namespace
@@ -132,8 +132,23 @@ public:
         return Decoration<T>(getRegistry()->template declareDecoration<T>());
     }
 
+    /**
+     * Returns the number of bytes needed to hold the decorations of each instance.
+     */
+    static size_t getDecorationBufferSizeBytes() {
+        return getRegistry()->getDecorationBufferSizeBytes();
+    }
+
 protected:
     Decorable() : _decorations(this, getRegistry()) {}
+
+    /**
+     * Places the decorations in "decorationBuffer" rather than allocating storage for them, unless
+     * it is null. See the DecorationContainer constructor for the requirements on the buffer.
+     */
+    explicit Decorable(unsigned char* decorationBuffer)
+        : _decorations(this, getRegistry(), decorationBuffer) {}
+
     ~Decorable() = default;
 
 private:
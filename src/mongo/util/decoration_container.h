@@ -96,15 +96,28 @@ public:
      */
     explicit DecorationContainer(Decorable<DecoratedType>* const decorated,
                                  const DecorationRegistry<DecoratedType>* const registry)
+        : DecorationContainer(decorated, registry, nullptr) {}
+
+    /**
+     * Like the above, but places the decorations in "buffer" rather than allocating storage for
+     * them, unless "buffer" is null. A non-null "buffer" must be aligned like memory returned by
+     * operator new, have room for registry->getDecorationBufferSizeBytes() bytes, and outlive the
+     * DecorationContainer.
+     */
+    DecorationContainer(Decorable<DecoratedType>* const decorated,
+                        const DecorationRegistry<DecoratedType>* const registry,
+                        unsigned char* const buffer)
         : _registry(registry),
-          _decorationData(new unsigned char[registry->getDecorationBufferSizeBytes()]) {
+          _ownedDecorationData(
+              buffer ? nullptr : new unsigned char[registry->getDecorationBufferSizeBytes()]),
+          _decorationData(buffer ? buffer : _ownedDecorationData.get()) {
         // Because the decorations live in the externally allocated storage buffer at
         // `_decorationData`, there needs to be a way to get back from a known location within this
         // buffer to the type which owns those decorations.  We place a pointer to ourselves, a
         // "back link" in the front of this storage buffer, as this is the easiest "well known
         // location" to compute.
         Decorable<DecoratedType>** const backLink =
-            reinterpret_cast<Decorable<DecoratedType>**>(_decorationData.get());
+            reinterpret_cast<Decorable<DecoratedType>**>(_decorationData);
         *backLink = decorated;
         _registry->construct(this);
     }
@@ -119,14 +132,14 @@ public:
      * The descriptor must be one returned from this DecorationContainer's associated _registry.
      */
     void* getDecoration(DecorationDescriptor descriptor) {
-        return _decorationData.get() + descriptor._index;
+        return _decorationData + descriptor._index;
     }
 
     /**
      * Same as the non-const form above, but returns a const result.
      */
     const void* getDecoration(DecorationDescriptor descriptor) const {
-        return _decorationData.get() + descriptor._index;
+        return _decorationData + descriptor._index;
     }
 
     /**
@@ -147,7 +160,8 @@ public:
 
 private:
     const DecorationRegistry<DecoratedType>* const _registry;
-    const std::unique_ptr<unsigned char[]> _decorationData;
+    const std::unique_ptr<unsigned char[]> _ownedDecorationData;
+    unsigned char* const _decorationData;
 };
 
 }  // namespace mongo
@@ -29,8 +29,11 @@
 
 #pragma once
 
+#include <cstddef>
 #include <functional>
+#include <new>
 #include <type_traits>
+#include <utility>
 
 #include "mongo/stdx/type_traits.h"
 #include "mongo/util/assert_util.h"
@@ -45,6 +48,9 @@ class unique_function;
  * it is incapable of being copied.  Often this happens with C++14 or later lambdas which capture a
  * `std::unique_ptr` by move.  The interface of `unique_function` is nearly identical to
  * `std::function`, except that it is not copyable.
+ *
+ * Small functors which can be moved without throwing are stored inline in the `unique_function`,
+ * so wrapping them doesn't allocate. Larger ones are stored on the heap.
  */
 template <typename RetType, typename... Args>
 class unique_function<RetType(Args...)> {
@@ -65,18 +71,29 @@ private:
 public:
     using result_type = RetType;
 
-    ~unique_function() noexcept = default;
+    ~unique_function() noexcept {
+        reset();
+    }
     unique_function() = default;
 
     unique_function(const unique_function&) = delete;
     unique_function& operator=(const unique_function&) = delete;
 
-    unique_function(unique_function&&) noexcept = default;
-    unique_function& operator=(unique_function&&) noexcept = default;
+    unique_function(unique_function&& that) noexcept {
+        takeFrom(that);
+    }
+    unique_function& operator=(unique_function&& that) noexcept {
+        if (this != &that) {
+            reset();
+            takeFrom(that);
+        }
+        return *this;
+    }
 
     void swap(unique_function& that) noexcept {
-        using std::swap;
-        swap(this->impl, that.impl);
+        unique_function tmp(std::move(that));
+        that = std::move(*this);
+        *this = std::move(tmp);
     }
 
     friend void swap(unique_function& a, unique_function& b) noexcept {
@@ -99,18 +116,25 @@ public:
             makeTag(),
         std::enable_if_t<std::is_move_constructible<Functor>::value, TagType> = makeTag(),
         std::enable_if_t<!std::is_same<std::decay_t<Functor>, unique_function>::value, TagType> =
-            makeTag())
-        : impl(makeImpl(std::forward<Functor>(functor))) {}
+            makeTag()) {
+        using Stored = std::decay_t<Functor>;
+        if constexpr (isStoredInline<Stored>()) {
+            new (&_storage) Stored(std::forward<Functor>(functor));
+        } else {
+            *reinterpret_cast<Stored**>(&_storage) = new Stored(std::forward<Functor>(functor));
+        }
+        _ops = &Manager<Stored>::kOps;
+    }
 
     unique_function(std::nullptr_t) noexcept {}
 
     RetType operator()(Args... args) const {
         invariant(static_cast<bool>(*this));
-        return impl->call(std::forward<Args>(args)...);
+        return _ops->call(&_storage, std::forward<Args>(args)...);
     }
 
     explicit operator bool() const noexcept {
-        return static_cast<bool>(this->impl);
+        return _ops != nullptr;
     }
 
     // Needed to make `std::is_convertible<mongo::unique_function<...>, std::function<...>>` be
@@ -132,9 +156,25 @@ private:
         return {};
     }
 
-    struct Impl {
-        virtual ~Impl() noexcept = default;
-        virtual RetType call(Args&&... args) = 0;
+    // Functors up to this size, which can be moved without throwing, are stored inline rather
+    // than on the heap. This is enough for continuations which capture a few pointers, which is
+    // the common case for callbacks attached to futures.
+    static constexpr std::size_t kInlineSize = 4 * sizeof(void*);
+    using Storage = std::aligned_storage_t<kInlineSize, alignof(void*)>;
+
+    template <typename Functor>
+    static constexpr bool isStoredInline() {
+        return sizeof(Functor) <= sizeof(Storage) && alignof(Functor) <= alignof(Storage) &&
+            std::is_nothrow_move_constructible<Functor>::value;
+    }
+
+    // The operations on a type-erased functor, which is either stored in `_storage` or pointed to
+    // by it.
+    struct Ops {
+        RetType (*call)(Storage* storage, Args&&... args);
+        // Moves the functor from one storage to another, leaving nothing to destroy in the source.
+        void (*relocate)(Storage* from, Storage* to) noexcept;
+        void (*destroy)(Storage* storage) noexcept;
     };
 
     // These overload helpers are needed to squelch problems in the `T ()` -> `void ()` case.
@@ -151,21 +191,57 @@ private:
     }
 
     template <typename Functor>
-    static auto makeImpl(Functor&& functor) {
-        struct SpecificImpl : Impl {
-            explicit SpecificImpl(Functor&& func) : f(std::forward<Functor>(func)) {}
+    struct Manager {
+        static Functor* get(Storage* storage) noexcept {
+            if constexpr (isStoredInline<Functor>()) {
+                return std::launder(reinterpret_cast<Functor*>(storage));
+            } else {
+                return *reinterpret_cast<Functor**>(storage);
+            }
+        }
+
+        static RetType call(Storage* storage, Args&&... args) {
+            return callRegularVoid(
+                std::is_void<RetType>(), *get(storage), std::forward<Args>(args)...);
+        }
+
+        static void relocate(Storage* from, Storage* to) noexcept {
+            if constexpr (isStoredInline<Functor>()) {
+                new (to) Functor(std::move(*get(from)));
+                get(from)->~Functor();
+            } else {
+                *reinterpret_cast<Functor**>(to) = get(from);
+            }
+        }
 
-            RetType call(Args&&... args) override {
-                return callRegularVoid(std::is_void<RetType>(), f, std::forward<Args>(args)...);
+        static void destroy(Storage* storage) noexcept {
+            if constexpr (isStoredInline<Functor>()) {
+                get(storage)->~Functor();
+            } else {
+                delete get(storage);
             }
+        }
+
+        static constexpr Ops kOps = {&call, &relocate, &destroy};
+    };
 
-            std::decay_t<Functor> f;
-        };
+    void reset() noexcept {
+        if (_ops) {
+            _ops->destroy(&_storage);
+            _ops = nullptr;
+        }
+    }
 
-        return std::make_unique<SpecificImpl>(std::forward<Functor>(functor));
+    // Requires that this is empty. Leaves `that` empty.
+    void takeFrom(unique_function& that) noexcept {
+        if (that._ops) {
+            that._ops->relocate(&that._storage, &_storage);
+            _ops = std::exchange(that._ops, nullptr);
+        }
     }
 
-    std::unique_ptr<Impl> impl;
+    const Ops* _ops = nullptr;
+    mutable Storage _storage;
 };
 
 /**
@@ -30,7 +30,12 @@
 #include "mongo/platform/basic.h"
 
 #include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
 
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/future.h"
 
 namespace mongo {
@@ -198,6 +203,107 @@ void BM_futureInt4xDeferredThenChained(benchmark::State& state) {
     }
 }
 
+void BM_futureIntReadyThenChain(benchmark::State& state) {
+    const int length = state.range(0);
+    for (auto _ : state) {
+        auto fut = makeReadyFut();
+        for (int i = 0; i < length; ++i) {
+            fut = std::move(fut).then([](int i) { return i + 1; });
+        }
+        benchmark::DoNotOptimize(std::move(fut).get());
+    }
+}
+
+void BM_futureIntDeferredThenChain(benchmark::State& state) {
+    const int length = state.range(0);
+    for (auto _ : state) {
+        benchmark::ClobberMemory();
+        auto pf = makePromiseFuture<int>();
+        auto fut = std::move(pf.future);
+        for (int i = 0; i < length; ++i) {
+            fut = std::move(fut).then([](int i) { return i + 1; });
+        }
+        pf.promise.emplaceValue(1);
+        benchmark::DoNotOptimize(std::move(fut).get());
+    }
+}
+
+// Like BM_futureIntDeferredThenChain, but with continuations capturing state the way most real
+// ones do.
+void BM_futureIntDeferredThenChainCapturing(benchmark::State& state) {
+    const int length = state.range(0);
+    const auto increment = std::make_shared<int>(1);
+    for (auto _ : state) {
+        benchmark::ClobberMemory();
+        auto pf = makePromiseFuture<int>();
+        auto fut = std::move(pf.future);
+        for (int i = 0; i < length; ++i) {
+            fut = std::move(fut).then([increment, i](int val) { return val + *increment + i; });
+        }
+        pf.promise.emplaceValue(1);
+        benchmark::DoNotOptimize(std::move(fut).get());
+    }
+}
+
+// Completes promises on another thread while this thread waits on futures chained off of them. The
+// promises are handed over in batches of state.range(0).
+void BM_futureIntCrossThreadFulfill(benchmark::State& state) {
+    const int batchSize = state.range(0);
+
+    stdx::mutex mutex;
+    stdx::condition_variable cv;
+    std::vector<Promise<int>> toFulfill;
+    bool done = false;
+
+    stdx::thread fulfiller([&] {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        while (true) {
+            cv.wait(lk, [&] { return done || !toFulfill.empty(); });
+            if (toFulfill.empty()) {
+                return;
+            }
+
+            auto promises = std::move(toFulfill);
+            toFulfill.clear();
+            lk.unlock();
+            for (auto& promise : promises) {
+                promise.emplaceValue(1);
+            }
+            lk.lock();
+        }
+    });
+
+    std::vector<Promise<int>> promises;
+    std::vector<Future<int>> futures;
+    for (auto _ : state) {
+        for (int i = 0; i < batchSize; ++i) {
+            auto pf = makePromiseFuture<int>();
+            promises.push_back(std::move(pf.promise));
+            futures.push_back(std::move(pf.future).then([](int i) { return i + 1; }));
+        }
+
+        {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            toFulfill = std::move(promises);
+        }
+        cv.notify_one();
+        promises.clear();
+
+        for (auto& fut : futures) {
+            benchmark::DoNotOptimize(std::move(fut).get());
+        }
+        futures.clear();
+    }
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        done = true;
+    }
+    cv.notify_one();
+    fulfiller.join();
+
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
 
 BENCHMARK(BM_plainIntReady);
 BENCHMARK(BM_futureIntReady);
@@ -212,5 +318,9 @@ BENCHMARK(BM_futureInt3xDeferredThenNested);
 BENCHMARK(BM_futureInt3xDeferredThenChained);
 BENCHMARK(BM_futureInt4xDeferredThenNested);
 BENCHMARK(BM_futureInt4xDeferredThenChained);
+BENCHMARK(BM_futureIntReadyThenChain)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK(BM_futureIntDeferredThenChain)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK(BM_futureIntDeferredThenChainCapturing)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK(BM_futureIntCrossThreadFulfill)->Arg(1)->Arg(100);
 
 }  // namespace mongo
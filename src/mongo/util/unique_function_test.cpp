@@ -171,6 +171,73 @@ TEST(UniqueFunctionTest, dtor_releases_functor_object_and_does_not_call_function
     ASSERT_FALSE(runDetection1.itRan);
 }
 
+// Counts the live copies of a functor, to check that a unique_function holding it destroys exactly
+// the copies it made, whether it stores the functor inline or on the heap.
+template <std::size_t padding, bool nothrowMove = true>
+struct CountedFunctor {
+    explicit CountedFunctor(int* live) : live(live) {
+        ++*live;
+    }
+    CountedFunctor(CountedFunctor&& other) noexcept(nothrowMove) : live(other.live) {
+        ++*live;
+    }
+    CountedFunctor(const CountedFunctor&) = delete;
+    CountedFunctor& operator=(const CountedFunctor&) = delete;
+    ~CountedFunctor() {
+        --*live;
+    }
+
+    int operator()(int x) const {
+        return x + static_cast<int>(sizeof(pad));
+    }
+
+    int* live;
+    char pad[padding] = {};
+};
+
+template <typename Functor>
+void checkMovesAndDestroysFunctor() {
+    int live = 0;
+    {
+        mongo::unique_function<int(int)> uf{Functor(&live)};
+        ASSERT_EQ(live, 1);
+        ASSERT_EQ(uf(1), 1 + static_cast<int>(sizeof(Functor::pad)));
+
+        mongo::unique_function<int(int)> uf2 = std::move(uf);
+        ASSERT_FALSE(uf);
+        ASSERT_EQ(live, 1);
+        ASSERT_EQ(uf2(1), 1 + static_cast<int>(sizeof(Functor::pad)));
+
+        mongo::unique_function<int(int)> uf3{Functor(&live)};
+        ASSERT_EQ(live, 2);
+        uf3.swap(uf2);
+        ASSERT_EQ(live, 2);
+
+        uf3 = std::move(uf2);
+        ASSERT_FALSE(uf2);
+        ASSERT_EQ(live, 1);
+
+        uf3 = nullptr;
+        ASSERT_EQ(live, 0);
+
+        uf3 = Functor(&live);
+        ASSERT_EQ(live, 1);
+    }
+    ASSERT_EQ(live, 0);
+}
+
+TEST(UniqueFunctionTest, moves_and_destroys_small_functor) {
+    checkMovesAndDestroysFunctor<CountedFunctor<1>>();
+}
+
+TEST(UniqueFunctionTest, moves_and_destroys_large_functor) {
+    checkMovesAndDestroysFunctor<CountedFunctor<256>>();
+}
+
+TEST(UniqueFunctionTest, moves_and_destroys_small_functor_with_throwing_move) {
+    checkMovesAndDestroysFunctor<CountedFunctor<1, false>>();
+}
+
 TEST(UniqueFunctionTest, comparison_checks) {
     mongo::unique_function<void()> uf;
 